@@ -0,0 +1,386 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+/**************************************************************
+ *****   Kernel Benchmarks
+ **************************************************************
+ ***** Google Benchmark suite of the serial kernels used in AMG
+ ***** setup and solve, for regression tracking on a single node.
+ ***** Each benchmark takes (problem, n) as arguments, where
+ ***** problem selects a gallery matrix :
+ *****    0 : 27-point Laplacian on an n x n x n grid
+ *****    1 : rotated anisotropic diffusion on an n x n grid
+ *****    2 : random, n*n rows with 10 entries per row
+ ***** Inputs are formed before timing.  Rates are reported as
+ ***** counters GB/s (bytes of the CSR arrays and vectors streamed,
+ ***** a lower bound on traffic), GFlop/s and nnz/s.
+ *****
+ ***** Run on a single process, e.g.
+ *****    ./bench_kernels --benchmark_out=kernels.json
+ *****        --benchmark_out_format=json
+ *****        --benchmark_filter=SpMV
+ **************************************************************/
+#include <benchmark/benchmark.h>
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+enum bench_problem_t {Laplace27, Diffusion2D, RandomMatrix};
+static const char* problem_names[3] = {"laplace_27pt", "diffusion_2d", "random"};
+
+static CSRMatrix* bench_matrix(int problem, int n)
+{
+    CSRMatrix* A = NULL;
+    double* stencil = NULL;
+    std::vector<int> grid;
+    switch (problem)
+    {
+        case Laplace27:
+            grid.resize(3, n);
+            stencil = laplace_stencil_27pt();
+            A = stencil_grid(stencil, grid.data(), 3);
+            delete[] stencil;
+            break;
+        case Diffusion2D:
+            grid.resize(2, n);
+            stencil = diffusion_stencil_2d(0.001, M_PI/8.0);
+            A = stencil_grid(stencil, grid.data(), 2);
+            delete[] stencil;
+            break;
+        default:
+            srand(2448422);
+            A = random(n*n, n*n, 10);
+            break;
+    }
+    return A;
+}
+
+// Bytes of the CSR arrays of A
+static double csr_bytes(CSRMatrix* A)
+{
+    return (double)A->nnz * (sizeof(double) + sizeof(int))
+        + (double)(A->n_rows + 1) * sizeof(int);
+}
+
+static void set_rates(benchmark::State& state, CSRMatrix* A, double bytes,
+        double flops, double nnz)
+{
+    state.SetLabel(problem_names[state.range(0)]);
+    state.counters["rows"] = A->n_rows;
+    state.counters["nnz"] = A->nnz;
+    state.counters["GB/s"] = benchmark::Counter(bytes * 1e-9,
+            benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["GFlop/s"] = benchmark::Counter(flops * 1e-9,
+            benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["nnz/s"] = benchmark::Counter(nnz,
+            benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_CSRSpMV(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    Vector x(A->n_cols);
+    Vector b(A->n_rows);
+    x.set_const_value(1.0);
+
+    for (auto _ : state)
+    {
+        A->mult(x, b);
+        benchmark::DoNotOptimize(b.data());
+        benchmark::ClobberMemory();
+    }
+
+    double bytes = csr_bytes(A) + (double)(A->n_rows + A->n_cols) * sizeof(double);
+    set_rates(state, A, bytes, 2.0 * A->nnz, A->nnz);
+    delete A;
+}
+
+// Block SpMV : each entry of the gallery matrix becomes a dense
+// block_size x block_size block
+static void BM_BSRSpMV(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    int block_size = state.range(2);
+    int b_size = block_size * block_size;
+
+    std::vector<double*> blocks(A->nnz);
+    for (int i = 0; i < A->nnz; i++)
+    {
+        blocks[i] = new double[b_size];
+        for (int j = 0; j < b_size; j++)
+        {
+            blocks[i][j] = A->vals[i] / (j + 1);
+        }
+    }
+    BSRMatrix* A_bsr = new BSRMatrix(A->n_rows, A->n_cols, block_size,
+            block_size, A->idx1, A->idx2, blocks);
+    for (int i = 0; i < A->nnz; i++)
+    {
+        delete[] blocks[i];
+    }
+
+    std::vector<double> x(A->n_cols * block_size, 1.0);
+    std::vector<double> b(A->n_rows * block_size);
+
+    for (auto _ : state)
+    {
+        A_bsr->spmv(x.data(), b.data());
+        benchmark::DoNotOptimize(b.data());
+        benchmark::ClobberMemory();
+    }
+
+    double bytes = (double)A_bsr->nnz * (b_size * sizeof(double) + sizeof(int))
+        + (double)(A_bsr->n_rows + 1) * sizeof(int)
+        + (double)(x.size() + b.size()) * sizeof(double);
+    set_rates(state, A, bytes, 2.0 * A_bsr->nnz * b_size,
+            (double)A_bsr->nnz * b_size);
+    state.counters["block_size"] = block_size;
+    delete A_bsr;
+    delete A;
+}
+
+// Sparse matrix-matrix product A*A (the kernel of AP and PTAP)
+static void BM_SpGEMM(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+
+    // Flops : one multiply and add per pair of entries A_ik, A_kj
+    double flops = 0;
+    for (int i = 0; i < A->nnz; i++)
+    {
+        int k = A->idx2[i];
+        flops += 2.0 * (A->idx1[k+1] - A->idx1[k]);
+    }
+
+    int nnz_C = 0;
+    for (auto _ : state)
+    {
+        CSRMatrix* C = A->spgemm(A);
+        nnz_C = C->nnz;
+        delete C;
+    }
+
+    double bytes = 2 * csr_bytes(A) + (double)nnz_C * (sizeof(double) + sizeof(int));
+    set_rates(state, A, bytes, flops, A->nnz);
+    state.counters["nnz_C"] = nnz_C;
+    delete A;
+}
+
+static void BM_Transpose(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        CSRMatrix* AT = A->transpose();
+        delete AT;
+    }
+
+    set_rates(state, A, 2 * csr_bytes(A), 0, A->nnz);
+    delete A;
+}
+
+// Relaxation sweep (Jacobi, SOR or SSOR, range(2) as relax_t)
+static void BM_Relax(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    A->sort();
+    A->move_diag();
+    relax_t relax_type = (relax_t) state.range(2);
+    Vector x(A->n_rows);
+    Vector b(A->n_rows);
+    Vector tmp(A->n_rows);
+    x.set_const_value(0.0);
+    b.set_const_value(1.0);
+
+    for (auto _ : state)
+    {
+        switch (relax_type)
+        {
+            case Jacobi:
+                jacobi(A, b, x, tmp, 1, 2.0/3);
+                break;
+            case SOR:
+                sor(A, b, x, tmp, 1, 1.0);
+                break;
+            case SSOR:
+                ssor(A, b, x, tmp, 1, 1.0);
+                break;
+        }
+        benchmark::DoNotOptimize(x.data());
+        benchmark::ClobberMemory();
+    }
+
+    // SSOR is a forward and backward sweep
+    double passes = relax_type == SSOR ? 2.0 : 1.0;
+    double bytes = passes * (csr_bytes(A) + 3.0 * A->n_rows * sizeof(double));
+    set_rates(state, A, bytes, passes * 2.0 * A->nnz, passes * A->nnz);
+    static const char* relax_names[3] = {"jacobi", "sor", "ssor"};
+    state.SetLabel(std::string(problem_names[state.range(0)]) + "/"
+            + relax_names[relax_type]);
+    delete A;
+}
+
+static void BM_Strength(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    A->sort();
+    A->move_diag();
+
+    for (auto _ : state)
+    {
+        CSRMatrix* S = A->strength(Classical, 0.25);
+        delete S;
+    }
+
+    set_rates(state, A, 2 * csr_bytes(A), 0, A->nnz);
+    delete A;
+}
+
+// CF splitting (range(2) as coarsen_t).  On a single process HMIS is
+// the first pass of Ruge-Stuben, as PMIS only treats the remaining
+// (off-process) undecided points.
+static void BM_Splitting(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    A->sort();
+    A->move_diag();
+    CSRMatrix* S = A->strength(Classical, 0.25);
+    coarsen_t coarsen_type = (coarsen_t) state.range(2);
+    std::vector<int> states;
+
+    for (auto _ : state)
+    {
+        switch (coarsen_type)
+        {
+            case CLJP:
+                split_cljp(S, states);
+                break;
+            case PMIS:
+                split_pmis(S, states);
+                break;
+            case HMIS:
+                split_rs(S, states, false, false);
+                break;
+            default:
+                split_rs(S, states);
+                break;
+        }
+        benchmark::DoNotOptimize(states.data());
+    }
+
+    int n_coarse = 0;
+    for (int i = 0; i < (int)states.size(); i++)
+    {
+        if (states[i] == Selected) n_coarse++;
+    }
+    set_rates(state, S, csr_bytes(S), 0, S->nnz);
+    state.counters["coarse_frac"] = (double)n_coarse / A->n_rows;
+    static const char* coarsen_names[5] = {"rs", "cljp", "falgout", "pmis", "hmis"};
+    state.SetLabel(std::string(problem_names[state.range(0)]) + "/"
+            + coarsen_names[coarsen_type]);
+    delete S;
+    delete A;
+}
+
+// Interpolation (range(2) as interp_t) from a PMIS splitting
+static void BM_Interpolation(benchmark::State& state)
+{
+    CSRMatrix* A = bench_matrix(state.range(0), state.range(1));
+    A->sort();
+    A->move_diag();
+    CSRMatrix* S = A->strength(Classical, 0.25);
+    interp_t interp_type = (interp_t) state.range(2);
+    std::vector<int> states;
+    split_pmis(S, states);
+
+    int nnz_P = 0;
+    for (auto _ : state)
+    {
+        CSRMatrix* P = NULL;
+        switch (interp_type)
+        {
+            case Direct:
+                P = direct_interpolation(A, S, states);
+                break;
+            case ModClassical:
+                P = mod_classical_interpolation(A, S, states);
+                break;
+            case Extended:
+                P = extended_interpolation(A, S, states);
+                break;
+        }
+        nnz_P = P->nnz;
+        delete P;
+    }
+
+    set_rates(state, A, csr_bytes(A) + csr_bytes(S), 0, A->nnz);
+    state.counters["nnz_P"] = nnz_P;
+    static const char* interp_names[3] = {"direct", "mod_classical", "extended"};
+    state.SetLabel(std::string(problem_names[state.range(0)]) + "/"
+            + interp_names[interp_type]);
+    delete S;
+    delete A;
+}
+
+// Grid sizes : ~27K to ~1M rows for the 3D problem, ~16K to ~1M otherwise
+static void problem_args(benchmark::internal::Benchmark* b)
+{
+    for (int n : {30, 60, 100}) b->Args({Laplace27, n});
+    for (int n : {128, 512, 1024}) b->Args({Diffusion2D, n});
+    for (int n : {128, 512}) b->Args({RandomMatrix, n});
+}
+
+// AMG kernels on the PDE problems, with a kernel variant as range(2)
+static void amg_args(benchmark::internal::Benchmark* b,
+        std::initializer_list<int> variants)
+{
+    for (int v : variants)
+    {
+        for (int n : {30, 60}) b->Args({Laplace27, n, v});
+        for (int n : {256, 1024}) b->Args({Diffusion2D, n, v});
+    }
+}
+
+BENCHMARK(BM_CSRSpMV)->Apply(problem_args)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BSRSpMV)->Apply([](benchmark::internal::Benchmark* b)
+        {
+            for (int block_size : {2, 3, 4})
+            {
+                b->Args({Laplace27, 30, block_size});
+                b->Args({Diffusion2D, 512, block_size});
+            }
+        })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SpGEMM)->Apply(problem_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Transpose)->Apply(problem_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Relax)->Apply([](benchmark::internal::Benchmark* b)
+        {
+            amg_args(b, {Jacobi, SOR, SSOR});
+        })->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Strength)->Apply([](benchmark::internal::Benchmark* b)
+        {
+            amg_args(b, {0});
+        })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Splitting)->Apply([](benchmark::internal::Benchmark* b)
+        {
+            amg_args(b, {RS, CLJP, PMIS, HMIS});
+        })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Interpolation)->Apply([](benchmark::internal::Benchmark* b)
+        {
+            amg_args(b, {Direct, ModClassical, Extended});
+        })->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,357 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+/**************************************************************
+ *****   AMG Scaling Benchmark
+ **************************************************************
+ ***** Sets up and solves one AMG hierarchy, configured entirely
+ ***** from the command line, and writes a JSON record (rank 0) of
+ ***** the problem, options, total and per-level setup and solve
+ ***** times (max over processes), iterations, complexities and
+ ***** communication volume of each level.  Sweeps over process
+ ***** counts are run with scaling_sweep.py.
+ *****
+ ***** Options (--name value)
+ ***** -------
+ ***** --problem laplace27 | diffusion | random | file (laplace27)
+ ***** --n : grid points per dimension (or sqrt of random rows) (20)
+ ***** --scaling strong | weak (strong)
+ *****    If weak, n is per process : the grid has n * p^(1/dim)
+ *****    points per dimension
+ ***** --file : .pm (RAPtor binary) or .mtx (Matrix Market) matrix
+ ***** --eps, --theta : anisotropy and rotation of diffusion
+ ***** --solver rs | sa (rs)
+ ***** --coarsen rs | cljp | falgout | pmis | hmis (hmis)
+ ***** --interp direct | mod_classical | extended (extended)
+ ***** --strength classical | symmetric (classical for rs)
+ ***** --relax jacobi | sor | ssor (sor)
+ ***** --theta_s : strong threshold (0.25 rs, 0.0 sa)
+ ***** --comm par | tap | model | timed (par)
+ *****    Standard, node-aware on levels >= tap_level, or chosen
+ *****    per level by the model / timed probes
+ ***** --tap_level : first TAP level with --comm tap (0)
+ ***** --shared_memory 0 | 1 : node-local TAP steps through MPI-3
+ *****    shared memory (0)
+ ***** --store_restriction 0 | 1 (0)
+ ***** --max_coarse, --max_levels, --tol, --max_iter
+ ***** --repeat : number of setups and solves (1)
+ ***** --out : JSON file (stdout)
+ **************************************************************/
+#include <map>
+#include <cstring>
+#include <string>
+#include <math.h>
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+typedef std::map<std::string, std::string> options_t;
+
+static std::string get_option(options_t& opts, const char* name,
+        const char* default_value)
+{
+    options_t::iterator it = opts.find(name);
+    if (it == opts.end()) return default_value;
+    return it->second;
+}
+
+static int find_option(const char** names, int n, const std::string& value)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (value == names[i]) return i;
+    }
+    return -1;
+}
+
+static bool ends_with(const std::string& str, const char* suffix)
+{
+    std::string s(suffix);
+    return str.size() >= s.size()
+        && str.compare(str.size() - s.size(), s.size(), s) == 0;
+}
+
+// Total time and MPI time (collective and point-to-point, which vector
+// and matrix communication times include) of the regions of a level
+// directly within region, max over processes
+static void level_times(TimerRegion* region, int level, double* max_times)
+{
+    double times[2] = {0.0, 0.0};
+    if (region)
+    {
+        for (int c = 0; c < (int)region->children.size(); c++)
+        {
+            TimerRegion* child = region->children[c];
+            if (child->level != level) continue;
+            times[0] += child->time;
+            times[1] += child->comm_times[CollectiveTime]
+                + child->comm_times[P2PTime];
+        }
+    }
+    RAPtor_MPI_Allreduce(times, max_times, 2, RAPtor_MPI_DOUBLE, RAPtor_MPI_MAX,
+            RAPtor_MPI_COMM_WORLD);
+}
+
+static double max_time(double t)
+{
+    double max_t;
+    RAPtor_MPI_Allreduce(&t, &max_t, 1, RAPtor_MPI_DOUBLE, RAPtor_MPI_MAX,
+            RAPtor_MPI_COMM_WORLD);
+    return max_t;
+}
+
+static long global_nnz(ParCSRMatrix* A)
+{
+    long nnz = A->on_proc->nnz + A->off_proc->nnz;
+    long global;
+    RAPtor_MPI_Allreduce(&nnz, &global, 1, RAPtor_MPI_LONG, RAPtor_MPI_SUM,
+            RAPtor_MPI_COMM_WORLD);
+    return global;
+}
+
+int main(int argc, char* argv[])
+{
+    MPI_Init(&argc, &argv);
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    options_t opts;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strncmp(argv[i], "--", 2) != 0)
+        {
+            if (rank == 0) printf("Expected --name value, got %s\n", argv[i]);
+            MPI_Finalize();
+            return 1;
+        }
+        opts[argv[i] + 2] = argv[i+1];
+    }
+
+    const char* problem_names[4] = {"laplace27", "diffusion", "random", "file"};
+    const char* solver_names[2] = {"rs", "sa"};
+    const char* coarsen_names[5] = {"rs", "cljp", "falgout", "pmis", "hmis"};
+    const char* interp_names[3] = {"direct", "mod_classical", "extended"};
+    const char* strength_names[2] = {"classical", "symmetric"};
+    const char* relax_names[3] = {"jacobi", "sor", "ssor"};
+    const char* comm_names[4] = {"par", "tap", "model", "timed"};
+    const char* scaling_names[2] = {"strong", "weak"};
+
+    int problem = find_option(problem_names, 4, get_option(opts, "problem", "laplace27"));
+    int solver = find_option(solver_names, 2, get_option(opts, "solver", "rs"));
+    int coarsen = find_option(coarsen_names, 5, get_option(opts, "coarsen", "hmis"));
+    int interp = find_option(interp_names, 3, get_option(opts, "interp", "extended"));
+    int strength = find_option(strength_names, 2, get_option(opts, "strength",
+                solver == 1 ? "symmetric" : "classical"));
+    int relax = find_option(relax_names, 3, get_option(opts, "relax", "sor"));
+    int comm = find_option(comm_names, 4, get_option(opts, "comm", "par"));
+    int scaling = find_option(scaling_names, 2, get_option(opts, "scaling", "strong"));
+    if (problem < 0 || solver < 0 || coarsen < 0 || interp < 0 || strength < 0
+            || relax < 0 || comm < 0 || scaling < 0)
+    {
+        if (rank == 0) printf("Unknown option value\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    int n = atoi(get_option(opts, "n", "20").c_str());
+    double eps = atof(get_option(opts, "eps", "0.001").c_str());
+    double theta = atof(get_option(opts, "theta", "0.3926990817").c_str());
+    double theta_s = atof(get_option(opts, "theta_s", solver == 1 ? "0.0" : "0.25").c_str());
+    int tap_level = atoi(get_option(opts, "tap_level", "0").c_str());
+    int repeat = atoi(get_option(opts, "repeat", "1").c_str());
+    std::string file = get_option(opts, "file", "");
+    std::string out = get_option(opts, "out", "");
+
+    // Form the problem
+    ParCSRMatrix* A = NULL;
+    int dim = problem == 0 ? 3 : 2;
+    int n_dim = n;
+    if (scaling == 1)
+    {
+        n_dim = (int)(n * pow((double)num_procs, 1.0 / dim) + 0.5);
+    }
+    double* stencil = NULL;
+    std::vector<int> grid(dim, n_dim);
+    switch (problem)
+    {
+        case 0:
+            stencil = laplace_stencil_27pt();
+            A = par_stencil_grid(stencil, grid.data(), dim);
+            delete[] stencil;
+            break;
+        case 1:
+            stencil = diffusion_stencil_2d(eps, theta);
+            A = par_stencil_grid(stencil, grid.data(), dim);
+            delete[] stencil;
+            break;
+        case 2:
+            A = par_random(n_dim * n_dim, n_dim * n_dim, 10);
+            break;
+        case 3:
+            if (ends_with(file, ".mtx")) A = read_par_mm(file.c_str());
+            else A = readParMatrix(file.c_str());
+            break;
+    }
+    if (A == NULL)
+    {
+        if (rank == 0) printf("Could not form problem\n");
+        MPI_Finalize();
+        return 1;
+    }
+
+    ParVector x(A->global_num_cols, A->on_proc_num_cols);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    x.set_const_value(1.0);
+    A->mult(x, b);
+
+    std::vector<double> setup_times(repeat);
+    std::vector<double> solve_times(repeat);
+    ParMultilevel* ml = NULL;
+    int iter = 0;
+    for (int r = 0; r < repeat; r++)
+    {
+        if (ml) delete ml;
+        if (solver == 0)
+        {
+            ml = new ParRugeStubenSolver(theta_s, (coarsen_t) coarsen,
+                    (interp_t) interp, (strength_t) strength, (relax_t) relax);
+        }
+        else
+        {
+            ml = new ParSmoothedAggregationSolver(theta_s, MIS,
+                    JacobiProlongation, (strength_t) strength, (relax_t) relax);
+        }
+        ml->track_times = true;
+        ml->store_residuals = true;
+        ml->store_restriction = atoi(get_option(opts, "store_restriction", "0").c_str());
+        ml->tap_shared_memory = atoi(get_option(opts, "shared_memory", "0").c_str());
+        ml->max_coarse = atoi(get_option(opts, "max_coarse", "50").c_str());
+        ml->max_levels = atoi(get_option(opts, "max_levels", "25").c_str());
+        ml->solve_tol = atof(get_option(opts, "tol", "1e-07").c_str());
+        ml->max_iterations = atoi(get_option(opts, "max_iter", "100").c_str());
+        switch (comm)
+        {
+            case 1:
+                ml->tap_amg = tap_level;
+                break;
+            case 2:
+                ml->comm_select = ModelComm;
+                break;
+            case 3:
+                ml->comm_select = TimedComm;
+                break;
+        }
+
+        RAPtor_MPI_Barrier(RAPtor_MPI_COMM_WORLD);
+        ml->setup(A);
+        setup_times[r] = max_time(timers.find(ml->setup_path)->time);
+
+        x.set_const_value(0.0);
+        RAPtor_MPI_Barrier(RAPtor_MPI_COMM_WORLD);
+        iter = ml->solve(x, b);
+        solve_times[r] = max_time(timers.find(ml->solve_path)->time);
+    }
+
+    // Per level sizes, times and communication
+    std::vector<long> rows(ml->num_levels);
+    std::vector<long> nnz(ml->num_levels);
+    std::vector<double> level_setup(2*ml->num_levels);
+    std::vector<double> level_solve(2*ml->num_levels);
+    double op_complexity = 0, grid_complexity = 0;
+    for (int i = 0; i < ml->num_levels; i++)
+    {
+        rows[i] = ml->levels[i]->A->global_num_rows;
+        nnz[i] = global_nnz(ml->levels[i]->A);
+        op_complexity += (double)nnz[i] / nnz[0];
+        grid_complexity += (double)rows[i] / rows[0];
+        level_times(timers.find(ml->setup_path), i, &level_setup[2*i]);
+        level_times(timers.find(ml->solve_path), i, &level_solve[2*i]);
+    }
+    std::vector<CommStats> stats = ml->get_comm_stats();
+    std::vector<double>& residuals = ml->get_residuals();
+
+    if (rank == 0)
+    {
+        FILE* f = stdout;
+        if (!out.empty()) f = fopen(out.c_str(), "w");
+        if (f == NULL)
+        {
+            printf("Could not open %s\n", out.c_str());
+            f = stdout;
+        }
+
+        fprintf(f, "{\n  \"num_procs\": %d,\n", num_procs);
+        fprintf(f, "  \"options\": {");
+        for (options_t::iterator it = opts.begin(); it != opts.end(); ++it)
+        {
+            fprintf(f, "%s\"%s\": \"%s\"", it == opts.begin() ? "" : ", ",
+                    it->first.c_str(), it->second.c_str());
+        }
+        fprintf(f, "},\n");
+        fprintf(f, "  \"problem\": \"%s\", \"solver\": \"%s\", \"coarsen\": \"%s\", "
+                "\"interp\": \"%s\", \"strength\": \"%s\", \"relax\": \"%s\", "
+                "\"comm\": \"%s\", \"scaling\": \"%s\",\n", problem_names[problem],
+                solver_names[solver], coarsen_names[coarsen], interp_names[interp],
+                strength_names[strength], relax_names[relax], comm_names[comm],
+                scaling_names[scaling]);
+        if (problem < 3) fprintf(f, "  \"grid_n\": %d,\n", n_dim);
+        else fprintf(f, "  \"file\": \"%s\",\n", file.c_str());
+        fprintf(f, "  \"global_rows\": %ld, \"global_nnz\": %ld,\n", rows[0], nnz[0]);
+        fprintf(f, "  \"num_levels\": %d, \"iterations\": %d, "
+                "\"final_residual\": %.6e,\n", ml->num_levels, iter,
+                iter < (int)residuals.size() ? residuals[iter] : 0.0);
+        fprintf(f, "  \"operator_complexity\": %.6f, \"grid_complexity\": %.6f,\n",
+                op_complexity, grid_complexity);
+        fprintf(f, "  \"setup_times\": [");
+        for (int r = 0; r < repeat; r++)
+        {
+            fprintf(f, "%s%.6e", r ? ", " : "", setup_times[r]);
+        }
+        fprintf(f, "],\n  \"solve_times\": [");
+        for (int r = 0; r < repeat; r++)
+        {
+            fprintf(f, "%s%.6e", r ? ", " : "", solve_times[r]);
+        }
+        fprintf(f, "],\n  \"levels\": [\n");
+        for (int i = 0; i < ml->num_levels; i++)
+        {
+            fprintf(f, "    {\"level\": %d, \"rows\": %ld, \"nnz\": %ld, "
+                    "\"setup_time\": %.6e, \"setup_comm_time\": %.6e, "
+                    "\"solve_time\": %.6e, \"solve_comm_time\": %.6e, \"comm\": [",
+                    i, rows[i], nnz[i], level_setup[2*i], level_setup[2*i+1],
+                    level_solve[2*i], level_solve[2*i+1]);
+            bool first = true;
+            for (int s = 0; s < (int)stats.size(); s++)
+            {
+                CommStats& st = stats[s];
+                if (st.level != i) continue;
+                double max_msgs = 0, max_bytes = 0;
+                for (int j = 0; j < NUM_LOCALITIES; j++)
+                {
+                    max_msgs += st.max_msgs[j];
+                    max_bytes += st.max_bytes[j];
+                }
+                fprintf(f, "%s\n      {\"name\": \"%s\", \"type\": \"%s\", "
+                        "\"max_msgs\": %.10g, \"max_bytes\": %.10g, "
+                        "\"max_inter_node_msgs\": %.10g, \"max_inter_node_bytes\": %.10g, "
+                        "\"avg_bytes\": %.10g}", first ? "" : ",", st.name.c_str(),
+                        st.comm_type.c_str(), max_msgs, max_bytes,
+                        st.max_msgs[InterNode], st.max_bytes[InterNode],
+                        st.avg_bytes[IntraSocket] + st.avg_bytes[IntraNode]
+                            + st.avg_bytes[InterNode]);
+                first = false;
+            }
+            fprintf(f, "]}%s\n", i + 1 < ml->num_levels ? "," : "");
+        }
+        fprintf(f, "  ]\n}\n");
+
+        if (f != stdout) fclose(f);
+    }
+
+    delete ml;
+    delete A;
+
+    MPI_Finalize();
+    return 0;
+}
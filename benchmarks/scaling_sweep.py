@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+# Copyright (c) 2015-2017, RAPtor Developer Team
+# License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+"""Weak or strong scaling sweep of bench_scaling with a local mpirun.
+
+Runs bench_scaling once per process count (and per configuration given
+with --config), and collects the JSON records into a single array.
+Options not recognized here are passed to bench_scaling, e.g.
+
+    ./scaling_sweep.py --procs 1 2 4 8 --scaling weak -o weak.json \\
+        --config "--coarsen hmis --interp extended" \\
+        --config "--coarsen pmis --interp mod_classical --comm tap" \\
+        -- --problem laplace27 --n 20
+"""
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+            formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--procs', type=int, nargs='+', default=[1, 2, 4],
+            help='process counts')
+    parser.add_argument('--scaling', choices=['strong', 'weak'], default='strong')
+    parser.add_argument('--config', action='append', default=[],
+            help='bench_scaling options of one configuration (repeatable)')
+    parser.add_argument('--mpirun', default='mpirun',
+            help='MPI launcher, split on whitespace')
+    parser.add_argument('--exe', default=os.path.join(
+            os.path.dirname(os.path.abspath(__file__)), 'bench_scaling'))
+    parser.add_argument('-o', '--output', default='scaling.json')
+    args, extra = parser.parse_known_args()
+    if extra and extra[0] == '--':
+        extra = extra[1:]
+
+    records = []
+    configs = args.config if args.config else ['']
+    for config in configs:
+        for p in args.procs:
+            fd, out = tempfile.mkstemp(suffix='.json')
+            os.close(fd)
+            cmd = shlex.split(args.mpirun) + ['-n', str(p), args.exe,
+                    '--scaling', args.scaling, '--out', out] \
+                    + shlex.split(config) + extra
+            print(' '.join(cmd), file=sys.stderr)
+            result = subprocess.run(cmd)
+            if result.returncode == 0:
+                with open(out) as f:
+                    record = json.load(f)
+                record['config'] = config
+                records.append(record)
+                print('  setup %.3e s, solve %.3e s, %d iterations'
+                        % (min(record['setup_times']), min(record['solve_times']),
+                            record['iterations']), file=sys.stderr)
+            else:
+                print('  failed (%d)' % result.returncode, file=sys.stderr)
+            os.remove(out)
+
+    with open(args.output, 'w') as f:
+        json.dump(records, f, indent=1)
+
+
+if __name__ == '__main__':
+    main()
@@ -1,5 +1,6 @@
 option(BUILD_SHARED_LIBS "Build the shared library" ON)
 option(BUILD_EXAMPLES "Build the examples" ON)
+option(BUILD_BENCHMARKS "Build the kernel benchmarks (if Google Benchmark is found)" ON)
 option(ENABLE_UNIT_TESTS "Enable unit testing" ON)
 option(ENABLE_COVERAGE "Enable unit test coverage" OFF)
 set(TEST_COMM_SIZE "2" CACHE STRING "MPI Communicator Size for tests")
@@ -70,8 +70,8 @@ void time_spgemm(ParCSRMatrix* A, ParCSRMatrix* P, bool tap)
     }
     finalize_profile();
     average_profile(n_tests);
-    double tfinal = total_t / n_tests;
-    double comm_t = p2p_t / n_tests;
+    double tfinal = profile_region()->time;
+    double comm_t = profile_region()->comm_times[P2PTime];
 
     if (tap)
     {
@@ -107,8 +107,8 @@ void time_spgemm_T(ParCSRMatrix* A, ParCSCMatrix* P, bool tap)
     }
     finalize_profile();
     average_profile(n_tests);
-    tfinal = total_t / n_tests;
-    comm_t = p2p_t / n_tests;
+    tfinal = profile_region()->time;
+    comm_t = profile_region()->comm_times[P2PTime];
 
     if (tap)
     {
@@ -652,4 +652,208 @@ int mis2(const ParCSRMatrix* A, std::vector<int>& states,
     return iterate;
 }
 
+ParCSRMatrix* distance2_pattern(const ParCSRMatrix* A)
+{
+    // G is the pattern of A (which may have no values) with unit values,
+    // so that no entries of G*G cancel
+    ParCSRMatrix* G = new ParCSRMatrix(A->partition, A->global_num_rows,
+            A->global_num_cols, A->local_num_rows, A->on_proc_num_cols,
+            A->off_proc_num_cols);
+    G->on_proc->idx1 = A->on_proc->idx1;
+    G->on_proc->idx2 = A->on_proc->idx2;
+    G->on_proc->vals.assign(A->on_proc->nnz, 1.0);
+    G->on_proc->nnz = A->on_proc->nnz;
+    G->off_proc->idx1 = A->off_proc->idx1;
+    G->off_proc->idx2 = A->off_proc->idx2;
+    G->off_proc->vals.assign(A->off_proc->nnz, 1.0);
+    G->off_proc->nnz = A->off_proc->nnz;
+    G->local_nnz = A->local_nnz;
+    G->on_proc_column_map = A->on_proc_column_map;
+    G->local_row_map = A->local_row_map;
+    G->off_proc_column_map = A->off_proc_column_map;
+    G->comm = A->comm;
+    G->comm->num_shared++;
+    ParCSRMatrix* G2 = G->mult(G);
+    delete G;
+
+    G2->comm = new ParComm(G2->partition, G2->off_proc_column_map,
+            G2->on_proc_column_map);
+
+    return G2;
+}
+
+int mis2_ghost(const ParCSRMatrix* A, std::vector<int>& states,
+        std::vector<int>& off_proc_states, bool tap_comm, double* rand_vals)
+{
+    int start, end, col;
+    int remaining, iterate;
+    int ctr, v, n_msgs, n_active;
+    int tag = 41827;
+
+    // Ghost layer: off_proc columns of the distance-two pattern
+    ParCSRMatrix* G2 = distance2_pattern(A);
+    NonContigData* send_data = G2->comm->send_data;
+    CommData* recv_data = G2->comm->recv_data;
+    int first_row = A->partition->first_local_row;
+
+    std::vector<int> V(A->local_num_rows);
+    std::vector<double> r(A->local_num_rows);
+    std::iota(V.begin(), V.end(), 0);
+    states.resize(A->local_num_rows);
+    std::fill(states.begin(), states.end(), Unassigned);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (rand_vals) r[i] = rand_vals[i];
+        else r[i] = ((double)(rand()) / RAND_MAX);
+    }
+
+    // Weights of the ghost layer are exchanged once
+    std::vector<double>& recvbuf = G2->comm->communicate(r);
+    std::vector<double> ghost_r(recvbuf.begin(),
+            recvbuf.begin() + G2->off_proc_num_cols);
+    std::vector<int> ghost_states(G2->off_proc_num_cols, Unassigned);
+
+    // Ties in weight are broken by global index
+    auto wins = [](double r_a, int gid_a, double r_b, int gid_b)
+    {
+        return r_a > r_b || (r_a == r_b && gid_a > gid_b);
+    };
+
+    std::vector<int> send_buffer(send_data->size_msgs);
+    std::vector<int> active_sends(send_data->num_msgs, 1);
+    std::vector<int> active_recvs(recv_data->num_msgs, 1);
+    std::vector<RAPtor_MPI_Request> requests(send_data->num_msgs
+            + recv_data->num_msgs);
+
+    remaining = A->local_num_rows;
+    n_active = send_data->num_msgs + recv_data->num_msgs;
+    iterate = 0;
+    while (remaining || n_active)
+    {
+        // Unselect vertices near a selected vertex, and select those
+        // outweighing all unassigned vertices within distance two
+        ctr = 0;
+        for (int i = 0; i < remaining; i++)
+        {
+            v = V[i];
+            bool near_selected = false;
+            bool max_weight = true;
+
+            start = G2->on_proc->idx1[v];
+            end = G2->on_proc->idx1[v+1];
+            for (int j = start; j < end; j++)
+            {
+                col = G2->on_proc->idx2[j];
+                if (col == v) continue;
+                if (states[col] == Selected)
+                {
+                    near_selected = true;
+                    break;
+                }
+                if (states[col] == Unassigned && 
+                        !wins(r[v], first_row + v, r[col], first_row + col))
+                {
+                    max_weight = false;
+                }
+            }
+            if (!near_selected)
+            {
+                start = G2->off_proc->idx1[v];
+                end = G2->off_proc->idx1[v+1];
+                for (int j = start; j < end; j++)
+                {
+                    col = G2->off_proc->idx2[j];
+                    if (ghost_states[col] == Selected)
+                    {
+                        near_selected = true;
+                        break;
+                    }
+                    if (ghost_states[col] == Unassigned &&
+                            !wins(r[v], first_row + v, ghost_r[col], 
+                                G2->off_proc_column_map[col]))
+                    {
+                        max_weight = false;
+                    }
+                }
+            }
+
+            if (near_selected) states[v] = Unselected;
+            else if (max_weight) states[v] = Selected;
+            else V[ctr++] = v;
+        }
+        remaining = ctr;
+
+        // Single exchange of states with each active ghost neighbor.  A
+        // message with no unassigned states is the last between the pair
+        n_msgs = 0;
+        for (int i = 0; i < send_data->num_msgs; i++)
+        {
+            if (!active_sends[i]) continue;
+            start = send_data->indptr[i];
+            end = send_data->indptr[i+1];
+            active_sends[i] = 0;
+            for (int j = start; j < end; j++)
+            {
+                send_buffer[j] = states[send_data->indices[j]];
+                if (send_buffer[j] == Unassigned) active_sends[i] = 1;
+            }
+            RAPtor_MPI_Isend(&(send_buffer[start]), end - start, RAPtor_MPI_INT,
+                    send_data->procs[i], tag, RAPtor_MPI_COMM_WORLD,
+                    &(requests[n_msgs++]));
+        }
+        for (int i = 0; i < recv_data->num_msgs; i++)
+        {
+            if (!active_recvs[i]) continue;
+            start = recv_data->indptr[i];
+            end = recv_data->indptr[i+1];
+            RAPtor_MPI_Irecv(&(ghost_states[start]), end - start, RAPtor_MPI_INT,
+                    recv_data->procs[i], tag, RAPtor_MPI_COMM_WORLD,
+                    &(requests[n_msgs++]));
+        }
+        if (n_msgs)
+        {
+            RAPtor_MPI_Waitall(n_msgs, requests.data(), RAPtor_MPI_STATUSES_IGNORE);
+        }
+
+        n_active = 0;
+        for (int i = 0; i < send_data->num_msgs; i++)
+        {
+            n_active += active_sends[i];
+        }
+        for (int i = 0; i < recv_data->num_msgs; i++)
+        {
+            if (!active_recvs[i]) continue;
+            start = recv_data->indptr[i];
+            end = recv_data->indptr[i+1];
+            active_recvs[i] = 0;
+            for (int j = start; j < end; j++)
+            {
+                if (ghost_states[j] == Unassigned)
+                {
+                    active_recvs[i] = 1;
+                    n_active++;
+                    break;
+                }
+            }
+        }
+
+        iterate++;
+    }
+
+    delete G2;
+
+    // States of the off_proc columns of A
+    CommPkg* comm = A->comm;
+    if (tap_comm)
+    {
+        comm = A->tap_comm;
+    }
+    std::vector<int>& recv_states = comm->communicate(states);
+    off_proc_states.resize(A->off_proc_num_cols);
+    std::copy(recv_states.begin(), recv_states.begin() + A->off_proc_num_cols,
+            off_proc_states.begin());
+
+    return iterate;
+}
+
 }
@@ -12,5 +12,52 @@ int mis2(const ParCSRMatrix* A, std::vector<int>& states,
         std::vector<int>& off_proc_states, bool tap_comm = false, 
         double* rand_vals = NULL);
 
+/**************************************************************
+ *****   Distance-2 Pattern
+ **************************************************************
+ ***** Returns the pattern of A*A, with unit values, holding every
+ ***** vertex within distance two of each row.  Its comm package
+ ***** reaches the distance-two ghost layer.
+ *****
+ ***** Parameters
+ ***** -------------
+ ***** A : const ParCSRMatrix*
+ *****    Matrix whose pattern is squared (values are not used)
+ **************************************************************/
+ParCSRMatrix* distance2_pattern(const ParCSRMatrix* A);
+
+/**************************************************************
+ *****   Distance-2 MIS on a Ghost Layer
+ **************************************************************
+ ***** Selects a distance-2 maximal independent set of A, as mis2,
+ ***** but on the pattern of A*A, whose off_proc columns form a
+ ***** ghost layer of all vertices within distance two.  Weights
+ ***** are exchanged once, and each round needs a single exchange
+ ***** of states with ghost neighbors.  Neighbors stop exchanging
+ ***** once a message holds no unassigned states, so there is no
+ ***** global termination check.  A must contain its diagonal (as
+ ***** strength matrices do).
+ *****
+ ***** Parameters
+ ***** -------------
+ ***** A : const ParCSRMatrix*
+ *****    Strength matrix (values are not used)
+ ***** states : std::vector<int>&
+ *****    Returns Selected or Unselected for each local row
+ ***** off_proc_states : std::vector<int>&
+ *****    Returns states of the off_proc columns of A
+ ***** tap_comm : bool (optional)
+ *****    Communicate off_proc_states with A->tap_comm
+ ***** rand_vals : double* (optional)
+ *****    Weights of local rows (random if NULL)
+ *****
+ ***** Returns
+ ***** -------------
+ ***** Number of rounds
+ **************************************************************/
+int mis2_ghost(const ParCSRMatrix* A, std::vector<int>& states,
+        std::vector<int>& off_proc_states, bool tap_comm = false,
+        double* rand_vals = NULL);
+
 }
 #endif
@@ -51,7 +51,8 @@ namespace raptor
         void extend_hierarchy()
         {
             int level_ctr = levels.size() - 1;
-            bool tap_level = tap_amg >= 0 && tap_amg <= level_ctr;
+            select_A_comm(level_ctr);
+            bool tap_level = levels[level_ctr]->tap_A;
 
             ParCSRMatrix* A = levels[level_ctr]->A;
             ParCSRMatrix* S;
@@ -65,11 +66,15 @@ namespace raptor
             std::vector<double> R;
             int n_aggs = 0;
 
-            // Form strength of connection
+            // Form strength of connection (pattern only, as aggregation
+            // takes values from A)
+            ScopedTimer strength_timer("strength", level_ctr);
             S = A->strength(strength_type, strong_threshold, tap_level, 
-                    1, NULL);
+                    1, NULL, true);
+            strength_timer.stop();
 
             // Aggregate Nodes
+            ScopedTimer splitting_timer("splitting", level_ctr);
             switch (agg_type)
             {
                 case MIS:
@@ -77,14 +82,21 @@ namespace raptor
                     n_aggs = aggregate(A, S, states, off_proc_states, 
                             aggregates, tap_level);
                     break;
+                case GhostMIS:
+                    mis2_ghost(S, states, off_proc_states, tap_level, weights);
+                    n_aggs = aggregate(A, S, states, off_proc_states, 
+                            aggregates, tap_level);
+                    break;
                 default:
                     mis2(S, states, off_proc_states, tap_level, weights);
                     n_aggs = aggregate(A, S, states, off_proc_states, 
                             aggregates, tap_level);
                     break;
             }
+            splitting_timer.stop();
 
             // Form tentative interpolation
+            ScopedTimer interp_timer("interpolation", level_ctr);
             T = fit_candidates(A, n_aggs, aggregates, B, R, 
                     num_candidates, false, interp_tol);
             
@@ -100,16 +112,21 @@ namespace raptor
                             prolong_weight, prolong_smooth_steps);
                     break;
             }
+            interp_timer.stop();
             levels[level_ctr]->P = P;
+            select_P_comm(level_ctr);
 
             // Form coarse grid operator
             levels.emplace_back(new ParLevel());
 
-            AP = A->mult(levels[level_ctr]->P, tap_level);
+            ScopedTimer spgemm_timer("spgemm", level_ctr);
+            AP = A->mult(levels[level_ctr]->P, levels[level_ctr]->tap_AP);
 
-            A = AP->mult_T(P, tap_level);
+            A = AP->mult_T(P, levels[level_ctr]->tap_PTAP);
+            spgemm_timer.stop();
 
             level_ctr++;
+            ScopedTimer comm_timer("comm init", level_ctr);
             levels[level_ctr]->A = A;
             A->comm = new ParComm(A->partition, A->off_proc_column_map,
                     A->on_proc_column_map, levels[level_ctr-1]->A->comm->key,
@@ -119,7 +136,7 @@ namespace raptor
             levels[level_ctr]->tmp.resize(A->global_num_rows, A->local_num_rows);
             levels[level_ctr]->P = NULL;
 
-            if (tap_amg >= 0 && tap_amg <= level_ctr)
+            if (comm_select == ThresholdComm && tap_amg >= 0 && tap_amg <= level_ctr)
             {
                 // Create 2-step node-aware communicator for setup phase
                 // will be changed to 3-step before solve phase
@@ -0,0 +1,118 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+// Every row of A*A (rows within distance two) holds exactly one
+// selected vertex if the row is unselected, and no other if selected
+void check_mis2(ParCSRMatrix* S, std::vector<int>& states,
+        std::vector<int>& off_proc_states)
+{
+    ParCSRMatrix* G2 = distance2_pattern(S);
+    std::vector<int>& ghost_states = G2->comm->communicate(states);
+
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        ASSERT_TRUE(states[i] == Selected || states[i] == Unselected);
+        int n_selected = 0;
+        for (int j = G2->on_proc->idx1[i]; j < G2->on_proc->idx1[i+1]; j++)
+        {
+            int col = G2->on_proc->idx2[j];
+            if (col != i && states[col] == Selected) n_selected++;
+        }
+        for (int j = G2->off_proc->idx1[i]; j < G2->off_proc->idx1[i+1]; j++)
+        {
+            if (ghost_states[G2->off_proc->idx2[j]] == Selected) n_selected++;
+        }
+        if (states[i] == Selected)
+        {
+            ASSERT_EQ(n_selected, 0);
+        }
+        else
+        {
+            ASSERT_GT(n_selected, 0);
+        }
+    }
+
+    std::vector<int>& recv_states = S->comm->communicate(states);
+    ASSERT_EQ((int) off_proc_states.size(), S->off_proc_num_cols);
+    for (int i = 0; i < S->off_proc_num_cols; i++)
+    {
+        ASSERT_EQ(off_proc_states[i], recv_states[i]);
+    }
+
+    delete G2;
+}
+
+TEST(TestParGhostMIS, TestsInAggregation)
+{ 
+    FILE* f;
+    std::vector<int> states;
+    std::vector<int> off_proc_states;
+    int n_items_read;
+
+    const char* S0_fn = "../../../../test_data/sas_S0.pm";
+    const char* weights_fn = "../../../../test_data/weights.txt";
+
+    ParCSRMatrix* S = readParMatrix(S0_fn);
+
+    f = fopen(weights_fn, "r");
+    std::vector<double> weights(S->local_num_rows);
+    for (int i = 0; i < S->partition->first_local_row; i++)
+    {
+        n_items_read = fscanf(f, "%lf\n", &weights[0]);
+        ASSERT_EQ(n_items_read, 1);
+    }
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        n_items_read = fscanf(f, "%lf\n", &weights[i]);
+        ASSERT_EQ(n_items_read, 1);
+    }
+    fclose(f);
+
+    int n_rounds = mis2_ghost(S, states, off_proc_states, false, weights.data());
+    ASSERT_GT(n_rounds, 0);
+    check_mis2(S, states, off_proc_states);
+
+    // Equal weights are broken by global index
+    std::fill(weights.begin(), weights.end(), 0.5);
+    mis2_ghost(S, states, off_proc_states, false, weights.data());
+    check_mis2(S, states, off_proc_states);
+
+    delete S;
+
+    // Smoothed aggregation with ghost layer MIS converges
+    int grid[3] = {15, 15, 15};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+
+    ParMultilevel* ml = new ParSmoothedAggregationSolver(0.0, GhostMIS);
+    ml->setup(A);
+    ASSERT_GT(ml->num_levels, 1);
+
+    x.set_const_value(1.0);
+    A->mult(x, b);
+    x.set_const_value(0.0);
+    int iter = ml->solve(x, b);
+    ASSERT_LT(iter, ml->max_iterations);
+
+    delete ml;
+    delete A;
+
+} // end of TEST(TestParGhostMIS, TestsInAggregation) //
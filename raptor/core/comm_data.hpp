@@ -1177,8 +1177,7 @@ public:
         std::vector<T>& buf = get_buffer<T>();
         if ((int)buf.size() < size) buf.resize(size);
 
-        std::vector<T> tmp(block_size);
-
+        // Duplicates are combined directly in the send buffer
         for (int i = 0; i < num_msgs; i++)
         {
             proc = procs[i];
@@ -1188,20 +1187,19 @@ public:
             {
                 idx_start = indptr_T[j];
                 idx_end = indptr_T[j+1];
-                std::fill(tmp.begin(), tmp.end(), init_result_func_val);
+                pos  = j * block_size;
+                for (int l = 0; l < block_size; l++)
+                {
+                    buf[pos + l] = init_result_func_val;
+                }
                 for (int k = idx_start; k < idx_end; k++)
                 {
                     idx = indices[k] * block_size;
                     for (int l = 0; l < block_size; l++)
                     {
-                        tmp[l] = init_result_func(tmp[l], values[idx+l]);
+                        buf[pos + l] = init_result_func(buf[pos + l], values[idx+l]);
                     }
                 }
-                pos  = j * block_size;
-                for (int k = 0; k < block_size; k++)
-                {
-                    buf[pos + k] = tmp[k];
-                }
             }
             RAPtor_MPI_Isend(&(buf[start * block_size]), (end - start) * block_size,
                    datatype, proc, key, mpi_comm, &(requests[i]));
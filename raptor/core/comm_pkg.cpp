@@ -186,6 +186,33 @@ namespace raptor
     {
         complete_int_comm_T(block_size, init_result_func, init_result_func_val);
     }
+
+    template<>
+    void CommPkg::conditional_exchange<double>(const std::vector<double>& vals,
+            const std::vector<double>& vals_T,
+            const std::vector<int>& states,
+            const std::vector<int>& off_proc_states,
+            std::function<bool(int)> compare_func,
+            std::vector<double>& off_proc_vals,
+            std::vector<double>& result,
+            std::function<double(double, double)> result_func)
+    {
+        conditional_double_exchange(vals, vals_T, states, off_proc_states,
+                compare_func, off_proc_vals, result, result_func);
+    }
+    template<>
+    void CommPkg::conditional_exchange<int>(const std::vector<int>& vals,
+            const std::vector<double>& vals_T,
+            const std::vector<int>& states,
+            const std::vector<int>& off_proc_states,
+            std::function<bool(int)> compare_func,
+            std::vector<int>& off_proc_vals,
+            std::vector<double>& result,
+            std::function<double(double, double)> result_func)
+    {
+        conditional_int_exchange(vals, vals_T, states, off_proc_states,
+                compare_func, off_proc_vals, result, result_func);
+    }
 }
 
 
@@ -201,3 +228,86 @@ void CommPkg::init_comm(ParVector& v, const int block_size)
 {
     init_double_comm(v.local.data(), block_size);
 }
+
+/**************************************************************
+*****   Model Sends
+**************************************************************
+***** Adds the modeled cost of intra-node messages in send_data
+***** to local_t, and the number and bytes of inter-node messages
+***** to global_n and global_bytes.  If on_node is true, procs are
+***** ranks in local_comm, and all messages are intra-node.
+**************************************************************/
+static void model_sends(CommData* send_data, Topology* topology,
+        const CommModel& model, const double value_bytes, bool on_node,
+        double& local_t, int& global_n, double& global_bytes)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    int rank_node = topology->get_node(rank);
+
+    for (int i = 0; i < send_data->num_msgs; i++)
+    {
+        double bytes = (send_data->indptr[i+1] - send_data->indptr[i]) * value_bytes;
+        if (on_node || topology->get_node(send_data->procs[i]) == rank_node)
+        {
+            local_t += model.local_alpha + model.local_beta * bytes;
+        }
+        else
+        {
+            global_n++;
+            global_bytes += bytes;
+        }
+    }
+}
+
+// Inter-node cost, limited by process and node injection bandwidth
+static double model_global(Topology* topology, const CommModel& model,
+        int global_n, double global_bytes)
+{
+    double node_bytes;
+    RAPtor_MPI_Allreduce(&global_bytes, &node_bytes, 1, RAPtor_MPI_DOUBLE,
+            RAPtor_MPI_SUM, topology->local_comm);
+    return global_n * model.global_alpha + std::max(model.global_beta * global_bytes,
+            model.node_beta * node_bytes);
+}
+
+double ParComm::model_time(const CommModel& model, const double value_bytes)
+{
+    double local_t = 0.0;
+    double global_bytes = 0.0;
+    int global_n = 0;
+
+    model_sends(send_data, topology, model, value_bytes,
+            mpi_comm == topology->local_comm, local_t, global_n, global_bytes);
+    double t = local_t + model_global(topology, model, global_n, global_bytes);
+
+    RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &t, 1, RAPtor_MPI_DOUBLE,
+            RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+    return t;
+}
+
+// Steps are performed in order (local_L and local_S together), so
+// the modeled time is the sum of the steps
+double TAPComm::model_time(const CommModel& model, const double value_bytes)
+{
+    double local_t = 0.0;
+    double global_bytes = 0.0;
+    int global_n = 0;
+
+    model_sends(local_L_par_comm->send_data, topology, model, value_bytes,
+            true, local_t, global_n, global_bytes);
+    if (local_S_par_comm)
+    {
+        model_sends(local_S_par_comm->send_data, topology, model, value_bytes,
+                true, local_t, global_n, global_bytes);
+    }
+    model_sends(local_R_par_comm->send_data, topology, model, value_bytes,
+            true, local_t, global_n, global_bytes);
+    model_sends(global_par_comm->send_data, topology, model, value_bytes,
+            false, local_t, global_n, global_bytes);
+    double t = local_t + model_global(topology, model, global_n, global_bytes);
+
+    RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &t, 1, RAPtor_MPI_DOUBLE,
+            RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+    return t;
+}
@@ -6,6 +6,7 @@
 #include <mpi.h>
 #include "comm_data.hpp"
 #include "matrix.hpp"
+#include "index_map.hpp"
 #include "partition.hpp"
 #include "par_vector.hpp"
 
@@ -31,6 +32,26 @@ namespace raptor
 {
     class ParCSRMatrix;
     class ParBSRMatrix;
+    struct CommStats;
+
+    /**************************************************************
+    *****   CommModel Struct
+    **************************************************************
+    ***** Parameters of the max-rate model used to estimate the cost
+    ***** of a communication package.  Each message costs alpha and
+    ***** each byte beta (seconds), with separate intra-node (local)
+    ***** and inter-node (global) parameters.  Inter-node bytes are
+    ***** also limited by the injection bandwidth of each node, at
+    ***** node_beta per byte sent by all processes on the node.
+    **************************************************************/
+    struct CommModel
+    {
+        double local_alpha = 1e-6;
+        double local_beta = 2.5e-10;
+        double global_alpha = 2e-6;
+        double global_beta = 3.3e-10;
+        double node_beta = 8e-11;
+    };
 
     class CommPkg
     {
@@ -249,6 +270,43 @@ namespace raptor
                 std::function<int(int, int)> init_result_func = &sum_func<int, int>,
                 int init_result_func_val = 0) = 0;
 
+        // Conditional Exchange
+        // Sends vals to off_proc_vals of neighbors, and vals_T back to
+        // result of their owners (combined with result_func), for
+        // entries whose states satisfy compare_func.  ParComm fuses both
+        // into one message per neighbor (see ParComm::conditional_exchange)
+        template<typename T> void conditional_exchange(
+                const std::vector<T>& vals,
+                const std::vector<double>& vals_T,
+                const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<T>& off_proc_vals,
+                std::vector<double>& result,
+                std::function<double(double, double)> result_func);
+        virtual void conditional_double_exchange(const std::vector<double>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<double>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func) = 0;
+        virtual void conditional_int_exchange(const std::vector<int>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<int>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func) = 0;
+
+        // Performance Model
+        // Modeled time (max over all processes) to communicate
+        // value_bytes per index.  Collective over RAPtor_MPI_COMM_WORLD.
+        virtual double model_time(const CommModel& model,
+                const double value_bytes) = 0;
+
+        // Communication Statistics (profiling/comm_stats.cpp)
+        // Adds messages sent by this process to stats
+        virtual void add_comm_stats(CommStats& stats) = 0;
+
         // Helper methods
         template <typename T> std::vector<T>& get_buffer();
         virtual std::vector<double>& get_double_buffer() = 0;
@@ -417,11 +475,7 @@ namespace raptor
             mpi_comm = comm;
             init_par_comm(off_proc_column_map, off_proc_col_to_proc,
                     _key, comm, r_data);
-            std::map<int,int> global_to_local;
-            for (int i = 0; i < (int)local_row_map.size(); i++)
-            {
-                global_to_local[local_row_map[i]] = i;
-            }
+            IndexMap global_to_local(local_row_map);
             for (int i = 0; i < send_data->size_msgs; i++)
             {
                 send_data->indices[i] = global_to_local[send_data->indices[i]];
@@ -487,11 +541,11 @@ namespace raptor
                     recv_data->indptr[i+1] - recv_data->indptr[i];
             RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, recv_sizes.data(), num_procs, RAPtor_MPI_INT,
                     RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             recv_data->send(off_proc_column_map.data(), tag, comm);
             send_data->probe(recv_sizes[rank], tag, comm);
             recv_data->waitall();
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
         }
 
         ParComm(ParComm* comm) : CommPkg(comm->topology)
@@ -630,19 +684,19 @@ namespace raptor
         template<typename T>
         void initialize(const T* values, const int block_size = 1)
         {
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             send_data->send(values, key, mpi_comm, block_size);
             recv_data->recv<T>(key, mpi_comm, block_size);
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
         }
 
         template<typename T>
         std::vector<T>& complete(const int block_size = 1)
         {
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             send_data->waitall();
             recv_data->waitall();
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
             key++;
 
             // Extract packed data to appropriate buffer
@@ -757,10 +811,10 @@ namespace raptor
                 std::function<T(T, T)> init_result_func = &sum_func<T, T>,
                 T init_result_func_val = 0)
         {
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             recv_data->send(values, key, mpi_comm, block_size, init_result_func, init_result_func_val);
             send_data->recv<T>(key, mpi_comm, block_size);
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
         }
 
         template<typename T, typename U>
@@ -792,10 +846,10 @@ namespace raptor
                 std::function<T(T, T)> init_result_func = &sum_func<T, T>,
                 T init_result_func_val = 0)
         {
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             send_data->waitall();
             recv_data->waitall();
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
             key++;
         }
 
@@ -812,14 +866,14 @@ namespace raptor
             int tag = 325493;
             bool comparison;
 
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             send_data->send(vals.data(), tag, mpi_comm, states, compare_func, &n_sends, block_size);
             recv_data->recv<T>(tag, mpi_comm, off_proc_states,
                     compare_func, &ctr, &n_recvs, block_size);
 
             send_data->waitall(n_sends);
             recv_data->waitall(n_recvs);
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
 
             std::vector<T>& recvbuf = recv_data->get_buffer<T>();
 
@@ -869,14 +923,14 @@ namespace raptor
             int tag = 453246;
             bool comparison;
 
-            if (profile) vec_t -= RAPtor_MPI_Wtime();
+            timers.comm_start(VecCommTime);
             recv_data->send(vals.data(), tag, mpi_comm, off_proc_states, compare_func,
                     &n_sends, block_size);
             send_data->recv<T>(tag, mpi_comm, states, compare_func, &ctr, &n_recvs, block_size);
 
             recv_data->waitall(n_sends);
             send_data->waitall(n_recvs);
-            if (profile) vec_t += RAPtor_MPI_Wtime();
+            timers.comm_stop(VecCommTime);
 
             std::vector<T>& sendbuf = send_data->get_buffer<T>();
 
@@ -903,6 +957,177 @@ namespace raptor
             }
         }
 
+        void conditional_double_exchange(const std::vector<double>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<double>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func)
+        {
+            conditional_exchange<double, double>(vals, vals_T, states,
+                    off_proc_states, compare_func, off_proc_vals, result,
+                    result_func);
+        }
+        void conditional_int_exchange(const std::vector<int>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<int>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func)
+        {
+            conditional_exchange<int, double>(vals, vals_T, states,
+                    off_proc_states, compare_func, off_proc_vals, result,
+                    result_func);
+        }
+
+        /**************************************************************
+        *****   ParComm Conditional Exchange
+        **************************************************************
+        ***** Fuses conditional_comm (of vals) and conditional_comm_T
+        ***** (of vals_T) into a single message to each neighbor, being
+        ***** any process in the send or recv lists.  The message to a
+        ***** neighbor holds vals at the rows sent to it whose states
+        ***** satisfy compare_func, followed by vals_T at the off_proc
+        ***** columns it owns whose off_proc_states satisfy compare_func.
+        ***** As off_proc_states mirror the states of their owners,
+        ***** both sides count the same entries, and neighbors with no
+        ***** entries left to exchange send no message.
+        *****
+        ***** Parameters
+        ***** -------------
+        ***** vals : std::vector<T>
+        *****    Local values, sent to off_proc_vals of neighbors
+        ***** vals_T : std::vector<U>
+        *****    Off_proc values, combined into result of their owners
+        ***** states, off_proc_states : std::vector<int>
+        *****    States of local rows and off_proc columns
+        ***** compare_func : std::function<bool(int)>
+        *****    Returns whether an entry with a given state is sent
+        ***** off_proc_vals : std::vector<T>
+        *****    Received vals (only set where off_proc_states satisfy
+        *****    compare_func)
+        ***** result : std::vector<U>
+        *****    Local values, combined with received vals_T
+        ***** result_func : std::function<U(U, U)>
+        *****    Combines result with each received value
+        **************************************************************/
+        template <typename T, typename U>
+        void conditional_exchange(const std::vector<T>& vals,
+                const std::vector<U>& vals_T,
+                const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<T>& off_proc_vals,
+                std::vector<U>& result,
+                std::function<U(U, U)> result_func)
+        {
+            int idx, pos, start, end;
+            int tag = 518273;
+
+            // Neighbors, with their send and recv messages (or -1)
+            std::vector<int> nbr_procs(send_data->procs);
+            nbr_procs.insert(nbr_procs.end(), recv_data->procs.begin(),
+                    recv_data->procs.end());
+            sort_unique(nbr_procs);
+            int n_nbrs = nbr_procs.size();
+            IndexMap nbr_map(nbr_procs);
+            std::vector<int> nbr_send(n_nbrs, -1);
+            std::vector<int> nbr_recv(n_nbrs, -1);
+            for (int i = 0; i < send_data->num_msgs; i++)
+            {
+                nbr_send[nbr_map[send_data->procs[i]]] = i;
+            }
+            for (int i = 0; i < recv_data->num_msgs; i++)
+            {
+                nbr_recv[nbr_map[recv_data->procs[i]]] = i;
+            }
+
+            // Entries exchanged with each neighbor (the same in both
+            // directions)
+            std::vector<int> nbr_ptr(n_nbrs + 1);
+            std::vector<double> sendbuf;
+            nbr_ptr[0] = 0;
+            for (int n = 0; n < n_nbrs; n++)
+            {
+                if (nbr_send[n] >= 0)
+                {
+                    start = send_data->indptr[nbr_send[n]];
+                    end = send_data->indptr[nbr_send[n]+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        idx = send_data->indices[j];
+                        if (compare_func(states[idx]))
+                        {
+                            sendbuf.emplace_back(vals[idx]);
+                        }
+                    }
+                }
+                if (nbr_recv[n] >= 0)
+                {
+                    start = recv_data->indptr[nbr_recv[n]];
+                    end = recv_data->indptr[nbr_recv[n]+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        if (compare_func(off_proc_states[j]))
+                        {
+                            sendbuf.emplace_back(vals_T[j]);
+                        }
+                    }
+                }
+                nbr_ptr[n+1] = sendbuf.size();
+            }
+            std::vector<double> recvbuf(sendbuf.size());
+
+            timers.comm_start(VecCommTime);
+            std::vector<RAPtor_MPI_Request> requests;
+            requests.reserve(2*n_nbrs);
+            for (int n = 0; n < n_nbrs; n++)
+            {
+                int size = nbr_ptr[n+1] - nbr_ptr[n];
+                if (size == 0) continue;
+                requests.emplace_back(RAPtor_MPI_Request());
+                RAPtor_MPI_Irecv(&(recvbuf[nbr_ptr[n]]), size, RAPtor_MPI_DOUBLE,
+                        nbr_procs[n], tag, mpi_comm, &(requests.back()));
+                requests.emplace_back(RAPtor_MPI_Request());
+                RAPtor_MPI_Isend(&(sendbuf[nbr_ptr[n]]), size, RAPtor_MPI_DOUBLE,
+                        nbr_procs[n], tag, mpi_comm, &(requests.back()));
+            }
+            RAPtor_MPI_Waitall(requests.size(), requests.data(), RAPtor_MPI_STATUSES_IGNORE);
+            timers.comm_stop(VecCommTime);
+
+            // Each message holds the neighbor's vals at the off_proc
+            // columns it owns, then its vals_T at the rows sent to it
+            for (int n = 0; n < n_nbrs; n++)
+            {
+                pos = nbr_ptr[n];
+                if (nbr_recv[n] >= 0)
+                {
+                    start = recv_data->indptr[nbr_recv[n]];
+                    end = recv_data->indptr[nbr_recv[n]+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        if (compare_func(off_proc_states[j]))
+                        {
+                            off_proc_vals[j] = (T) recvbuf[pos++];
+                        }
+                    }
+                }
+                if (nbr_send[n] >= 0)
+                {
+                    start = send_data->indptr[nbr_send[n]];
+                    end = send_data->indptr[nbr_send[n]+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        idx = send_data->indices[j];
+                        if (compare_func(states[idx]))
+                        {
+                            result[idx] = result_func(result[idx], recvbuf[pos++]);
+                        }
+                    }
+                }
+            }
+        }
+
 
         // Matrix Communication
         CSRMatrix* communicate(const std::vector<int>& rowptr,
@@ -969,6 +1194,9 @@ namespace raptor
             CommPkg::init_comm(v, block_size);
         }
 
+        double model_time(const CommModel& model, const double value_bytes);
+        void add_comm_stats(CommStats& stats);
+
         // Helper Methods
         std::vector<double>& get_double_buffer()
         {
@@ -987,6 +1215,97 @@ namespace raptor
 
 
 
+    /**************************************************************
+    *****   SharedWindow Class
+    **************************************************************
+    ***** MPI-3 shared memory window over a node-local communicator.
+    ***** Each process owns a segment of num_elems entries, which
+    ***** every other process of the communicator can read directly.
+    ***** Segments are (re)allocated when an entry of more than
+    ***** elem_bytes bytes is reserved, which is collective.
+    *****
+    ***** Attributes
+    ***** -------------
+    ***** comm : RAPtor_MPI_Comm
+    *****    Node-local communicator sharing the window
+    ***** num_elems : int
+    *****    Number of entries in the segment of rank
+    ***** elem_bytes : int
+    *****    Size in bytes of each entry (block_size * sizeof(T))
+    ***** segments : std::vector<char*>
+    *****    Start of the segment of each process in comm
+    **************************************************************/
+    class SharedWindow
+    {
+      public:
+        SharedWindow(RAPtor_MPI_Comm _comm, int _num_elems)
+        {
+            comm = _comm;
+            num_elems = _num_elems;
+            elem_bytes = 0;
+            allocated = false;
+
+            int num_procs;
+            RAPtor_MPI_Comm_size(comm, &num_procs);
+            segments.resize(num_procs, NULL);
+        }
+
+        ~SharedWindow()
+        {
+            release();
+        }
+
+        void reserve(int bytes)
+        {
+            if (bytes <= elem_bytes) return;
+
+            release();
+            elem_bytes = bytes;
+
+            char* base;
+            RAPtor_MPI_Aint size = (RAPtor_MPI_Aint) num_elems * elem_bytes;
+            RAPtor_MPI_Win_allocate_shared(size, 1, RAPtor_MPI_INFO_NULL, comm,
+                    &base, &win);
+            for (int i = 0; i < (int)segments.size(); i++)
+            {
+                int disp_unit;
+                RAPtor_MPI_Win_shared_query(win, i, &size, &disp_unit,
+                        &(segments[i]));
+            }
+            RAPtor_MPI_Win_lock_all(RAPtor_MPI_MODE_NOCHECK, win);
+            allocated = true;
+        }
+
+        void release()
+        {
+            if (!allocated) return;
+            RAPtor_MPI_Win_unlock_all(win);
+            RAPtor_MPI_Win_free(&win);
+            allocated = false;
+        }
+
+        // Makes writes to all segments visible on node
+        void sync()
+        {
+            RAPtor_MPI_Win_sync(win);
+            RAPtor_MPI_Barrier(comm);
+            RAPtor_MPI_Win_sync(win);
+        }
+
+        template <typename T> T* segment(int proc)
+        {
+            return (T*) segments[proc];
+        }
+
+        RAPtor_MPI_Comm comm;
+        int num_elems;
+        int elem_bytes;
+        bool allocated;
+        RAPtor_MPI_Win win;
+        std::vector<char*> segments;
+    };
+
+
     /**************************************************************
     *****   TAPComm Class
     **************************************************************
@@ -1016,6 +1335,11 @@ namespace raptor
     *****    recv buffers, ordered to match off_proc_column_map
     ***** Partition* partition
     *****    Partition, holding information about topology
+    ***** shared_x_win, shared_G_win : SharedWindow*
+    *****    If init_shared_windows() succeeded, node-local steps of
+    *****    vector communication read values from these windows
+    *****    (values of rank and values recvd in the inter-node step)
+    *****    instead of exchanging local_S/R/L messages
     **************************************************************/
     class TAPComm : public CommPkg
     {
@@ -1323,6 +1647,8 @@ namespace raptor
                 local_R_par_comm->delete_comm();
             if (local_L_par_comm)
                 local_L_par_comm->delete_comm();
+            delete shared_x_win;
+            delete shared_G_win;
         }
 
         void init_tap_comm(Partition* partition,
@@ -1474,6 +1800,35 @@ namespace raptor
         void update_recv(const std::vector<int>& on_node_to_off_proc,
                 const std::vector<int>& off_node_to_off_proc, bool update_L = true);
 
+        // Node-local vector communication through shared memory windows.
+        // Collective over topology->local_comm, and returns false (keeping
+        // message-based steps) if local_comm spans multiple shared memory
+        // domains.  Transpose and matrix communication still use messages.
+        bool init_shared_windows();
+        void form_shared_indices(ParComm* comm, std::vector<int>& src_indices);
+
+        template <typename T>
+        void shared_gather(ParComm* comm, const std::vector<int>& src_indices,
+                SharedWindow* win, const int block_size)
+        {
+            CommData* recv_data = comm->recv_data;
+            std::vector<T>& buf = recv_data->get_buffer<T>();
+            int size = recv_data->size_msgs * block_size;
+            if ((int)buf.size() < size) buf.resize(size);
+
+            timers.comm_start(VecCommTime);
+            for (int i = 0; i < recv_data->num_msgs; i++)
+            {
+                const T* src = win->segment<T>(recv_data->procs[i]);
+                for (int j = recv_data->indptr[i]; j < recv_data->indptr[i+1]; j++)
+                {
+                    const T* src_val = &(src[src_indices[j] * block_size]);
+                    std::copy(src_val, src_val + block_size, &(buf[j * block_size]));
+                }
+            }
+            timers.comm_stop(VecCommTime);
+        }
+
         // Class Methods
         void init_double_comm(const double* values, const int block_size)
         {
@@ -1508,6 +1863,33 @@ namespace raptor
         template<typename T>
         void initialize(const T* values, const int block_size = 1)
         {
+            if (shared_x_win)
+            {
+                // Expose values of rank to processes on node
+                shared_x_win->reserve(block_size * sizeof(T));
+                std::copy(values, values + shared_x_win->num_elems * block_size,
+                        shared_x_win->segment<T>(shared_rank));
+                shared_x_win->sync();
+
+                // Read values with origin and final destination on node
+                shared_gather<T>(local_L_par_comm, shared_L_indices,
+                        shared_x_win, block_size);
+
+                if (local_S_par_comm)
+                {
+                    // Initial redistribution among node
+                    shared_gather<T>(local_S_par_comm, shared_S_indices,
+                            shared_x_win, block_size);
+                    std::vector<T>& S_vals = local_S_par_comm->recv_data->get_buffer<T>();
+                    global_par_comm->initialize(S_vals.data(), block_size);
+                }
+                else
+                {
+                    global_par_comm->initialize(values, block_size);
+                }
+                return;
+            }
+
             // Messages with origin and final destination on node
             local_L_par_comm->communicate<T>(values, block_size);
 
@@ -1532,7 +1914,19 @@ namespace raptor
             std::vector<T>& G_vals = global_par_comm->complete<T>(block_size);
 
             // Redistributing recvd inter-node values
-            local_R_par_comm->communicate<T>(G_vals.data(), block_size);
+            if (shared_G_win)
+            {
+                shared_G_win->reserve(block_size * sizeof(T));
+                std::copy(G_vals.begin(), G_vals.begin() + shared_G_win->num_elems * block_size,
+                        shared_G_win->segment<T>(shared_rank));
+                shared_G_win->sync();
+                shared_gather<T>(local_R_par_comm, shared_R_indices,
+                        shared_G_win, block_size);
+            }
+            else
+            {
+                local_R_par_comm->communicate<T>(G_vals.data(), block_size);
+            }
 
             std::vector<T>& recvbuf = get_buffer<T>();
 
@@ -1639,6 +2033,67 @@ namespace raptor
             complete_T<int>(block_size, init_result_func, init_result_func_val);
         }
 
+        /**************************************************************
+        *****   TAPComm Conditional Exchange
+        **************************************************************
+        ***** Messages of a TAPComm are aggregated per node, so entries
+        ***** cannot be skipped per neighbor.  Instead, vals and vals_T
+        ***** are communicated in full, and only entries whose states
+        ***** (off_proc_states for vals, states for vals_T) satisfy
+        ***** compare_func are kept.  As off_proc_states mirror the
+        ***** states of their owners, this matches ParComm.
+        **************************************************************/
+        template <typename T>
+        void tap_conditional_exchange(const std::vector<T>& vals,
+                const std::vector<double>& vals_T,
+                const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<T>& off_proc_vals,
+                std::vector<double>& result,
+                std::function<double(double, double)> result_func)
+        {
+            std::vector<T>& recvbuf = CommPkg::communicate<T>(vals.data());
+            for (int i = 0; i < (int)off_proc_states.size(); i++)
+            {
+                if (compare_func(off_proc_states[i]))
+                {
+                    off_proc_vals[i] = recvbuf[i];
+                }
+            }
+
+            std::vector<double> combined(result);
+            CommPkg::communicate_T(vals_T.data(), combined, 1, result_func,
+                    result_func);
+            for (int i = 0; i < (int)states.size(); i++)
+            {
+                if (compare_func(states[i]))
+                {
+                    result[i] = combined[i];
+                }
+            }
+        }
+        void conditional_double_exchange(const std::vector<double>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<double>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func)
+        {
+            tap_conditional_exchange(vals, vals_T, states, off_proc_states,
+                    compare_func, off_proc_vals, result, result_func);
+        }
+        void conditional_int_exchange(const std::vector<int>& vals,
+                const std::vector<double>& vals_T, const std::vector<int>& states,
+                const std::vector<int>& off_proc_states,
+                std::function<bool(int)> compare_func,
+                std::vector<int>& off_proc_vals, std::vector<double>& result,
+                std::function<double(double, double)> result_func)
+        {
+            tap_conditional_exchange(vals, vals_T, states, off_proc_states,
+                    compare_func, off_proc_vals, result, result_func);
+        }
+
         template<typename T, typename U>
         void communicate_T(const std::vector<T>& values, std::vector<U>& result,
                 const int block_size = 1,
@@ -1820,6 +2275,9 @@ namespace raptor
             CommPkg::init_comm(v, block_size);
         }
 
+        double model_time(const CommModel& model, const double value_bytes);
+        void add_comm_stats(CommStats& stats);
+
         // Helper Methods
         std::vector<double>& get_double_buffer()
         {
@@ -1836,6 +2294,13 @@ namespace raptor
         ParComm* local_R_par_comm;
         ParComm* local_L_par_comm;
         ParComm* global_par_comm;
+
+        int shared_rank = 0;
+        SharedWindow* shared_x_win = NULL;
+        SharedWindow* shared_G_win = NULL;
+        std::vector<int> shared_L_indices;
+        std::vector<int> shared_S_indices;
+        std::vector<int> shared_R_indices;
     };
 }
 #endif
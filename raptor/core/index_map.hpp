@@ -0,0 +1,191 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#ifndef RAPTOR_CORE_INDEX_MAP_HPP
+#define RAPTOR_CORE_INDEX_MAP_HPP
+
+#include <vector>
+#include <algorithm>
+
+/**************************************************************
+ *****   Sort Unique
+ **************************************************************
+ ***** Sorts a vector of non-negative (global) indices and removes
+ ***** duplicates.  Large vectors are sorted with an LSD radix sort
+ ***** (11 bits per pass, skipping passes above the largest index),
+ ***** and small ones with std::sort.
+ **************************************************************/
+namespace raptor
+{
+    inline void sort_unique(std::vector<int>& v)
+    {
+        int n = v.size();
+        if (n < 2) return;
+
+        if (n < 256)
+        {
+            std::sort(v.begin(), v.end());
+        }
+        else
+        {
+            const int bits = 11;
+            const int num_buckets = 1 << bits;
+            const int mask = num_buckets - 1;
+
+            int max_val = *std::max_element(v.begin(), v.end());
+            std::vector<int> tmp(n);
+            std::vector<int> count(num_buckets);
+            for (int shift = 0; shift < 31 && (max_val >> shift); shift += bits)
+            {
+                std::fill(count.begin(), count.end(), 0);
+                for (int i = 0; i < n; i++)
+                {
+                    count[(v[i] >> shift) & mask]++;
+                }
+                int pos = 0;
+                for (int b = 0; b < num_buckets; b++)
+                {
+                    int size = count[b];
+                    count[b] = pos;
+                    pos += size;
+                }
+                for (int i = 0; i < n; i++)
+                {
+                    tmp[count[(v[i] >> shift) & mask]++] = v[i];
+                }
+                v.swap(tmp);
+            }
+        }
+
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+
+    /**************************************************************
+    *****   IndexMap Class
+    **************************************************************
+    ***** Maps non-negative global indices (such as off_proc columns)
+    ***** to local positions.  Replaces std::map<int, int> where the
+    ***** keys are built once and then looked up once per nonzero:
+    ***** keys are stored in an open addressing table (linear probing,
+    ***** at most half full), so a lookup is usually a single cache
+    ***** line rather than a walk down a tree.
+    *****
+    ***** Methods
+    ***** -------
+    ***** init(keys)
+    *****    Maps keys[i] to i for each i
+    ***** insert(key, val)
+    *****    Maps key to val, replacing any previous value
+    ***** find(key)
+    *****    Returns the value of key, or -1 if key is not mapped
+    ***** operator[](key)
+    *****    Returns the value of key, which must be mapped
+    **************************************************************/
+    class IndexMap
+    {
+      public:
+        IndexMap(int n = 0)
+        {
+            num_keys = 0;
+            reserve(n);
+        }
+
+        IndexMap(const std::vector<int>& keys)
+        {
+            num_keys = 0;
+            init(keys);
+        }
+
+        void init(const std::vector<int>& keys)
+        {
+            clear();
+            reserve(keys.size());
+            for (int i = 0; i < (int)keys.size(); i++)
+            {
+                insert(keys[i], i);
+            }
+        }
+
+        // Ensures n keys can be inserted without rehashing
+        void reserve(int n)
+        {
+            int capacity = 16;
+            while (capacity < 2*n) capacity *= 2;
+            if (capacity <= (int)table_keys.size()) return;
+
+            std::vector<int> old_keys;
+            std::vector<int> old_vals;
+            old_keys.swap(table_keys);
+            old_vals.swap(table_vals);
+            table_keys.resize(capacity, -1);
+            table_vals.resize(capacity);
+            mask = capacity - 1;
+            shift = 32;
+            for (int c = capacity; c > 1; c >>= 1) shift--;
+            num_keys = 0;
+            for (int i = 0; i < (int)old_keys.size(); i++)
+            {
+                if (old_keys[i] >= 0) insert(old_keys[i], old_vals[i]);
+            }
+        }
+
+        void insert(int key, int val)
+        {
+            if (2*(num_keys+1) > (int)table_keys.size()) reserve(num_keys+1);
+
+            int slot = hash(key);
+            while (table_keys[slot] >= 0 && table_keys[slot] != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            if (table_keys[slot] < 0)
+            {
+                table_keys[slot] = key;
+                num_keys++;
+            }
+            table_vals[slot] = val;
+        }
+
+        int find(int key) const
+        {
+            if (num_keys == 0) return -1;
+            int slot = hash(key);
+            while (table_keys[slot] >= 0)
+            {
+                if (table_keys[slot] == key) return table_vals[slot];
+                slot = (slot + 1) & mask;
+            }
+            return -1;
+        }
+
+        int operator[](int key) const
+        {
+            return find(key);
+        }
+
+        int size() const
+        {
+            return num_keys;
+        }
+
+        void clear()
+        {
+            std::fill(table_keys.begin(), table_keys.end(), -1);
+            num_keys = 0;
+        }
+
+      private:
+        int hash(int key) const
+        {
+            // Fibonacci hashing: high bits of the product
+            return (int)(((unsigned)key * 2654435761u) >> shift);
+        }
+
+        std::vector<int> table_keys;
+        std::vector<int> table_vals;
+        int mask;
+        int shift;
+        int num_keys;
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "matrix.hpp"
 #include "utilities.hpp"
+#include "threads.hpp"
 
 using namespace raptor;
 
@@ -133,7 +134,7 @@ void BSCMatrix::print()
 **************************************************************/
 COOMatrix* COOMatrix::transpose()
 {
-    COOMatrix* T = new COOMatrix(n_rows, n_cols, idx2, idx1, vals);
+    COOMatrix* T = new COOMatrix(n_cols, n_rows, idx2, idx1, vals);
     return T;
 }
 
@@ -145,7 +146,7 @@ BCOOMatrix* BCOOMatrix::transpose()
 
 CSRMatrix* CSRMatrix::transpose()
 {
-    CSCMatrix* T_csc = new CSCMatrix(n_rows, n_cols, idx1, idx2, vals); 
+    CSCMatrix* T_csc = new CSCMatrix(n_cols, n_rows, idx1, idx2, vals); 
     CSRMatrix* T = T_csc->to_CSR();
     delete T_csc;
     return T;
@@ -161,7 +162,7 @@ BSRMatrix* BSRMatrix::transpose()
 
 CSCMatrix* CSCMatrix::transpose()
 {
-    CSRMatrix* T_csr = new CSRMatrix(n_rows, n_cols, idx1, idx2, vals); 
+    CSRMatrix* T_csr = new CSRMatrix(n_cols, n_rows, idx1, idx2, vals); 
     CSCMatrix* T = T_csr->to_CSC();
     delete T_csr;
     return T;
@@ -391,6 +392,110 @@ void BSR_to_CSR(const BSRMatrix* A, CSRMatrix* B, std::vector<T*>& A_vals,
     B->nnz = B->vals.size();
 
 }
+/**************************************************************
+*****   Transpose Compressed
+**************************************************************
+***** Transposes the n_outer compressed rows (or columns) ptr, idx
+***** and A_vals, with indices 0 to n_inner, into T_ptr, T_idx and
+***** T_vals (already sized).  Entries of each transposed row are
+***** ordered by their original row, as in a stable counting sort.
+*****
+***** Large matrices are transposed by multiple threads, each with
+***** the counts of its own contiguous range of rows, so that each
+***** thread scatters into a disjoint, precomputed set of positions.
+**************************************************************/
+template <typename T>
+void transpose_compressed(const Matrix* B, int n_outer, int n_inner,
+        const std::vector<int>& ptr, const std::vector<int>& idx, 
+        std::vector<T>& A_vals, std::vector<int>& T_ptr, std::vector<int>& T_idx,
+        std::vector<T>& T_vals, bool has_vals)
+{
+    int nnz = ptr[n_outer];
+    int n_threads = work_threads(nnz);
+
+    for (int i = 0; i <= n_inner; i++) T_ptr[i] = 0;
+
+    if (n_threads == 1)
+    {
+        for (int i = 0; i < nnz; i++)
+        {
+            T_ptr[idx[i] + 1]++;
+        }
+        for (int i = 1; i <= n_inner; i++)
+        {
+            T_ptr[i] += T_ptr[i-1];
+        }
+
+        std::vector<int> ctr(n_inner, 0);
+        for (int i = 0; i < n_outer; i++)
+        {
+            for (int j = ptr[i]; j < ptr[i+1]; j++)
+            {
+                int col = idx[j];
+                int pos = T_ptr[col] + ctr[col]++;
+                T_idx[pos] = i;
+                if (has_vals)
+                {
+                    T_vals[pos] = B->copy_val(A_vals[j]);
+                }
+            }
+        }
+        return;
+    }
+
+    // Position of each thread's entries within each transposed row
+    std::vector<int> thread_pos((long) n_threads * n_inner, 0);
+    RAPTOR_OMP(omp parallel num_threads(n_threads))
+    {
+        int tid = thread_id();
+        int n_team = team_size();
+        int start, end;
+        thread_range(ptr, n_outer, tid, n_team, start, end);
+        int* pos = thread_pos.data() + (long) tid * n_inner;
+
+        for (int j = ptr[start]; j < ptr[end]; j++)
+        {
+            pos[idx[j]]++;
+        }
+
+        RAPTOR_OMP(omp barrier)
+        RAPTOR_OMP(omp for)
+        for (int col = 0; col < n_inner; col++)
+        {
+            int size = 0;
+            for (int t = 0; t < n_team; t++)
+            {
+                int count = thread_pos[(long) t * n_inner + col];
+                thread_pos[(long) t * n_inner + col] = size;
+                size += count;
+            }
+            T_ptr[col+1] = size;
+        }
+
+        RAPTOR_OMP(omp single)
+        {
+            for (int i = 1; i <= n_inner; i++)
+            {
+                T_ptr[i] += T_ptr[i-1];
+            }
+        }
+
+        for (int i = start; i < end; i++)
+        {
+            for (int j = ptr[i]; j < ptr[i+1]; j++)
+            {
+                int col = idx[j];
+                int p = T_ptr[col] + pos[col]++;
+                T_idx[p] = i;
+                if (has_vals)
+                {
+                    T_vals[p] = B->copy_val(A_vals[j]);
+                }
+            }
+        }
+    }
+}
+
 template <typename T>
 void CSC_to_CSR(const CSCMatrix* A, CSRMatrix* B, std::vector<T>& A_vals,
         std::vector<T>& B_vals)
@@ -409,35 +514,9 @@ void CSC_to_CSR(const CSCMatrix* A, CSRMatrix* B, std::vector<T>& A_vals,
     if (A->data_size())
         B_vals.resize(A->nnz);
 
-    // Create indptr, summing number times row appears in CSC
-    for (int i = 0; i <= A->n_rows; i++) B->idx1[i] = 0;
-    for (int i = 0; i < A->nnz; i++)
-    {
-        B->idx1[A->idx2[i] + 1]++;
-    }
-    for (int i = 1; i <= A->n_rows; i++)
-    {
-        B->idx1[i] += B->idx1[i-1];
-    }
-
-    // Add values to indices and data
-    std::vector<int> ctr(B->n_rows, 0);
-    for (int i = 0; i < A->n_cols; i++)
-    {
-        int col_start = A->idx1[i];
-        int col_end = A->idx1[i+1];
-        for (int j = col_start; j < col_end; j++)
-        {
-            int row = A->idx2[j];
-            int idx = B->idx1[row] + ctr[row]++;
-            B->idx2[idx] = i;
-            if (A->data_size())
-            {
-                B_vals[idx] = B->copy_val(A_vals[j]);
-            }
-        }
-    }
-
+    // Rows of B are the transposed columns of A
+    transpose_compressed(B, A->n_cols, A->n_rows, A->idx1, A->idx2, A_vals,
+            B->idx1, B->idx2, B_vals, A->data_size());
 }
 template <typename T>
 void COO_to_CSC(const COOMatrix* A, CSCMatrix* B, std::vector<T>& A_vals,
@@ -504,35 +583,9 @@ void CSR_to_CSC(const CSRMatrix* A, CSCMatrix* B, std::vector<T>& A_vals,
     if (A->data_size())
         B_vals.resize(A->nnz);
 
-    // Create indptr, summing number times row appears in CSC
-    for (int i = 0; i <= A->n_cols; i++) B->idx1[i] = 0;
-    for (int i = 0; i < A->nnz; i++)
-    {
-        B->idx1[A->idx2[i] + 1]++;
-    }
-    for (int i = 1; i <= A->n_cols; i++)
-    {
-        B->idx1[i] += B->idx1[i-1];
-    }
-
-    // Add values to indices and data
-    std::vector<int> ctr(B->n_cols, 0);
-    for (int i = 0; i < A->n_rows; i++)
-    {
-        int row_start = A->idx1[i];
-        int row_end = A->idx1[i+1];
-        for (int j = row_start; j < row_end; j++)
-        {
-            int col = A->idx2[j];
-            int idx = B->idx1[col] + ctr[col]++;
-            B->idx2[idx] = i;
-            if (A->data_size())
-            {
-                B_vals[idx] = B->copy_val(A_vals[j]);
-            }
-        }
-    }
-
+    // Columns of B are the transposed rows of A
+    transpose_compressed(B, A->n_rows, A->n_cols, A->idx1, A->idx2, A_vals,
+            B->idx1, B->idx2, B_vals, A->data_size());
 }
 template <typename T>
 void CSC_to_CSC(const CSCMatrix* A, CSCMatrix* B, std::vector<T>& A_vals,
@@ -661,7 +714,12 @@ void CSRMatrix::sort()
 }
 void BSRMatrix::sort()
 {
+    bool was_sorted = sorted;
     sort_helper(this, block_vals);
+    if (!was_sorted || !is_packed())
+    {
+        pack();
+    }
 }
 void CSCMatrix::sort()
 {
@@ -857,7 +915,12 @@ void CSRMatrix::move_diag()
 }
 void BSRMatrix::move_diag()
 {
+    bool was_diag_first = diag_first;
     move_diag_helper(this, block_vals);
+    if (!was_diag_first || !is_packed())
+    {
+        pack();
+    }
 }
 void CSCMatrix::move_diag()
 {
@@ -877,6 +940,11 @@ void BSCMatrix::move_diag()
 template <typename T>
 void remove_duplicates_helper(COOMatrix* A, std::vector<T>& vals)
 {
+    if (A->nnz == 0)
+    {
+        return;
+    }
+
     if (!A->sorted)
     {
         A->sort();
@@ -1060,9 +1128,98 @@ void CSRMatrix::remove_duplicates()
 {
     remove_duplicates_helper(this, vals);
 }
+// Blocks are combined in place in the contiguous block_data array
 void BSRMatrix::remove_duplicates()
 {
-    remove_duplicates_helper(this, block_vals);
+    int orig_start, orig_end;
+    int new_start;
+    int col, prev_col;
+    int ctr, row_size;
+
+    if (!sorted)
+    {
+        sort();
+        diag_first = false;
+    }
+    if (!is_packed())
+    {
+        pack();
+    }
+
+    // Matrices holding only a sparsity pattern have no blocks to combine
+    bool has_vals = block_vals.size() >= (unsigned) nnz;
+    double* data = block_data.data();
+
+    orig_start = idx1[0];
+    for (int row = 0; row < n_rows; row++)
+    {
+        new_start = idx1[row];
+        orig_end = idx1[row+1];
+        row_size = orig_end - orig_start;
+        if (row_size == 0) 
+        {
+            orig_start = orig_end;
+            idx1[row+1] = idx1[row];
+            continue;
+        }
+
+        // Remove Duplicates
+        col = idx2[orig_start];
+        idx2[new_start] = col;
+        if (has_vals)
+        {
+            std::copy(data + orig_start*b_size, data + (orig_start+1)*b_size,
+                    data + new_start*b_size);
+        }
+        prev_col = col;
+        ctr = 1;
+        for (int j = orig_start + 1; j < orig_end; j++)
+        {
+            col = idx2[j];
+            if (col == prev_col)
+            {
+                if (!has_vals) continue;
+                double* val = data + (ctr - 1 + new_start)*b_size;
+                double* addl_val = data + j*b_size;
+                for (int k = 0; k < b_size; k++)
+                    val[k] += addl_val[k];
+            }
+            else
+            {
+                if (has_vals && abs_val(data + (ctr - 1 + new_start)*b_size) < zero_tol)
+                {
+                    ctr--;
+                }
+
+                idx2[ctr + new_start] = col;
+                if (has_vals)
+                {
+                    std::copy(data + j*b_size, data + (j+1)*b_size,
+                            data + (ctr + new_start)*b_size);
+                }
+                ctr++;
+                prev_col = col;
+            }
+        }
+        if (has_vals && abs_val(data + (ctr - 1 + new_start)*b_size) < zero_tol)
+        {
+            ctr--;
+        }
+
+        orig_start = orig_end;
+        idx1[row+1] = idx1[row] + ctr;
+    }
+    nnz = idx1[n_rows];
+    idx2.resize(nnz);
+    if (has_vals)
+    {
+        block_vals.resize(nnz);
+        block_data.resize(nnz * b_size);
+        for (int j = 0; j < nnz; j++)
+        {
+            block_vals[j] = block_data.data() + j*b_size;
+        }
+    }
 }
 void CSCMatrix::remove_duplicates()
 {
@@ -1117,6 +1274,7 @@ CSRMatrix* BCOOMatrix::to_BSR()
     A->b_cols = b_cols;
     A->b_size = b_size;
     COO_to_CSR(this, A, block_vals, A->block_vals);
+    A->pack();
     return A;
 }
 CSCMatrix* COOMatrix::to_CSC()
@@ -1252,6 +1410,7 @@ CSRMatrix* BSCMatrix::to_BSR()
     A->b_cols = b_cols;
     A->b_size = b_size;
     CSC_to_CSR(this, A, block_vals, A->block_vals);
+    A->pack();
     return A;
 }
 CSCMatrix* CSCMatrix::to_CSC()
@@ -1301,9 +1460,56 @@ BSRMatrix* BSRMatrix::copy()
     A->b_rows = b_rows;
     A->b_cols = b_cols;
     A->b_size = b_size;
-    CSR_to_CSR(this, A, block_vals, A->block_vals);
+    if (!is_packed())
+    {
+        pack();
+    }
+    A->n_rows = n_rows;
+    A->n_cols = n_cols;
+    A->nnz = nnz;
+    A->idx1.assign(idx1.begin(), idx1.begin() + n_rows + 1);
+    A->idx2.assign(idx2.begin(), idx2.begin() + nnz);
+    A->block_data = block_data;
+    A->block_vals.resize(block_vals.size());
+    for (int j = 0; j < (int) block_vals.size(); j++)
+    {
+        A->block_vals[j] = A->block_data.data() + j*b_size;
+    }
+    A->packed = true;
     return A;
 }
+
+/**************************************************************
+*****   BSRMatrix Pack
+**************************************************************
+***** Copies all blocks into the contiguous block_data array,
+***** in the order of block_vals, freeing any separately 
+***** allocated blocks, and points block_vals into block_data
+**************************************************************/
+void BSRMatrix::pack()
+{
+    int n_blocks = block_vals.size();
+    std::vector<double> data(n_blocks * b_size, 0.0);
+    for (int j = 0; j < n_blocks; j++)
+    {
+        double* val = block_vals[j];
+        if (val == NULL) continue;
+        std::copy(val, val + b_size, data.data() + j*b_size);
+        if (!in_block_data(val))
+        {
+            delete[] val;
+        }
+    }
+    block_data.swap(data);
+    for (int j = 0; j < n_blocks; j++)
+    {
+        block_vals[j] = block_data.data() + j*b_size;
+    }
+    packed = true;
+
+    diag_inv.clear();
+    has_diag_inv.clear();
+}
 CSCMatrix* CSCMatrix::copy()
 {
     CSCMatrix* A = new CSCMatrix();
@@ -1436,3 +1642,131 @@ void BSRMatrix::block_removal_col_check(bool* col_check)
         }
     }
 }
+
+/**************************************************************
+*****  SELLMatrix Form SELL
+**************************************************************
+***** Builds the SELL-C-sigma arrays from the CSR arrays.  Rows
+***** are sorted by decreasing length within each window of 
+***** sort_scope rows, and consecutive sorted rows are grouped 
+***** into chunks of chunk_size rows.  Each chunk is stored 
+***** column-major, padded with zeros to its longest row.
+**************************************************************/
+void SELLMatrix::form_sell()
+{
+    num_chunks = (n_rows + chunk_size - 1) / chunk_size;
+
+    // Sort rows by length within each sigma-window
+    row_perm.resize(num_chunks * chunk_size);
+    for (int i = 0; i < n_rows; i++)
+    {
+        row_perm[i] = i;
+    }
+    for (int i = n_rows; i < num_chunks * chunk_size; i++)
+    {
+        row_perm[i] = -1;
+    }
+    if (sort_scope > 1)
+    {
+        for (int i = 0; i < n_rows; i += sort_scope)
+        {
+            int end = i + sort_scope;
+            if (end > n_rows) end = n_rows;
+            std::stable_sort(row_perm.begin() + i, row_perm.begin() + end,
+                    [&](const int a, const int b)
+                    {
+                        return (idx1[a+1] - idx1[a]) > (idx1[b+1] - idx1[b]);
+                    });
+        }
+    }
+
+    // Find width of each chunk
+    chunk_ptr.resize(num_chunks + 1);
+    chunk_width.resize(num_chunks);
+    chunk_ptr[0] = 0;
+    for (int c = 0; c < num_chunks; c++)
+    {
+        int width = 0;
+        for (int k = 0; k < chunk_size; k++)
+        {
+            int row = row_perm[c*chunk_size + k];
+            if (row < 0) continue;
+            int size = idx1[row+1] - idx1[row];
+            if (size > width) width = size;
+        }
+        chunk_width[c] = width;
+        chunk_ptr[c+1] = chunk_ptr[c] + width * chunk_size;
+    }
+
+    // Copy (padded) values into column-major chunks
+    sell_cols.resize(chunk_ptr[num_chunks]);
+    sell_vals.resize(chunk_ptr[num_chunks]);
+    for (int c = 0; c < num_chunks; c++)
+    {
+        int* cols = sell_cols.data() + chunk_ptr[c];
+        double* data = sell_vals.data() + chunk_ptr[c];
+        for (int k = 0; k < chunk_size; k++)
+        {
+            int row = row_perm[c*chunk_size + k];
+            int start = 0;
+            int size = 0;
+            if (row >= 0)
+            {
+                start = idx1[row];
+                size = idx1[row+1] - start;
+            }
+            for (int j = 0; j < size; j++)
+            {
+                cols[j*chunk_size + k] = idx2[start + j];
+                data[j*chunk_size + k] = vals[start + j];
+            }
+            for (int j = size; j < chunk_width[c]; j++)
+            {
+                cols[j*chunk_size + k] = 0;
+                data[j*chunk_size + k] = 0.0;
+            }
+        }
+    }
+}
+
+void SELLMatrix::sort()
+{
+    if (sorted || nnz == 0)
+    {
+        sorted = true;
+        return;
+    }
+    CSRMatrix::sort();
+    form_sell();
+}
+
+void SELLMatrix::move_diag()
+{
+    if (diag_first || nnz == 0)
+    {
+        return;
+    }
+    CSRMatrix::move_diag();
+    form_sell();
+}
+
+void SELLMatrix::remove_duplicates()
+{
+    CSRMatrix::remove_duplicates();
+    form_sell();
+}
+
+SELLMatrix* SELLMatrix::copy()
+{
+    SELLMatrix* A = new SELLMatrix();
+    CSR_to_CSR(this, A, vals, A->vals);
+    A->sorted = sorted;
+    A->diag_first = diag_first;
+    A->init_sell(chunk_size, sort_scope);
+    return A;
+}
+
+SELLMatrix* CSRMatrix::to_SELL(int chunk_size, int sort_scope)
+{
+    return new SELLMatrix(this, chunk_size, sort_scope);
+}
@@ -39,7 +39,7 @@
  ***** Virtual Methods
  ***** -------
  ***** format() 
- *****    Returns the format of the sparse matrix (COO, CSR, CSC)
+ *****    Returns the format of the sparse matrix (COO, CSR, CSC, SELL, ...)
  ***** sort()
  *****    Sorts the matrix by position.  Whether row-wise or 
  *****    column-wise depends on matrix format.
@@ -53,6 +53,7 @@ namespace raptor
   class COOMatrix;
   class CSRMatrix;
   class CSCMatrix;
+  class SELLMatrix;
   class Matrix
   {
 
@@ -115,8 +116,9 @@ namespace raptor
 
         T* val_list = (T*) get_data();
 
-        std::copy(_idx1.begin(), _idx1.end(), std::back_inserter(idx1));
-        std::copy(_idx2.begin(), _idx2.end(), std::back_inserter(idx2));
+        // Block constructors have already sized idx1 through CSRMatrix
+        idx1.assign(_idx1.begin(), _idx1.end());
+        idx2.assign(_idx2.begin(), _idx2.end());
 
         for (int i = 0; i < nnz; i++)
         {
@@ -730,6 +732,7 @@ namespace raptor
     CSRMatrix* to_BSR();
     CSCMatrix* to_BSC();
     COOMatrix* to_BCOO();
+    SELLMatrix* to_SELL(int chunk_size = 8, int sort_scope = 1);
 
     void block_removal_col_check(bool* col_check);
 
@@ -959,6 +962,18 @@ class BCOOMatrix;
 class BSRMatrix;
 class BSCMatrix;
 
+/**************************************************************
+ *****   BSRMatrix Class (Inherits from CSRMatrix Class)
+ **************************************************************
+ ***** Block sparse row matrix.  Each nonzero is a dense 
+ ***** b_rows x b_cols block, stored row-major and accessed through
+ ***** block_vals[j].  Blocks are gathered into the contiguous 
+ ***** block_data array by pack() (called on construction from 
+ ***** data, and after sort/move_diag/remove_duplicates), in which 
+ ***** case block_vals[j] == &block_data[j*b_size].  Packed matrices
+ ***** with square blocks of size 2, 3, 4, 6 or 8 use fixed-size 
+ ***** SpMV, SpGEMM and relaxation kernels.
+ **************************************************************/
 class BSRMatrix : public CSRMatrix
 {
   public:
@@ -969,6 +984,7 @@ class BSRMatrix : public CSRMatrix
         b_rows = block_row_size;
         b_cols = block_col_size;
         b_size = b_rows * b_cols;
+        packed = false;
     }
 
     BSRMatrix(int num_block_rows, int num_block_cols, 
@@ -979,7 +995,9 @@ class BSRMatrix : public CSRMatrix
         b_cols = block_col_size;
         b_size = b_rows * b_cols;
 
+        packed = false;
         init_from_dense(data);
+        pack();
     }
 
 
@@ -992,7 +1010,9 @@ class BSRMatrix : public CSRMatrix
         b_cols = block_col_size;
         b_size = b_rows * b_cols;
 
+        packed = false;
         init_from_lists(rowptr, cols, data);
+        pack();
     }
 
     
@@ -1001,13 +1021,34 @@ class BSRMatrix : public CSRMatrix
         b_rows = 1;
         b_cols = 1;
         b_size = 1;
+        packed = false;
     }
 
     ~BSRMatrix()
     {
         for (std::vector<double*>::iterator it = block_vals.begin();
                 it != block_vals.end(); ++it)
-            delete[] *it;
+        {
+            if (!in_block_data(*it))
+                delete[] *it;
+        }
+    }
+
+    // Gather all blocks into block_data, in CSR order
+    void pack();
+
+    // True if block_vals[j] == &block_data[j*b_size] for all j
+    bool is_packed() const
+    {
+        return packed && block_data.size() == block_vals.size() * b_size;
+    }
+
+    bool in_block_data(const double* val) const
+    {
+        if (block_data.empty()) return false;
+        std::less<const double*> lt;
+        return !lt(val, block_data.data()) 
+            && lt(val, block_data.data() + block_data.size());
     }
 
     BSRMatrix* transpose();
@@ -1047,6 +1088,7 @@ class BSRMatrix : public CSRMatrix
         idx2.emplace_back(col);
         block_vals.emplace_back(copy_val(value));
         nnz++;
+        packed = false;
     }
 
     void* get_data()
@@ -1060,6 +1102,7 @@ class BSRMatrix : public CSRMatrix
     void resize_data(int size)
     {
         block_vals.resize(size);
+        packed = false;
     }
     void reserve_size(int size)
     {
@@ -1073,6 +1116,15 @@ class BSRMatrix : public CSRMatrix
     }
 
     std::vector<double*> block_vals;
+    std::vector<double> block_data;
+    bool packed;
+
+    // Inverted diagonal blocks of each row for block relaxation (see
+    // par_relax.cpp), with a scratch block row.  Formed once, and
+    // cleared by pack() when blocks move.
+    std::vector<double> diag_inv;
+    std::vector<bool> has_diag_inv;
+    std::vector<double> relax_work;
 };
 
 class BCOOMatrix : public COOMatrix
@@ -1309,6 +1361,113 @@ class BSCMatrix : public CSCMatrix
 };
 
 
+/**************************************************************
+ *****   SELLMatrix Class (Inherits from CSRMatrix Class)
+ **************************************************************
+ ***** This class stores a sparse matrix in SELL-C-sigma (sliced
+ ***** ELLPACK) format, alongside the CSR arrays it is formed from.
+ ***** Rows are sorted by length within windows of sort_scope rows,
+ ***** and grouped into chunks of chunk_size rows.  Each chunk is
+ ***** padded to its longest row and stored column-major, so that
+ ***** the SpMV inner loop runs over chunk_size independent rows
+ ***** and maps onto SIMD lanes (AVX2 / AVX-512 when enabled by the
+ ***** compiler flags).  The CSR arrays are kept, so all CSR-based
+ ***** routines (relaxation, strength, transposes, ...) still work,
+ ***** and a SELLMatrix can be used as on_proc / off_proc of a
+ ***** ParCSRMatrix.
+ *****
+ ***** Attributes
+ ***** -------------
+ ***** chunk_size : int
+ *****    Number of rows per chunk (C)
+ ***** sort_scope : int
+ *****    Number of consecutive rows sorted by length (sigma)
+ ***** num_chunks : int
+ *****    Number of chunks
+ ***** chunk_ptr : std::vector<int>
+ *****    Position of first padded entry of each chunk
+ ***** chunk_width : std::vector<int>
+ *****    Padded row length of each chunk
+ ***** row_perm : std::vector<int>
+ *****    Original row of each chunk slot (-1 for padding rows)
+ ***** sell_cols : std::vector<int>
+ *****    Column of each padded entry
+ ***** sell_vals : std::vector<double>
+ *****    Value of each padded entry (0 for padding)
+ *****
+ ***** Methods
+ ***** -------
+ ***** form_sell()
+ *****    (Re)builds the sliced arrays from the CSR arrays.  Must be
+ *****    called after the CSR arrays or values are modified directly.
+ **************************************************************/
+class SELLMatrix : public CSRMatrix
+{
+  public:
+    SELLMatrix(CSRMatrix* A, int _chunk_size = 8, int _sort_scope = 1) 
+        : CSRMatrix(A->n_rows, A->n_cols, A->idx1, A->idx2, A->vals)
+    {
+        sorted = A->sorted;
+        diag_first = A->diag_first;
+        init_sell(_chunk_size, _sort_scope);
+    }
+
+    SELLMatrix(int _nrows, int _ncols, std::vector<int>& rowptr, 
+            std::vector<int>& cols, std::vector<double>& data,
+            int _chunk_size = 8, int _sort_scope = 1) 
+        : CSRMatrix(_nrows, _ncols, rowptr, cols, data)
+    {
+        init_sell(_chunk_size, _sort_scope);
+    }
+
+    SELLMatrix() : CSRMatrix()
+    {
+        chunk_size = 8;
+        sort_scope = 1;
+        num_chunks = 0;
+    }
+
+    ~SELLMatrix()
+    {
+
+    }
+
+    void init_sell(int _chunk_size, int _sort_scope)
+    {
+        chunk_size = _chunk_size < 1 ? 1 : _chunk_size;
+        sort_scope = _sort_scope < 1 ? 1 : _sort_scope;
+        form_sell();
+    }
+
+    void form_sell();
+
+    void sort();
+    void move_diag();
+    void remove_duplicates();
+
+    void spmv(const double* x, double* b) const;
+    void spmv_append(const double* x, double* b) const;
+    void spmv_append_neg(const double* x, double* b) const;
+    void spmv_residual(const double* x, const double* b, double* r) const; 
+
+    SELLMatrix* copy();
+
+    format_t format()
+    {
+        return SELL;
+    }
+
+    int chunk_size;
+    int sort_scope;
+    int num_chunks;
+    std::vector<int> chunk_ptr;
+    std::vector<int> chunk_width;
+    std::vector<int> row_perm;
+    std::vector<int> sell_cols;
+    std::vector<double> sell_vals;
+};
+
+
 
 }
 
@@ -6,20 +6,8 @@
 #include "types.hpp"
 #include <mpi.h>
 
-// Global Timing Variables
-extern bool profile;
-extern double collective_t;
-extern double p2p_t;
-extern double* current_t;
-extern double mat_t;
-extern double vec_t;
-extern double total_t;
-
-extern void init_profile();
-extern void reset_profile();
-extern void finalize_profile();
-extern void print_profile(const char* string);
-extern void average_profile(int n_iter);
+// Timing regions, and communication times recorded by the wrappers
+#include "raptor/profiling/timer.hpp"
 
 #define RAPtor_MPI_COMM_WORLD        MPI_COMM_WORLD
 #define RAPtor_MPI_COMM_NULL         MPI_COMM_NULL
@@ -30,11 +18,15 @@ extern void average_profile(int n_iter);
 #define RAPtor_MPI_Request           MPI_Request
 #define RAPtor_MPI_Status            MPI_Status
 #define RAPtor_MPI_Op                MPI_Op
+#define RAPtor_MPI_Win               MPI_Win
+#define RAPtor_MPI_Aint              MPI_Aint
+#define RAPtor_MPI_Info              MPI_Info
 
 #define RAPtor_MPI_INT               MPI_INT
 #define RAPtor_MPI_DOUBLE            MPI_DOUBLE
 #define RAPtor_MPI_DOUBLE_INT        MPI_DOUBLE_INT
 #define RAPtor_MPI_LONG              MPI_LONG
+#define RAPtor_MPI_CHAR              MPI_CHAR
 #define RAPtor_MPI_PACKED            MPI_PACKED
 
 #define RAPtor_MPI_STATUS_IGNORE     MPI_STATUS_IGNORE
@@ -46,8 +38,16 @@ extern void average_profile(int n_iter);
 #define RAPtor_MPI_IN_PLACE          MPI_IN_PLACE
 #define RAPtor_MPI_SUM               MPI_SUM
 #define RAPtor_MPI_MAX               MPI_MAX
+#define RAPtor_MPI_MIN               MPI_MIN
 #define RAPtor_MPI_BOR               MPI_BOR
 
+#define RAPtor_MPI_INFO_NULL         MPI_INFO_NULL
+#define RAPtor_MPI_MODE_NOCHECK      MPI_MODE_NOCHECK
+#define RAPtor_MPI_COMM_TYPE_SHARED  MPI_COMM_TYPE_SHARED
+#ifdef OPEN_MPI
+#define RAPtor_MPI_COMM_TYPE_SOCKET  OMPI_COMM_TYPE_SOCKET
+#endif
+
 
 // MPI Information
 extern int RAPtor_MPI_Comm_rank(RAPtor_MPI_Comm comm, int *rank);
@@ -129,5 +129,18 @@ extern int RAPtor_MPI_Group_incl(RAPtor_MPI_Group group, int n, const int ranks[
         RAPtor_MPI_Group *newgroup);
 extern int RAPtor_MPI_Group_free(RAPtor_MPI_Group* group);
 extern int RAPtor_MPI_Comm_dup(MPI_Comm comm, MPI_Comm* new_comm);
+extern int RAPtor_MPI_Comm_split_type(RAPtor_MPI_Comm comm, int split_type,
+        int key, RAPtor_MPI_Info info, RAPtor_MPI_Comm* new_comm);
+
+// Shared Memory Windows
+extern int RAPtor_MPI_Win_allocate_shared(RAPtor_MPI_Aint size, int disp_unit,
+        RAPtor_MPI_Info info, RAPtor_MPI_Comm comm, void* baseptr,
+        RAPtor_MPI_Win* win);
+extern int RAPtor_MPI_Win_shared_query(RAPtor_MPI_Win win, int rank,
+        RAPtor_MPI_Aint* size, int* disp_unit, void* baseptr);
+extern int RAPtor_MPI_Win_free(RAPtor_MPI_Win* win);
+extern int RAPtor_MPI_Win_lock_all(int assert, RAPtor_MPI_Win win);
+extern int RAPtor_MPI_Win_unlock_all(RAPtor_MPI_Win win);
+extern int RAPtor_MPI_Win_sync(RAPtor_MPI_Win win);
 
 #endif
@@ -0,0 +1,313 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "par_matrix.hpp"
+#include <algorithm>
+
+using namespace raptor;
+
+// Declare Private Methods
+void exchange_stash(std::vector<AssemblyEntry>& send_entries,
+        const std::vector<int>& proc_ptr, std::vector<AssemblyEntry>& recv_entries);
+void sort_row(std::vector<int>& idx2, std::vector<double>& vals, int start, int end,
+        std::vector<std::pair<int, double> >& row_buf);
+
+/**************************************************************
+*****   ParMatrix Add Global Values
+**************************************************************
+***** Stashes n values in any global rows.  As with add_value,
+***** zero values are dropped.
+**************************************************************/
+void ParMatrix::add_global_values(int n, const int* rows,
+        const int* global_cols, const double* values)
+{
+    stash.reserve(stash.size() + n);
+    for (int i = 0; i < n; i++)
+    {
+        if (fabs(values[i]) > zero_tol)
+        {
+            AssemblyEntry entry;
+            entry.row = rows[i];
+            entry.col = global_cols[i];
+            entry.val = values[i];
+            stash.emplace_back(entry);
+        }
+    }
+}
+
+/**************************************************************
+*****   Exchange Stash
+**************************************************************
+***** Sends send_entries[proc_ptr[p]:proc_ptr[p+1]] to each process
+***** p, and appends the entries sent to this process (including
+***** its own) to recv_entries.  Uses a synchronous send to each
+***** destination followed by a non-blocking barrier (NBX), so the
+***** number of messages to receive need not be known in advance.
+**************************************************************/
+void exchange_stash(std::vector<AssemblyEntry>& send_entries,
+        const std::vector<int>& proc_ptr, std::vector<AssemblyEntry>& recv_entries)
+{
+    int rank, num_procs;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    int tag = 4185;
+    int entry_bytes = sizeof(AssemblyEntry);
+    int flag, count, size;
+    RAPtor_MPI_Status recv_status;
+    RAPtor_MPI_Request barrier_request;
+    std::vector<RAPtor_MPI_Request> send_requests;
+
+    // Own entries are kept
+    recv_entries.insert(recv_entries.end(), send_entries.begin() + proc_ptr[rank],
+            send_entries.begin() + proc_ptr[rank+1]);
+
+    for (int proc = 0; proc < num_procs; proc++)
+    {
+        count = proc_ptr[proc+1] - proc_ptr[proc];
+        if (proc == rank || count == 0) continue;
+        send_requests.emplace_back(RAPtor_MPI_Request());
+        RAPtor_MPI_Issend(&(send_entries[proc_ptr[proc]]), count * entry_bytes,
+                RAPtor_MPI_CHAR, proc, tag, RAPtor_MPI_COMM_WORLD,
+                &(send_requests.back()));
+    }
+
+    // Receive until all sends have matched and every process has
+    // reached the barrier
+    bool barrier_active = false;
+    while (true)
+    {
+        RAPtor_MPI_Iprobe(RAPtor_MPI_ANY_SOURCE, tag, RAPtor_MPI_COMM_WORLD, &flag,
+                &recv_status);
+        if (flag)
+        {
+            RAPtor_MPI_Get_count(&recv_status, RAPtor_MPI_CHAR, &count);
+            size = recv_entries.size();
+            recv_entries.resize(size + count / entry_bytes);
+            RAPtor_MPI_Recv(&(recv_entries[size]), count, RAPtor_MPI_CHAR,
+                    recv_status.MPI_SOURCE, tag, RAPtor_MPI_COMM_WORLD,
+                    RAPtor_MPI_STATUS_IGNORE);
+        }
+
+        if (barrier_active)
+        {
+            RAPtor_MPI_Test(&barrier_request, &flag, RAPtor_MPI_STATUS_IGNORE);
+            if (flag) break;
+        }
+        else
+        {
+            RAPtor_MPI_Testall(send_requests.size(), send_requests.data(), &flag,
+                    RAPtor_MPI_STATUSES_IGNORE);
+            if (flag)
+            {
+                RAPtor_MPI_Ibarrier(RAPtor_MPI_COMM_WORLD, &barrier_request);
+                barrier_active = true;
+            }
+        }
+    }
+}
+
+// Sorts idx2[start:end] (and vals) by column
+void sort_row(std::vector<int>& idx2, std::vector<double>& vals, int start, int end,
+        std::vector<std::pair<int, double> >& row_buf)
+{
+    if (end - start < 2) return;
+
+    row_buf.clear();
+    for (int j = start; j < end; j++)
+    {
+        row_buf.emplace_back(std::make_pair(idx2[j], vals[j]));
+    }
+    std::sort(row_buf.begin(), row_buf.end());
+    for (int j = start; j < end; j++)
+    {
+        idx2[j] = row_buf[j - start].first;
+        vals[j] = row_buf[j - start].second;
+    }
+}
+
+/**************************************************************
+*****   ParMatrix Assemble
+**************************************************************
+***** Stashed values are bucketed by owning process and local row
+***** with counting sorts.  Off_proc columns are condensed through
+***** a hash map (built once from the sorted unique columns), and
+***** duplicates in each row are summed through dense position
+***** arrays, as in SpGEMM, with no per-entry tree lookups.
+**************************************************************/
+void ParMatrix::assemble(bool create_comm)
+{
+    int rank, num_procs;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    format_t format = on_proc->format();
+    if (format != COO && format != CSR)
+    {
+        if (rank == 0) printf("Assembly is only implemented for COO and CSR matrices.\n");
+        return;
+    }
+
+    int proc, row, col, idx;
+    int first_row = partition->first_local_row;
+    int first_col = partition->first_local_col;
+    int last_col = partition->last_local_col;
+
+    // First global row of each process
+    std::vector<int> first_rows(num_procs + 1);
+    RAPtor_MPI_Allgather(&first_row, 1, RAPtor_MPI_INT, first_rows.data(), 1,
+            RAPtor_MPI_INT, RAPtor_MPI_COMM_WORLD);
+    first_rows[num_procs] = global_num_rows;
+
+    // Bucket stashed entries by owning process
+    int n_stash = stash.size();
+    std::vector<int> entry_proc(n_stash);
+    std::vector<int> proc_ptr(num_procs + 1, 0);
+    for (int i = 0; i < n_stash; i++)
+    {
+        proc = std::upper_bound(first_rows.begin(), first_rows.begin() + num_procs,
+                stash[i].row) - first_rows.begin() - 1;
+        entry_proc[i] = proc;
+        proc_ptr[proc + 1]++;
+    }
+    for (int i = 0; i < num_procs; i++)
+    {
+        proc_ptr[i+1] += proc_ptr[i];
+    }
+    std::vector<AssemblyEntry> send_entries(n_stash);
+    std::vector<int> proc_pos(proc_ptr.begin(), proc_ptr.end() - 1);
+    for (int i = 0; i < n_stash; i++)
+    {
+        send_entries[proc_pos[entry_proc[i]]++] = stash[i];
+    }
+    std::vector<AssemblyEntry>().swap(stash);
+
+    std::vector<AssemblyEntry> entries;
+    exchange_stash(send_entries, proc_ptr, entries);
+    std::vector<AssemblyEntry>().swap(send_entries);
+    int n_entries = entries.size();
+
+    // Bucket local entries by row
+    std::vector<int> row_ptr(local_num_rows + 1, 0);
+    for (int i = 0; i < n_entries; i++)
+    {
+        row_ptr[entries[i].row - first_row + 1]++;
+    }
+    for (int i = 0; i < local_num_rows; i++)
+    {
+        row_ptr[i+1] += row_ptr[i];
+    }
+    std::vector<AssemblyEntry> row_entries(n_entries);
+    std::vector<int> row_pos(row_ptr.begin(), row_ptr.end() - 1);
+    for (int i = 0; i < n_entries; i++)
+    {
+        row_entries[row_pos[entries[i].row - first_row]++] = entries[i];
+    }
+    std::vector<AssemblyEntry>().swap(entries);
+
+    // Sorted, unique off_proc columns, and hash map to local columns
+    off_proc_column_map.clear();
+    for (int i = 0; i < n_entries; i++)
+    {
+        col = row_entries[i].col;
+        if (col < first_col || col > last_col)
+        {
+            off_proc_column_map.emplace_back(col);
+        }
+    }
+    sort_unique(off_proc_column_map);
+    off_proc_num_cols = off_proc_column_map.size();
+    IndexMap global_to_local(off_proc_column_map);
+
+    // Form rows, summing duplicates through dense position arrays
+    Matrix* mats[2] = {on_proc, off_proc};
+    for (int m = 0; m < 2; m++)
+    {
+        mats[m]->idx1.clear();
+        mats[m]->idx2.clear();
+        mats[m]->vals.clear();
+        if (format == CSR)
+        {
+            mats[m]->idx1.resize(local_num_rows + 1);
+            mats[m]->idx1[0] = 0;
+        }
+    }
+    std::vector<int> on_pos(partition->local_num_cols, -1);
+    std::vector<int> off_pos(off_proc_num_cols, -1);
+    std::vector<std::pair<int, double> > row_buf;
+    std::vector<int>& on_idx2 = on_proc->idx2;
+    std::vector<double>& on_vals = on_proc->vals;
+    std::vector<int>& off_idx2 = off_proc->idx2;
+    std::vector<double>& off_vals = off_proc->vals;
+    for (row = 0; row < local_num_rows; row++)
+    {
+        int on_start = on_idx2.size();
+        int off_start = off_idx2.size();
+        for (int j = row_ptr[row]; j < row_ptr[row+1]; j++)
+        {
+            col = row_entries[j].col;
+            if (col >= first_col && col <= last_col)
+            {
+                col -= first_col;
+                idx = on_pos[col];
+                if (idx < 0)
+                {
+                    on_pos[col] = on_idx2.size();
+                    on_idx2.emplace_back(col);
+                    on_vals.emplace_back(row_entries[j].val);
+                }
+                else
+                {
+                    on_vals[idx] += row_entries[j].val;
+                }
+            }
+            else
+            {
+                col = global_to_local[col];
+                idx = off_pos[col];
+                if (idx < 0)
+                {
+                    off_pos[col] = off_idx2.size();
+                    off_idx2.emplace_back(col);
+                    off_vals.emplace_back(row_entries[j].val);
+                }
+                else
+                {
+                    off_vals[idx] += row_entries[j].val;
+                }
+            }
+        }
+        for (int j = on_start; j < (int) on_idx2.size(); j++)
+        {
+            on_pos[on_idx2[j]] = -1;
+        }
+        for (int j = off_start; j < (int) off_idx2.size(); j++)
+        {
+            off_pos[off_idx2[j]] = -1;
+        }
+        sort_row(on_idx2, on_vals, on_start, on_idx2.size(), row_buf);
+        sort_row(off_idx2, off_vals, off_start, off_idx2.size(), row_buf);
+
+        if (format == CSR)
+        {
+            on_proc->idx1[row+1] = on_idx2.size();
+            off_proc->idx1[row+1] = off_idx2.size();
+        }
+        else
+        {
+            on_proc->idx1.resize(on_idx2.size(), row);
+            off_proc->idx1.resize(off_idx2.size(), row);
+        }
+    }
+
+    for (int m = 0; m < 2; m++)
+    {
+        mats[m]->n_rows = local_num_rows;
+        mats[m]->nnz = mats[m]->idx2.size();
+        mats[m]->sorted = true;
+        mats[m]->diag_first = false;
+    }
+    on_proc->n_cols = partition->local_num_cols;
+    on_proc_num_cols = partition->local_num_cols;
+
+    finalize_maps(create_comm);
+}
@@ -83,27 +83,11 @@ void ParMatrix::condense_off_proc()
         return;
     }
 
-    int prev_col = -1;
-
-    std::map<int, int> orig_to_new;
-
-    std::copy(off_proc->idx2.begin(), off_proc->idx2.end(),
-            std::back_inserter(off_proc_column_map));
-    std::sort(off_proc_column_map.begin(), off_proc_column_map.end());
-
-    off_proc_num_cols = 0;
-    for (std::vector<int>::iterator it = off_proc_column_map.begin();
-            it != off_proc_column_map.end(); ++it)
-    {
-        if (*it != prev_col)
-        {
-            orig_to_new[*it] = off_proc_num_cols;
-            off_proc_column_map[off_proc_num_cols++] = *it;
-            prev_col = *it;
-        }
-    }
-    off_proc_column_map.resize(off_proc_num_cols);
+    off_proc_column_map.assign(off_proc->idx2.begin(), off_proc->idx2.end());
+    sort_unique(off_proc_column_map);
+    off_proc_num_cols = off_proc_column_map.size();
 
+    IndexMap orig_to_new(off_proc_column_map);
     for (std::vector<int>::iterator it = off_proc->idx2.begin();
             it != off_proc->idx2.end(); ++it)
     {
@@ -118,10 +102,22 @@ void ParMatrix::finalize(bool create_comm)
     off_proc->sort();
     off_proc->remove_duplicates();
 
-    int rank, num_procs;
-    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
-    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    // Condense columns in off_proc, storing global
+    // columns as 0-num_cols, and store mapping
+    if (off_proc->nnz)
+    {
+        condense_off_proc();
+    }
+    else
+    {
+        off_proc_num_cols = 0;
+    }
 
+    finalize_maps(create_comm);
+}
+
+void ParMatrix::finalize_maps(bool create_comm)
+{
     // Assume nonzeros in each on_proc column
     if (on_proc_num_cols > (int)on_proc_column_map.size())
     {
@@ -141,16 +137,6 @@ void ParMatrix::finalize(bool create_comm)
         }
     }
 
-    // Condense columns in off_proc, storing global
-    // columns as 0-num_cols, and store mapping
-    if (off_proc->nnz)
-    {
-        condense_off_proc();
-    }
-    else
-    {
-        off_proc_num_cols = 0;
-    }
     off_proc->resize(local_num_rows, off_proc_num_cols);
     local_nnz = on_proc->nnz + off_proc->nnz;
 
@@ -443,6 +429,24 @@ ParCSCMatrix* ParBSCMatrix::to_ParBSC()
 }
 
 
+void ParCSRMatrix::form_SELL(int chunk_size, int sort_scope)
+{
+    // Blocked matrices keep their BSR kernels
+    if (on_proc->format() != CSR || off_proc->format() != CSR)
+    {
+        return;
+    }
+
+    SELLMatrix* on_proc_sell = ((CSRMatrix*) on_proc)->to_SELL(chunk_size, sort_scope);
+    SELLMatrix* off_proc_sell = ((CSRMatrix*) off_proc)->to_SELL(chunk_size, sort_scope);
+
+    delete on_proc;
+    delete off_proc;
+
+    on_proc = on_proc_sell;
+    off_proc = off_proc_sell;
+}
+
 void ParCSRMatrix::copy_structure(ParBSRMatrix* A)
 {
     on_proc->idx1.clear();
@@ -915,14 +919,14 @@ ParBSRMatrix* ParCSRMatrix::to_ParBSR(const int block_row_size, const int block_
     }
 
     prev_col = -1;
-    std::map<int, int> global_to_block_local;
+    IndexMap global_to_block_local;
     for (std::vector<int>::iterator it = off_proc_column_map.begin();
             it != off_proc_column_map.end(); ++it)
     {
         block_col = *it / block_col_size;
         if (block_col != prev_col)
         {
-            global_to_block_local[block_col] = A->off_proc_column_map.size();
+            global_to_block_local.insert(block_col, A->off_proc_column_map.size());
             A->off_proc_column_map.emplace_back(block_col);
             prev_col = block_col;
         }
@@ -953,14 +957,14 @@ ParBSRMatrix* ParCSRMatrix::to_ParBSR(const int block_row_size, const int block_
                 {
                     on_proc_pos[block_col] = A_on_proc->idx2.size();
                     A_on_proc->idx2.emplace_back(block_col);
-                    A_on_proc->block_vals.emplace_back(
-                            new double[A_on_proc->b_size]());
+                    A_on_proc->block_data.resize(
+                            A_on_proc->block_data.size() + A_on_proc->b_size, 0.0);
                 }
                 val = on_proc->vals[k];
                 pos = on_proc_pos[block_col];
                 col_pos = col % block_col_size;
                 block_pos = row_pos * block_col_size + col_pos;
-                A_on_proc->block_vals[pos][block_pos] = val;
+                A_on_proc->block_data[pos*A_on_proc->b_size + block_pos] = val;
             }
 
             start = off_proc->idx1[i+row_pos];
@@ -974,14 +978,14 @@ ParBSRMatrix* ParCSRMatrix::to_ParBSR(const int block_row_size, const int block_
                 {
                     off_proc_pos[block_col] = A_off_proc->idx2.size();
                     A_off_proc->idx2.emplace_back(block_col);
-                    A_off_proc->block_vals.emplace_back(
-                            new double[A_off_proc->b_size]());
+                    A_off_proc->block_data.resize(
+                            A_off_proc->block_data.size() + A_off_proc->b_size, 0.0);
                 }
                 val = off_proc->vals[k];
                 pos = off_proc_pos[block_col];
                 col_pos = global_col % block_col_size;
                 block_pos = row_pos * block_col_size + col_pos;
-                A_off_proc->block_vals[pos][block_pos] = val;
+                A_off_proc->block_data[pos*A_off_proc->b_size + block_pos] = val;
             }
         }
         A_on_proc->idx1[i/block_row_size + 1] = A_on_proc->idx2.size();
@@ -990,6 +994,16 @@ ParBSRMatrix* ParCSRMatrix::to_ParBSR(const int block_row_size, const int block_
     A_on_proc->nnz = A_on_proc->idx2.size();
     A_off_proc->nnz = A_off_proc->idx2.size();
 
+    // Blocks were formed contiguously, point block_vals into block_data
+    A_on_proc->block_vals.resize(A_on_proc->nnz);
+    for (int j = 0; j < A_on_proc->nnz; j++)
+        A_on_proc->block_vals[j] = A_on_proc->block_data.data() + j*A_on_proc->b_size;
+    A_on_proc->packed = true;
+    A_off_proc->block_vals.resize(A_off_proc->nnz);
+    for (int j = 0; j < A_off_proc->nnz; j++)
+        A_off_proc->block_vals[j] = A_off_proc->block_data.data() + j*A_off_proc->b_size;
+    A_off_proc->packed = true;
+
     A->comm = new ParComm(A->partition, A->off_proc_column_map);
 
     return A;
@@ -8,6 +8,7 @@
 #include <set>
 
 #include "matrix.hpp"
+#include "index_map.hpp"
 #include "par_vector.hpp"
 #include "comm_pkg.hpp"
 #include "mpi_types.hpp"
@@ -63,9 +64,22 @@
  *****    Finalizes a matrix after values have been added.
  *****    Converts the matrices to the appropriate formats and
  *****    creates the parallel communicator.
+ ***** add_global_values()
+ *****    Stashes a batch of values, in any global rows
+ ***** assemble()
+ *****    Sends stashed values to the owners of their rows, sums
+ *****    duplicates, and finalizes the matrix
  **************************************************************/
 namespace raptor
 {
+  // Value stashed by add_global_values (global row and column)
+  struct AssemblyEntry
+  {
+      int row;
+      int col;
+      double val;
+  };
+
   class ParComm;
   class TAPComm;
   class ParCOOMatrix;
@@ -237,13 +251,48 @@ namespace raptor
     **************************************************************/
     void finalize(bool create_comm = true); //b_cols added for BSR
 
+    /**************************************************************
+    *****   ParMatrix Add Global Values
+    **************************************************************
+    ***** Stashes n values (global row, global column, value), with
+    ***** rows owned by any process, until assemble() is called.
+    ***** Duplicate entries are summed.
+    *****
+    ***** Parameters
+    ***** -------------
+    ***** n : int
+    *****    Number of values
+    ***** rows, global_cols : const int*
+    *****    Global row and column of each value
+    ***** values : const double*
+    *****    Values to be added to parallel matrix
+    **************************************************************/
+    void add_global_values(int n, const int* rows, const int* global_cols,
+            const double* values);
+
+    /**************************************************************
+    *****   ParMatrix Assemble
+    **************************************************************
+    ***** Collective.  Sends stashed values to the processes owning
+    ***** their rows (in one sparse all-to-all), and forms on_proc
+    ***** and off_proc from the values of local rows, summing
+    ***** duplicates and sorting each row.  Replaces any values
+    ***** added with add_value, and then finalizes the matrix.
+    ***** Supported for COO and CSR matrices.
+    **************************************************************/
+    void assemble(bool create_comm = true);
+
+    // Column and row maps, number of nonzeros and communicator of a
+    // matrix with condensed off_proc columns
+    void finalize_maps(bool create_comm = true);
+
     int* map_partition_to_local();
     void condense_off_proc();
 
-    void residual(ParVector& x, ParVector& b, ParVector& r, bool tap = false);
-    void tap_residual(ParVector& x, ParVector& b, ParVector& r);
-    void mult(ParVector& x, ParVector& b, bool tap = false);
-    void tap_mult(ParVector& x, ParVector& b);
+    virtual void residual(ParVector& x, ParVector& b, ParVector& r, bool tap = false);
+    virtual void tap_residual(ParVector& x, ParVector& b, ParVector& r);
+    virtual void mult(ParVector& x, ParVector& b, bool tap = false);
+    virtual void tap_mult(ParVector& x, ParVector& b);
     void mult_append(ParVector& x, ParVector& b, bool tap = false);
     void tap_mult_append(ParVector& x, ParVector& b);
     void mult_T(ParVector& x, ParVector& b, bool tap = false);
@@ -333,6 +382,9 @@ namespace raptor
     std::vector<int> on_proc_column_map; // Maps on_proc local to global
     std::vector<int> local_row_map; // Maps local rows to global
 
+    // Values of add_global_values, waiting for assemble()
+    std::vector<AssemblyEntry> stash;
+
     // Parallel communication package indicating which
     // processes hold vector values associated with off_proc,
     // and which processes need vector values from this proc
@@ -570,12 +622,27 @@ namespace raptor
 
     ParBSRMatrix* to_ParBSR(const int block_row_size, const int block_col_size);
 
+    // Replace on_proc and off_proc with SELL-C-sigma copies (in place)
+    void form_SELL(int chunk_size = 8, int sort_scope = 1);
+
+    // Hooks for matrix-free operators (e.g. ParStencilMatrix), which 
+    // relax without on_proc / off_proc and can drop them after setup
+    virtual bool relax_matrix_free(ParVector& x, ParVector& b, ParVector& tmp,
+            int num_sweeps, double omega, relax_t relax_type)
+    {
+        return false;
+    }
+    virtual void release_explicit()
+    {
+    }
+
     void copy_helper(ParCSRMatrix* A);
     void copy_helper(ParCSCMatrix* A);
     void copy_helper(ParCOOMatrix* A);
 
     ParCSRMatrix* strength(strength_t strength_type, double theta = 0.0,
-            bool tap_amg = false, int num_variables = 1, int* variables = NULL);
+            bool tap_amg = false, int num_variables = 1, int* variables = NULL,
+            bool pattern_only = false);
     ParCSRMatrix* aggregate();
     ParCSRMatrix* fit_candidates(double* B, double* R, int num_candidates,
             double tol = 1e-10);
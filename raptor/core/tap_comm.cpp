@@ -215,7 +215,7 @@ void TAPComm::form_local_R_par_comm(const std::vector<int>& off_node_column_map,
                 it != recv_nodes.end(); ++it)
         {
             node_to_local_proc[*it] = local_proc++ ;
-            if (local_proc >= topology->PPN)
+            if (local_proc >= topology->local_num_procs)
             {
                 local_proc = 0;
             }
@@ -526,11 +526,11 @@ void TAPComm::form_global_par_comm(std::vector<int>& orig_procs)
     n_sends = sendbuf.size();
     RAPtor_MPI_Allgather(&n_sends, 1, RAPtor_MPI_INT, send_sizes.data(), 1, RAPtor_MPI_INT, topology->local_comm);
     send_displs[0] = 0;
-    for (int i = 0; i < topology->PPN; i++)
+    for (int i = 0; i < topology->local_num_procs; i++)
     {
         send_displs[i+1] = send_displs[i] + send_sizes[i];
     } 
-    n_send_procs = send_displs[topology->PPN];
+    n_send_procs = send_displs[topology->local_num_procs];
     send_procs.resize(n_send_procs);
     send_proc_sizes.resize(n_send_procs);
     RAPtor_MPI_Allgatherv(sendbuf.data(), n_sends, RAPtor_MPI_INT, send_procs.data(), 
@@ -566,7 +566,8 @@ void TAPComm::form_global_par_comm(std::vector<int>& orig_procs)
 
     // Distribute send_procs across local procs
     n_sends = 0;
-    for (size_t i = topology->PPN - local_rank - 1; i < send_procs.size(); i += topology->PPN)
+    for (size_t i = topology->local_num_procs - local_rank - 1; i < send_procs.size();
+            i += topology->local_num_procs)
     {
         global_par_comm->send_data->procs.emplace_back(send_procs[i]);
     }
@@ -808,10 +809,10 @@ void TAPComm::adjust_send_indices(const int first_local_col)
         }
 
         // Update global_par_comm->send_data->indices (global rows) to 
-        std::map<int, int> S_global_to_local;
+        IndexMap S_global_to_local(local_S_recv->size_msgs);
         for (int i = 0; i < local_S_recv->size_msgs; i++)
         {
-            S_global_to_local[local_S_recv->indices[i]] = i;
+            S_global_to_local.insert(local_S_recv->indices[i], i);
         }
         std::vector<int> local_S_num_pos;
         if (local_S_recv->size_msgs)
@@ -850,10 +851,10 @@ void TAPComm::adjust_send_indices(const int first_local_col)
 
     // Update local_R_par_comm->send_data->indices (global_rows)
     DuplicateData* global_recv = (DuplicateData*) global_par_comm->recv_data;
-    std::map<int, int> global_to_local;
+    IndexMap global_to_local(global_recv->size_msgs);
     for (int i = 0; i < global_recv->size_msgs; i++)
     {
-        global_to_local[global_recv->indices[i]] = i;
+        global_to_local.insert(global_recv->indices[i], i);
     }
     std::vector<int> global_num_pos;
     if (global_recv->size_msgs)
@@ -995,7 +996,7 @@ void TAPComm::form_simple_R_par_comm(std::vector<int>& off_node_column_map,
     for (std::vector<int>::iterator it = off_node_col_to_proc.begin();
             it != off_node_col_to_proc.end(); ++it)
     {
-        local_proc = topology->get_local_proc(*it);
+        local_proc = topology->get_local_proc(*it) % topology->local_num_procs;
         local_proc_sizes[local_proc]++;
     }
 
@@ -1023,7 +1024,7 @@ void TAPComm::form_simple_R_par_comm(std::vector<int>& off_node_column_map,
     for (int i = 0; i < off_node_num_cols; i++)
     {
         proc = off_node_col_to_proc[i];
-        local_proc = topology->get_local_proc(proc);
+        local_proc = topology->get_local_proc(proc) % topology->local_num_procs;
         proc_idx = proc_size_idx[local_proc];
         idx = local_R_recv->indptr[proc_idx] + local_proc_sizes[local_proc]++;
         local_R_recv->indices[idx] = i;
@@ -1156,3 +1157,116 @@ void TAPComm::update_recv(const std::vector<int>& on_node_to_off_proc,
 
 
 
+
+/**************************************************************
+*****   Init Shared Windows
+**************************************************************
+***** Replaces the node-local steps of vector communication
+***** (local_L, local_S and local_R) with direct reads from MPI-3
+***** shared memory windows.  Each process exposes its values
+***** (and values recvd in the inter-node step), and reads the
+***** entries that would otherwise be sent to it, leaving only
+***** global_par_comm messages.
+*****
+***** Returns false if processes of local_comm do not share
+***** memory (e.g. nodes defined by the PPN environment variable
+***** span multiple hosts), in which case messages are still used.
+**************************************************************/
+bool TAPComm::init_shared_windows()
+{
+    if (shared_x_win) return true;
+
+    RAPtor_MPI_Comm local_comm = topology->local_comm;
+    RAPtor_MPI_Comm shared_comm;
+    int local_size, shared_size;
+    RAPtor_MPI_Comm_rank(local_comm, &shared_rank);
+    RAPtor_MPI_Comm_size(local_comm, &local_size);
+    RAPtor_MPI_Comm_split_type(local_comm, RAPtor_MPI_COMM_TYPE_SHARED, 0,
+            RAPtor_MPI_INFO_NULL, &shared_comm);
+    RAPtor_MPI_Comm_size(shared_comm, &shared_size);
+    RAPtor_MPI_Comm_free(&shared_comm);
+
+    int is_shared = shared_size == local_size;
+    RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &is_shared, 1, RAPtor_MPI_INT,
+            RAPtor_MPI_MIN, local_comm);
+    if (!is_shared) return false;
+
+    // Number of values of rank read by other processes on node
+    int num_x = 0;
+    for (std::vector<int>::iterator it = local_L_par_comm->send_data->indices.begin();
+            it != local_L_par_comm->send_data->indices.end(); ++it)
+    {
+        if (*it + 1 > num_x) num_x = *it + 1;
+    }
+    if (local_S_par_comm)
+    {
+        for (std::vector<int>::iterator it = local_S_par_comm->send_data->indices.begin();
+                it != local_S_par_comm->send_data->indices.end(); ++it)
+        {
+            if (*it + 1 > num_x) num_x = *it + 1;
+        }
+    }
+
+    form_shared_indices(local_L_par_comm, shared_L_indices);
+    if (local_S_par_comm)
+    {
+        form_shared_indices(local_S_par_comm, shared_S_indices);
+    }
+    form_shared_indices(local_R_par_comm, shared_R_indices);
+
+    shared_x_win = new SharedWindow(local_comm, num_x);
+    shared_G_win = new SharedWindow(local_comm,
+            global_par_comm->recv_data->size_msgs);
+
+    return true;
+}
+
+/**************************************************************
+*****   Form Shared Indices
+**************************************************************
+***** Sends the send indices of each message of a node-local
+***** ParComm to its destination, so that each recv position
+***** holds the index of the value in the segment of the origin
+*****
+***** Parameters
+***** -------------
+***** comm : ParComm*
+*****    Node-local communication package (over local_comm)
+***** src_indices : std::vector<int>&
+*****    Returned holding origin index of each recvd value
+**************************************************************/
+void TAPComm::form_shared_indices(ParComm* comm, std::vector<int>& src_indices)
+{
+    int proc, start, end;
+    int tag = 7890;
+    NonContigData* send_data = comm->send_data;
+    CommData* recv_data = comm->recv_data;
+
+    src_indices.resize(recv_data->size_msgs);
+    std::vector<RAPtor_MPI_Request> send_requests(send_data->num_msgs);
+    std::vector<RAPtor_MPI_Request> recv_requests(recv_data->num_msgs);
+
+    for (int i = 0; i < send_data->num_msgs; i++)
+    {
+        proc = send_data->procs[i];
+        start = send_data->indptr[i];
+        end = send_data->indptr[i+1];
+        RAPtor_MPI_Isend(&(send_data->indices[start]), end - start, RAPtor_MPI_INT,
+                proc, tag, comm->mpi_comm, &(send_requests[i]));
+    }
+    for (int i = 0; i < recv_data->num_msgs; i++)
+    {
+        proc = recv_data->procs[i];
+        start = recv_data->indptr[i];
+        end = recv_data->indptr[i+1];
+        RAPtor_MPI_Irecv(&(src_indices[start]), end - start, RAPtor_MPI_INT,
+                proc, tag, comm->mpi_comm, &(recv_requests[i]));
+    }
+
+    if (send_data->num_msgs)
+        RAPtor_MPI_Waitall(send_data->num_msgs, send_requests.data(),
+                RAPtor_MPI_STATUSES_IGNORE);
+    if (recv_data->num_msgs)
+        RAPtor_MPI_Waitall(recv_data->num_msgs, recv_requests.data(),
+                RAPtor_MPI_STATUSES_IGNORE);
+}
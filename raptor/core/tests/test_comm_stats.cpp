@@ -0,0 +1,199 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+double total(const double* vals)
+{
+    return vals[IntraSocket] + vals[IntraNode] + vals[InterNode];
+}
+
+TEST(CommStatsTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Two processes per node (with no socket information)
+    setenv("PPN", "2", 1);
+
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    int grid[2] = {25, 25};
+    double* stencil = diffusion_stencil_2d(eps, theta);
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+    delete[] stencil;
+
+    A->comm = new ParComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map);
+    TAPComm* tap3 = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map, true);
+    TAPComm* tap2 = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map, false);
+
+    // ParComm statistics match the send data
+    CommStats stats = comm_stats(A->comm, 0, "A");
+    ASSERT_EQ(stats.comm_type, "ParComm");
+    long n = A->comm->send_data->num_msgs;
+    long bytes = A->comm->send_data->size_msgs * sizeof(double);
+    long sum_n, sum_bytes, max_n;
+    MPI_Allreduce(&n, &sum_n, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&n, &max_n, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(&bytes, &sum_bytes, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    ASSERT_NEAR(total(stats.avg_msgs) * num_procs, sum_n, 1e-8);
+    ASSERT_NEAR(total(stats.avg_bytes) * num_procs, sum_bytes, 1e-6);
+    ASSERT_LE(total(stats.max_msgs), 3*max_n);
+    ASSERT_EQ(stats.max_msgs[IntraSocket], 0);
+    ASSERT_LE(stats.max_neighbors, max_n);
+    if (num_procs == 1)
+    {
+        ASSERT_EQ(total(stats.max_msgs), 0);
+        ASSERT_EQ(stats.max_neighbors, 0);
+    }
+
+    // Node-aware communication sends fewer inter-node messages
+    CommStats stats3 = comm_stats(tap3, 0, "A");
+    CommStats stats2 = comm_stats(tap2, 0, "A");
+    ASSERT_EQ(stats3.comm_type, "TAPComm3");
+    ASSERT_EQ(stats2.comm_type, "TAPComm2");
+    ASSERT_LE(stats3.max_msgs[InterNode], stats.max_msgs[InterNode]);
+    ASSERT_LE(stats2.max_msgs[InterNode], stats.max_msgs[InterNode]);
+
+    // Bytes per index scale the byte counts
+    CommStats stats_int = comm_stats(A->comm, 0, "A", sizeof(int));
+    for (int i = 0; i < NUM_LOCALITIES; i++)
+    {
+        ASSERT_EQ(stats_int.max_msgs[i], stats.max_msgs[i]);
+        ASSERT_NEAR(stats_int.avg_bytes[i] * sizeof(double),
+                stats.avg_bytes[i] * sizeof(int), 1e-6);
+    }
+
+    // Socket level topology : messages to another socket of the same
+    // shared memory node are intra-node, never inter-node
+    Topology* topology = new Topology(SocketLevel);
+    Partition* part = new Partition(A->partition->global_num_rows,
+            A->partition->global_num_cols, A->partition->local_num_rows,
+            A->partition->local_num_cols, A->partition->first_local_row,
+            A->partition->first_local_col, topology);
+    ParComm* socket_comm = new ParComm(part, A->off_proc_column_map,
+            A->on_proc_column_map);
+    CommStats socket_stats = comm_stats(socket_comm, 0, "A");
+
+    // Expected localities from the lowest rank of each process's
+    // shared memory node and socket (or node, for NodeLevel)
+    MPI_Comm host_comm;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+            MPI_INFO_NULL, &host_comm);
+    int leaders[2];
+    MPI_Allreduce(&rank, &(leaders[0]), 1, MPI_INT, MPI_MIN, topology->local_comm);
+    MPI_Allreduce(&rank, &(leaders[1]), 1, MPI_INT, MPI_MIN, host_comm);
+    MPI_Comm_free(&host_comm);
+    std::vector<int> all_leaders(2*num_procs);
+    MPI_Allgather(leaders, 2, MPI_INT, all_leaders.data(), 2, MPI_INT,
+            MPI_COMM_WORLD);
+
+    long socket_n[NUM_LOCALITIES] = {0, 0, 0};
+    long max_socket_n[NUM_LOCALITIES];
+    for (int i = 0; i < socket_comm->send_data->num_msgs; i++)
+    {
+        int proc = socket_comm->send_data->procs[i];
+        if (all_leaders[2*proc+1] != leaders[1])
+        {
+            socket_n[InterNode]++;
+        }
+        else if (all_leaders[2*proc] == leaders[0] 
+                && topology->level == SocketLevel)
+        {
+            socket_n[IntraSocket]++;
+        }
+        else
+        {
+            socket_n[IntraNode]++;
+        }
+    }
+    MPI_Allreduce(socket_n, max_socket_n, NUM_LOCALITIES, MPI_LONG, MPI_MAX,
+            MPI_COMM_WORLD);
+    for (int i = 0; i < NUM_LOCALITIES; i++)
+    {
+        ASSERT_EQ(socket_stats.max_msgs[i], max_socket_n[i]);
+    }
+    if (topology->level == NodeLevel)
+    {
+        ASSERT_EQ(socket_stats.max_msgs[IntraSocket], 0);
+    }
+
+    delete socket_comm;
+    delete part;
+    delete topology;
+
+    delete tap2;
+    delete tap3;
+    delete A;
+
+    // Statistics of each level of a node-aware hierarchy
+    int grid_3d[3] = {10, 10, 10};
+    stencil = laplace_stencil_27pt();
+    A = par_stencil_grid(stencil, grid_3d, 3);
+    delete[] stencil;
+
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended, Classical, SOR);
+    ml->tap_amg = 0;
+    ml->store_restriction = true;
+    ml->setup(A);
+    std::vector<CommStats> hier_stats = ml->get_comm_stats();
+    int num_tap = 0;
+    int max_level = 0;
+    for (int i = 0; i < (int)hier_stats.size(); i++)
+    {
+        if (hier_stats[i].comm_type != "ParComm") num_tap++;
+        max_level = std::max(max_level, hier_stats[i].level);
+    }
+    ASSERT_GT(num_tap, 0);
+    ASSERT_EQ(max_level, ml->num_levels - 1);
+
+    // Exported rows
+    write_comm_stats_json(hier_stats, "comm_stats.json");
+    write_comm_stats_csv(hier_stats, "comm_stats.csv");
+    if (rank == 0)
+    {
+        char line[1024];
+        int num_lines = 0;
+        FILE* f = fopen("comm_stats.csv", "r");
+        ASSERT_TRUE(f != NULL);
+        while (fgets(line, 1024, f)) num_lines++;
+        fclose(f);
+        ASSERT_EQ(num_lines, (int)hier_stats.size() + 1);
+
+        int num_entries = 0;
+        f = fopen("comm_stats.json", "r");
+        ASSERT_TRUE(f != NULL);
+        while (fgets(line, 1024, f))
+        {
+            if (strstr(line, "\"level\"")) num_entries++;
+        }
+        fclose(f);
+        ASSERT_EQ(num_entries, (int)hier_stats.size());
+        remove("comm_stats.csv");
+        remove("comm_stats.json");
+    }
+
+    delete ml;
+    delete A;
+
+    setenv("PPN", "16", 1);
+
+} // end of TEST(CommStatsTest, TestsInCore) //
+
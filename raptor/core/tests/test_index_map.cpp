@@ -0,0 +1,124 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+#include <map>
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+TEST(IndexMapTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Sort unique, both small (std::sort) and large (radix sort)
+    srand(rank + 1);
+    int sizes[3] = {10, 1000, 100000};
+    for (int s = 0; s < 3; s++)
+    {
+        std::vector<int> v(sizes[s]);
+        for (int i = 0; i < sizes[s]; i++)
+        {
+            v[i] = (s == 2 && i % 2) ? rand() : rand() % (sizes[s] / 2);
+        }
+        std::vector<int> v_std(v);
+        std::sort(v_std.begin(), v_std.end());
+        v_std.erase(std::unique(v_std.begin(), v_std.end()), v_std.end());
+
+        sort_unique(v);
+        ASSERT_EQ(v.size(), v_std.size());
+        for (int i = 0; i < (int)v.size(); i++)
+        {
+            ASSERT_EQ(v[i], v_std[i]);
+        }
+
+        // Map sorted columns to positions, and look up against std::map
+        IndexMap idx_map(v);
+        std::map<int, int> std_map;
+        for (int i = 0; i < (int)v.size(); i++)
+        {
+            std_map[v[i]] = i;
+        }
+        ASSERT_EQ(idx_map.size(), (int)std_map.size());
+        for (int i = 0; i < 2 * sizes[s]; i++)
+        {
+            int key = (i % 2) ? rand() : i / 2;
+            std::map<int, int>::iterator it = std_map.find(key);
+            if (it == std_map.end())
+            {
+                ASSERT_EQ(idx_map.find(key), -1);
+            }
+            else
+            {
+                ASSERT_EQ(idx_map[key], it->second);
+            }
+        }
+    }
+
+    // Growing through insert, and replacing values
+    IndexMap grow_map;
+    for (int i = 0; i < 5000; i++)
+    {
+        grow_map.insert(7 * i, i);
+    }
+    for (int i = 0; i < 5000; i += 2)
+    {
+        grow_map.insert(7 * i, -i);
+    }
+    ASSERT_EQ(grow_map.size(), 5000);
+    for (int i = 0; i < 5000; i++)
+    {
+        ASSERT_EQ(grow_map[7 * i], (i % 2) ? i : -i);
+        ASSERT_EQ(grow_map.find(7 * i + 1), -1);
+    }
+    grow_map.clear();
+    ASSERT_EQ(grow_map.size(), 0);
+    ASSERT_EQ(grow_map.find(0), -1);
+
+    // Finalize condenses off_proc columns to the sorted, unique map
+    int n = 100 * num_procs;
+    ParCSRMatrix* A = new ParCSRMatrix(n, n);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        int row = A->partition->first_local_row + i;
+        for (int j = 0; j < 5; j++)
+        {
+            int col = (row + 37 * j * j + 11) % n;
+            A->add_global_value(row, col, 1.0);
+        }
+    }
+    A->finalize();
+
+    for (int i = 1; i < A->off_proc_num_cols; i++)
+    {
+        ASSERT_GT(A->off_proc_column_map[i], A->off_proc_column_map[i-1]);
+    }
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        int row = A->partition->first_local_row + i;
+        std::vector<int> cols;
+        for (int j = 0; j < 5; j++)
+        {
+            cols.emplace_back((row + 37 * j * j + 11) % n);
+        }
+        for (int j = A->off_proc->idx1[i]; j < A->off_proc->idx1[i+1]; j++)
+        {
+            int global_col = A->off_proc_column_map[A->off_proc->idx2[j]];
+            ASSERT_TRUE(std::find(cols.begin(), cols.end(), global_col) != cols.end());
+        }
+    }
+    delete A;
+
+} // end of TEST(IndexMapTest, TestsInCore) //
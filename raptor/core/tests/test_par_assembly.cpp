@@ -0,0 +1,150 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+// Compares as ParCSRMatrix (to_ParCSR returns a ParCSRMatrix itself)
+void compare(ParMatrix* A, ParMatrix* B)
+{
+    ParCSRMatrix* A_csr = A->to_ParCSR();
+    ParCSRMatrix* B_csr = B->to_ParCSR();
+    ASSERT_EQ(A_csr->local_nnz, B_csr->local_nnz);
+    ASSERT_EQ(A_csr->off_proc_num_cols, B_csr->off_proc_num_cols);
+    for (int i = 0; i < A_csr->off_proc_num_cols; i++)
+    {
+        ASSERT_EQ(A_csr->off_proc_column_map[i], B_csr->off_proc_column_map[i]);
+    }
+    CSRMatrix* mats_A[2] = {(CSRMatrix*) A_csr->on_proc, (CSRMatrix*) A_csr->off_proc};
+    CSRMatrix* mats_B[2] = {(CSRMatrix*) B_csr->on_proc, (CSRMatrix*) B_csr->off_proc};
+    for (int m = 0; m < 2; m++)
+    {
+        ASSERT_EQ(mats_A[m]->nnz, mats_B[m]->nnz);
+        for (int i = 0; i <= A_csr->local_num_rows; i++)
+        {
+            ASSERT_EQ(mats_A[m]->idx1[i], mats_B[m]->idx1[i]);
+        }
+        for (int j = 0; j < mats_A[m]->nnz; j++)
+        {
+            ASSERT_EQ(mats_A[m]->idx2[j], mats_B[m]->idx2[j]);
+            ASSERT_NEAR(mats_A[m]->vals[j], mats_B[m]->vals[j], 1e-12);
+        }
+    }
+    if (A_csr != A) delete A_csr;
+    if (B_csr != B) delete B_csr;
+}
+
+TEST(ParAssemblyTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // 1D linear finite elements, with elements split evenly over
+    // processes (so element rows are often owned by a neighbor)
+    int n = 103;
+    int n_elements = n - 1;
+    int first_elem = rank * (n_elements / num_procs);
+    int last_elem = (rank + 1) * (n_elements / num_procs);
+    if (rank == num_procs - 1) last_elem = n_elements;
+
+    std::vector<int> rows, cols;
+    std::vector<double> vals;
+    for (int e = first_elem; e < last_elem; e++)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                rows.emplace_back(e + i);
+                cols.emplace_back(e + j);
+                vals.emplace_back(i == j ? 1.0 : -1.0);
+            }
+        }
+    }
+
+    ParCSRMatrix* A = new ParCSRMatrix(n, n);
+    A->add_global_values(rows.size(), rows.data(), cols.data(), vals.data());
+    A->assemble();
+
+    // Reference, formed row by row from owned rows
+    ParCOOMatrix* A_ref = new ParCOOMatrix(n, n);
+    for (int i = 0; i < A_ref->local_num_rows; i++)
+    {
+        int row = i + A_ref->partition->first_local_row;
+        int num_elems = (row > 0) + (row < n - 1);
+        A_ref->add_value(i, row, num_elems);
+        if (row > 0) A_ref->add_value(i, row - 1, -1.0);
+        if (row < n - 1) A_ref->add_value(i, row + 1, -1.0);
+    }
+    A_ref->finalize();
+    compare(A, A_ref);
+
+    // Communication package matches the assembled columns
+    ParVector x(n, A->local_num_rows);
+    ParVector b(n, A->local_num_rows);
+    ParVector b_ref(n, A->local_num_rows);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        x[i] = i + A->partition->first_local_row;
+    }
+    A->mult(x, b);
+    A_ref->mult(x, b_ref);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        ASSERT_NEAR(b[i], b_ref[i], 1e-12);
+    }
+    delete A_ref;
+    delete A;
+
+    // Every process adds to every row, including duplicates and zeros
+    rows.clear();
+    cols.clear();
+    vals.clear();
+    for (int row = 0; row < n; row++)
+    {
+        rows.emplace_back(row);
+        cols.emplace_back((row * 7 + rank) % n);
+        vals.emplace_back(1.0);
+        rows.emplace_back(row);
+        cols.emplace_back(row);
+        vals.emplace_back(rank + 1.0);
+        rows.emplace_back(row);
+        cols.emplace_back((row + 1) % n);
+        vals.emplace_back(0.0);
+    }
+    ParCOOMatrix* B = new ParCOOMatrix(n, n);
+    B->add_global_values(rows.size() / 2, rows.data(), cols.data(), vals.data());
+    B->add_global_values(rows.size() - rows.size() / 2, rows.data() + rows.size() / 2,
+            cols.data() + rows.size() / 2, vals.data() + rows.size() / 2);
+    B->assemble();
+    ASSERT_EQ(B->stash.size(), 0);
+
+    ParCOOMatrix* B_ref = new ParCOOMatrix(n, n);
+    for (int i = 0; i < B_ref->local_num_rows; i++)
+    {
+        int row = i + B_ref->partition->first_local_row;
+        for (int p = 0; p < num_procs; p++)
+        {
+            B_ref->add_value(i, (row * 7 + p) % n, 1.0);
+            B_ref->add_value(i, row, p + 1.0);
+        }
+    }
+    B_ref->finalize();
+    compare(B, B_ref);
+
+    delete B_ref;
+    delete B;
+}
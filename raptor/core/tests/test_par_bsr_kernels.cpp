@@ -0,0 +1,123 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+double local_residual_norm(ParCSRMatrix* A, ParVector& x, ParVector& b,
+        ParVector& r)
+{
+    A->residual(x, b, r);
+    return r.norm(2);
+}
+
+TEST(ParBSRKernelsTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Fixed-size kernels (2, 3, 4, 6, 8) and runtime fallback (5)
+    int block_sizes[6] = {2, 3, 4, 5, 6, 8};
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    double* stencil = diffusion_stencil_2d(eps, theta);
+
+    for (int s = 0; s < 6; s++)
+    {
+        int block_n = block_sizes[s];
+        std::vector<int> grid(2, num_procs*block_n);
+        ParCSRMatrix* A = par_stencil_grid(stencil, grid.data(), 2);
+        ParBSRMatrix* A_bsr = A->to_ParBSR(block_n, block_n);
+        BSRMatrix* A_on = (BSRMatrix*) A_bsr->on_proc;
+        BSRMatrix* A_off = (BSRMatrix*) A_bsr->off_proc;
+        ASSERT_TRUE(A_on->is_packed());
+        ASSERT_TRUE(A_off->is_packed());
+
+        ParVector x(A->global_num_rows, A->local_num_rows);
+        ParVector b(A->global_num_rows, A->local_num_rows);
+        ParVector tmp(A->global_num_rows, A->local_num_rows);
+        for (int i = 0; i < A->local_num_rows; i++)
+            x[i] = sin(0.1 * A->local_row_map[i]) + 1.0;
+
+        // SpMV, transpose SpMV and residual
+        A->mult(x, b);
+        A_bsr->mult(x, tmp);
+        for (int i = 0; i < A->local_num_rows; i++)
+            ASSERT_NEAR(tmp[i], b[i], 1e-10);
+
+        A->mult_T(x, b);
+        A_bsr->mult_T(x, tmp);
+        for (int i = 0; i < A->local_num_rows; i++)
+            ASSERT_NEAR(tmp[i], b[i], 1e-10);
+
+        ParVector rhs(A->global_num_rows, A->local_num_rows);
+        rhs.set_const_value(1.0);
+        A->residual(x, rhs, b);
+        A_bsr->residual(x, rhs, tmp);
+        for (int i = 0; i < A->local_num_rows; i++)
+            ASSERT_NEAR(tmp[i], b[i], 1e-10);
+
+        // Sorting and copying keep blocks contiguous
+        BSRMatrix* A_on_copy = A_on->copy();
+        A_on_copy->move_diag();
+        ASSERT_TRUE(A_on_copy->is_packed());
+        ASSERT_EQ(A_on_copy->block_vals[0], A_on_copy->block_data.data());
+
+        // Sequential SpGEMM on the on_proc block : (A*A)*v == A*(A*v)
+        CSRMatrix* A_on_csr = (CSRMatrix*) A->on_proc;
+        BSRMatrix* C = A_on->spgemm(A_on_copy);
+        ASSERT_TRUE(C->is_packed());
+        int n = A_on_csr->n_rows;
+        std::vector<double> v(n), Av(n), AAv(n), Cv(n);
+        for (int i = 0; i < n; i++)
+            v[i] = cos(0.2*i);
+        A_on_csr->spmv(v.data(), Av.data());
+        A_on_csr->spmv(Av.data(), AAv.data());
+        C->spmv(v.data(), Cv.data());
+        for (int i = 0; i < n; i++)
+            ASSERT_NEAR(Cv[i], AAv[i], 1e-10);
+        delete C;
+        delete A_on_copy;
+
+        // Block relaxation reduces the residual, and inverts the
+        // diagonal blocks only once
+        relax_t relax_types[3] = {Jacobi, SOR, SSOR};
+        ASSERT_TRUE(block_relax_setup(A_bsr));
+        BSRMatrix* A_on_bsr = (BSRMatrix*) A_bsr->on_proc;
+        const double* diag_inv = A_on_bsr->diag_inv.data();
+        for (int r = 0; r < 3; r++)
+        {
+            x.set_const_value(0.0);
+            double init_norm = local_residual_norm(A_bsr, x, rhs, b);
+            if (relax_types[r] == Jacobi)
+                jacobi(A_bsr, x, rhs, tmp, 5, 0.8);
+            else if (relax_types[r] == SOR)
+                sor(A_bsr, x, rhs, tmp, 5, 1.0);
+            else
+                ssor(A_bsr, x, rhs, tmp, 5, 1.0);
+            double final_norm = local_residual_norm(A_bsr, x, rhs, b);
+            ASSERT_LT(final_norm, init_norm);
+            ASSERT_EQ(A_on_bsr->diag_inv.data(), diag_inv);
+        }
+
+        delete A_bsr;
+        delete A;
+    }
+
+    delete[] stencil;
+
+} // end of TEST(ParBSRKernelsTest, TestsInCore) //
+
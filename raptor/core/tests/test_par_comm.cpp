@@ -81,3 +81,94 @@ TEST(ParCommTest, TestsInCore)
     delete A_seq;
 
 } // end of TEST(ParCommTest, TestsInCore) //
+
+TEST(ParCommTest, ConditionalExchange)
+{
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    int grid[2] = {10, 10};
+    double* stencil = diffusion_stencil_2d(eps, theta);
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+
+    // Only even global rows and columns take part in the exchange
+    std::vector<int> states(A->local_num_rows);
+    std::vector<int> off_proc_states(A->off_proc_num_cols);
+    std::vector<int> vals(A->local_num_rows);
+    std::vector<double> vals_T(A->off_proc_num_cols);
+    std::vector<int> off_proc_vals(A->off_proc_num_cols, -1);
+    std::vector<double> result(A->local_num_rows, 0.0);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        states[i] = A->local_row_map[i] % 2;
+        vals[i] = A->local_row_map[i];
+    }
+    for (int i = 0; i < A->off_proc_num_cols; i++)
+    {
+        off_proc_states[i] = A->off_proc_column_map[i] % 2;
+        vals_T[i] = A->off_proc_column_map[i] + 1.0;
+    }
+
+    std::function<bool(int)> compare_func = [](const int a)
+    {
+        return a == 0;
+    };
+    std::function<double(double, double)> result_sum = [](double c, double d)
+    {
+        return c + d;
+    };
+    A->comm->conditional_exchange(vals, vals_T, states, off_proc_states,
+            compare_func, off_proc_vals, result, result_sum);
+
+    for (int i = 0; i < A->off_proc_num_cols; i++)
+    {
+        if (off_proc_states[i] == 0)
+        {
+            ASSERT_EQ(off_proc_vals[i], A->off_proc_column_map[i]);
+        }
+        else
+        {
+            ASSERT_EQ(off_proc_vals[i], -1);
+        }
+    }
+
+    // Each even row receives global row + 1 from each process it is
+    // sent to
+    std::vector<int> num_sends(A->local_num_rows, 0);
+    for (int i = 0; i < A->comm->send_data->size_msgs; i++)
+    {
+        num_sends[A->comm->send_data->indices[i]]++;
+    }
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (states[i] == 0)
+        {
+            ASSERT_NEAR(result[i], num_sends[i] * (A->local_row_map[i] + 1.0), 1e-10);
+        }
+        else
+        {
+            ASSERT_NEAR(result[i], 0.0, 1e-10);
+        }
+    }
+
+    // Through CommPkg, both ParComm and TAPComm match
+    TAPComm* tap_comm = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map);
+    CommPkg* comms[2] = {A->comm, tap_comm};
+    for (int c = 0; c < 2; c++)
+    {
+        std::vector<int> comm_off_proc_vals(A->off_proc_num_cols, -1);
+        std::vector<double> comm_result(A->local_num_rows, 0.0);
+        comms[c]->conditional_exchange(vals, vals_T, states, off_proc_states,
+                compare_func, comm_off_proc_vals, comm_result, result_sum);
+        ASSERT_EQ(comm_off_proc_vals, off_proc_vals);
+        for (int i = 0; i < A->local_num_rows; i++)
+        {
+            ASSERT_NEAR(comm_result[i], result[i], 1e-10);
+        }
+    }
+    delete tap_comm;
+
+    delete[] stencil;
+    delete A;
+
+} // end of TEST(ParCommTest, ConditionalExchange) //
@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+TEST(ParSELLMatrixTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    int chunk_sizes[5] = {1, 3, 4, 8, 16};
+    int sort_scopes[2] = {1, 32};
+
+    // Sequential SELL kernels vs CSR kernels (anisotropic 2D, with
+    // varying row lengths on the boundary)
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    int grid[2] = {25, 25};
+    double* stencil = diffusion_stencil_2d(eps, theta);
+    CSRMatrix* A = stencil_grid(stencil, grid, 2);
+
+    std::vector<double> x(A->n_cols);
+    std::vector<double> b(A->n_rows);
+    std::vector<double> b_csr(A->n_rows);
+    std::vector<double> b_sell(A->n_rows);
+    for (int i = 0; i < A->n_cols; i++)
+        x[i] = sin(0.1*i) + 1.0;
+    for (int i = 0; i < A->n_rows; i++)
+        b[i] = cos(0.3*i);
+
+    for (int c = 0; c < 5; c++)
+    {
+        for (int s = 0; s < 2; s++)
+        {
+            SELLMatrix* A_sell = A->to_SELL(chunk_sizes[c], sort_scopes[s]);
+            ASSERT_EQ(A_sell->format(), SELL);
+            ASSERT_EQ(A_sell->nnz, A->nnz);
+
+            A->spmv(x.data(), b_csr.data());
+            A_sell->spmv(x.data(), b_sell.data());
+            for (int i = 0; i < A->n_rows; i++)
+                ASSERT_NEAR(b_csr[i], b_sell[i], 1e-12);
+
+            A->spmv_append(x.data(), b_csr.data());
+            A_sell->spmv_append(x.data(), b_sell.data());
+            for (int i = 0; i < A->n_rows; i++)
+                ASSERT_NEAR(b_csr[i], b_sell[i], 1e-12);
+
+            A->spmv_append_neg(x.data(), b_csr.data());
+            A_sell->spmv_append_neg(x.data(), b_sell.data());
+            for (int i = 0; i < A->n_rows; i++)
+                ASSERT_NEAR(b_csr[i], b_sell[i], 1e-12);
+
+            A->spmv_residual(x.data(), b.data(), b_csr.data());
+            A_sell->spmv_residual(x.data(), b.data(), b_sell.data());
+            for (int i = 0; i < A->n_rows; i++)
+                ASSERT_NEAR(b_csr[i], b_sell[i], 1e-12);
+
+            // Copies and reordering keep the SELL arrays consistent
+            SELLMatrix* A_copy = A_sell->copy();
+            A_copy->move_diag();
+            A_copy->spmv(x.data(), b_sell.data());
+            A->spmv(x.data(), b_csr.data());
+            for (int i = 0; i < A->n_rows; i++)
+                ASSERT_NEAR(b_csr[i], b_sell[i], 1e-12);
+
+            delete A_copy;
+            delete A_sell;
+        }
+    }
+    delete A;
+    delete[] stencil;
+
+    // Parallel SpMV / residual with SELL on_proc and off_proc
+    int grid_3d[3] = {10, 10, 10};
+    stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A_par = par_stencil_grid(stencil, grid_3d, 3);
+    ParCSRMatrix* A_sell_par = A_par->copy();
+    A_sell_par->form_SELL(8, 16);
+    ASSERT_EQ(A_sell_par->on_proc->format(), SELL);
+    ASSERT_EQ(A_sell_par->off_proc->format(), SELL);
+
+    ParVector x_par(A_par->global_num_cols, A_par->on_proc_num_cols);
+    ParVector b_par(A_par->global_num_rows, A_par->local_num_rows);
+    ParVector r_csr(A_par->global_num_rows, A_par->local_num_rows);
+    ParVector r_sell(A_par->global_num_rows, A_par->local_num_rows);
+    for (int i = 0; i < A_par->local_num_rows; i++)
+    {
+        int row = A_par->local_row_map[i];
+        x_par[i] = sin(0.01*row);
+        b_par[i] = 1.0;
+    }
+
+    A_par->mult(x_par, r_csr);
+    A_sell_par->mult(x_par, r_sell);
+    for (int i = 0; i < A_par->local_num_rows; i++)
+        ASSERT_NEAR(r_csr[i], r_sell[i], 1e-12);
+
+    A_par->residual(x_par, b_par, r_csr);
+    A_sell_par->residual(x_par, b_par, r_sell);
+    for (int i = 0; i < A_par->local_num_rows; i++)
+        ASSERT_NEAR(r_csr[i], r_sell[i], 1e-12);
+
+    A_par->tap_mult(x_par, r_csr);
+    A_sell_par->tap_mult(x_par, r_sell);
+    for (int i = 0; i < A_par->local_num_rows; i++)
+        ASSERT_NEAR(r_csr[i], r_sell[i], 1e-12);
+
+    delete A_sell_par;
+    delete A_par;
+    delete[] stencil;
+
+} // end of TEST(ParSELLMatrixTest, TestsInCore) //
+
@@ -0,0 +1,126 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+TEST(TAPSharedCommTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Two processes per node, so both node-local and inter-node
+    // steps are used
+    setenv("PPN", "2", 1);
+
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    int grid[2] = {25, 25};
+    double* stencil = diffusion_stencil_2d(eps, theta);
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+
+    TAPComm* tap3 = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map, true);
+    TAPComm* tap2 = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map, false);
+    ASSERT_TRUE(tap3->init_shared_windows());
+    ASSERT_TRUE(tap2->init_shared_windows());
+    ASSERT_TRUE(tap3->init_shared_windows());
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    std::vector<int> x_int(A->local_num_rows);
+    std::vector<double> x_block(2*A->local_num_rows);
+
+    // Repeated communication reuses the windows
+    for (int iter = 0; iter < 3; iter++)
+    {
+        for (int i = 0; i < A->local_num_rows; i++)
+        {
+            x[i] = A->local_row_map[i] + 0.5*iter;
+            x_int[i] = A->local_row_map[i] * (iter + 1);
+            x_block[2*i] = x[i];
+            x_block[2*i+1] = -x[i];
+        }
+
+        std::vector<double> par_recv = A->comm->communicate(x);
+        std::vector<double> tap3_recv = tap3->communicate(x);
+        std::vector<double> tap2_recv = tap2->communicate(x);
+        ASSERT_GE((int)tap3_recv.size(), A->off_proc_num_cols);
+        ASSERT_GE((int)tap2_recv.size(), A->off_proc_num_cols);
+        for (int i = 0; i < A->off_proc_num_cols; i++)
+        {
+            ASSERT_NEAR(par_recv[i], tap3_recv[i], zero_tol);
+            ASSERT_NEAR(par_recv[i], tap2_recv[i], zero_tol);
+        }
+
+        std::vector<int> par_int = A->comm->communicate(x_int);
+        std::vector<int> tap3_int = tap3->communicate(x_int);
+        std::vector<int> tap2_int = tap2->communicate(x_int);
+        for (int i = 0; i < A->off_proc_num_cols; i++)
+        {
+            ASSERT_EQ(par_int[i], tap3_int[i]);
+            ASSERT_EQ(par_int[i], tap2_int[i]);
+        }
+
+        std::vector<double> par_block = A->comm->communicate(x_block, 2);
+        std::vector<double> tap3_block = tap3->communicate(x_block, 2);
+        for (int i = 0; i < 2*A->off_proc_num_cols; i++)
+        {
+            ASSERT_NEAR(par_block[i], tap3_block[i], zero_tol);
+        }
+    }
+
+    delete tap3;
+    delete tap2;
+    delete A;
+    delete[] stencil;
+
+    // Node-aware AMG solve with shared memory windows
+    int grid_3d[3] = {10, 10, 10};
+    stencil = laplace_stencil_27pt();
+    A = par_stencil_grid(stencil, grid_3d, 3);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    ParVector x_shared(A->global_num_rows, A->local_num_rows);
+    x.resize(A->global_num_rows, A->local_num_rows);
+    b.set_const_value(1.0);
+
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended, Classical, SOR);
+    ParMultilevel* ml_shared = new ParRugeStubenSolver(0.25, HMIS, Extended, Classical, SOR);
+    ml->tap_amg = 0;
+    ml_shared->tap_amg = 0;
+    ml_shared->tap_shared_memory = true;
+    ml->setup(A);
+    ml_shared->setup(A);
+
+    x.set_const_value(0.0);
+    x_shared.set_const_value(0.0);
+    int iter = ml->solve(x, b);
+    int iter_shared = ml_shared->solve(x_shared, b);
+    ASSERT_EQ(iter, iter_shared);
+    for (int i = 0; i < iter; i++)
+    {
+        ASSERT_NEAR(ml->residuals[i], ml_shared->residuals[i], 1e-10);
+    }
+
+    delete ml_shared;
+    delete ml;
+    delete A;
+    delete[] stencil;
+
+    setenv("PPN", "16", 1);
+
+} // end of TEST(TAPSharedCommTest, TestsInCore) //
+
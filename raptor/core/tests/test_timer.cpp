@@ -0,0 +1,148 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+TEST(TimerTest, TestsInProfiling)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Disabled timers record nothing
+    timers.reset();
+    {
+        ScopedTimer t("outer");
+    }
+    ASSERT_EQ(timers.root.children.size(), 0);
+
+    // Nested regions, keyed by name and level
+    timers.enable(true);
+    for (int i = 0; i < 3; i++)
+    {
+        ScopedTimer outer("outer");
+        for (int level = 0; level < 2; level++)
+        {
+            ScopedTimer inner("inner", level);
+            double val = rank;
+            double sum;
+            RAPtor_MPI_Allreduce(&val, &sum, 1, RAPtor_MPI_DOUBLE, RAPtor_MPI_SUM,
+                    RAPtor_MPI_COMM_WORLD);
+        }
+    }
+    timers.disable();
+    ASSERT_EQ(timers.current, &(timers.root));
+    ASSERT_FALSE(timers.active);
+
+    TimerRegion* outer = timers.find("outer");
+    ASSERT_TRUE(outer != NULL);
+    ASSERT_EQ(outer->count, 3);
+    ASSERT_EQ(outer->children.size(), 2);
+    TimerRegion* inner = timers.find("outer/inner@1");
+    ASSERT_TRUE(inner != NULL);
+    ASSERT_EQ(inner->count, 3);
+    ASSERT_EQ(inner->path(), "outer/inner@1");
+    ASSERT_TRUE(timers.find("outer/inner@2") == NULL);
+    ASSERT_TRUE(timers.find("inner@0") == NULL);
+
+    // Collective time is attributed to the inner regions and their parent
+    ASSERT_GT(inner->comm_times[CollectiveTime], 0.0);
+    ASSERT_LE(inner->comm_times[CollectiveTime], inner->time);
+    ASSERT_GE(outer->comm_times[CollectiveTime], inner->comm_times[CollectiveTime]);
+    ASSERT_GE(outer->time, inner->time);
+    ASSERT_EQ(outer->comm_times[P2PTime], 0.0);
+    ASSERT_EQ(timers.events.size(), 9);
+
+    // Trace and summary files
+    timers.write_trace("timer_test");
+    std::string trace_file = "timer_test." + std::to_string(rank) + ".json";
+    char line[1024];
+    int num_events = 0;
+    FILE* f = fopen(trace_file.c_str(), "r");
+    ASSERT_TRUE(f != NULL);
+    while (fgets(line, 1024, f))
+    {
+        if (strstr(line, "\"ph\": \"X\"")) num_events++;
+    }
+    fclose(f);
+    ASSERT_EQ(num_events, 9);
+    remove(trace_file.c_str());
+
+    timers.write_summary("timer_test_summary.json");
+    if (rank == 0)
+    {
+        int num_regions = 0;
+        f = fopen("timer_test_summary.json", "r");
+        ASSERT_TRUE(f != NULL);
+        while (fgets(line, 1024, f))
+        {
+            if (strstr(line, "\"path\"")) num_regions++;
+        }
+        fclose(f);
+        ASSERT_EQ(num_regions, 3);
+        remove("timer_test_summary.json");
+    }
+
+    // Single region profiling
+    timers.reset();
+    init_profile();
+    double val = 1.0, sum;
+    RAPtor_MPI_Allreduce(&val, &sum, 1, RAPtor_MPI_DOUBLE, RAPtor_MPI_SUM,
+            RAPtor_MPI_COMM_WORLD);
+    finalize_profile();
+    ASSERT_FALSE(timers.enabled);
+    ASSERT_EQ(profile_region()->count, 1);
+    ASSERT_GT(profile_region()->comm_times[CollectiveTime], 0.0);
+    double t = profile_region()->time;
+    average_profile(2);
+    ASSERT_NEAR(profile_region()->time, t / 2, 1e-15);
+
+    // Hierarchy setup and solve regions
+    timers.reset();
+    int grid[2] = {25, 25};
+    double* stencil = diffusion_stencil_2d(0.001, M_PI/8.0);
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+    delete[] stencil;
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    x.set_const_value(1.0);
+    A->mult(x, b);
+    x.set_const_value(0.0);
+
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended, Classical, SOR);
+    ml->track_times = true;
+    ml->setup(A);
+    int iter = ml->solve(x, b);
+    ASSERT_FALSE(timers.enabled);
+
+    TimerRegion* setup = timers.find("setup");
+    TimerRegion* solve = timers.find("solve");
+    ASSERT_TRUE(setup != NULL);
+    ASSERT_TRUE(solve != NULL);
+    ASSERT_EQ(setup->count, 1);
+    ASSERT_EQ(solve->count, 1);
+    ASSERT_TRUE(timers.find("setup/extend hierarchy@0/strength@0") != NULL);
+    ASSERT_TRUE(timers.find("setup/extend hierarchy@0/spgemm@0") != NULL);
+    ASSERT_TRUE(timers.find("solve/relax@0") != NULL);
+    ASSERT_TRUE(timers.find("solve/coarse solve@" + std::to_string(ml->num_levels - 1)) != NULL);
+    ASSERT_EQ(timers.find("solve/relax@0")->count, 2*iter);
+    ASSERT_LE(timers.find("setup/extend hierarchy@0")->time, setup->time);
+
+    delete ml;
+    delete A;
+    timers.reset();
+
+} // end of TEST(TimerTest, TestsInProfiling) //
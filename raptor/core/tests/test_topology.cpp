@@ -0,0 +1,167 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+#include "raptor/tests/compare.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+void check_maps(Topology* topology)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    int local_rank, local_size;
+    MPI_Comm_rank(topology->local_comm, &local_rank);
+    MPI_Comm_size(topology->local_comm, &local_size);
+
+    int rank_node = topology->get_node(rank);
+    ASSERT_EQ(topology->local_num_procs, local_size);
+    ASSERT_EQ(topology->get_node_size(rank_node), local_size);
+    ASSERT_EQ(topology->get_local_proc(rank), local_rank);
+    ASSERT_LE(local_size, topology->PPN);
+
+    // Every process is on exactly one node, and maps are inverses
+    int total = 0;
+    for (int node = 0; node < topology->num_nodes; node++)
+    {
+        int size = topology->get_node_size(node);
+        total += size;
+        for (int i = 0; i < size; i++)
+        {
+            int proc = topology->get_global_proc(node, i);
+            ASSERT_EQ(topology->get_node(proc), node);
+            ASSERT_EQ(topology->get_local_proc(proc), i);
+        }
+        ASSERT_GE(topology->node_to_host[node], 0);
+    }
+    ASSERT_EQ(total, num_procs);
+
+    // Nodes agree with local_comm
+    std::vector<int> local_procs(local_size);
+    MPI_Allgather(&rank, 1, MPI_INT, local_procs.data(), 1, MPI_INT,
+            topology->local_comm);
+    for (int i = 0; i < local_size; i++)
+    {
+        ASSERT_EQ(topology->get_node(local_procs[i]), rank_node);
+    }
+}
+
+void compare_tap(ParCSRMatrix* A, Topology* topology)
+{
+    Partition* part = new Partition(A->partition->global_num_rows,
+            A->partition->global_num_cols, A->partition->local_num_rows,
+            A->partition->local_num_cols, A->partition->first_local_row,
+            A->partition->first_local_col, topology);
+    TAPComm* tap3 = new TAPComm(part, A->off_proc_column_map,
+            A->on_proc_column_map, true);
+    TAPComm* tap2 = new TAPComm(part, A->off_proc_column_map,
+            A->on_proc_column_map, false);
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        x[i] = A->local_row_map[i] + 0.25;
+    }
+    std::vector<double> par_recv = A->comm->communicate(x);
+    std::vector<double> tap3_recv = tap3->communicate(x);
+    std::vector<double> tap2_recv = tap2->communicate(x);
+    ASSERT_EQ(tap3_recv.size(), par_recv.size());
+    ASSERT_EQ(tap2_recv.size(), par_recv.size());
+    for (int i = 0; i < (int)par_recv.size(); i++)
+    {
+        ASSERT_NEAR(par_recv[i], tap3_recv[i], zero_tol);
+        ASSERT_NEAR(par_recv[i], tap2_recv[i], zero_tol);
+    }
+
+    CSRMatrix* recv_mat = A->comm->communicate(A);
+    CSRMatrix* tap_recv_mat = tap3->communicate(A);
+    compare(recv_mat, tap_recv_mat);
+    delete tap_recv_mat;
+    delete recv_mat;
+
+    delete tap2;
+    delete tap3;
+    delete part;
+}
+
+TEST(TopologyTest, TestsInCore)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    double eps = 0.001;
+    double theta = M_PI / 8.0;
+    int grid[2] = {25, 25};
+    double* stencil = diffusion_stencil_2d(eps, theta);
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+
+    // Shared memory nodes (PPN must not be set)
+    unsetenv("PPN");
+    Topology* topology = new Topology();
+    ASSERT_EQ(topology->rank_ordering, -1);
+    ASSERT_EQ(topology->level, NodeLevel);
+    check_maps(topology);
+    compare_tap(A, topology);
+    int num_hosts = topology->num_nodes;
+    delete topology;
+
+    // Sockets within each node
+    topology = new Topology(SocketLevel);
+    check_maps(topology);
+    ASSERT_GE(topology->num_nodes, num_hosts);
+    compare_tap(A, topology);
+    delete topology;
+
+    // Uneven nodes with contiguous ranks
+    std::vector<int> node_map(num_procs);
+    for (int i = 0; i < num_procs; i++)
+    {
+        node_map[i] = (4*i) / (3*num_procs);
+    }
+    topology = new Topology(node_map);
+    check_maps(topology);
+    compare_tap(A, topology);
+    delete topology;
+
+    // Uneven nodes with interleaved ranks
+    for (int i = 0; i < num_procs; i++)
+    {
+        node_map[i] = 10 - (i % 3);
+    }
+    topology = new Topology(node_map);
+    check_maps(topology);
+    ASSERT_EQ(topology->get_node(0), 0);
+    ASSERT_EQ(topology->num_nodes, std::min(num_procs, 3));
+    compare_tap(A, topology);
+    delete topology;
+
+    // PPN environment variable is still an override
+    setenv("PPN", "2", 1);
+    topology = new Topology();
+    ASSERT_EQ(topology->PPN, 2);
+    ASSERT_EQ(topology->rank_ordering, 1);
+    ASSERT_EQ(topology->get_node(rank), rank / 2);
+    compare_tap(A, topology);
+    delete topology;
+
+    delete A;
+    delete[] stencil;
+
+    setenv("PPN", "16", 1);
+
+} // end of TEST(TopologyTest, TestsInCore) //
+
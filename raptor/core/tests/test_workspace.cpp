@@ -0,0 +1,114 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+
+} // end of main() //
+
+void compare(CSRMatrix* A, CSRMatrix* B)
+{
+    ASSERT_EQ(A->n_rows, B->n_rows);
+    ASSERT_EQ(A->nnz, B->nnz);
+    for (int i = 0; i <= A->n_rows; i++)
+    {
+        ASSERT_EQ(A->idx1[i], B->idx1[i]);
+    }
+    for (int j = 0; j < A->nnz; j++)
+    {
+        ASSERT_EQ(A->idx2[j], B->idx2[j]);
+        ASSERT_DOUBLE_EQ(A->vals[j], B->vals[j]);
+    }
+}
+
+TEST(WorkspaceTest, TestsInCore)
+{
+    // Disabled workspace : WorkVectors are ordinary vectors
+    {
+        WorkVector<int> v(10, -1);
+        ASSERT_EQ(v.size(), 10);
+        ASSERT_EQ(v[9], -1);
+    }
+    ASSERT_EQ(workspace.pooled_bytes(), 0);
+
+    // Enabled workspace : buffers are returned and reused
+    workspace.enable();
+    int* first_data;
+    {
+        WorkVector<int> v(1000, 0);
+        first_data = v.data();
+    }
+    ASSERT_GE(workspace.pooled_bytes(), 1000 * (long)sizeof(int));
+    long reused = workspace.num_reused;
+    {
+        WorkVector<int> v(500, 3);
+        ASSERT_EQ(v.data(), first_data);
+        ASSERT_EQ(v.size(), 500);
+        ASSERT_EQ(v[499], 3);
+
+        // A second buffer is in use at the same time
+        WorkVector<int> w(10, 1);
+        ASSERT_NE(w.data(), v.data());
+    }
+    ASSERT_EQ(workspace.num_reused, reused + 1);
+
+    // Nested scopes keep the pool until the outermost ends
+    {
+        ScopedWorkspace inner;
+    }
+    ASSERT_GT(workspace.pooled_bytes(), 0);
+    workspace.disable();
+    ASSERT_FALSE(workspace.enabled());
+    ASSERT_EQ(workspace.pooled_bytes(), 0);
+}
+
+TEST(WorkspaceParTest, TestsInCore)
+{
+    int grid[3] = {8, 8, 8};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    // Products formed from pooled buffers match, and are sized exactly
+    ParCSRMatrix* C = A->mult(A);
+    CSRMatrix* C_serial = A->on_proc->mult((CSRMatrix*) A->on_proc);
+    ParCSRMatrix* C_pool;
+    CSRMatrix* C_serial_pool;
+    {
+        ScopedWorkspace ws;
+        C_pool = A->mult(A);
+        C_serial_pool = A->on_proc->mult((CSRMatrix*) A->on_proc);
+        ASSERT_GT(workspace.pooled_bytes(), 0);
+    }
+    ASSERT_EQ(workspace.pooled_bytes(), 0);
+
+    compare((CSRMatrix*) C->on_proc, (CSRMatrix*) C_pool->on_proc);
+    compare((CSRMatrix*) C->off_proc, (CSRMatrix*) C_pool->off_proc);
+    compare(C_serial, C_serial_pool);
+    ASSERT_EQ(C_serial_pool->idx2.capacity(), C_serial_pool->nnz);
+    ASSERT_EQ(C_serial_pool->vals.capacity(), C_serial_pool->nnz);
+
+    // Setup pools its temporaries, and frees them before returning
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended);
+    ml->setup(A);
+    ASSERT_FALSE(workspace.enabled());
+    ASSERT_EQ(workspace.pooled_bytes(), 0);
+    ASSERT_GT(workspace.num_reused, 0);
+
+    delete ml;
+    delete C_serial_pool;
+    delete C_serial;
+    delete C_pool;
+    delete C;
+    delete A;
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#ifndef RAPTOR_CORE_THREADS_HPP
+#define RAPTOR_CORE_THREADS_HPP
+
+#include <vector>
+#include <algorithm>
+
+#ifdef USING_OPENMP
+#include <omp.h>
+#define RAPTOR_OMP(directive) _Pragma(#directive)
+#else
+#define RAPTOR_OMP(directive)
+#endif
+
+/**************************************************************
+ *****   Threads
+ **************************************************************
+ ***** Helpers for threading local (per process) kernels with
+ ***** OpenMP, when built WITH_OPENMP.  Otherwise every kernel
+ ***** runs on a single thread, and RAPTOR_OMP directives are
+ ***** removed.
+ *****
+ ***** Threaded kernels split their rows into contiguous ranges
+ ***** of roughly equal work, so each thread forms a contiguous
+ ***** block of the result and results match the serial kernels
+ ***** exactly.
+ *****
+ ***** Methods
+ ***** -------
+ ***** work_threads(work)
+ *****    Returns the number of threads to use for a kernel with
+ *****    work nonzeros : 1 below thread_min_work, and otherwise
+ *****    the OpenMP maximum
+ ***** thread_id(), team_size()
+ *****    Returns the id of the calling thread, and the number of
+ *****    threads in its parallel region
+ ***** thread_range(ptr, n, tid, n_threads, start, end)
+ *****    Sets [start, end) to the rows of thread tid, splitting
+ *****    rows 0 to n so that each range holds about the same
+ *****    number of entries of the row pointer ptr
+ **************************************************************/
+namespace raptor
+{
+    const int thread_min_work = 8192;
+
+    inline int work_threads(long work)
+    {
+#ifdef USING_OPENMP
+        if (work >= thread_min_work) return omp_get_max_threads();
+#endif
+        return 1;
+    }
+
+    inline int thread_id()
+    {
+#ifdef USING_OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    inline int team_size()
+    {
+#ifdef USING_OPENMP
+        return omp_get_num_threads();
+#else
+        return 1;
+#endif
+    }
+
+    inline void thread_range(const std::vector<int>& ptr, int n, int tid,
+            int n_threads, int& start, int& end)
+    {
+        long work = ptr[n] - ptr[0];
+        long first = ptr[0] + (work * tid) / n_threads;
+        long last = ptr[0] + (work * (tid + 1)) / n_threads;
+        start = std::lower_bound(ptr.begin(), ptr.begin() + n, first) - ptr.begin();
+        end = std::lower_bound(ptr.begin(), ptr.begin() + n, last) - ptr.begin();
+        if (tid == n_threads - 1) end = n;
+    }
+}
+
+#endif
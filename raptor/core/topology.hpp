@@ -6,6 +6,7 @@
 #include <mpi.h>
 #include <math.h>
 #include <set>
+#include <vector>
 
 #include "types.hpp"
 
@@ -15,25 +16,66 @@
  ***** This class holds information about the topology of
  ***** the parallel computer on which Raptor is being run
  *****
+ ***** By default, processes are grouped into nodes with
+ ***** MPI_Comm_split_type(MPI_COMM_TYPE_SHARED), and the rank to
+ ***** node maps are stored explicitly, so nodes may hold any number
+ ***** of processes in any rank ordering.  Setting the PPN
+ ***** environment variable (or passing _PPN > 0) instead uses
+ ***** PPN processes per node, with the rank ordering given by
+ ***** RAPtor_MPICH_RANK_REORDER_METHOD.  A Topology can also be
+ ***** formed at the socket level (TAPComm then aggregates messages
+ ***** per socket), or from a user-defined rank to node map.
+ *****
  ***** Attributes
  ***** -------------
- ***** global_num_indices : index_t
- *****    Number of rows to be partitioned
- ***** first_local_idx : index_t
- *****    First global index of a row in partition local to rank
- ***** local_num_indices : index_t
- *****    Number of rows local to rank's partition
+ ***** PPN : int
+ *****    Maximum number of processes per node
+ ***** rank_ordering : int
+ *****    Rank ordering of PPN topologies (-1 if maps are stored)
+ ***** num_nodes : int
+ *****    Number of nodes (or sockets for SocketLevel)
+ ***** local_num_procs : int
+ *****    Number of processes on rank's node
+ ***** level : topology_level_t
+ *****    Hardware level grouped into each node
+ ***** rank_to_node : std::vector<int>
+ *****    Node of each process (empty for PPN topologies)
+ ***** rank_to_local : std::vector<int>
+ *****    Rank of each process in its node's local_comm
+ ***** node_ptr, node_procs : std::vector<int>
+ *****    Processes of node i are node_procs[node_ptr[i]:node_ptr[i+1]]
+ ***** node_to_host : std::vector<int>
+ *****    Shared memory node containing each node (each socket for
+ *****    SocketLevel, identity otherwise)
+ ***** local_comm : RAPtor_MPI_Comm
+ *****    Communicator of all processes on rank's node
  *****
  ***** Methods
  ***** ---------
+ ***** get_node(proc)
+ *****    Returns the node of process proc
+ ***** get_local_proc(proc)
+ *****    Returns the rank of proc in the local_comm of its node
+ ***** get_global_proc(node, local_proc)
+ *****    Returns the global rank of local_proc on node (wrapped by
+ *****    the number of processes on node)
+ ***** get_node_size(node)
+ *****    Returns the number of processes on node
  **************************************************************/
 namespace raptor
 {
   class Topology
   {
   public:
-    Topology(int _PPN = 16, int _standard_rank_ordering = 1)
+    Topology(int _PPN = 0, int _standard_rank_ordering = 1)
     {     
+        char* PPN_c = getenv("PPN");
+        if (PPN_c == NULL && _PPN <= 0)
+        {
+            detect_topology(NodeLevel);
+            return;
+        }
+
         int rank, num_procs;
         RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
         RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
@@ -41,7 +83,6 @@ namespace raptor
         int rank_node;
 
         char* proc_layout_c = getenv("RAPtor_MPICH_RANK_REORDER_METHOD");
-        char* PPN_c = getenv("PPN");
         if (PPN_c) 
         {
             PPN = atoi(PPN_c);
@@ -60,15 +101,33 @@ namespace raptor
             rank_ordering = _standard_rank_ordering;
         }
 
+        level = NodeLevel;
         num_nodes = num_procs / PPN;
         if (num_procs % PPN) num_nodes++;
         rank_node = get_node(rank);
 
         // Create intra-node communicator
         RAPtor_MPI_Comm_split(RAPtor_MPI_COMM_WORLD, rank_node, rank, &local_comm);
+        RAPtor_MPI_Comm_size(local_comm, &local_num_procs);
         num_shared = 0;
     }
 
+    Topology(topology_level_t _level)
+    {
+        detect_topology(_level);
+    }
+
+    // All processes pass the same map of ranks to nodes (nodes are
+    // renumbered in order of their lowest rank)
+    Topology(const std::vector<int>& node_map)
+    {
+        int rank;
+        RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+        RAPtor_MPI_Comm_split(RAPtor_MPI_COMM_WORLD, node_map[rank], rank, &local_comm);
+        level = NodeLevel;
+        form_maps(-1);
+    }
+
     ~Topology()
     {
         RAPtor_MPI_Comm_free(&local_comm);
@@ -76,7 +135,11 @@ namespace raptor
 
     int get_node(int proc)
     {
-        if (rank_ordering == 0)
+        if (rank_to_node.size())
+        {
+            return rank_to_node[proc];
+        }
+        else if (rank_ordering == 0)
         {
             return proc % num_nodes;
         }
@@ -109,7 +172,11 @@ namespace raptor
 
     int get_local_proc(int proc)
     {
-        if (rank_ordering == 0 || rank_ordering == 2)
+        if (rank_to_local.size())
+        {
+            return rank_to_local[proc];
+        }
+        else if (rank_ordering == 0 || rank_ordering == 2)
         {
             return proc / num_nodes;
         }
@@ -131,7 +198,12 @@ namespace raptor
 
     int get_global_proc(int node, int local_proc)
     {
-        if (rank_ordering == 0)
+        if (node_ptr.size())
+        {
+            int start = node_ptr[node];
+            return node_procs[start + (local_proc % (node_ptr[node+1] - start))];
+        }
+        else if (rank_ordering == 0)
         {
             return local_proc * num_nodes + node;
         }
@@ -162,12 +234,144 @@ namespace raptor
         }
     }
 
+    int get_node_size(int node)
+    {
+        if (node_ptr.size())
+        {
+            return node_ptr[node+1] - node_ptr[node];
+        }
+        return PPN;
+    }
+
     int PPN;
     int rank_ordering;
     int num_shared;
     int num_nodes;
+    int local_num_procs;
+    topology_level_t level;
+
+    std::vector<int> rank_to_node;
+    std::vector<int> rank_to_local;
+    std::vector<int> node_ptr;
+    std::vector<int> node_procs;
+    std::vector<int> node_to_host;
 
     RAPtor_MPI_Comm local_comm;
+
+  private:
+    /**************************************************************
+     *****   Detect Topology
+     **************************************************************
+     ***** Splits RAPtor_MPI_COMM_WORLD into shared memory nodes, and
+     ***** each node into sockets for SocketLevel (if the MPI
+     ***** implementation exposes sockets, otherwise nodes are used)
+     **************************************************************/
+    void detect_topology(topology_level_t _level)
+    {
+        int rank;
+        RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+        RAPtor_MPI_Comm host_comm;
+        RAPtor_MPI_Comm_split_type(RAPtor_MPI_COMM_WORLD, RAPtor_MPI_COMM_TYPE_SHARED,
+                rank, RAPtor_MPI_INFO_NULL, &host_comm);
+
+        level = NodeLevel;
+        if (_level == SocketLevel)
+        {
+#ifdef RAPtor_MPI_COMM_TYPE_SOCKET
+            RAPtor_MPI_Comm_split_type(host_comm, RAPtor_MPI_COMM_TYPE_SOCKET,
+                    rank, RAPtor_MPI_INFO_NULL, &local_comm);
+            level = SocketLevel;
+#endif
+        }
+        if (level == NodeLevel)
+        {
+            RAPtor_MPI_Comm_split(host_comm, 0, rank, &local_comm);
+        }
+
+        int host_leader;
+        RAPtor_MPI_Allreduce(&rank, &host_leader, 1, RAPtor_MPI_INT,
+                RAPtor_MPI_MIN, host_comm);
+        RAPtor_MPI_Comm_free(&host_comm);
+
+        form_maps(host_leader);
+    }
+
+    /**************************************************************
+     *****   Form Maps
+     **************************************************************
+     ***** Forms rank to node maps from local_comm (with processes
+     ***** ordered by global rank).  Each node is identified by its
+     ***** lowest rank, and nodes are numbered in order of these.
+     *****
+     ***** Parameters
+     ***** -------------
+     ***** host_leader : int
+     *****    Lowest rank on rank's shared memory node (-1 if nodes
+     *****    are not subsets of shared memory nodes)
+     **************************************************************/
+    void form_maps(int host_leader)
+    {
+        int rank, num_procs;
+        RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+        RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+        RAPtor_MPI_Comm_size(local_comm, &local_num_procs);
+
+        int leaders[2];
+        RAPtor_MPI_Allreduce(&rank, &(leaders[0]), 1, RAPtor_MPI_INT,
+                RAPtor_MPI_MIN, local_comm);
+        leaders[1] = host_leader;
+        std::vector<int> all_leaders(2*num_procs);
+        RAPtor_MPI_Allgather(leaders, 2, RAPtor_MPI_INT, all_leaders.data(), 2,
+                RAPtor_MPI_INT, RAPtor_MPI_COMM_WORLD);
+
+        // Node of proc is the number of node leaders below its leader
+        std::vector<int> leader_to_node(num_procs, -1);
+        std::vector<int> leader_to_host(num_procs, -1);
+        num_nodes = 0;
+        int num_hosts = 0;
+        for (int proc = 0; proc < num_procs; proc++)
+        {
+            if (all_leaders[2*proc] == proc)
+            {
+                leader_to_node[proc] = num_nodes++;
+            }
+            if (all_leaders[2*proc+1] == proc)
+            {
+                leader_to_host[proc] = num_hosts++;
+            }
+        }
+
+        rank_to_node.resize(num_procs);
+        rank_to_local.resize(num_procs);
+        node_ptr.resize(num_nodes + 1, 0);
+        node_to_host.resize(num_nodes);
+        for (int proc = 0; proc < num_procs; proc++)
+        {
+            int leader = all_leaders[2*proc];
+            int node = leader_to_node[leader];
+            rank_to_node[proc] = node;
+            rank_to_local[proc] = node_ptr[node+1]++;
+            int host = all_leaders[2*proc+1];
+            node_to_host[node] = host >= 0 ? leader_to_host[host] : node;
+        }
+
+        PPN = 0;
+        for (int i = 0; i < num_nodes; i++)
+        {
+            if (node_ptr[i+1] > PPN) PPN = node_ptr[i+1];
+            node_ptr[i+1] += node_ptr[i];
+        }
+        node_procs.resize(num_procs);
+        for (int proc = 0; proc < num_procs; proc++)
+        {
+            int node = rank_to_node[proc];
+            node_procs[node_ptr[node] + rank_to_local[proc]] = proc;
+        }
+
+        rank_ordering = -1;
+        num_shared = 0;
+    }
   };
 }
 
@@ -47,12 +47,16 @@ namespace raptor
     using data_t = double;
     using index_t = int;
     enum strength_t {Classical, Symmetric};
-    enum format_t {COO, CSR, CSC, BCOO, BSR, BSC};
+    enum format_t {COO, CSR, CSC, BCOO, BSR, BSC, SELL};
     enum coarsen_t {RS, CLJP, Falgout, PMIS, HMIS};
     enum interp_t {Direct, ModClassical, Extended};
-    enum agg_t {MIS};
+    enum agg_interp_t {Multipass, TwoStageExtended};
+    enum agg_t {MIS, GhostMIS};
     enum prolong_t {JacobiProlongation};
     enum relax_t {Jacobi, SOR, SSOR};
+    enum coarse_solve_t {DenseLU, SparseCG, SparseBiCGStab};
+    enum topology_level_t {NodeLevel, SocketLevel};
+    enum comm_select_t {ThresholdComm, ModelComm, TimedComm};
 
     template<typename T, typename U>
     U sum_func(const U& a, const T&b)
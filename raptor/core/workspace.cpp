@@ -0,0 +1,8 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "workspace.hpp"
+
+namespace raptor
+{
+    Workspace workspace;
+}
@@ -0,0 +1,227 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#ifndef RAPTOR_CORE_WORKSPACE_HPP
+#define RAPTOR_CORE_WORKSPACE_HPP
+
+#include <vector>
+#include <utility>
+
+/**************************************************************
+ *****   Workspace Class
+ **************************************************************
+ ***** Pool of std::vector<int> and std::vector<double> buffers
+ ***** for short-lived temporaries of the AMG setup (row sums,
+ ***** linked lists, rows of products before they are copied into
+ ***** exactly sized matrices).  Buffers are returned to the pool
+ ***** with their capacity, so a setup allocates each temporary
+ ***** roughly once, instead of once per level and kernel.
+ *****
+ ***** The pool is only used while enabled (see ScopedWorkspace),
+ ***** and is freed when disabled, so no memory from the setup
+ ***** persists into the solve.  Buffers are borrowed through
+ ***** WorkVector.
+ *****
+ ***** Methods
+ ***** -------
+ ***** enable()
+ *****    Starts pooling buffers (nested calls are counted)
+ ***** disable()
+ *****    Ends a call to enable(), freeing the pool after the last
+ ***** release()
+ *****    Frees all pooled buffers
+ ***** pooled_bytes()
+ *****    Returns the capacity held by the pool, in bytes
+ **************************************************************/
+namespace raptor
+{
+    class Workspace
+    {
+      public:
+        Workspace()
+        {
+            depth = 0;
+            num_acquired = 0;
+            num_reused = 0;
+        }
+
+        void enable()
+        {
+            depth++;
+        }
+
+        void disable()
+        {
+            if (depth > 0) depth--;
+            if (depth == 0) release();
+        }
+
+        bool enabled() const
+        {
+            return depth > 0;
+        }
+
+        void release()
+        {
+            std::vector<std::vector<int> >().swap(int_pool);
+            std::vector<std::vector<double> >().swap(double_pool);
+        }
+
+        long pooled_bytes() const
+        {
+            long bytes = 0;
+            for (int i = 0; i < (int)int_pool.size(); i++)
+                bytes += int_pool[i].capacity() * sizeof(int);
+            for (int i = 0; i < (int)double_pool.size(); i++)
+                bytes += double_pool[i].capacity() * sizeof(double);
+            return bytes;
+        }
+
+        // Moves an empty buffer into v, reusing the pooled buffer with
+        // the largest capacity (if any)
+        template <typename T>
+        void acquire(std::vector<T>& v)
+        {
+            std::vector<std::vector<T> >& p = pool(v);
+            num_acquired++;
+            if (p.empty()) return;
+
+            int max_idx = 0;
+            for (int i = 1; i < (int)p.size(); i++)
+            {
+                if (p[i].capacity() > p[max_idx].capacity())
+                    max_idx = i;
+            }
+            v = std::move(p[max_idx]);
+            p[max_idx] = std::move(p.back());
+            p.pop_back();
+            v.clear();
+            num_reused++;
+        }
+
+        // Returns the buffer of v to the pool, leaving v empty
+        template <typename T>
+        void restore(std::vector<T>& v)
+        {
+            if (v.capacity() == 0) return;
+            std::vector<std::vector<T> >& p = pool(v);
+            p.emplace_back(std::move(v));
+            v = std::vector<T>();
+        }
+
+        int depth;
+        long num_acquired;
+        long num_reused;
+
+      private:
+        std::vector<std::vector<int> >& pool(std::vector<int>&)
+        {
+            return int_pool;
+        }
+        std::vector<std::vector<double> >& pool(std::vector<double>&)
+        {
+            return double_pool;
+        }
+
+        std::vector<std::vector<int> > int_pool;
+        std::vector<std::vector<double> > double_pool;
+    };
+
+    extern Workspace workspace;
+
+    // Enables the workspace pool for the enclosing scope
+    class ScopedWorkspace
+    {
+      public:
+        ScopedWorkspace()
+        {
+            workspace.enable();
+        }
+        ~ScopedWorkspace()
+        {
+            workspace.disable();
+        }
+    };
+
+    // Pooled buffers exist for int and double only
+    template <typename T> struct is_pooled
+    {
+        static const bool value = false;
+    };
+    template <> struct is_pooled<int>
+    {
+        static const bool value = true;
+    };
+    template <> struct is_pooled<double>
+    {
+        static const bool value = true;
+    };
+
+    /**************************************************************
+    *****   WorkVector Class
+    **************************************************************
+    ***** Temporary std::vector of size n (initialized to val),
+    ***** borrowed from the workspace pool while it is enabled and
+    ***** returned to it on destruction.  Otherwise (or for types
+    ***** other than int and double), an ordinary vector.
+    **************************************************************/
+    template <typename T>
+    class WorkVector
+    {
+      public:
+        WorkVector(int n = 0, T val = T())
+        {
+            pooled = is_pooled<T>::value && workspace.enabled();
+            if (pooled) acquire_pooled(v);
+            if (n) v.resize(n, val);
+        }
+
+        ~WorkVector()
+        {
+            if (pooled && workspace.enabled()) restore_pooled(v);
+        }
+
+        std::vector<T>& vec()
+        {
+            return v;
+        }
+        T* data()
+        {
+            return v.data();
+        }
+        int size() const
+        {
+            return v.size();
+        }
+        T& operator[](int i)
+        {
+            return v[i];
+        }
+        const T& operator[](int i) const
+        {
+            return v[i];
+        }
+
+      private:
+        template <typename U>
+        void acquire_pooled(std::vector<U>& u)
+        {
+            workspace.acquire(u);
+        }
+        void acquire_pooled(std::vector<double*>& u) {}
+
+        template <typename U>
+        void restore_pooled(std::vector<U>& u)
+        {
+            workspace.restore(u);
+        }
+        void restore_pooled(std::vector<double*>& u) {}
+
+        WorkVector(const WorkVector&);
+        WorkVector& operator=(const WorkVector&);
+
+        std::vector<T> v;
+        bool pooled;
+    };
+}
+
+#endif
@@ -4,6 +4,20 @@
 
 namespace raptor {
 ParCSRMatrix* par_stencil_grid(data_t* stencil, int* grid, int dim)
+{
+    int N_v = 1;
+    for (index_t i = 0; i < dim; i++)
+    {
+       N_v *= grid[i];
+    }
+
+    ParCSRMatrix* A = new ParCSRMatrix(N_v, N_v);
+    par_stencil_fill(A, stencil, grid, dim);
+
+    return A;
+}
+
+void par_stencil_fill(ParCSRMatrix* A, data_t* stencil, int* grid, int dim)
 {
     // Get MPI Information
     int rank, num_procs;
@@ -46,8 +60,6 @@ ParCSRMatrix* par_stencil_grid(data_t* stencil, int* grid, int dim)
         }
     }
 
-    ParCSRMatrix* A = new ParCSRMatrix(N_v, N_v);
-
     n_v = A->partition->local_num_rows;
     int first_local_row = A->partition->first_local_row;
     int last_local_row = first_local_row + n_v - 1;
@@ -221,8 +233,6 @@ ParCSRMatrix* par_stencil_grid(data_t* stencil, int* grid, int dim)
     A->off_proc->nnz = A->off_proc->idx2.size();
 
     A->finalize();
-
-    return A;
 }
 
 }
@@ -15,5 +15,9 @@ namespace raptor {
 
 ParCSRMatrix* par_stencil_grid(data_t* stencil, int* grid, int dim);
 
+// Adds the stencil entries of all local rows to A (formed with 
+// N_v global rows and columns) and finalizes A
+void par_stencil_fill(ParCSRMatrix* A, data_t* stencil, int* grid, int dim);
+
 }
 #endif
@@ -0,0 +1,421 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "par_stencil_matrix.hpp"
+
+namespace raptor {
+
+static int stencil_grid_size(int* grid, int dim)
+{
+    int N_v = 1;
+    for (int i = 0; i < dim; i++)
+    {
+        N_v *= grid[i];
+    }
+    return N_v;
+}
+
+ParStencilMatrix::ParStencilMatrix(data_t* stencil, int* _grid, int _dim,
+        bool form_explicit) : ParCSRMatrix(stencil_grid_size(_grid, _dim),
+            stencil_grid_size(_grid, _dim))
+{
+    if (_dim > max_dim)
+    {
+        printf("Error.  ParStencilMatrix supports at most %d dimensions.\n",
+                max_dim);
+        exit(-1);
+    }
+
+    dim = _dim;
+    grid.assign(_grid, _grid + dim);
+    init_stencil(stencil);
+
+    if (form_explicit)
+    {
+        par_stencil_fill(this, stencil, _grid, dim);
+    }
+    else
+    {
+        form_halo_map();
+    }
+
+    x_ext.resize(local_num_rows + 2*halo, 0.0);
+}
+
+/**************************************************************
+ *****   ParStencilMatrix Init Stencil
+ **************************************************************
+ ***** Stores the nonzero stencil entries in the same order as
+ ***** par_stencil_grid : entry d couples each row to column
+ ***** row + stencil_diags[d] with value stencil_vals[d]
+ **************************************************************/
+void ParStencilMatrix::init_stencil(data_t* stencil)
+{
+    int stencil_len = (int)pow(3, dim);
+
+    // Strides of each dimension (last dimension is contiguous)
+    grid_strides.resize(dim);
+    grid_strides[dim-1] = 1;
+    for (int j = dim - 2; j >= 0; j--)
+    {
+        grid_strides[j] = grid_strides[j+1] * grid[j+1];
+    }
+
+    std::vector<int> nonzero_offsets;
+    std::vector<double> nonzero_stencil;
+    for (int i = 0; i < stencil_len; i++)
+    {
+        if (fabs(stencil[i]) > zero_tol)
+        {
+            int pos = nonzero_offsets.size();
+            nonzero_offsets.resize(pos + dim);
+            for (int j = 0; j < dim; j++)
+            {
+                int idiv = i / pow(3, j);
+                nonzero_offsets[pos + dim - j - 1] = (idiv % 3) - 1;
+            }
+            nonzero_stencil.push_back(stencil[i]);
+        }
+    }
+    int N_s = nonzero_stencil.size();
+
+    stencil_offsets.resize(N_s * dim);
+    stencil_diags.resize(N_s);
+    stencil_vals.resize(N_s);
+    center = -1;
+    halo = 0;
+    for (int d = 0; d < N_s; d++)
+    {
+        int diag = 0;
+        for (int j = 0; j < dim; j++)
+        {
+            stencil_offsets[d*dim + j] = nonzero_offsets[d*dim + j];
+            diag += nonzero_offsets[d*dim + j] * grid_strides[j];
+        }
+        stencil_diags[d] = diag;
+        stencil_vals[d] = nonzero_stencil[N_s - d - 1];
+
+        if (diag == 0) center = d;
+        if (abs(diag) > halo) halo = abs(diag);
+    }
+}
+
+/**************************************************************
+ *****   ParStencilMatrix Form Halo Map
+ **************************************************************
+ ***** Forms the row and column maps (and an empty explicit
+ ***** matrix) when on_proc / off_proc are not assembled.  The
+ ***** off_proc columns are the sorted global indices of all
+ ***** neighbors of local rows that are stored on other processes
+ **************************************************************/
+void ParStencilMatrix::form_halo_map()
+{
+    int first_local_row = partition->first_local_row;
+    int last_local_row = first_local_row + local_num_rows - 1;
+    int N_s = stencil_diags.size();
+    std::vector<int> coords(dim);
+
+    local_row_map.resize(local_num_rows);
+    on_proc_column_map.resize(on_proc_num_cols);
+    for (int i = 0; i < local_num_rows; i++)
+    {
+        local_row_map[i] = first_local_row + i;
+    }
+    for (int i = 0; i < on_proc_num_cols; i++)
+    {
+        on_proc_column_map[i] = partition->first_local_col + i;
+    }
+
+    local_nnz = 0;
+    off_proc_column_map.clear();
+    for (int i = 0; i < local_num_rows; i++)
+    {
+        int row = first_local_row + i;
+        for (int j = 0; j < dim; j++)
+        {
+            coords[j] = (row / grid_strides[j]) % grid[j];
+        }
+        for (int d = 0; d < N_s; d++)
+        {
+            if (!valid_entry(coords.data(), d)) continue;
+            local_nnz++;
+
+            int col = row + stencil_diags[d];
+            if (col < first_local_row || col > last_local_row)
+            {
+                off_proc_column_map.push_back(col);
+            }
+        }
+    }
+    std::sort(off_proc_column_map.begin(), off_proc_column_map.end());
+    off_proc_column_map.erase(std::unique(off_proc_column_map.begin(),
+                off_proc_column_map.end()), off_proc_column_map.end());
+    off_proc_num_cols = off_proc_column_map.size();
+
+    off_proc->resize(local_num_rows, off_proc_num_cols);
+
+    comm = new ParComm(partition, off_proc_column_map, on_proc_column_map);
+}
+
+/**************************************************************
+ *****   ParStencilMatrix Release Explicit
+ **************************************************************
+ ***** Replaces on_proc and off_proc with empty matrices of the
+ ***** same dimensions, keeping all maps and communicators.  A
+ ***** stencil without a diagonal entry cannot relax matrix free,
+ ***** so its explicit matrices are kept.
+ **************************************************************/
+void ParStencilMatrix::release_explicit()
+{
+    if (center < 0)
+    {
+        return;
+    }
+
+    delete on_proc;
+    delete off_proc;
+    on_proc = new CSRMatrix(local_num_rows, on_proc_num_cols);
+    off_proc = new CSRMatrix(local_num_rows, off_proc_num_cols);
+}
+
+ParStencilMatrix* ParStencilMatrix::copy()
+{
+    ParStencilMatrix* A = new ParStencilMatrix();
+    A->dim = dim;
+    A->grid = grid;
+    A->grid_strides = grid_strides;
+    A->stencil_offsets = stencil_offsets;
+    A->stencil_diags = stencil_diags;
+    A->stencil_vals = stencil_vals;
+    A->center = center;
+    A->halo = halo;
+    A->copy_helper(this);
+    A->x_ext.resize(A->local_num_rows + 2*halo, 0.0);
+    return A;
+}
+
+bool ParStencilMatrix::valid_entry(const int* coords, int d) const
+{
+    const int* offsets = &(stencil_offsets[d*dim]);
+    for (int j = 0; j < dim; j++)
+    {
+        int c = coords[j] + offsets[j];
+        if (c < 0 || c >= grid[j])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns sum of stencil entries (other than entry skip) times x_ext,
+// for local row i.  Rows away from the grid boundary skip the
+// boundary checks.
+double ParStencilMatrix::row_sum(int i, int skip) const
+{
+    int N_s = stencil_diags.size();
+    int row = partition->first_local_row + i;
+    const double* x_row = &(x_ext[halo + i]);
+    double sum = 0;
+
+    int coords[max_dim];
+    bool interior = true;
+    for (int j = 0; j < dim; j++)
+    {
+        coords[j] = (row / grid_strides[j]) % grid[j];
+        if (coords[j] == 0 || coords[j] == grid[j] - 1)
+        {
+            interior = false;
+        }
+    }
+
+    if (interior)
+    {
+        for (int d = 0; d < N_s; d++)
+        {
+            if (d == skip) continue;
+            sum += stencil_vals[d] * x_row[stencil_diags[d]];
+        }
+    }
+    else
+    {
+        for (int d = 0; d < N_s; d++)
+        {
+            if (d == skip || !valid_entry(coords, d)) continue;
+            sum += stencil_vals[d] * x_row[stencil_diags[d]];
+        }
+    }
+
+    return sum;
+}
+
+void ParStencilMatrix::load_local(ParVector& x)
+{
+    std::copy(x.local.values.begin(), x.local.values.begin() + local_num_rows,
+            x_ext.begin() + halo);
+}
+
+void ParStencilMatrix::load_halo(const std::vector<double>& dist_x)
+{
+    int base = partition->first_local_row - halo;
+    for (int i = 0; i < off_proc_num_cols; i++)
+    {
+        x_ext[off_proc_column_map[i] - base] = dist_x[i];
+    }
+}
+
+/**************************************************************
+ *****   ParStencilMatrix Mult / Residual
+ **************************************************************
+ ***** Rows at least halo away from the ends of the local range
+ ***** only read local values, and are computed while the halo
+ ***** values are communicated
+ **************************************************************/
+void ParStencilMatrix::mult(ParVector& x, ParVector& b, bool tap)
+{
+    if (comm == NULL)
+    {
+        comm = new ParComm(partition, off_proc_column_map, on_proc_column_map);
+    }
+
+    int start = std::min(halo, local_num_rows);
+    int end = std::max(start, local_num_rows - halo);
+
+    comm->init_comm(x);
+    load_local(x);
+    for (int i = start; i < end; i++)
+    {
+        b[i] = row_sum(i, -1);
+    }
+
+    load_halo(comm->complete_comm<double>());
+    for (int i = 0; i < start; i++)
+    {
+        b[i] = row_sum(i, -1);
+    }
+    for (int i = end; i < local_num_rows; i++)
+    {
+        b[i] = row_sum(i, -1);
+    }
+}
+
+void ParStencilMatrix::tap_mult(ParVector& x, ParVector& b)
+{
+    mult(x, b, false);
+}
+
+void ParStencilMatrix::residual(ParVector& x, ParVector& b, ParVector& r,
+        bool tap)
+{
+    if (comm == NULL)
+    {
+        comm = new ParComm(partition, off_proc_column_map, on_proc_column_map);
+    }
+
+    int start = std::min(halo, local_num_rows);
+    int end = std::max(start, local_num_rows - halo);
+
+    comm->init_comm(x);
+    load_local(x);
+    for (int i = start; i < end; i++)
+    {
+        r[i] = b[i] - row_sum(i, -1);
+    }
+
+    load_halo(comm->complete_comm<double>());
+    for (int i = 0; i < start; i++)
+    {
+        r[i] = b[i] - row_sum(i, -1);
+    }
+    for (int i = end; i < local_num_rows; i++)
+    {
+        r[i] = b[i] - row_sum(i, -1);
+    }
+}
+
+void ParStencilMatrix::tap_residual(ParVector& x, ParVector& b, ParVector& r)
+{
+    residual(x, b, r, false);
+}
+
+/**************************************************************
+ *****   ParStencilMatrix Relax Matrix Free
+ **************************************************************
+ ***** Jacobi, SOR and SSOR sweeps with the same updates as the
+ ***** CSR relaxation in par_relax.cpp (Jacobi across processes,
+ ***** and Gauss-Seidel on local rows).  Returns false if the
+ ***** stencil has no diagonal entry, so the explicit matrices
+ ***** are relaxed instead (exits if they were never formed).
+ **************************************************************/
+bool ParStencilMatrix::relax_matrix_free(ParVector& x, ParVector& b,
+        ParVector& tmp, int num_sweeps, double omega, relax_t relax_type)
+{
+    if (center < 0)
+    {
+        if (local_nnz > 0 && on_proc->nnz + off_proc->nnz == 0)
+        {
+            printf("Error.  Stencil has no diagonal entry, and explicit "
+                    "matrices were not formed for relaxation.\n");
+            exit(-1);
+        }
+        return false;
+    }
+
+    if (comm == NULL)
+    {
+        comm = new ParComm(partition, off_proc_column_map, on_proc_column_map);
+    }
+
+    double diag = stencil_vals[center];
+    double* x_local = &(x_ext[halo]);
+    double row_sum_i;
+
+    for (int iter = 0; iter < num_sweeps; iter++)
+    {
+        std::vector<double>& dist_x = comm->communicate(x);
+        load_local(x);
+        load_halo(dist_x);
+
+        if (relax_type == Jacobi)
+        {
+            for (int i = 0; i < local_num_rows; i++)
+            {
+                tmp[i] = x[i];
+            }
+            if (fabs(diag) > zero_tol)
+            {
+                for (int i = 0; i < local_num_rows; i++)
+                {
+                    row_sum_i = row_sum(i, center);
+                    x[i] = ((1.0 - omega)*tmp[i])
+                        + (omega*((b[i] - row_sum_i) / diag));
+                }
+            }
+            continue;
+        }
+
+        // Forward sweep (SOR and SSOR)
+        for (int i = 0; i < local_num_rows; i++)
+        {
+            row_sum_i = row_sum(i, center);
+            x_local[i] = (x_local[i] + omega * (b[i] - x_local[i] - row_sum_i))
+                / diag;
+        }
+
+        // Backward sweep (SSOR)
+        if (relax_type == SSOR)
+        {
+            for (int i = local_num_rows - 1; i >= 0; i--)
+            {
+                row_sum_i = row_sum(i, center);
+                x_local[i] = ((1.0 - omega)*x_local[i])
+                    + (omega*((b[i] - row_sum_i) / diag));
+            }
+        }
+
+        std::copy(x_local, x_local + local_num_rows, x.local.values.begin());
+    }
+
+    return true;
+}
+
+}
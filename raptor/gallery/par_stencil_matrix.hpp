@@ -0,0 +1,98 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#ifndef PARSTENCILMATRIX_HPP
+#define PARSTENCILMATRIX_HPP
+
+#include "raptor/core/types.hpp"
+#include "raptor/core/par_matrix.hpp"
+#include "raptor/core/par_vector.hpp"
+#include "par_stencil.hpp"
+
+/**************************************************************
+ *****   ParStencilMatrix Class (Inherits from ParCSRMatrix)
+ **************************************************************
+ ***** Matrix-free operator for a constant coefficient stencil
+ ***** (e.g. laplace_stencil_27pt, diffusion_stencil_2d) on a
+ ***** structured grid, with the same row distribution and values
+ ***** as par_stencil_grid.  SpMV, residual and relaxation apply the
+ ***** stencil directly to the local rows, reading x from a local
+ ***** array extended by halo regions, which are filled by ParComm.
+ *****
+ ***** The explicit on_proc / off_proc matrices are formed if
+ ***** form_explicit is true, so the operator can be passed to
+ ***** ParMultilevel::setup.  ParMultilevel releases them on the
+ ***** fine level after setup, and they can be released directly
+ ***** with release_explicit() when the operator is only used in
+ ***** Krylov methods.  Operations other than mult, residual and
+ ***** relaxation (transposes, SpGEMM, ...) require the explicit
+ ***** matrices.  TAP communication is not used : tap variants
+ ***** exchange halos with ParComm.
+ *****
+ ***** Attributes
+ ***** -------------
+ ***** dim : int
+ *****    Dimension of the grid
+ ***** grid : std::vector<int>
+ *****    Number of points in each dimension
+ ***** stencil_offsets : std::vector<int>
+ *****    Offset in each dimension of each nonzero stencil entry
+ ***** stencil_diags : std::vector<int>
+ *****    Offset in global index of each nonzero stencil entry
+ ***** stencil_vals : std::vector<double>
+ *****    Value of each nonzero stencil entry
+ ***** center : int
+ *****    Position of the diagonal in the nonzero stencil entries
+ ***** halo : int
+ *****    Largest absolute offset in global index
+ ***** max_dim : int
+ *****    Largest supported dimension
+ **************************************************************/
+namespace raptor
+{
+class ParStencilMatrix : public ParCSRMatrix
+{
+  public:
+    ParStencilMatrix(data_t* stencil, int* grid, int dim,
+            bool form_explicit = true);
+
+    ParStencilMatrix* copy();
+
+    using ParCSRMatrix::mult;
+    void mult(ParVector& x, ParVector& b, bool tap = false);
+    void tap_mult(ParVector& x, ParVector& b);
+    void residual(ParVector& x, ParVector& b, ParVector& r, bool tap = false);
+    void tap_residual(ParVector& x, ParVector& b, ParVector& r);
+
+    bool relax_matrix_free(ParVector& x, ParVector& b, ParVector& tmp,
+            int num_sweeps, double omega, relax_t relax_type);
+    void release_explicit();
+
+    int dim;
+    std::vector<int> grid;
+    std::vector<int> stencil_offsets;
+    std::vector<int> stencil_diags;
+    std::vector<double> stencil_vals;
+    int center;
+    int halo;
+
+    static const int max_dim = 8;
+
+  private:
+    ParStencilMatrix() : ParCSRMatrix()
+    {
+    }
+
+    void init_stencil(data_t* stencil);
+    void form_halo_map();
+    void load_local(ParVector& x);
+    void load_halo(const std::vector<double>& dist_x);
+    bool valid_entry(const int* coords, int d) const;
+    double row_sum(int i, int skip) const;
+
+    std::vector<int> grid_strides;
+    std::vector<double> x_ext;
+};
+
+}
+#endif
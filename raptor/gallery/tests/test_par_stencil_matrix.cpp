@@ -0,0 +1,158 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+void compare_operators(ParCSRMatrix* A, ParStencilMatrix* A_sten)
+{
+    ASSERT_EQ(A->local_num_rows, A_sten->local_num_rows);
+    ASSERT_EQ(A->off_proc_num_cols, A_sten->off_proc_num_cols);
+    ASSERT_EQ(A->local_nnz, A_sten->local_nnz);
+    for (int i = 0; i < A->off_proc_num_cols; i++)
+        ASSERT_EQ(A->off_proc_column_map[i], A_sten->off_proc_column_map[i]);
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    ParVector r(A->global_num_rows, A->local_num_rows);
+    ParVector r_sten(A->global_num_rows, A->local_num_rows);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        int row = A->local_row_map[i];
+        x[i] = sin(0.1*row) + 1.0;
+        b[i] = cos(0.3*row);
+    }
+
+    A->mult(x, r);
+    A_sten->mult(x, r_sten);
+    for (int i = 0; i < A->local_num_rows; i++)
+        ASSERT_NEAR(r[i], r_sten[i], 1e-12);
+
+    A->residual(x, b, r);
+    A_sten->residual(x, b, r_sten);
+    for (int i = 0; i < A->local_num_rows; i++)
+        ASSERT_NEAR(r[i], r_sten[i], 1e-12);
+
+    A->tap_mult(x, r);
+    A_sten->tap_mult(x, r_sten);
+    for (int i = 0; i < A->local_num_rows; i++)
+        ASSERT_NEAR(r[i], r_sten[i], 1e-12);
+
+    // Relaxation matches the CSR sweeps
+    ParVector x_sten(A->global_num_rows, A->local_num_rows);
+    ParVector tmp(A->global_num_rows, A->local_num_rows);
+    for (int t = 0; t < 3; t++)
+    {
+        x.set_const_value(0.0);
+        x_sten.set_const_value(0.0);
+        if (t == 0)
+        {
+            jacobi(A, x, b, tmp, 3, 0.8);
+            jacobi(A_sten, x_sten, b, tmp, 3, 0.8);
+        }
+        else if (t == 1)
+        {
+            sor(A, x, b, tmp, 3, 1.0);
+            sor(A_sten, x_sten, b, tmp, 3, 1.0);
+        }
+        else
+        {
+            ssor(A, x, b, tmp, 3, 1.0);
+            ssor(A_sten, x_sten, b, tmp, 3, 1.0);
+        }
+        for (int i = 0; i < A->local_num_rows; i++)
+            ASSERT_NEAR(x[i], x_sten[i], 1e-10);
+    }
+}
+
+TEST(ParStencilMatrixTest, TestsInGallery)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // 27 point Laplacian, with and without explicit matrices
+    int grid[3] = {10, 10, 10};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    ParStencilMatrix* A_sten = new ParStencilMatrix(stencil, grid, 3);
+    ParStencilMatrix* A_free = new ParStencilMatrix(stencil, grid, 3, false);
+    ASSERT_EQ(A_sten->on_proc->nnz, A->on_proc->nnz);
+    ASSERT_EQ(A_free->on_proc->nnz, 0);
+    compare_operators(A, A_sten);
+    compare_operators(A, A_free);
+
+    // Copies and released operators apply the same stencil
+    ParStencilMatrix* A_copy = A_free->copy();
+    compare_operators(A, A_copy);
+    A_sten->release_explicit();
+    ASSERT_EQ(A_sten->on_proc->nnz, 0);
+    compare_operators(A, A_sten);
+
+    // CG converges the same as with the explicit matrix
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    std::vector<double> res, res_sten;
+    x.set_const_value(1.0);
+    A->mult(x, b);
+    x.set_const_value(0.0);
+    CG(A, x, b, res);
+    x.set_const_value(0.0);
+    CG(A_free, x, b, res_sten);
+    ASSERT_EQ(res.size(), res_sten.size());
+    for (int i = 0; i < (int)res.size(); i++)
+        ASSERT_NEAR(res[i], res_sten[i], 1e-8);
+
+    delete A_copy;
+    delete A_free;
+    delete A_sten;
+    delete A;
+    delete[] stencil;
+
+    // Anisotropic 2D as the fine level of AMG
+    int grid_2d[2] = {50, 50};
+    stencil = diffusion_stencil_2d(0.001, M_PI/8.0);
+    A = par_stencil_grid(stencil, grid_2d, 2);
+    A_sten = new ParStencilMatrix(stencil, grid_2d, 2);
+    compare_operators(A, A_sten);
+
+    ParVector x_sten(A->global_num_rows, A->local_num_rows);
+    b.resize(A->global_num_rows, A->local_num_rows);
+    x.resize(A->global_num_rows, A->local_num_rows);
+    b.set_const_value(1.0);
+
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, RS, Direct, Classical, SOR);
+    ParMultilevel* ml_sten = new ParRugeStubenSolver(0.25, RS, Direct, Classical, SOR);
+    ml->setup(A);
+    ml_sten->setup(A_sten);
+    ASSERT_EQ(ml->num_levels, ml_sten->num_levels);
+    ASSERT_EQ(ml_sten->levels[0]->A->on_proc->nnz, 0);
+
+    x.set_const_value(0.0);
+    x_sten.set_const_value(0.0);
+    int iter = ml->solve(x, b);
+    int iter_sten = ml_sten->solve(x_sten, b);
+    ASSERT_EQ(iter, iter_sten);
+    for (int i = 0; i < iter; i++)
+        ASSERT_NEAR(ml->residuals[i], ml_sten->residuals[i],
+                1e-8 * ml->residuals[0]);
+
+    delete ml_sten;
+    delete ml;
+    delete A_sten;
+    delete A;
+    delete[] stencil;
+
+} // end of TEST(ParStencilMatrixTest, TestsInGallery) //
+
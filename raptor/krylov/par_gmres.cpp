@@ -0,0 +1,292 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "par_gmres.hpp"
+
+namespace raptor {
+
+/**************************************************************
+*****   Orthogonalize
+**************************************************************
+***** Orthogonalizes w against V[0..k] with classical Gram-Schmidt,
+***** adding the coefficients to h[0..k] and returning ||w||.  Each
+***** pass reduces V^T w and w^T w together, and the new norm is
+***** w^T w - h^T h.  If that drops below half of w^T w, a second
+***** pass (CGS2) restores orthogonality.
+**************************************************************/
+static double orthogonalize(std::vector<ParVector>& V, int k, ParVector& w,
+        double* h, std::vector<double>& sums, double* comm_t)
+{
+    int n = w.local_n;
+    double* w_data = w.local.data();
+    double norm2 = 0.0;
+
+    for (int i = 0; i <= k; i++)
+    {
+        h[i] = 0.0;
+    }
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // Local <V_i, w> and <w, w>, summed in one reduction
+        for (int i = 0; i <= k; i++)
+        {
+            double* v_data = V[i].local.data();
+            double sum = 0.0;
+            for (int j = 0; j < n; j++)
+            {
+                sum += v_data[j] * w_data[j];
+            }
+            sums[i] = sum;
+        }
+        double ww = 0.0;
+        for (int j = 0; j < n; j++)
+        {
+            ww += w_data[j] * w_data[j];
+        }
+        sums[k+1] = ww;
+
+if (comm_t) *comm_t -= RAPtor_MPI_Wtime();
+        RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, sums.data(), k+2, RAPtor_MPI_DOUBLE,
+                RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+if (comm_t) *comm_t += RAPtor_MPI_Wtime();
+
+        // w -= V * (V^T w)
+        double hh = 0.0;
+        for (int i = 0; i <= k; i++)
+        {
+            double* v_data = V[i].local.data();
+            double coef = sums[i];
+            for (int j = 0; j < n; j++)
+            {
+                w_data[j] -= coef * v_data[j];
+            }
+            h[i] += coef;
+            hh += coef * coef;
+        }
+        ww = sums[k+1];
+        norm2 = ww - hh;
+
+        if (norm2 > 0.5 * ww) break;
+    }
+
+    // Pythagoras fails if w is (numerically) in span(V)
+    if (norm2 <= 0.0)
+    {
+if (comm_t) *comm_t -= RAPtor_MPI_Wtime();
+        double norm = w.norm(2);
+if (comm_t) *comm_t += RAPtor_MPI_Wtime();
+        return norm;
+    }
+
+    return sqrt(norm2);
+}
+
+static void gmres_helper(ParCSRMatrix* A, ParMultilevel* ml, bool flexible,
+        ParVector& x, ParVector& b, std::vector<double>& res, int restart,
+        double tol, int max_iter, double* precond_t, double* comm_t)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+    int iter, k, ld;
+    double norm_r, norm_r0, h_next, denom, tmp;
+
+    if (max_iter <= 0)
+    {
+        max_iter = ((int)(1.3*b.global_n)) + 2;
+    }
+    if (restart <= 0 || restart > max_iter)
+    {
+        restart = max_iter;
+    }
+
+    // Krylov basis V, and preconditioned basis Z if flexible
+    std::vector<ParVector> V(restart + 1);
+    std::vector<ParVector> Z(flexible ? restart : 0);
+    ParVector z;
+    for (int i = 0; i <= restart; i++)
+    {
+        V[i].resize(b.global_n, b.local_n);
+    }
+    for (int i = 0; i < (int) Z.size(); i++)
+    {
+        Z[i].resize(b.global_n, b.local_n);
+    }
+    if (ml && !flexible)
+    {
+        z.resize(b.global_n, b.local_n);
+    }
+
+    // Hessenberg matrix (column major), Givens rotations, and
+    // rotated right-hand side
+    ld = restart + 1;
+    std::vector<double> H(ld * restart);
+    std::vector<double> cs(restart);
+    std::vector<double> sn(restart);
+    std::vector<double> g(restart + 1);
+    std::vector<double> y(restart);
+    std::vector<double> sums(restart + 2);
+
+    // r0 = b - A * x0
+    A->residual(x, b, V[0]);
+if (comm_t) *comm_t -= RAPtor_MPI_Wtime();
+    norm_r = V[0].norm(2);
+if (comm_t) *comm_t += RAPtor_MPI_Wtime();
+    norm_r0 = norm_r;
+    if (norm_r0 < zero_tol) norm_r0 = 1.0;
+    res.emplace_back(norm_r / norm_r0);
+
+    if (norm_r != 0.0)
+    {
+        tol = tol * norm_r;
+    }
+
+    iter = 0;
+    while (norm_r > tol && iter < max_iter)
+    {
+        // v_0 = r / ||r||
+        V[0].scale(1.0 / norm_r);
+        g[0] = norm_r;
+        for (int i = 1; i <= restart; i++)
+        {
+            g[i] = 0.0;
+        }
+
+        k = 0;
+        while (k < restart && iter < max_iter)
+        {
+            // v_{k+1} = A * M^{-1} v_k
+            if (ml)
+            {
+                ParVector& zk = flexible ? Z[k] : z;
+                zk.set_const_value(0.0);
+if (precond_t) *precond_t -= RAPtor_MPI_Wtime();
+                ml->cycle(zk, V[k]);
+if (precond_t) *precond_t += RAPtor_MPI_Wtime();
+                A->mult(zk, V[k+1]);
+            }
+            else
+            {
+                A->mult(V[k], V[k+1]);
+            }
+
+            double* h = &(H[k*ld]);
+            h_next = orthogonalize(V, k, V[k+1], h, sums, comm_t);
+            if (h_next > 0.0)
+            {
+                V[k+1].scale(1.0 / h_next);
+            }
+
+            // Apply previous rotations to column k, and rotate out h_{k+1,k}
+            for (int i = 0; i < k; i++)
+            {
+                tmp = cs[i] * h[i] + sn[i] * h[i+1];
+                h[i+1] = -sn[i] * h[i] + cs[i] * h[i+1];
+                h[i] = tmp;
+            }
+            denom = sqrt(h[k] * h[k] + h_next * h_next);
+            if (denom > 0.0)
+            {
+                cs[k] = h[k] / denom;
+                sn[k] = h_next / denom;
+            }
+            else
+            {
+                cs[k] = 1.0;
+                sn[k] = 0.0;
+            }
+            h[k] = denom;
+            g[k+1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+
+            k++;
+            iter++;
+            norm_r = fabs(g[k]);
+            res.emplace_back(norm_r / norm_r0);
+
+            // Converged, or the Krylov space is invariant under A
+            if (norm_r <= tol || h_next == 0.0) break;
+        }
+
+        // Solve upper triangular H y = g
+        for (int i = k - 1; i >= 0; i--)
+        {
+            tmp = g[i];
+            for (int j = i + 1; j < k; j++)
+            {
+                tmp -= H[j*ld + i] * y[j];
+            }
+            y[i] = H[i*ld + i] != 0.0 ? tmp / H[i*ld + i] : 0.0;
+        }
+
+        // x += M^{-1} V y
+        if (flexible)
+        {
+            for (int i = 0; i < k; i++)
+            {
+                x.axpy(Z[i], y[i]);
+            }
+        }
+        else if (ml)
+        {
+            z.set_const_value(0.0);
+            for (int i = 0; i < k; i++)
+            {
+                z.axpy(V[i], y[i]);
+            }
+            V[0].set_const_value(0.0);
+if (precond_t) *precond_t -= RAPtor_MPI_Wtime();
+            ml->cycle(V[0], z);
+if (precond_t) *precond_t += RAPtor_MPI_Wtime();
+            x.axpy(V[0], 1.0);
+        }
+        else
+        {
+            for (int i = 0; i < k; i++)
+            {
+                x.axpy(V[i], y[i]);
+            }
+        }
+
+        // Restart from the true residual
+        A->residual(x, b, V[0]);
+if (comm_t) *comm_t -= RAPtor_MPI_Wtime();
+        norm_r = V[0].norm(2);
+if (comm_t) *comm_t += RAPtor_MPI_Wtime();
+    }
+
+    if (rank == 0)
+    {
+        if (iter == max_iter && norm_r > tol)
+        {
+            printf("Max Iterations Reached.\n");
+        }
+        else
+        {
+            printf("%d Iteration required to converge\n", iter);
+        }
+        printf("Relative Residual: %lg\n\n", norm_r / norm_r0);
+    }
+}
+
+void GMRES(ParCSRMatrix* A, ParVector& x, ParVector& b, std::vector<double>& res,
+        int restart, double tol, int max_iter, double* comm_t)
+{
+    gmres_helper(A, NULL, false, x, b, res, restart, tol, max_iter, NULL, comm_t);
+}
+
+void PGMRES(ParCSRMatrix* A, ParMultilevel* ml, ParVector& x, ParVector& b,
+        std::vector<double>& res, int restart, double tol, int max_iter,
+        double* precond_t, double* comm_t)
+{
+    gmres_helper(A, ml, false, x, b, res, restart, tol, max_iter, precond_t, comm_t);
+}
+
+void FGMRES(ParCSRMatrix* A, ParMultilevel* ml, ParVector& x, ParVector& b,
+        std::vector<double>& res, int restart, double tol, int max_iter,
+        double* precond_t, double* comm_t)
+{
+    gmres_helper(A, ml, true, x, b, res, restart, tol, max_iter, precond_t, comm_t);
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef RAPTOR_KRYLOV_PAR_GMRES_HPP
+#define RAPTOR_KRYLOV_PAR_GMRES_HPP
+
+#include <vector>
+
+#include "raptor/core/types.hpp"
+#include "raptor/core/par_matrix.hpp"
+#include "raptor/core/par_vector.hpp"
+#include "raptor/multilevel/par_multilevel.hpp"
+
+/**************************************************************
+ *****   Restarted GMRES
+ **************************************************************
+ ***** GMRES(m) for nonsymmetric systems, restarted every
+ ***** 'restart' iterations.  PGMRES is right preconditioned by
+ ***** one cycle of ml, and FGMRES is flexible (the preconditioned
+ ***** basis is stored, so the preconditioner may change between
+ ***** iterations).  With right preconditioning, res holds the
+ ***** true relative residual norms ||b - Ax|| / ||r0||.
+ *****
+ ***** Each Arnoldi vector is orthogonalized by classical
+ ***** Gram-Schmidt, with all inner products and the norm fused
+ ***** into one Allreduce.  The norm follows from Pythagoras, and
+ ***** a second pass (CGS2) is done only if it shows severe
+ ***** cancellation, so an iteration takes one (or two) reductions
+ ***** independent of the restart length.
+ *****
+ ***** Parameters
+ ***** -------------
+ ***** restart : int
+ *****    Maximum dimension of the Krylov space between restarts
+ ***** tol : double
+ *****    Convergence tolerance, relative to the initial residual
+ ***** max_iter : int
+ *****    Maximum total iterations (default 1.3*n + 2)
+ ***** precond_t, comm_t : double*
+ *****    If not NULL, time of preconditioning / reductions is added
+ **************************************************************/
+namespace raptor {
+
+void GMRES(ParCSRMatrix* A, ParVector& x, ParVector& b, std::vector<double>& res,
+        int restart = 30, double tol = 1e-05, int max_iter = -1,
+        double* comm_t = NULL);
+void PGMRES(ParCSRMatrix* A, ParMultilevel* ml, ParVector& x, ParVector& b,
+        std::vector<double>& res, int restart = 30, double tol = 1e-05,
+        int max_iter = -1, double* precond_t = NULL, double* comm_t = NULL);
+void FGMRES(ParCSRMatrix* A, ParMultilevel* ml, ParVector& x, ParVector& b,
+        std::vector<double>& res, int restart = 30, double tol = 1e-05,
+        int max_iter = -1, double* precond_t = NULL, double* comm_t = NULL);
+
+}
+#endif
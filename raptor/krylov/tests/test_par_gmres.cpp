@@ -0,0 +1,102 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+// Counts reductions (through the MPI profiling interface)
+int num_allreduce = 0;
+int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    num_allreduce++;
+    return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+// Relative true residual ||b - Ax|| / ||b||
+double true_residual(ParCSRMatrix* A, ParVector& x, ParVector& b)
+{
+    ParVector r(b.global_n, b.local_n);
+    A->residual(x, b, r);
+    return r.norm(2) / b.norm(2);
+}
+
+TEST(ParGMRESTest, TestsInKrylov)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // 2D convection-diffusion, first order upwind convection
+    int grid[2] = {40, 40};
+    double c = 2.0;
+    double stencil[9] = {0.0, -1.0 - c, 0.0,
+                         -1.0 - c, 4.0 + 2*c, -1.0,
+                         0.0, -1.0, 0.0};
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 2);
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    std::vector<double> res;
+    double tol = 1e-8;
+
+    x.set_rand_values();
+    A->mult(x, b);
+
+    // GMRES(20), with one or two reductions per iteration
+    x.set_const_value(0.0);
+    num_allreduce = 0;
+    GMRES(A, x, b, res, 20, tol);
+    int gmres_iter = res.size() - 1;
+    int num_restarts = (gmres_iter + 19) / 20;
+    ASSERT_LT(res.back(), tol);
+    ASSERT_LT(true_residual(A, x, b), 10*tol);
+    ASSERT_GE(num_allreduce, gmres_iter);
+    ASSERT_LE(num_allreduce, 2*gmres_iter + 2*num_restarts + 2);
+
+    // Full GMRES never needs more iterations than restarted
+    res.clear();
+    x.set_const_value(0.0);
+    GMRES(A, x, b, res, 1000, tol);
+    ASSERT_LE((int)res.size() - 1, gmres_iter);
+    ASSERT_LT(true_residual(A, x, b), 10*tol);
+
+    // AMG preconditioned
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended);
+    ml->setup(A);
+
+    res.clear();
+    x.set_const_value(0.0);
+    PGMRES(A, ml, x, b, res, 20, tol);
+    int pgmres_iter = res.size() - 1;
+    ASSERT_LT(pgmres_iter, gmres_iter);
+    ASSERT_LT(true_residual(A, x, b), 10*tol);
+
+    // Flexible variant agrees with a fixed preconditioner
+    res.clear();
+    x.set_const_value(0.0);
+    FGMRES(A, ml, x, b, res, 20, tol);
+    ASSERT_NEAR((int)res.size() - 1, pgmres_iter, 1);
+    ASSERT_LT(true_residual(A, x, b), 10*tol);
+
+    // Restart lengths shorter than the iteration count
+    res.clear();
+    x.set_const_value(0.0);
+    FGMRES(A, ml, x, b, res, 3, tol);
+    ASSERT_LT(true_residual(A, x, b), 10*tol);
+
+    delete ml;
+    delete A;
+    
+} // end of TEST(ParGMRESTest, TestsInKrylov) //
+
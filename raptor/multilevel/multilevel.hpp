@@ -6,6 +6,7 @@
 #include "raptor/core/types.hpp"
 #include "raptor/core/matrix.hpp"
 #include "raptor/core/vector.hpp"
+#include "raptor/core/workspace.hpp"
 #include "level.hpp"
 #include "raptor/util/linalg/relax.hpp"
 
@@ -61,6 +62,10 @@ namespace raptor
                     form_rand_weights(Af->n_rows);
                 }
 
+                // Temporaries of the setup are pooled, and freed when
+                // the setup returns
+                ScopedWorkspace setup_workspace;
+
                 levels.emplace_back(new Level());
                 levels[0]->A = Af->copy();
                 levels[0]->A->sort();
@@ -116,6 +121,7 @@ namespace raptor
                 int info;
                 dgetrf_(&coarse_n, &coarse_n, A_coarse.data(), &coarse_n, 
                         LU_permute.data(), &info);
+                coarse_b.resize(coarse_n);
             }
 
             void cycle(Vector& x, Vector& b, int level)
@@ -130,7 +136,7 @@ namespace raptor
                     char trans = 'N'; //No transpose
                     int nhrs = 1; // Number of right hand sides
                     int info; // result
-                    double b_data[b.size()];
+                    double* b_data = coarse_b.data();
                     for (int i = 0; i < b.size(); i++)
                         b_data[i] = b.data()[i];
                     dgetrs_(&trans, &coarse_n, &nhrs, A_coarse.data(), &coarse_n, 
@@ -202,8 +208,9 @@ namespace raptor
                     residuals.resize(num_iterations + 1);
                 }
 
-                // Iterate until convergence or max iterations
-                Vector resid(rhs.size());
+                // Iterate until convergence or max iterations (the residual
+                // is held in the finest level's workspace between cycles)
+                Vector& resid = levels[0]->tmp;
                 levels[0]->A->residual(sol, rhs, resid);
                 if (fabs(b_norm) > zero_tol)
                 {
@@ -265,6 +272,7 @@ namespace raptor
             std::vector<Level*> levels;
             std::vector<double> A_coarse;
             std::vector<int> LU_permute;
+            std::vector<double> coarse_b;
             int coarse_n;
             int num_levels;
 
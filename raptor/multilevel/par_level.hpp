@@ -10,6 +10,9 @@
 // Coarse Matrices (A) are CSR
 // Prolongation Matrices (P) are CSR
 // P^T*A*P is then CSR*(CSR*CSR) -- returns CSR Ac
+// Restriction Matrices (R), if formed, are CSR copies of P^T
+// tap_* flags select TAP communication (tap_comm for vectors, tap_mat_comm
+// for matrices) rather than comm for each operation on the level
 namespace raptor
 {
     class ParLevel
@@ -19,14 +22,26 @@ namespace raptor
             {
                 A = NULL;
                 P = NULL;
+                R = NULL;
                 AP = NULL;
                 I = NULL;
+
+                tap_A = false;
+                tap_P = false;
+                tap_R = false;
+                tap_AP = false;
+                tap_PTAP = false;
+
+                galerkin_nnz = -1;
+                galerkin_recv_size = -1;
+                galerkin_num_recvs = -1;
             }
 
             ~ParLevel()
             {
                 delete A;
                 delete P;
+                delete R;
 
                 delete AP;
                 delete I;
@@ -34,12 +49,25 @@ namespace raptor
 
             ParCSRMatrix* A;
             ParCSRMatrix* P;
+            ParCSRMatrix* R; // Explicit P^T, if stored
             ParVector x;
             ParVector b;
             ParVector tmp;
 
             ParCSRMatrix* AP;
             ParCSRMatrix* I;
+
+            bool tap_A; // SpMVs with A (relaxation, residual)
+            bool tap_P; // SpMVs with P (interpolation, restriction if no R)
+            bool tap_R; // SpMVs with R
+            bool tap_AP; // A*P
+            bool tap_PTAP; // P^T*(AP)
+
+            // Local nnz, off_proc columns and processes received from 
+            // of the Galerkin P^T*A*P, if A was sparsified (otherwise -1)
+            long galerkin_nnz;
+            int galerkin_recv_size;
+            int galerkin_num_recvs;
     };
 }
 #endif
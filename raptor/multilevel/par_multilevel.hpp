@@ -6,7 +6,10 @@
 #include "raptor/core/types.hpp"
 #include "raptor/core/par_matrix.hpp"
 #include "raptor/core/par_vector.hpp"
+#include "raptor/core/workspace.hpp"
 #include "raptor/multilevel/par_level.hpp"
+#include "raptor/multilevel/par_sparsify.hpp"
+#include "raptor/profiling/comm_stats.hpp"
 #include "raptor/util/linalg/par_relax.hpp"
 #include "raptor/ruge_stuben/par_interpolation.hpp"
 #include "raptor/ruge_stuben/par_cf_splitting.hpp"
@@ -56,6 +59,65 @@
  *****    Maximum global num rows allowed in coarsest matrix
  ***** max_levels : int (default -1)
  *****    Maximum number of levels in hierarchy, or no maximum if -1
+ ***** store_restriction : bool (default false)
+ *****    If true, R = P^T is formed explicitly on each level during 
+ *****    setup, and restriction is performed as a standard SpMV 
+ *****    with R rather than a transpose SpMV with P
+ ***** sell_chunk_size : int (default 0)
+ *****    If positive, A, P (and R) on each level are converted to
+ *****    SELL-C-sigma format with chunks of sell_chunk_size rows 
+ *****    after setup, so the solve phase uses SIMD SpMV kernels
+ ***** sell_sort_scope : int (default 1)
+ *****    Number of rows sorted by length when forming SELL matrices
+ ***** tap_amg : int (default -1)
+ *****    First level using node-aware (TAP) communication for all
+ *****    operations, or -1 for none (with comm_select ThresholdComm)
+ ***** comm_select : comm_select_t (default ThresholdComm)
+ *****    How each level chooses between standard communication and
+ *****    3-step / 2-step TAPComm.  Options are
+ *****      - ThresholdComm : TAP communication on levels >= tap_amg
+ *****      - ModelComm : fastest under comm_model, chosen separately
+ *****        for SpMVs with A, P and R, and for A*P and P^T*(AP)
+ *****      - TimedComm : as ModelComm, but each communicator is timed
+ *****        with comm_probe_tests exchanges of equivalent volume
+ ***** comm_model : CommModel
+ *****    Max-rate model parameters used by ModelComm
+ ***** comm_probe_tests : int (default 3)
+ *****    Number of timed exchanges per communicator with TimedComm
+ ***** tap_shared_memory : bool (default false)
+ *****    If true, TAP communicators of levels using node-aware 
+ *****    communication exchange node-local values through MPI-3
+ *****    shared memory windows, so only inter-node steps use messages
+ ***** track_times : bool (default false)
+ *****    If true, timers are enabled during setup and solve.  Each
+ *****    level records regions (strength, splitting, interpolation,
+ *****    spgemm, comm init, relax, residual, restriction, coarse
+ *****    solve) within the "setup" and "solve" regions of timers,
+ *****    printed per level with print_setup_times / print_solve_times.
+ *****    Each setup replaces the times of previous setups and solves.
+ ***** coarse_solve_type : coarse_solve_t (default DenseLU)
+ *****    Solver used on the coarsest level.  Options are
+ *****      - DenseLU : coarse matrix is gathered as a dense array on
+ *****        every active process and factored with dgetrf
+ *****      - SparseCG : coarse matrix is gathered in CSR format on
+ *****        every active process and solved redundantly with 
+ *****        Jacobi preconditioned CG (symmetric coarse matrices)
+ *****      - SparseBiCGStab : as SparseCG, but with Jacobi 
+ *****        preconditioned BiCGStab (nonsymmetric coarse matrices)
+ ***** coarse_solve_tol : double (default 1e-12)
+ *****    Relative residual tolerance of sparse coarse solves
+ ***** coarse_max_iterations : int (default 200)
+ *****    Maximum iterations performed by sparse coarse solves
+ ***** sparsify_tol : double (default 0.0)
+ *****    If positive, coarse operators of Ruge-Stuben hierarchies are
+ *****    sparsified (non-Galerkin) : entries outside the minimal
+ *****    pattern I^T A P + P^T A I and smaller than sparsify_tol times
+ *****    the largest off-diagonal of their row are lumped into the
+ *****    diagonal.  Compare with print_sparsify_stats.
+ ***** sparsify_level_tols : std::vector<double> (default empty)
+ *****    Per-level schedule replacing sparsify_tol : entry l is used
+ *****    for the coarse operator formed on level l (and sparsify_tol
+ *****    for levels past the end).  Zero keeps the level Galerkin.
  ***** 
  ***** Methods
  ***** -------
@@ -85,12 +147,20 @@ namespace raptor
                 tap_amg = -1;
                 weights = NULL;
                 store_residuals = true;
+                store_restriction = false;
+                sell_chunk_size = 0;
+                sell_sort_scope = 1;
+                tap_shared_memory = false;
+                comm_select = ThresholdComm;
+                comm_probe_tests = 3;
                 track_times = false;
-                setup_times = NULL;
-                solve_times = NULL;
                 sparsify_tol = 0.0;
                 solve_tol = 1e-07;
                 max_iterations = 100;
+                coarse_solve_type = DenseLU;
+                coarse_solve_tol = 1e-12;
+                coarse_max_iterations = 200;
+                A_coarse_sparse = NULL;
             }
 
             virtual ~ParMultilevel()
@@ -110,9 +180,7 @@ namespace raptor
                 }
 
                 delete[] weights;
-
-                delete[] setup_times;
-                delete[] solve_times;
+                delete A_coarse_sparse;
             }
             
             virtual void setup(ParCSRMatrix* Af) = 0;
@@ -124,11 +192,21 @@ namespace raptor
                 RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
                 int last_level = 0;
 
-                if (track_times)
+                // Times of any previous setup and solve are replaced
+                if (track_times || timers.enabled)
                 {
-                    setup_times = new double[5 * max_levels]();
-                    init_profile();
+                    TimerRegion* setup_region = timers.current->child("setup", -1);
+                    TimerRegion* solve_region = timers.current->child("solve", -1);
+                    setup_region->clear();
+                    solve_region->clear();
+                    setup_path = setup_region->path();
+                    solve_path = solve_region->path();
                 }
+                ScopedTimer setup_timer("setup", -1, track_times);
+
+                // Temporaries of the setup are pooled, and freed when
+                // the setup returns
+                ScopedWorkspace setup_workspace;
 
                 // Add original, fine level to hierarchy
                 levels.emplace_back(new ParLevel());
@@ -140,6 +218,7 @@ namespace raptor
                 levels[0]->tmp.resize(Af->global_num_rows, Af->local_num_rows);
                 if (tap_amg == 0)
                 {
+                    ScopedTimer t("comm init", 0);
                     if (!Af->tap_comm && !Af->tap_mat_comm)
                     {
                         levels[0]->A->init_tap_communicators();
@@ -165,17 +244,9 @@ namespace raptor
                 while (levels[last_level]->A->global_num_rows > max_coarse && 
                         (max_levels == -1 || (int) levels.size() < max_levels))
                 {
-                    extend_hierarchy();
-
-                    if (track_times)
                     {
-                        finalize_profile();
-                        setup_times[5*last_level] = total_t;
-                        setup_times[5*last_level + 1] = collective_t;
-                        setup_times[5*last_level + 2] = p2p_t;
-                        setup_times[5*last_level + 3] = vec_t;
-                        setup_times[5*last_level + 4] = mat_t;
-                        init_profile();
+                        ScopedTimer t("extend hierarchy", last_level);
+                        extend_hierarchy();
                     }
 
                     last_level++;
@@ -188,24 +259,274 @@ namespace raptor
                     weights = NULL;
                 }
 
+                // Form explicit restriction operators R = P^T
+                if (store_restriction)
+                {
+                    form_restriction();
+                }
+
+                // Convert solve-phase matrices to SELL-C-sigma format
+                if (sell_chunk_size > 0)
+                {
+                    for (int i = 0; i < num_levels; i++)
+                    {
+                        ParLevel* l = levels[i];
+                        l->A->form_SELL(sell_chunk_size, sell_sort_scope);
+                        if (l->P) l->P->form_SELL(sell_chunk_size, sell_sort_scope);
+                        if (l->R) l->R->form_SELL(sell_chunk_size, sell_sort_scope);
+                    }
+                }
+
+                // Use shared memory windows for node-local TAP steps
+                if (tap_shared_memory)
+                {
+                    for (int i = 0; i < num_levels - 1; i++)
+                    {
+                        ParLevel* l = levels[i];
+                        if (l->tap_A) l->A->tap_comm->init_shared_windows();
+                        if (l->tap_P) l->P->tap_comm->init_shared_windows();
+                        if (l->tap_R) l->R->tap_comm->init_shared_windows();
+                    }
+                }
+
                 // Duplicate coarsest level across all processes that hold any
                 // rows of A_c
-                duplicate_coarse();
+                {
+                    ScopedTimer t("coarse solve", num_levels - 1);
+                    duplicate_coarse();
+                }
 
-                if (track_times)
+                // Matrix-free fine operators no longer need on_proc / off_proc
+                if (num_levels > 1)
                 {
-                    finalize_profile();
-                    setup_times[5*(num_levels-1)] += total_t;
-                    setup_times[5*(num_levels-1) + 1] += collective_t;
-                    setup_times[5*(num_levels-1) + 2] += p2p_t;
-                    setup_times[5*(num_levels-1) + 3] += vec_t;
-                    setup_times[5*(num_levels-1) + 4] += mat_t;
+                    levels[0]->A->release_explicit();
+                }
 
-                    solve_times = new double[5 * num_levels]();
+                // Size solve workspaces, so solve() does not allocate
+                if (store_residuals)
+                {
+                    residuals.resize(max_iterations + 1);
+                }
+                for (int i = 0; i < num_levels - 1; i++)
+                {
+                    block_relax_setup(levels[i]->A);
                 }
             } 
 
 
+            void form_restriction()
+            {
+                for (int i = 0; i < num_levels - 1; i++)
+                {
+                    ScopedTimer t("restriction", i);
+                    ParCSRMatrix* P = levels[i]->P;
+                    if (P->comm == NULL)
+                    {
+                        P->comm = new ParComm(P->partition, P->off_proc_column_map,
+                                P->on_proc_column_map);
+                    }
+
+                    delete levels[i]->R;
+                    ParCSRMatrix* R = P->transpose();
+                    levels[i]->R = R;
+
+                    // Coarse levels are indexed by fine-level global indices, 
+                    // so restore the row and column maps of P that the 
+                    // transposed partition cannot describe
+                    R->global_num_rows = P->global_num_cols;
+                    R->global_num_cols = P->global_num_rows;
+                    R->local_row_map = P->on_proc_column_map;
+                    R->on_proc_column_map = P->local_row_map;
+                    R->comm->delete_comm();
+                    R->comm = new ParComm(R->partition, R->off_proc_column_map,
+                            R->on_proc_column_map, P->comm->key, P->comm->mpi_comm);
+
+                    if (comm_select != ThresholdComm)
+                    {
+                        bool tap_mat = false;
+                        select_comm(R, true, 0.0, levels[i]->tap_R, tap_mat);
+                    }
+                    else if (levels[i]->tap_P)
+                    {
+                        R->tap_comm = new TAPComm(R->partition, 
+                                R->off_proc_column_map, R->on_proc_column_map);
+                        levels[i]->tap_R = true;
+                    }
+                }
+            }
+
+            /**************************************************************
+             *****   Select A Comm
+             **************************************************************
+             ***** Chooses communication for SpMVs with A on level, which
+             ***** is also used for strength, splitting and interpolation
+             **************************************************************/
+            void select_A_comm(int level)
+            {
+                ScopedTimer t("comm init", level);
+                ParLevel* l = levels[level];
+                if (comm_select == ThresholdComm)
+                {
+                    l->tap_A = tap_amg >= 0 && tap_amg <= level;
+                    l->tap_AP = l->tap_A;
+                    return;
+                }
+
+                select_comm(l->A, true, 0.0, l->tap_A, l->tap_AP);
+            }
+
+            /**************************************************************
+             *****   Select P Comm
+             **************************************************************
+             ***** Chooses communication for A*P (rows of P are sent), 
+             ***** P^T*(AP) and SpMVs with P.  Rows of AP are estimated
+             ***** with the rows of A, and transpose communication is 
+             ***** modeled by the forward communication of P.
+             **************************************************************/
+            void select_P_comm(int level)
+            {
+                ScopedTimer t("comm init", level);
+                ParLevel* l = levels[level];
+                if (comm_select == ThresholdComm)
+                {
+                    l->tap_P = l->tap_A;
+                    l->tap_PTAP = l->tap_A;
+                    return;
+                }
+
+                bool tap_vec = l->tap_A;
+                select_comm(l->A, false, row_bytes(l->P), tap_vec, l->tap_AP);
+                select_comm(l->P, true, row_bytes(l->A), l->tap_P, l->tap_PTAP);
+            }
+
+            // Average bytes of a communicated row of M (global)
+            double row_bytes(ParCSRMatrix* M)
+            {
+                double nnz = M->on_proc->nnz + M->off_proc->nnz;
+                RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &nnz, 1, RAPtor_MPI_DOUBLE,
+                        RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+                if (M->global_num_rows == 0) return sizeof(int);
+                return sizeof(int) + (nnz / M->global_num_rows)
+                    * (sizeof(int) + sizeof(double));
+            }
+
+            /**************************************************************
+             *****   Select Comm
+             **************************************************************
+             ***** Chooses the fastest of M->comm, 3-step and 2-step 
+             ***** TAPComm for vector communication (if vec is true) and
+             ***** for matrix communication of mat_bytes per row (if
+             ***** mat_bytes > 0), setting tap_vec and tap_mat.
+             ***** M->tap_comm holds the TAPComm used for vectors and
+             ***** M->tap_mat_comm the TAPComm used for matrices (or the
+             ***** other TAPComm if standard communication is chosen).  
+             ***** A TAPComm used by neither is deleted.
+             **************************************************************/
+            void select_comm(ParCSRMatrix* M, bool vec, double mat_bytes,
+                    bool& tap_vec, bool& tap_mat)
+            {
+                if (M->comm == NULL)
+                {
+                    M->comm = new ParComm(M->partition, M->off_proc_column_map,
+                            M->on_proc_column_map);
+                }
+                if (M->tap_comm == NULL)
+                {
+                    M->tap_comm = new TAPComm(M->partition, M->off_proc_column_map,
+                            M->on_proc_column_map, true);
+                }
+                if (M->tap_mat_comm == NULL)
+                {
+                    M->tap_mat_comm = new TAPComm(M->partition, M->off_proc_column_map,
+                            M->on_proc_column_map, false);
+                }
+
+                CommPkg* comms[3] = {M->comm, M->tap_comm, M->tap_mat_comm};
+                int vec_idx = -1;
+                int mat_idx = -1;
+                if (vec) vec_idx = fastest_comm(M, comms, sizeof(double));
+                if (mat_bytes > 0) mat_idx = fastest_comm(M, comms, mat_bytes);
+
+                // Previous choices are kept if not selected here
+                bool vec_tap = vec_idx >= 0 ? vec_idx > 0 : tap_vec;
+                bool mat_tap = mat_idx >= 0 ? mat_idx > 0 : tap_mat;
+                TAPComm* taps[2] = {M->tap_comm, M->tap_mat_comm};
+                TAPComm* vec_comm = vec_idx == 2 ? taps[1] : taps[0];
+                TAPComm* mat_comm = mat_idx == 1 ? taps[0] : taps[1];
+
+                // Unused slots hold the other TAPComm
+                if (!mat_tap && mat_comm == vec_comm)
+                {
+                    mat_comm = vec_comm == taps[0] ? taps[1] : taps[0];
+                }
+                if (!vec_tap && vec_comm == mat_comm)
+                {
+                    vec_comm = mat_comm == taps[0] ? taps[1] : taps[0];
+                }
+
+                if (vec_comm == mat_comm)
+                {
+                    vec_comm->num_shared++;
+                    if (taps[0] != vec_comm) taps[0]->delete_comm();
+                    if (taps[1] != vec_comm) taps[1]->delete_comm();
+                }
+                M->tap_comm = vec_comm;
+                M->tap_mat_comm = mat_comm;
+
+                tap_vec = vec_tap;
+                tap_mat = mat_tap;
+            }
+
+            // Returns index of fastest communicator (lowest on ties)
+            int fastest_comm(ParCSRMatrix* M, CommPkg** comms, double value_bytes)
+            {
+                int idx = 0;
+                double min_t = 0.0;
+                for (int i = 0; i < 3; i++)
+                {
+                    double t;
+                    if (comm_select == TimedComm)
+                    {
+                        t = time_comm(M, comms[i], value_bytes);
+                    }
+                    else
+                    {
+                        t = comms[i]->model_time(comm_model, value_bytes);
+                    }
+                    if (i == 0 || t < min_t)
+                    {
+                        idx = i;
+                        min_t = t;
+                    }
+                }
+                return idx;
+            }
+
+            // Max time over all processes of exchanging a vector with
+            // value_bytes per column of M
+            double time_comm(ParCSRMatrix* M, CommPkg* comm, double value_bytes)
+            {
+                int block_size = (int) ceil(value_bytes / sizeof(double));
+                if (block_size < 1) block_size = 1;
+                std::vector<double> values(M->on_proc_num_cols * block_size, 1.0);
+
+                // Communicated values are read up to the buffer size, so the
+                // buffer is restored after probing with blocks
+                int buffer_size = comm->get_buffer<double>().size();
+                comm->communicate(values, block_size);
+                RAPtor_MPI_Barrier(RAPtor_MPI_COMM_WORLD);
+                double t0 = RAPtor_MPI_Wtime();
+                for (int i = 0; i < comm_probe_tests; i++)
+                {
+                    comm->communicate(values, block_size);
+                }
+                double t = (RAPtor_MPI_Wtime() - t0) / comm_probe_tests;
+                comm->get_buffer<double>().resize(buffer_size);
+                RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &t, 1, RAPtor_MPI_DOUBLE,
+                        RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+                return t;
+            }
+
             void form_rand_weights(int local_n, int first_n)
             {
                 if (local_n == 0) return;
@@ -277,15 +598,16 @@ namespace raptor
                             global_row_indices.data(), coarse_sizes.data(), 
                             coarse_displs.data(), RAPtor_MPI_INT, coarse_comm);
     
-                    std::map<int, int> global_to_local;
-                    int ctr = 0;
-                    for (std::vector<int>::iterator it = global_row_indices.begin();
-                            it != global_row_indices.end(); ++it)
+                    IndexMap global_to_local(global_row_indices);
+
+                    coarse_n = Ac->global_num_rows;
+                    coarse_b.resize(coarse_n);
+                    if (coarse_solve_type != DenseLU)
                     {
-                        global_to_local[*it] = ctr++;
+                        form_sparse_coarse(Ac, global_to_local, num_active);
+                        return;
                     }
 
-                    coarse_n = Ac->global_num_rows;
                     A_coarse_lcl.resize(coarse_n*Ac->local_num_rows, 0);
                     for (int i = 0; i < Ac->local_num_rows; i++)
                     {
@@ -332,20 +654,267 @@ namespace raptor
                 }
             }
 
-            void cycle(ParVector& x, ParVector& b, int level = 0)
+            void form_sparse_coarse(ParCSRMatrix* Ac, const IndexMap& global_to_local,
+                    int num_active)
+            {
+                int start, end;
+                int local_nnz = Ac->on_proc->nnz + Ac->off_proc->nnz;
+
+                // Form local rows of coarse matrix, with columns indexed
+                // by position in the gathered coarse vector
+                std::vector<int> row_sizes(coarse_n + 1);
+                std::vector<int> local_cols(local_nnz);
+                std::vector<double> local_vals(local_nnz);
+                std::vector<int> row_sizes_lcl(Ac->local_num_rows);
+                int ctr = 0;
+                for (int i = 0; i < Ac->local_num_rows; i++)
+                {
+                    row_sizes_lcl[i] = ctr;
+                    start = Ac->on_proc->idx1[i];
+                    end = Ac->on_proc->idx1[i+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        local_cols[ctr] = global_to_local[Ac->on_proc_column_map[
+                            Ac->on_proc->idx2[j]]];
+                        local_vals[ctr++] = Ac->on_proc->vals[j];
+                    }
+
+                    start = Ac->off_proc->idx1[i];
+                    end = Ac->off_proc->idx1[i+1];
+                    for (int j = start; j < end; j++)
+                    {
+                        local_cols[ctr] = global_to_local[Ac->off_proc_column_map[
+                            Ac->off_proc->idx2[j]]];
+                        local_vals[ctr++] = Ac->off_proc->vals[j];
+                    }
+                    row_sizes_lcl[i] = ctr - row_sizes_lcl[i];
+                }
+
+                // Gather row sizes, and then column indices and values
+                RAPtor_MPI_Allgatherv(row_sizes_lcl.data(), Ac->local_num_rows, RAPtor_MPI_INT,
+                        &(row_sizes[1]), coarse_sizes.data(), coarse_displs.data(),
+                        RAPtor_MPI_INT, coarse_comm);
+
+                std::vector<int> nnz_sizes(num_active);
+                std::vector<int> nnz_displs(num_active + 1);
+                RAPtor_MPI_Allgather(&local_nnz, 1, RAPtor_MPI_INT, nnz_sizes.data(), 1,
+                        RAPtor_MPI_INT, coarse_comm);
+                nnz_displs[0] = 0;
+                for (int i = 0; i < num_active; i++)
+                {
+                    nnz_displs[i+1] = nnz_displs[i] + nnz_sizes[i];
+                }
+
+                delete A_coarse_sparse;
+                A_coarse_sparse = new CSRMatrix(coarse_n, coarse_n, nnz_displs[num_active]);
+                CSRMatrix* A_c = A_coarse_sparse;
+                A_c->idx1[0] = 0;
+                for (int i = 0; i < coarse_n; i++)
+                {
+                    A_c->idx1[i+1] = A_c->idx1[i] + row_sizes[i+1];
+                }
+                A_c->nnz = A_c->idx1[coarse_n];
+                A_c->idx2.resize(A_c->nnz);
+                A_c->vals.resize(A_c->nnz);
+                RAPtor_MPI_Allgatherv(local_cols.data(), local_nnz, RAPtor_MPI_INT,
+                        A_c->idx2.data(), nnz_sizes.data(), nnz_displs.data(),
+                        RAPtor_MPI_INT, coarse_comm);
+                RAPtor_MPI_Allgatherv(local_vals.data(), local_nnz, RAPtor_MPI_DOUBLE,
+                        A_c->vals.data(), nnz_sizes.data(), nnz_displs.data(),
+                        RAPtor_MPI_DOUBLE, coarse_comm);
+
+                // Inverse diagonal for Jacobi preconditioning
+                coarse_diag_inv.resize(coarse_n);
+                for (int i = 0; i < coarse_n; i++)
+                {
+                    coarse_diag_inv[i] = 1.0;
+                    for (int j = A_c->idx1[i]; j < A_c->idx1[i+1]; j++)
+                    {
+                        if (A_c->idx2[j] == i)
+                        {
+                            if (fabs(A_c->vals[j]) > zero_tol)
+                                coarse_diag_inv[i] = 1.0 / A_c->vals[j];
+                            break;
+                        }
+                    }
+                }
+
+                // Workspace for redundant Krylov solve (final n values
+                // hold the gathered coarse solution)
+                coarse_work.resize(9 * coarse_n);
+            }
+
+            // Solves A_coarse_sparse * x = b redundantly on every active process
+            // with Jacobi preconditioned CG.  Every active process holds
+            // identical data, so no communication is required.
+            void sparse_coarse_cg(double* b, double* x)
+            {
+                int n = coarse_n;
+                double* r = &(coarse_work[0]);
+                double* z = &(coarse_work[n]);
+                double* p = &(coarse_work[2*n]);
+                double* Ap = &(coarse_work[3*n]);
+                double alpha, beta, rz, next_rz, pAp;
+                double norm_b = 0.0, norm_r;
+
+                for (int i = 0; i < n; i++)
+                {
+                    x[i] = 0.0;
+                    r[i] = b[i];
+                    norm_b += b[i]*b[i];
+                }
+                norm_b = sqrt(norm_b);
+                if (norm_b < zero_tol) return;
+
+                rz = 0.0;
+                for (int i = 0; i < n; i++)
+                {
+                    z[i] = coarse_diag_inv[i] * r[i];
+                    p[i] = z[i];
+                    rz += r[i] * z[i];
+                }
+
+                for (int iter = 0; iter < coarse_max_iterations; iter++)
+                {
+                    A_coarse_sparse->spmv(p, Ap);
+                    pAp = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        pAp += p[i] * Ap[i];
+                    }
+                    if (fabs(pAp) < zero_tol) break;
+                    alpha = rz / pAp;
+
+                    norm_r = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        x[i] += alpha * p[i];
+                        r[i] -= alpha * Ap[i];
+                        norm_r += r[i] * r[i];
+                    }
+                    if (sqrt(norm_r) <= coarse_solve_tol * norm_b) break;
+
+                    next_rz = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        z[i] = coarse_diag_inv[i] * r[i];
+                        next_rz += r[i] * z[i];
+                    }
+                    beta = next_rz / rz;
+                    rz = next_rz;
+                    for (int i = 0; i < n; i++)
+                    {
+                        p[i] = z[i] + beta * p[i];
+                    }
+                }
+            }
+
+            // Solves A_coarse_sparse * x = b redundantly on every active process
+            // with right Jacobi preconditioned BiCGStab
+            void sparse_coarse_bicgstab(double* b, double* x)
             {
-                if (solve_times)
+                int n = coarse_n;
+                double* r = &(coarse_work[0]);
+                double* r_star = &(coarse_work[n]);
+                double* p = &(coarse_work[2*n]);
+                double* v = &(coarse_work[3*n]);
+                double* s = &(coarse_work[4*n]);
+                double* t = &(coarse_work[5*n]);
+                double* p_hat = &(coarse_work[6*n]);
+                double* s_hat = &(coarse_work[7*n]);
+                double alpha, beta, omega, rho, next_rho;
+                double r_star_v, ts, tt;
+                double norm_b = 0.0, norm_r;
+
+                for (int i = 0; i < n; i++)
                 {
-                    init_profile();
+                    x[i] = 0.0;
+                    r[i] = b[i];
+                    r_star[i] = b[i];
+                    p[i] = b[i];
+                    norm_b += b[i]*b[i];
                 }
+                norm_b = sqrt(norm_b);
+                if (norm_b < zero_tol) return;
+                rho = norm_b * norm_b;
 
+                for (int iter = 0; iter < coarse_max_iterations; iter++)
+                {
+                    for (int i = 0; i < n; i++)
+                    {
+                        p_hat[i] = coarse_diag_inv[i] * p[i];
+                    }
+                    A_coarse_sparse->spmv(p_hat, v);
+                    r_star_v = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        r_star_v += r_star[i] * v[i];
+                    }
+                    if (fabs(r_star_v) < zero_tol) break;
+                    alpha = rho / r_star_v;
+
+                    norm_r = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        s[i] = r[i] - alpha * v[i];
+                        norm_r += s[i] * s[i];
+                    }
+                    if (sqrt(norm_r) <= coarse_solve_tol * norm_b)
+                    {
+                        for (int i = 0; i < n; i++)
+                        {
+                            x[i] += alpha * p_hat[i];
+                        }
+                        break;
+                    }
+
+                    for (int i = 0; i < n; i++)
+                    {
+                        s_hat[i] = coarse_diag_inv[i] * s[i];
+                    }
+                    A_coarse_sparse->spmv(s_hat, t);
+                    ts = 0.0;
+                    tt = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        ts += t[i] * s[i];
+                        tt += t[i] * t[i];
+                    }
+                    if (tt < zero_tol) break;
+                    omega = ts / tt;
+
+                    norm_r = 0.0;
+                    next_rho = 0.0;
+                    for (int i = 0; i < n; i++)
+                    {
+                        x[i] += alpha * p_hat[i] + omega * s_hat[i];
+                        r[i] = s[i] - omega * t[i];
+                        norm_r += r[i] * r[i];
+                        next_rho += r_star[i] * r[i];
+                    }
+                    if (sqrt(norm_r) <= coarse_solve_tol * norm_b) break;
+                    if (fabs(omega) < zero_tol) break;
+
+                    beta = (next_rho / rho) * (alpha / omega);
+                    rho = next_rho;
+                    for (int i = 0; i < n; i++)
+                    {
+                        p[i] = r[i] + beta * (p[i] - omega * v[i]);
+                    }
+                }
+            }
+
+            void cycle(ParVector& x, ParVector& b, int level = 0)
+            {
                 ParCSRMatrix* A = levels[level]->A;
                 ParCSRMatrix* P = levels[level]->P;
+                ParCSRMatrix* R = levels[level]->R;
                 ParVector& tmp = levels[level]->tmp;
-                bool tap_level = tap_amg >= 0 && tap_amg <= level;
+                bool tap_level = levels[level]->tap_A;
 
                 if (level == num_levels - 1)
                 {
+                    ScopedTimer t("coarse solve", level);
                     if (A->local_num_rows)
                     {
                         int active_rank;
@@ -355,27 +924,36 @@ namespace raptor
                         int nhrs = 1; // Number of right hand sides
                         int info; // result
 
-                        std::vector<double> b_data(coarse_n);
-                        RAPtor_MPI_Allgatherv(b.local.data(), b.local_n, RAPtor_MPI_DOUBLE, b_data.data(), 
+                        double* b_data = coarse_b.data();
+                        RAPtor_MPI_Allgatherv(b.local.data(), b.local_n, RAPtor_MPI_DOUBLE, b_data, 
                                 coarse_sizes.data(), coarse_displs.data(), 
                                 RAPtor_MPI_DOUBLE, coarse_comm);
 
-                        dgetrs_(&trans, &coarse_n, &nhrs, A_coarse.data(), &coarse_n, 
-                                LU_permute.data(), b_data.data(), &coarse_n, &info);
-                        for (int i = 0; i < b.local_n; i++)
+                        if (coarse_solve_type == DenseLU)
                         {
-                            x.local[i] = b_data[i + coarse_displs[active_rank]];
+                            dgetrs_(&trans, &coarse_n, &nhrs, A_coarse.data(), &coarse_n, 
+                                    LU_permute.data(), b_data, &coarse_n, &info);
+                            for (int i = 0; i < b.local_n; i++)
+                            {
+                                x.local[i] = b_data[i + coarse_displs[active_rank]];
+                            }
+                        }
+                        else
+                        {
+                            double* x_data = &(coarse_work[8*coarse_n]);
+                            if (coarse_solve_type == SparseBiCGStab)
+                            {
+                                sparse_coarse_bicgstab(b_data, x_data);
+                            }
+                            else
+                            {
+                                sparse_coarse_cg(b_data, x_data);
+                            }
+                            for (int i = 0; i < b.local_n; i++)
+                            {
+                                x.local[i] = x_data[i + coarse_displs[active_rank]];
+                            }
                         }
-                    }
-
-                    if (solve_times)
-                    {
-                        finalize_profile();
-                        solve_times[5*level] += total_t;
-                        solve_times[5*level + 1] += collective_t;
-                        solve_times[5*level + 2] += p2p_t;
-                        solve_times[5*level + 3] += vec_t;
-                        solve_times[5*level + 4] += mat_t;
                     }
                 }
                 else
@@ -383,50 +961,54 @@ namespace raptor
                     levels[level+1]->x.set_const_value(0.0);
                     
                     // Relax
-                    switch (relax_type)
                     {
-                        case Jacobi:
-                            jacobi(A, x, b, tmp, num_smooth_sweeps, relax_weight,
-                                    tap_level);
-                            break;
-                        case SOR:
-                            sor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
-                                    tap_level);
-                            break;
-                        case SSOR:
-                            ssor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
-                                    tap_level);
-                            break;
-                        default:
-                            sor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
-                                    tap_level);
-                            break;
+                        ScopedTimer t("relax", level);
+                        switch (relax_type)
+                        {
+                            case Jacobi:
+                                jacobi(A, x, b, tmp, num_smooth_sweeps, relax_weight,
+                                        tap_level);
+                                break;
+                            case SOR:
+                                sor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
+                                        tap_level);
+                                break;
+                            case SSOR:
+                                ssor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
+                                        tap_level);
+                                break;
+                            default:
+                                sor(A, x, b, tmp, num_smooth_sweeps, relax_weight,
+                                        tap_level);
+                                break;
+                        }
                     }
 
-
-                    A->residual(x, b, tmp, tap_level);
-
-                    P->mult_T(tmp, levels[level+1]->b, tap_level);
-
-
-                    if (solve_times)
                     {
-                        finalize_profile();
-                        solve_times[5*level] += total_t;
-                        solve_times[5*level + 1] += collective_t;
-                        solve_times[5*level + 2] += p2p_t;
-                        solve_times[5*level + 3] += vec_t;
-                        solve_times[5*level + 4] += mat_t;
+                        ScopedTimer t("residual", level);
+                        A->residual(x, b, tmp, tap_level);
                     }
-                    cycle(levels[level+1]->x, levels[level+1]->b, level+1);
-                    if (solve_times)
+
                     {
-                        init_profile();
+                        ScopedTimer t("restriction", level);
+                        if (R)
+                        {
+                            R->mult(tmp, levels[level+1]->b, levels[level]->tap_R);
+                        }
+                        else
+                        {
+                            P->mult_T(tmp, levels[level+1]->b, levels[level]->tap_P);
+                        }
                     }
 
+                    cycle(levels[level+1]->x, levels[level+1]->b, level+1);
 
-                    P->mult_append(levels[level+1]->x, x, tap_level);
+                    {
+                        ScopedTimer t("interpolation", level);
+                        P->mult_append(levels[level+1]->x, x, levels[level]->tap_P);
+                    }
 
+                    ScopedTimer t("relax", level);
                     switch (relax_type)
                     {
                         case Jacobi:
@@ -446,15 +1028,6 @@ namespace raptor
                                     tap_level);
                             break;
                      }
-                    if (solve_times)
-                    {
-                        finalize_profile();
-                        solve_times[5*level] += total_t;
-                        solve_times[5*level + 1] += collective_t;
-                        solve_times[5*level + 2] += p2p_t;
-                        solve_times[5*level + 3] += vec_t;
-                        solve_times[5*level + 4] += mat_t;
-                    }
                 }
             }
 
@@ -469,15 +1042,16 @@ namespace raptor
                     residuals.resize(max_iterations + 1);
                 }
 
-                if (track_times)
+                ScopedTimer solve_timer("solve", -1, track_times);
+
+                // Iterate until convergence or max iterations.  The residual
+                // is only needed between cycles, so the finest level's
+                // workspace holds it
+                ParVector& resid = levels[0]->tmp;
                 {
-                    if (!solve_times) solve_times = new double[5*num_levels]();
-                    init_profile();
+                    ScopedTimer t("residual", 0);
+                    levels[0]->A->residual(sol, rhs, resid);
                 }
-
-                // Iterate until convergence or max iterations
-                ParVector resid(rhs.global_n, rhs.local_n);
-                levels[0]->A->residual(sol, rhs, resid);
                 if (fabs(b_norm) > zero_tol)
                 {
                     r_norm = resid.norm(2) / b_norm;
@@ -491,27 +1065,15 @@ namespace raptor
                     residuals[iter] = r_norm;
                 }
 
-                if (track_times)
-                {
-                    finalize_profile();
-                    solve_times[0] += total_t;
-                    solve_times[1] += collective_t;
-                    solve_times[2] += p2p_t;
-                    solve_times[3] += vec_t;
-                    solve_times[4] += mat_t;
-                }
-
                 while (r_norm > solve_tol && iter < max_iterations)
                 {
                     cycle(sol, rhs, 0);
 
-                    if (track_times)
+                    iter++;
                     {
-                        init_profile();
+                        ScopedTimer t("residual", 0);
+                        levels[0]->A->residual(sol, rhs, resid);
                     }
-
-                    iter++;
-                    levels[0]->A->residual(sol, rhs, resid);
                     if (fabs(b_norm) > zero_tol)
                     {
                         r_norm = resid.norm(2) / b_norm;
@@ -524,15 +1086,6 @@ namespace raptor
                     {
                         residuals[iter] = r_norm;
                     }
-                    if (track_times)
-                    {
-                        finalize_profile();
-                        solve_times[0] += total_t;
-                        solve_times[1] += collective_t;
-                        solve_times[2] += p2p_t;
-                        solve_times[3] += vec_t;
-                        solve_times[4] += mat_t;
-                    }
                 }
 
 
@@ -577,52 +1130,199 @@ namespace raptor
                 }
             }
 
-            void print_times(double* times, const char* phase)
+            /**************************************************************
+             *****   Print Times
+             **************************************************************
+             ***** Prints the total and communication times of each level
+             ***** (max over processes), summing the regions of that level
+             ***** directly within the setup or solve region at path
+             **************************************************************/
+            void print_times(const std::string& path, const char* phase)
             {
-                if (times == NULL) return;
+                if (path.empty()) return;
+                TimerRegion* region = timers.find(path);
+                if (region == NULL) return;
 
                 int rank;
                 RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
 
+                const char* labels[5] = {"Total", "Collective", "P2P", "Vec Comm",
+                    "Mat Comm"};
+                double times[5];
                 double max_t;
                 for (int i = 0; i < num_levels; i++)
                 {
+                    for (int j = 0; j < 5; j++)
+                    {
+                        times[j] = 0.0;
+                    }
+                    for (int c = 0; c < (int)region->children.size(); c++)
+                    {
+                        TimerRegion* child = region->children[c];
+                        if (child->level != i) continue;
+                        times[0] += child->time;
+                        for (int j = 0; j < 4; j++)
+                        {
+                            times[j+1] += child->comm_times[j];
+                        }
+                    }
+
                     if (rank == 0) printf("Level %d\n", i);
+                    for (int j = 0; j < 5; j++)
+                    {
+                        RAPtor_MPI_Reduce(&times[j], &max_t, 1, RAPtor_MPI_DOUBLE,
+                                RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
+                        if (rank == 0 && max_t > 0)
+                        {
+                            printf("%s %s Time: %e\n", phase, labels[j], max_t);
+                        }
+                    }
+                }
+            }
 
-                    RAPtor_MPI_Reduce(&times[5*i], &max_t, 1, RAPtor_MPI_DOUBLE, 
-                            RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
-                    if (rank == 0 && max_t > 0) printf("%s Total Time: %e\n", phase, max_t);
+            void print_setup_times()
+            {
+                print_times(setup_path, "Setup");
+            }
+            void print_solve_times()
+            {
+                print_times(solve_path, "Solve");
+            }
 
-                    RAPtor_MPI_Reduce(&times[5*i+1], &max_t, 1, RAPtor_MPI_DOUBLE, 
-                            RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
-                    if (rank == 0 && max_t > 0) printf("%s Collective Time: %e\n", phase, max_t);
+            /**************************************************************
+             *****   Get Comm Stats
+             **************************************************************
+             ***** Returns the statistics of every communicator in the
+             ***** hierarchy (ParComm, and TAPComms if formed, of A, P and
+             ***** R on each level).  Collective, and can be written with
+             ***** write_comm_stats_json or write_comm_stats_csv.
+             **************************************************************/
+            std::vector<CommStats> get_comm_stats()
+            {
+                std::vector<CommStats> stats;
+                for (int i = 0; i < num_levels; i++)
+                {
+                    ParLevel* l = levels[i];
+                    add_comm_stats(stats, i, "A", l->A);
+                    if (l->P) add_comm_stats(stats, i, "P", l->P);
+                    if (l->R) add_comm_stats(stats, i, "R", l->R);
+                }
+                return stats;
+            }
 
-                    RAPtor_MPI_Reduce(&times[5*i+2], &max_t, 1, RAPtor_MPI_DOUBLE, 
-                            RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
-                    if (rank == 0 && max_t > 0) printf("%s P2P Time: %e\n", phase, max_t);
+            void add_comm_stats(std::vector<CommStats>& stats, int level,
+                    const char* name, ParCSRMatrix* M)
+            {
+                if (M->comm) stats.push_back(comm_stats(M->comm, level, name));
+                if (M->tap_comm) stats.push_back(comm_stats(M->tap_comm, level, name));
+                if (M->tap_mat_comm && M->tap_mat_comm != M->tap_comm)
+                {
+                    stats.push_back(comm_stats(M->tap_mat_comm, level, name));
+                }
+            }
 
-                    RAPtor_MPI_Reduce(&times[5*i+3], &max_t, 1, RAPtor_MPI_DOUBLE, 
-                            RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
-                    if (rank == 0 && max_t > 0) printf("%s Vec Comm Time: %e\n", phase, max_t);
+            std::vector<double>& get_residuals()
+            {
+                return residuals;
+            }
 
-                    RAPtor_MPI_Reduce(&times[5*i+4], &max_t, 1, RAPtor_MPI_DOUBLE, 
-                            RAPtor_MPI_MAX, 0, RAPtor_MPI_COMM_WORLD);
-                    if (rank == 0 && max_t > 0) printf("%s Mat Comm Time: %e\n", phase, max_t);
+            double get_sparsify_tol(int level)
+            {
+                if (level < (int) sparsify_level_tols.size())
+                {
+                    return sparsify_level_tols[level];
                 }
+                return sparsify_tol;
             }
 
-            void print_setup_times()
+            /**************************************************************
+             *****   Sparsify Coarse
+             **************************************************************
+             ***** Sparsifies Ac = P^T*(AP), formed with the P and states of
+             ***** level, and records the size and receives of the Galerkin
+             ***** operator on the coarse level.  Called before the ParComm
+             ***** of Ac is formed.
+             **************************************************************/
+            void sparsify_coarse(int level, ParCSRMatrix* AP, ParCSRMatrix* Ac,
+                    const std::vector<int>& states)
             {
-                print_times(setup_times, "Setup");
+                ParLevel* l = levels[level];
+                ParLevel* coarse = levels[level+1];
+                coarse->galerkin_nnz = Ac->local_nnz;
+                coarse->galerkin_recv_size = Ac->off_proc_num_cols;
+                coarse->galerkin_num_recvs = num_recv_procs(Ac);
+
+                ParCSRMatrix* I = form_injection(l->P, states);
+                sparsify(l->A, l->P, I, AP, Ac, get_sparsify_tol(level));
+                delete I;
             }
-            void print_solve_times()
+
+            // Number of processes owning off_proc columns of A
+            int num_recv_procs(ParCSRMatrix* A)
             {
-                print_times(solve_times, "Solve");
+                std::vector<int> col_to_proc;
+                A->partition->form_col_to_proc(A->off_proc_column_map, col_to_proc);
+                int n_procs = 0;
+                for (int i = 0; i < (int) col_to_proc.size(); i++)
+                {
+                    if (i == 0 || col_to_proc[i] != col_to_proc[i-1]) n_procs++;
+                }
+                return n_procs;
             }
 
-            std::vector<double>& get_residuals()
+            /**************************************************************
+             *****   Print Sparsify Stats
+             **************************************************************
+             ***** Prints, for each sparsified level, the global nnz and the
+             ***** max and total receives (values and messages) per SpMV of
+             ***** the Galerkin and sparsified coarse operators, followed by
+             ***** the operator complexity of both hierarchies
+             **************************************************************/
+            void print_sparsify_stats()
             {
-                return residuals;
+                int rank;
+                RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+                long lcl[6], sums[6], maxs[6];
+                long nnz_fine = 0;
+                long nnz_total[2] = {0, 0};
+                if (rank == 0)
+                {
+                    printf("Level\tNNZ (Gal / Sparse)\tMax Recv Size\tTotal Recv Size"
+                            "\tMax Recvs\tTotal Recvs\n");
+                }
+                for (int i = 0; i < num_levels; i++)
+                {
+                    ParLevel* l = levels[i];
+                    ParCSRMatrix* Al = l->A;
+                    bool sparsified = (l->galerkin_nnz >= 0);
+                    lcl[0] = sparsified ? l->galerkin_nnz : Al->local_nnz;
+                    lcl[1] = Al->local_nnz;
+                    lcl[2] = sparsified ? l->galerkin_recv_size : Al->off_proc_num_cols;
+                    lcl[3] = Al->off_proc_num_cols;
+                    lcl[4] = sparsified ? l->galerkin_num_recvs : num_recv_procs(Al);
+                    lcl[5] = num_recv_procs(Al);
+                    RAPtor_MPI_Allreduce(lcl, sums, 6, RAPtor_MPI_LONG, RAPtor_MPI_SUM,
+                            RAPtor_MPI_COMM_WORLD);
+                    RAPtor_MPI_Allreduce(lcl, maxs, 6, RAPtor_MPI_LONG, RAPtor_MPI_MAX,
+                            RAPtor_MPI_COMM_WORLD);
+                    if (i == 0) nnz_fine = sums[0];
+                    nnz_total[0] += sums[0];
+                    nnz_total[1] += sums[1];
+
+                    if (rank == 0)
+                    {
+                        printf("%d\t%ld / %ld\t%ld / %ld\t%ld / %ld\t%ld / %ld\t%ld / %ld\n",
+                                i, sums[0], sums[1], maxs[2], maxs[3], sums[2], sums[3],
+                                maxs[4], maxs[5], sums[4], sums[5]);
+                    }
+                }
+                if (rank == 0 && nnz_fine)
+                {
+                    printf("Operator Complexity (Gal / Sparse): %e / %e\n",
+                            ((double) nnz_total[0]) / nnz_fine,
+                            ((double) nnz_total[1]) / nnz_fine);
+                }
             }
 
             strength_t strength_type;
@@ -632,14 +1332,22 @@ namespace raptor
             int max_coarse;
             int max_levels;
             int tap_amg;
+            comm_select_t comm_select;
+            CommModel comm_model;
+            int comm_probe_tests;
             int max_iterations;
 
             double strong_threshold;
             double relax_weight;
             double sparsify_tol;
+            std::vector<double> sparsify_level_tols;
             double solve_tol;
 
             bool store_residuals;
+            bool store_restriction;
+            int sell_chunk_size;
+            int sell_sort_scope;
+            bool tap_shared_memory;
 
             double* weights;
             std::vector<double> residuals;
@@ -650,11 +1358,19 @@ namespace raptor
             int num_variables;
             
             bool track_times;
-            double* setup_times;
-            double* solve_times;
+            std::string setup_path;
+            std::string solve_path;
+
+            coarse_solve_t coarse_solve_type;
+            double coarse_solve_tol;
+            int coarse_max_iterations;
 
             int coarse_n;
             std::vector<double> A_coarse;
+            CSRMatrix* A_coarse_sparse;
+            std::vector<double> coarse_diag_inv;
+            std::vector<double> coarse_work;
+            std::vector<double> coarse_b;
             std::vector<int> coarse_sizes;
             std::vector<int> coarse_displs;
             RAPtor_MPI_Comm coarse_comm;
@@ -4,6 +4,56 @@
 
 namespace raptor {
 
+/**************************************************************
+*****   Form Injection
+**************************************************************
+***** Returns the injection I from the coarse points of states to
+***** the fine level, with the rows, columns and partition of P
+**************************************************************/
+ParCSRMatrix* form_injection(ParCSRMatrix* P, const std::vector<int>& states)
+{
+    ParCSRMatrix* I = new ParCSRMatrix(P->partition, P->global_num_rows,
+            P->global_num_cols, P->local_num_rows, P->on_proc_num_cols, 0);
+    I->local_row_map = P->local_row_map;
+    I->on_proc_column_map = P->on_proc_column_map;
+    I->on_proc_num_cols = P->on_proc_num_cols;
+    I->off_proc_num_cols = 0;
+
+    int ctr = 0;
+    I->on_proc->idx1[0] = 0;
+    I->off_proc->idx1[0] = 0;
+    for (int i = 0; i < P->local_num_rows; i++)
+    {
+        if (states[i] == Selected)
+        {
+            I->on_proc->idx2.emplace_back(ctr++);
+            I->on_proc->vals.emplace_back(1.0);
+        }
+        I->on_proc->idx1[i+1] = I->on_proc->idx2.size();
+        I->off_proc->idx1[i+1] = 0;
+    }
+    I->on_proc->nnz = I->on_proc->idx2.size();
+    I->off_proc->nnz = 0;
+    I->on_proc->n_cols = I->on_proc_num_cols;
+    I->off_proc->n_cols = 0;
+    I->local_nnz = I->on_proc->nnz;
+
+    I->comm = new ParComm(I->partition, I->off_proc_column_map,
+            I->on_proc_column_map);
+
+    return I;
+}
+
+/**************************************************************
+*****   Sparsify
+**************************************************************
+***** Non-Galerkin sparsification of the coarse operator Ac = 
+***** P^T A P.  Entries outside the minimal pattern M = I^T A P + 
+***** P^T A I (I is the injection to the coarse points) that are
+***** smaller than theta times the largest off-diagonal of their
+***** row are lumped into the diagonal.  The off_proc columns and
+***** ParComm of Ac are condensed to the remaining entries.
+**************************************************************/
 void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I, 
         ParCSRMatrix* AP, ParCSRMatrix* Ac, const double theta)
 {
@@ -16,12 +66,6 @@ void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I,
     delete M1;
     delete M2;
 
-    int nnz;
-    int rank;
-    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
-    RAPtor_MPI_Reduce(&M->local_nnz, &nnz, 1, RAPtor_MPI_INT, RAPtor_MPI_SUM, 0, RAPtor_MPI_COMM_WORLD);
-    if (rank == 0) printf("NNZ %d\n", nnz);
-
     int diag_pos, ctr_on, ctr_off;
     int start_on, start_off;
     int end_on, end_off;
@@ -83,7 +127,7 @@ void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I,
         // For each val in row, check if in M, or if greater than theta*row_max
         ctr_M = M->on_proc->idx1[i];
         end_M = M->on_proc->idx1[i+1];
-        if (M->on_proc->idx2[ctr_M] == i)
+        if (ctr_M < end_M && M->on_proc->idx2[ctr_M] == i)
         {
             ctr_M++;
         }
@@ -151,6 +195,10 @@ void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I,
     Ac->on_proc->nnz = ctr_on;
     Ac->off_proc->nnz = ctr_off;
     Ac->local_nnz = ctr_on + ctr_off;
+    Ac->on_proc->idx2.resize(ctr_on);
+    Ac->on_proc->vals.resize(ctr_on);
+    Ac->off_proc->idx2.resize(ctr_off);
+    Ac->off_proc->vals.resize(ctr_off);
 
     std::vector<int> off_proc_col_to_new;
     if (Ac->off_proc_num_cols)
@@ -168,6 +216,7 @@ void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I,
     }
     Ac->off_proc_column_map.resize(ctr);
     Ac->off_proc_num_cols = ctr;
+    Ac->off_proc->n_cols = ctr;
 
     for (std::vector<int>::iterator it = Ac->off_proc->idx2.begin();
             it != Ac->off_proc->idx2.end(); ++it)
@@ -175,10 +224,14 @@ void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I,
         *it = off_proc_col_to_new[*it];
     }
 
-    // Update communicate package (only recv if off proc col exists)
+    // Communication package only receives remaining off_proc columns
     if (Ac->comm)
     {
-        Ac->comm->update(off_proc_col_exists);
+        int key = Ac->comm->key;
+        RAPtor_MPI_Comm mpi_comm = Ac->comm->mpi_comm;
+        Ac->comm->delete_comm();
+        Ac->comm = new ParComm(Ac->partition, Ac->off_proc_column_map,
+                Ac->on_proc_column_map, key, mpi_comm);
     }
 
     delete M;
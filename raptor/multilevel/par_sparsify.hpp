@@ -8,6 +8,8 @@
 
 namespace raptor {
 
+ParCSRMatrix* form_injection(ParCSRMatrix* P, const std::vector<int>& states);
+
 void sparsify(ParCSRMatrix* A, ParCSRMatrix* P, ParCSRMatrix* I, 
         ParCSRMatrix* AP, ParCSRMatrix* Ac, const double theta = 0.1);
 
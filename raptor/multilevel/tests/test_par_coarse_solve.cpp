@@ -0,0 +1,63 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+TEST(ParCoarseSolveTest, TestsInMultilevel)
+{
+    int dim = 3;
+    int grid[3] = {10, 10, 10};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, dim);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+
+    coarse_solve_t coarse_types[3] = {DenseLU, SparseCG, SparseBiCGStab};
+    int iters[3];
+    for (int i = 0; i < 3; i++)
+    {
+        ParMultilevel* ml = new ParRugeStubenSolver(0.25, Falgout, ModClassical);
+        ml->max_coarse = 200;
+        ml->coarse_solve_type = coarse_types[i];
+        ml->setup(A);
+        if (i > 0)
+        {
+            ASSERT_EQ(ml->A_coarse.size(), 0);
+        }
+
+        x.set_const_value(1.0);
+        A->mult(x, b);
+        x.set_const_value(0.0);
+        iters[i] = ml->solve(x, b);
+
+        std::vector<double>& res = ml->get_residuals();
+        ASSERT_LT(res[iters[i]], ml->solve_tol);
+        for (int j = 0; j < x.local_n; j++)
+        {
+            ASSERT_NEAR(x.local[j], 1.0, 1e-05);
+        }
+
+        delete ml;
+    }
+
+    // Tight sparse coarse solves should match the direct solve
+    ASSERT_EQ(iters[0], iters[1]);
+    ASSERT_EQ(iters[0], iters[2]);
+
+    delete A;
+
+} // end of TEST(ParCoarseSolveTest, TestsInMultilevel) //
@@ -0,0 +1,151 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+// Each level holds the communicators its flags select
+void check_levels(ParMultilevel* ml)
+{
+    for (int i = 0; i < ml->num_levels - 1; i++)
+    {
+        ParLevel* l = ml->levels[i];
+        if (l->tap_A)
+        {
+            ASSERT_TRUE(l->A->tap_comm != NULL);
+        }
+        if (l->tap_AP)
+        {
+            ASSERT_TRUE(l->A->tap_mat_comm != NULL);
+        }
+        if (l->tap_P)
+        {
+            ASSERT_TRUE(l->P->tap_comm != NULL);
+        }
+        if (l->tap_PTAP)
+        {
+            ASSERT_TRUE(l->P->tap_mat_comm != NULL);
+        }
+        if (l->tap_R)
+        {
+            ASSERT_TRUE(l->R->tap_comm != NULL);
+        }
+    }
+}
+
+void compare_solves(ParCSRMatrix* A, ParMultilevel* ml, ParMultilevel* ml_sel)
+{
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    b.set_const_value(1.0);
+
+    ml->setup(A);
+    ml_sel->setup(A);
+    ASSERT_EQ(ml->num_levels, ml_sel->num_levels);
+    check_levels(ml_sel);
+
+    x.set_const_value(0.0);
+    int iter = ml->solve(x, b);
+    x.set_const_value(0.0);
+    int iter_sel = ml_sel->solve(x, b);
+    ASSERT_EQ(iter, iter_sel);
+    for (int i = 0; i <= iter; i++)
+    {
+        ASSERT_NEAR(ml->residuals[i], ml_sel->residuals[i],
+                1e-8 * ml->residuals[0]);
+    }
+}
+
+TEST(ParCommSelectTest, TestsInMultilevel)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    // Two processes per node, so TAP communication has inter-node steps
+    setenv("PPN", "2", 1);
+
+    int grid[3] = {10, 10, 10};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    // Modeled times are consistent across processes
+    A->comm = new ParComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map);
+    TAPComm* tap3 = new TAPComm(A->partition, A->off_proc_column_map,
+            A->on_proc_column_map, true);
+    CommModel model;
+    double t_par = A->comm->model_time(model, sizeof(double));
+    double t_tap = tap3->model_time(model, sizeof(double));
+    double t_max;
+    MPI_Allreduce(&t_tap, &t_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    ASSERT_GE(t_par, 0.0);
+    ASSERT_EQ(t_tap, t_max);
+    if (num_procs == 1)
+    {
+        ASSERT_EQ(t_par, 0.0);
+    }
+    delete tap3;
+
+    // Model and timing probe, Ruge-Stuben with and without R
+    comm_select_t selects[2] = {ModelComm, TimedComm};
+    for (int s = 0; s < 2; s++)
+    {
+        for (int store_R = 0; store_R < 2; store_R++)
+        {
+            ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended,
+                    Classical, SOR);
+            ParMultilevel* ml_sel = new ParRugeStubenSolver(0.25, HMIS, Extended,
+                    Classical, SOR);
+            ml->store_restriction = store_R;
+            ml_sel->store_restriction = store_R;
+            ml_sel->comm_select = selects[s];
+            ml_sel->tap_shared_memory = store_R;
+            compare_solves(A, ml, ml_sel);
+            delete ml_sel;
+            delete ml;
+        }
+
+        ParMultilevel* ml = new ParSmoothedAggregationSolver(0.0);
+        ParMultilevel* ml_sel = new ParSmoothedAggregationSolver(0.0);
+        ml_sel->comm_select = selects[s];
+        compare_solves(A, ml, ml_sel);
+        delete ml_sel;
+        delete ml;
+    }
+
+    // Only intra-node messages cost : standard communication is never slower
+    ParMultilevel* ml = new ParRugeStubenSolver(0.25, HMIS, Extended,
+            Classical, SOR);
+    ml->comm_select = ModelComm;
+    ml->comm_model.local_alpha = 1.0;
+    ml->comm_model.local_beta = 0.0;
+    ml->comm_model.global_alpha = 0.0;
+    ml->comm_model.global_beta = 0.0;
+    ml->comm_model.node_beta = 0.0;
+    ml->setup(A);
+    for (int i = 0; i < ml->num_levels - 1; i++)
+    {
+        ParLevel* l = ml->levels[i];
+        ASSERT_FALSE(l->tap_A || l->tap_P || l->tap_AP || l->tap_PTAP);
+    }
+    delete ml;
+
+    delete A;
+
+    setenv("PPN", "16", 1);
+
+} // end of TEST(ParCommSelectTest, TestsInMultilevel) //
+
@@ -0,0 +1,91 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+TEST(ParRestrictionTest, TestsInMultilevel)
+{
+    int dim = 3;
+    int grid[3] = {10, 10, 10};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, dim);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+
+    for (int tap = 0; tap < 2; tap++)
+    {
+        ParMultilevel* ml = new ParRugeStubenSolver(0.25, Falgout, ModClassical);
+        ParMultilevel* ml_R = new ParRugeStubenSolver(0.25, Falgout, ModClassical);
+        ml_R->store_restriction = true;
+        if (tap)
+        {
+            ml->tap_amg = 0;
+            ml_R->tap_amg = 0;
+        }
+        ml->setup(A);
+        ml_R->setup(A);
+        ASSERT_EQ(ml->num_levels, ml_R->num_levels);
+
+        // Restriction with R must match transpose multiplication with P
+        for (int i = 0; i < ml_R->num_levels - 1; i++)
+        {
+            ParCSRMatrix* P = ml_R->levels[i]->P;
+            ParCSRMatrix* R = ml_R->levels[i]->R;
+            ASSERT_TRUE(ml->levels[i]->R == NULL);
+            ASSERT_EQ(R->global_num_rows, P->global_num_cols);
+            ASSERT_EQ(R->global_num_cols, P->global_num_rows);
+            ASSERT_EQ(R->local_num_rows, P->on_proc_num_cols);
+
+            ParVector& r = ml_R->levels[i]->tmp;
+            ParVector& b_P = ml->levels[i+1]->b;
+            ParVector& b_R = ml_R->levels[i+1]->b;
+            for (int j = 0; j < r.local_n; j++)
+            {
+                r.local[j] = (r.local_n - j) * 0.1;
+            }
+            P->mult_T(r, b_P);
+            R->mult(r, b_R);
+            for (int j = 0; j < b_R.local_n; j++)
+            {
+                ASSERT_NEAR(b_P.local[j], b_R.local[j], 1e-10);
+            }
+        }
+
+        // Solves with and without stored restriction must agree
+        x.set_const_value(1.0);
+        A->mult(x, b);
+        x.set_const_value(0.0);
+        int iter = ml->solve(x, b);
+        std::vector<double>& res = ml->get_residuals();
+
+        x.set_const_value(0.0);
+        int iter_R = ml_R->solve(x, b);
+        std::vector<double>& res_R = ml_R->get_residuals();
+
+        ASSERT_EQ(iter, iter_R);
+        for (int i = 0; i <= iter; i++)
+        {
+            ASSERT_NEAR(res[i], res_R[i], 1e-10);
+        }
+
+        delete ml;
+        delete ml_R;
+    }
+
+    delete A;
+
+} // end of TEST(ParRestrictionTest, TestsInMultilevel) //
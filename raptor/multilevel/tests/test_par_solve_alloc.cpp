@@ -0,0 +1,129 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+
+#include <new>
+#include <cstdlib>
+#include <string>
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+// Counts heap allocations (through the replaced global operator new,
+// which the library also uses) while count_allocs is set
+static bool count_allocs = false;
+static long num_allocs = 0;
+
+// The replacements pair malloc with free, but once GCC inlines them it sees
+// free() applied to the result of operator new and raises
+// -Wmismatched-new-delete at every delete in this file
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(std::size_t size)
+{
+    if (count_allocs) num_allocs++;
+    void* ptr = malloc(size);
+    if (ptr == NULL) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept
+{
+    free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp=RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+TEST(ParSolveAllocTest, TestsInMultilevel)
+{
+    // Emulate two processes per node, so TAP levels have inter-node steps
+    const char* old_ppn = getenv("PPN");
+    std::string saved_ppn = old_ppn ? old_ppn : "";
+    setenv("PPN", "2", 1);
+
+    int grid[3] = {10, 10, 10};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+    x.set_const_value(1.0);
+    A->mult(x, b);
+
+    for (int config = 0; config < 5; config++)
+    {
+        ParMultilevel* ml;
+        if (config == 3)
+        {
+            ml = new ParSmoothedAggregationSolver(0.0);
+        }
+        else
+        {
+            ml = new ParRugeStubenSolver(0.25, HMIS, Extended, Classical,
+                    (relax_t) (config % 3));
+        }
+        // Dense / sparse coarse solves, explicit / transpose restriction,
+        // standard / TAP / shared memory / model communication, and SELL
+        switch (config)
+        {
+            case 1:
+                ml->coarse_solve_type = SparseCG;
+                ml->store_restriction = true;
+                ml->max_coarse = 100;
+                break;
+            case 2:
+                ml->coarse_solve_type = SparseBiCGStab;
+                ml->tap_amg = 0;
+                ml->max_coarse = 100;
+                break;
+            case 3:
+                ml->tap_amg = 0;
+                ml->tap_shared_memory = true;
+                break;
+            case 4:
+                ml->sell_chunk_size = 8;
+                ml->comm_select = ModelComm;
+                break;
+        }
+        ml->setup(A);
+
+        for (int test = 0; test < 2; test++)
+        {
+            x.set_const_value(0.0);
+            count_allocs = true;
+            num_allocs = 0;
+            int iter = ml->solve(x, b);
+            count_allocs = false;
+
+            // No allocations in cycles or residuals, from the first solve on
+            ASSERT_EQ(num_allocs, 0);
+            ASSERT_GT(iter, 0);
+            ASSERT_LT(ml->get_residuals()[iter], ml->solve_tol);
+        }
+        delete ml;
+    }
+    delete A;
+
+    if (old_ppn) setenv("PPN", saved_ppn.c_str(), 1);
+    else unsetenv("PPN");
+
+} // end of TEST(ParSolveAllocTest, TestsInMultilevel) //
@@ -1,6 +1,7 @@
 // Copyright (c) 2015-2017, RAPtor Developer Team
 // License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
 
+#include <set>
 #include "gtest/gtest.h"
 #include "raptor/raptor.hpp"
 #include "raptor/tests/par_compare.hpp"
@@ -31,7 +32,6 @@ TEST(ParSparsifyTest, TestsInMultilevel)
     MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
 
     FILE* f;
-    int cf;
 
     ParCSRMatrix* A;
     std::vector<int> states;
@@ -45,8 +45,6 @@ TEST(ParSparsifyTest, TestsInMultilevel)
     const char* A0_fn = "../../../../test_data/rss_A0.pm";
     const char* weight_fn = "../../../../test_data/weights.txt";
     const char* cf0_fn = "../../../../test_data/rss_cf0.txt";
-    const char* A1_fn = "../../../../test_data/rss_A1.pm";
-    const char* A1_hgal_fn = "../../../../test_data/rss_A1_hgal.pm";
 
     A = readParMatrix(A0_fn);
     S = A->strength(Classical, 0.25);
@@ -78,44 +76,82 @@ TEST(ParSparsifyTest, TestsInMultilevel)
 
     P = mod_classical_interpolation(A, S, states, S->comm->recv_data->int_buffer);
 
-    std::vector<int> first_rows(num_procs+1);
-    first_rows[0] = 0;
-    MPI_Allgather(&P->on_proc_num_cols, 1, MPI_INT, &first_rows[1], 1, MPI_INT, MPI_COMM_WORLD);
-    for (int i = 0; i < num_procs; i++)
-    {
-        first_rows[i+1] += first_rows[i];
-    }
-
     ParCSRMatrix* AP = A->mult(P);
     Ac = AP->mult_T(P);
+    Ac->sort();
+    Ac->on_proc->move_diag();
     Ac->comm = new ParComm(Ac->partition, Ac->off_proc_column_map, Ac->on_proc_column_map);
-    Ac_rap = readParMatrix(A1_hgal_fn, Ac->local_num_rows, Ac->on_proc_num_cols, 
-            first_rows[rank], first_rows[rank]);
+    Ac_rap = Ac->copy();
 
+    I = form_injection(P, states);
+    sparsify(A, P, I, AP, Ac, 0.1);
 
-    I = new ParCSRMatrix(P->partition, P->global_num_rows, P->global_num_cols,
-            P->local_num_rows, P->on_proc_num_cols, 0);
-    I->on_proc->idx1[0] = 0;
-    I->off_proc->idx1[0] = 0;
-    int ctr = 0;
-    for (int i = 0; i < P->local_num_rows; i++)
+    // Sparsified rows are subsets of Galerkin rows with the same row sums,
+    // and dropped entries are small relative to the row
+    long nnz[2] = {Ac_rap->local_nnz, Ac->local_nnz};
+    for (int i = 0; i < Ac->local_num_rows; i++)
     {
-        if (states[i])
+        std::map<int, double> row;
+        double row_max = 0.0;
+        double row_sum = 0.0;
+        for (int j = Ac_rap->on_proc->idx1[i]; j < Ac_rap->on_proc->idx1[i+1]; j++)
         {
-            I->on_proc->idx2.push_back(ctr++);
-            I->on_proc->vals.push_back(1.0);
+            int col = Ac_rap->on_proc_column_map[Ac_rap->on_proc->idx2[j]];
+            row[col] = Ac_rap->on_proc->vals[j];
+            row_sum += Ac_rap->on_proc->vals[j];
+            if (col != Ac_rap->local_row_map[i] && fabs(row[col]) > row_max)
+                row_max = fabs(row[col]);
+        }
+        for (int j = Ac_rap->off_proc->idx1[i]; j < Ac_rap->off_proc->idx1[i+1]; j++)
+        {
+            int col = Ac_rap->off_proc_column_map[Ac_rap->off_proc->idx2[j]];
+            row[col] = Ac_rap->off_proc->vals[j];
+            row_sum += Ac_rap->off_proc->vals[j];
+            if (fabs(row[col]) > row_max) row_max = fabs(row[col]);
         }
-        I->on_proc->idx1[i+1] = I->on_proc->idx2.size();
-        I->off_proc->idx1[i+1] = 0;
-    }
-    I->on_proc->nnz = I->on_proc->idx2.size();
-    I->off_proc->nnz = 0;
-    I->finalize();
 
-    printf("%d, %d\n", Ac->off_proc_num_cols, Ac_rap->off_proc_num_cols);
-    sparsify(A, P, I, AP, Ac, 0.1);
-    printf("%d, %d\n", Ac->off_proc_num_cols, Ac_rap->off_proc_num_cols);
-    //compare(Ac, Ac_rap);
+        double sparse_sum = 0.0;
+        std::set<int> kept;
+        for (int j = Ac->on_proc->idx1[i]; j < Ac->on_proc->idx1[i+1]; j++)
+        {
+            int col = Ac->on_proc_column_map[Ac->on_proc->idx2[j]];
+            ASSERT_TRUE(row.count(col));
+            if (col != Ac->local_row_map[i])
+            {
+                ASSERT_NEAR(row[col], Ac->on_proc->vals[j], 1e-12);
+            }
+            sparse_sum += Ac->on_proc->vals[j];
+            kept.insert(col);
+        }
+        for (int j = Ac->off_proc->idx1[i]; j < Ac->off_proc->idx1[i+1]; j++)
+        {
+            int col = Ac->off_proc_column_map[Ac->off_proc->idx2[j]];
+            ASSERT_TRUE(row.count(col));
+            ASSERT_NEAR(row[col], Ac->off_proc->vals[j], 1e-12);
+            sparse_sum += Ac->off_proc->vals[j];
+            kept.insert(col);
+        }
+        ASSERT_NEAR(row_sum, sparse_sum, 1e-10);
+
+        for (std::map<int, double>::iterator it = row.begin(); it != row.end(); ++it)
+        {
+            if (!kept.count(it->first))
+            {
+                ASSERT_LT(fabs(it->second), 0.1 * row_max);
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, nnz, 2, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    ASSERT_LT(nnz[1], nnz[0]);
+
+    // Off_proc columns and communication package are condensed
+    ASSERT_LE(Ac->off_proc_num_cols, Ac_rap->off_proc_num_cols);
+    ASSERT_EQ(Ac->comm->recv_data->size_msgs, Ac->off_proc_num_cols);
+    std::vector<bool> col_used(Ac->off_proc_num_cols, false);
+    for (int j = 0; j < Ac->off_proc->nnz; j++)
+        col_used[Ac->off_proc->idx2[j]] = true;
+    for (int j = 0; j < Ac->off_proc_num_cols; j++)
+        ASSERT_TRUE(col_used[j]);
 
     delete AP;
     delete P;
@@ -125,5 +161,57 @@ TEST(ParSparsifyTest, TestsInMultilevel)
     delete S;
     delete A;
 
-} // end of TEST(ParAMGTest, TestsInMultilevel) //
+} // end of TEST(ParSparsifyTest, TestsInMultilevel) //
 
+
+TEST(ParSparsifyTest, TestsInSolver)
+{
+    int grid[3] = {15, 15, 15};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+
+    long coarse_nnz[2];
+    for (int t = 0; t < 2; t++)
+    {
+        ParRugeStubenSolver* ml = new ParRugeStubenSolver(0.25, HMIS, Extended,
+                Classical, SOR);
+        if (t == 1)
+        {
+            ml->sparsify_tol = 0.01;
+            ml->sparsify_level_tols.push_back(0.0); // first level Galerkin
+        }
+        ml->setup(A);
+
+        coarse_nnz[t] = 0;
+        for (int i = 1; i < ml->num_levels; i++)
+        {
+            coarse_nnz[t] += ml->levels[i]->A->local_nnz;
+            if (t == 0 || i == 1)
+            {
+                ASSERT_EQ(ml->levels[i]->galerkin_nnz, -1);
+            }
+            else
+            {
+                ASSERT_LE(ml->levels[i]->A->local_nnz, ml->levels[i]->galerkin_nnz);
+                ASSERT_EQ(ml->levels[i]->A->comm->recv_data->size_msgs,
+                        ml->levels[i]->A->off_proc_num_cols);
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &coarse_nnz[t], 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+        x.set_const_value(1.0);
+        A->mult(x, b);
+        x.set_const_value(0.0);
+        int iter = ml->solve(x, b);
+        ASSERT_LT(iter, ml->max_iterations);
+
+        delete ml;
+    }
+    ASSERT_LT(coarse_nnz[1], coarse_nnz[0]);
+
+    delete A;
+} // end of TEST(ParSparsifyTest, TestsInSolver) //
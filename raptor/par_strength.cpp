@@ -2,328 +2,182 @@
 // License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
 
 #include "core/par_matrix.hpp"
+#include "core/threads.hpp"
 
 using namespace raptor;
 
 // Declare Private Methods
-ParCSRMatrix* classical_strength(ParCSRMatrix* A, double theta, bool tap_amg, int num_variables,
-        int* variables);
-ParCSRMatrix* symmetric_strength(ParCSRMatrix* A, double theta, bool tap_amg);
-
+ParCSRMatrix* classical_strength(ParCSRMatrix* A, double theta, bool tap_amg,
+        int num_variables, int* variables, bool pattern_only);
+ParCSRMatrix* symmetric_strength(ParCSRMatrix* A, double theta, bool tap_amg,
+        bool pattern_only);
+double row_threshold(const ParCSRMatrix* A, int row, int row_start_on, double sign,
+        double theta, int num_variables, const int* variables, const int* off_variables);
+
+// Returns the diagonal of row, and moves row_start_on past it
+// (A is sorted with the diagonal first)
+inline double row_diag(const ParCSRMatrix* A, int row, int& row_start_on)
+{
+    if (row_start_on < A->on_proc->idx1[row+1] && A->on_proc->idx2[row_start_on] == row)
+    {
+        return A->on_proc->vals[row_start_on++];
+    }
+    return 0.0;
+}
 
-ParCSRMatrix* classical_strength(ParCSRMatrix* A, double theta, bool tap_amg, int num_variables,
-        int* variables)
+/**************************************************************
+*****   Row Threshold
+**************************************************************
+***** Returns theta times the largest entry in row (among those
+***** of the same variable, if num_variables > 1), after scaling
+***** by -sign (sign is that of the diagonal), so that an entry
+***** val is strong if sign * val < threshold.
+**************************************************************/
+double row_threshold(const ParCSRMatrix* A, int row, int row_start_on, double sign,
+        double theta, int num_variables, const int* variables, const int* off_variables)
 {
-    int row_start_on, row_end_on;
-    int row_start_off, row_end_off;
     int col;
     double val;
-    double row_scale;
-    double threshold;
-    double diag;
+    double row_scale = RAND_MAX;
 
-    CommPkg* comm = A->comm;
-    if (tap_amg)
+    for (int j = row_start_on; j < A->on_proc->idx1[row+1]; j++)
     {
-        comm = A->tap_comm;
+        if (num_variables > 1)
+        {
+            col = A->on_proc->idx2[j];
+            if (variables[row] != variables[col]) continue;
+        }
+        val = sign * A->on_proc->vals[j];
+        if (val < row_scale)
+        {
+            row_scale = val;
+        }
     }
-
-    ParCSRMatrix* S = new ParCSRMatrix(A->partition, A->global_num_rows, A->global_num_cols,
-            A->local_num_rows, A->on_proc_num_cols, A->off_proc_num_cols);
-    
-    int* off_variables = NULL;
-    if (num_variables > 1)
+    for (int j = A->off_proc->idx1[row]; j < A->off_proc->idx1[row+1]; j++)
     {
-        std::vector<int>& recvbuf = comm->communicate(variables);
-        off_variables = recvbuf.data();
+        if (num_variables > 1)
+        {
+            col = A->off_proc->idx2[j];
+            if (variables[row] != off_variables[col]) continue;
+        }
+        val = sign * A->off_proc->vals[j];
+        if (val < row_scale)
+        {
+            row_scale = val;
+        }
     }
 
-    // A and S will be sorted 
-    A->sort();
-    A->on_proc->move_diag();
-    
-    if (A->on_proc->nnz)
+    // Multiply row max magnitude by theta
+    return row_scale * theta;
+}
+
+
+/**************************************************************
+*****   Form Strength Rows
+**************************************************************
+***** Forms S, sharing the maps and communicators of A, with
+***** add_row(i, on_idx2, on_vals, off_idx2, off_vals), which
+***** appends the diagonal and strong connections of row i to the
+***** given buffers (values only if pattern_only is false).  S is
+***** sorted with the diagonal first.
+*****
+***** Rows are independent, so large matrices are split among 
+***** threads by nonzeros.  Each thread forms its rows in its own
+***** buffers, which are then copied into place.
+**************************************************************/
+template <typename RowFunc>
+ParCSRMatrix* form_strength_rows(ParCSRMatrix* A, bool pattern_only,
+        RowFunc add_row)
+{
+    int n_rows = A->local_num_rows;
+    ParCSRMatrix* S = new ParCSRMatrix(A->partition, A->global_num_rows,
+            A->global_num_cols, n_rows, A->on_proc_num_cols, A->off_proc_num_cols);
+    std::vector<int>& on_sizes = S->on_proc->idx1;
+    std::vector<int>& off_sizes = S->off_proc->idx1;
+
+    auto add_rows = [&](int start, int end, std::vector<int>& on_idx2,
+            std::vector<double>& on_vals, std::vector<int>& off_idx2,
+            std::vector<double>& off_vals)
     {
-        S->on_proc->idx2.resize(A->on_proc->nnz);
-        S->on_proc->vals.resize(A->on_proc->nnz);
-    }
-    if (A->off_proc->nnz)
+        for (int i = start; i < end; i++)
+        {
+            int on_size = on_idx2.size();
+            int off_size = off_idx2.size();
+            add_row(i, on_idx2, on_vals, off_idx2, off_vals);
+            on_sizes[i+1] = on_idx2.size() - on_size;
+            off_sizes[i+1] = off_idx2.size() - off_size;
+        }
+    };
+
+    int n_threads = work_threads(A->on_proc->nnz + A->off_proc->nnz);
+    if (n_threads == 1)
     {
-        S->off_proc->idx2.resize(A->off_proc->nnz);
-        S->off_proc->vals.resize(A->off_proc->nnz);
+        add_rows(0, n_rows, S->on_proc->idx2, S->on_proc->vals,
+                S->off_proc->idx2, S->off_proc->vals);
     }
-
-    S->on_proc->idx1[0] = 0;
-    S->off_proc->idx1[0] = 0;
-    S->on_proc->nnz = 0;
-    S->off_proc->nnz = 0;
-    for (int i = 0; i < A->local_num_rows; i++)
+    else
     {
-        row_start_on = A->on_proc->idx1[i];
-        row_end_on = A->on_proc->idx1[i+1];
-        row_start_off = A->off_proc->idx1[i];
-        row_end_off = A->off_proc->idx1[i+1];
-        if (row_end_on - row_start_on || row_end_off - row_start_off)
+        std::vector<std::vector<int> > on_idx2(n_threads);
+        std::vector<std::vector<double> > on_vals(n_threads);
+        std::vector<std::vector<int> > off_idx2(n_threads);
+        std::vector<std::vector<double> > off_vals(n_threads);
+        std::vector<int> on_ptr(n_threads + 1, 0);
+        std::vector<int> off_ptr(n_threads + 1, 0);
+
+        RAPTOR_OMP(omp parallel num_threads(n_threads))
         {
-            if (A->on_proc->idx2[row_start_on] == i)
-            {
-                diag = A->on_proc->vals[row_start_on];
-                row_start_on++;
-            }
-            else
-            {
-                diag = 0.0;
-            }
+            int tid = thread_id();
+            int start, end;
+            thread_range(A->on_proc->idx1, n_rows, tid, team_size(), start, end);
 
-            // Find value with max magnitude in row
-            if (num_variables == 1)
-            {
-                if (diag < 0.0)
-                {
-                    row_scale = -RAND_MAX; 
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        val = A->on_proc->vals[j];
-                        if (val > row_scale)
-                        {
-                            row_scale = val;
-                        }
-                    }    
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        val = A->off_proc->vals[j];
-                        if (val > row_scale)
-                        {
-                            row_scale = val;
-                        }
-                    } 
-                }
-                else
-                {
-                    row_scale = RAND_MAX;
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        val = A->on_proc->vals[j];
-                        if (val < row_scale)
-                        {
-                            row_scale = val;
-                        }
-                    }    
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        val = A->off_proc->vals[j];
-                        if (val < row_scale)
-                        {
-                            row_scale = val;
-                        }
-                    } 
-                }
-            }
-            else
+            add_rows(start, end, on_idx2[tid], on_vals[tid], off_idx2[tid],
+                    off_vals[tid]);
+            on_ptr[tid+1] = on_idx2[tid].size();
+            off_ptr[tid+1] = off_idx2[tid].size();
+
+            RAPTOR_OMP(omp barrier)
+            RAPTOR_OMP(omp single)
             {
-                if (diag < 0.0)
+                for (int t = 0; t < n_threads; t++)
                 {
-                    row_scale = -RAND_MAX; 
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        col = A->on_proc->idx2[j];
-                        if (variables[i] == variables[col])
-                        {
-                            val = A->on_proc->vals[j];
-                            if (val > row_scale)
-                            {
-                                row_scale = val;
-                            }
-                        }
-                    }    
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        col = A->off_proc->idx2[j];
-                        if (variables[i] == off_variables[col])
-                        {
-                            val = A->off_proc->vals[j];
-                            if (val > row_scale)
-                            {
-                                row_scale = val;
-                            }
-                        }
-                    } 
+                    on_ptr[t+1] += on_ptr[t];
+                    off_ptr[t+1] += off_ptr[t];
                 }
-                else
+                S->on_proc->idx2.resize(on_ptr[n_threads]);
+                S->off_proc->idx2.resize(off_ptr[n_threads]);
+                if (!pattern_only)
                 {
-                    row_scale = RAND_MAX;
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        col = A->on_proc->idx2[j];
-                        if (variables[i] == variables[col])
-                        {
-                            val = A->on_proc->vals[j];
-                            if (val < row_scale)
-                            {
-                                row_scale = val;
-                            }
-                        }
-                    }    
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        col = A->off_proc->idx2[j];
-                        if (variables[i] == off_variables[col])
-                        {
-                            val = A->off_proc->vals[j];
-                            if (val < row_scale)
-                            {
-                                row_scale = val;
-                            }
-                        }
-                    } 
+                    S->on_proc->vals.resize(on_ptr[n_threads]);
+                    S->off_proc->vals.resize(off_ptr[n_threads]);
                 }
             }
 
-
-
-            // Multiply row max magnitude by theta
-            threshold = row_scale * theta;
-
-            // Always add diagonal
-            S->on_proc->idx2[S->on_proc->nnz] = i;
-            S->on_proc->vals[S->on_proc->nnz] = diag;
-            S->on_proc->nnz++;
-
-            // Add all off-diagonal entries to strength
-            // if magnitude greater than equal to 
-            // row_max * theta
-            if (num_variables == 1)
+            std::copy(on_idx2[tid].begin(), on_idx2[tid].end(),
+                    S->on_proc->idx2.begin() + on_ptr[tid]);
+            std::copy(off_idx2[tid].begin(), off_idx2[tid].end(),
+                    S->off_proc->idx2.begin() + off_ptr[tid]);
+            if (!pattern_only)
             {
-                if (diag < 0)
-                {
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        val = A->on_proc->vals[j];
-                        if (val > threshold)
-                        {
-                            col = A->on_proc->idx2[j];
-                            S->on_proc->idx2[S->on_proc->nnz] = col;
-                            S->on_proc->vals[S->on_proc->nnz] = val;
-                            S->on_proc->nnz++;
-                        }
-                    }
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        val = A->off_proc->vals[j];
-                        if (val > threshold)
-                        {
-                            col = A->off_proc->idx2[j];
-                            S->off_proc->idx2[S->off_proc->nnz] = col;
-                            S->off_proc->vals[S->off_proc->nnz] = val;
-                            S->off_proc->nnz++;
-                        }
-                    }
-                }
-                else
-                {
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        val = A->on_proc->vals[j];
-                        if (val < threshold)
-                        {
-                            col = A->on_proc->idx2[j];
-                            S->on_proc->idx2[S->on_proc->nnz] = col;
-                            S->on_proc->vals[S->on_proc->nnz] = val;
-                            S->on_proc->nnz++;
-                        }
-                    }
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        val = A->off_proc->vals[j];
-                        if (val < threshold)
-                        {
-                            col = A->off_proc->idx2[j];
-                            S->off_proc->idx2[S->off_proc->nnz] = col;
-                            S->off_proc->vals[S->off_proc->nnz] = val;
-                            S->off_proc->nnz++;
-                        }
-                    }
-                }
+                std::copy(on_vals[tid].begin(), on_vals[tid].end(),
+                        S->on_proc->vals.begin() + on_ptr[tid]);
+                std::copy(off_vals[tid].begin(), off_vals[tid].end(),
+                        S->off_proc->vals.begin() + off_ptr[tid]);
             }
-            else
-            {
-                if (diag < 0)
-                {
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        col = A->on_proc->idx2[j];
-                        if (variables[i] == variables[col])
-                        {
-                            val = A->on_proc->vals[j];
-                            if (val > threshold)
-                            {
-                                S->on_proc->idx2[S->on_proc->nnz] = col;
-                                S->on_proc->vals[S->on_proc->nnz] = val;
-                                S->on_proc->nnz++;
-                            }
-                        }
-                    }
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        col = A->off_proc->idx2[j];
-                        if (variables[i] == off_variables[col])
-                        {
-                            val = A->off_proc->vals[j];
-                            if (val > threshold)
-                            {
-                                S->off_proc->idx2[S->off_proc->nnz] = col;
-                                S->off_proc->vals[S->off_proc->nnz] = val;
-                                S->off_proc->nnz++;
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    for (int j = row_start_on; j < row_end_on; j++)
-                    {
-                        col = A->on_proc->idx2[j];
-                        if (variables[i] == variables[col])
-                        {
-                            val = A->on_proc->vals[j];
-                            if (val < threshold)
-                            {
-                                S->on_proc->idx2[S->on_proc->nnz] = col;
-                                S->on_proc->vals[S->on_proc->nnz] = val;
-                                S->on_proc->nnz++;
-                            }
-                        }
-                    }
-                    for (int j = row_start_off; j < row_end_off; j++)
-                    {
-                        col = A->off_proc->idx2[j];
-                        if (variables[i] == off_variables[col])
-                        {
-                            val = A->off_proc->vals[j];
-                            if (val < threshold)
-                            {
-                                S->off_proc->idx2[S->off_proc->nnz] = col;
-                                S->off_proc->vals[S->off_proc->nnz] = val;
-                                S->off_proc->nnz++;
-                            }
-                        }
-                    }
-                }
-            }
-
         }
-        S->on_proc->idx1[i+1] = S->on_proc->nnz;
-        S->off_proc->idx1[i+1] = S->off_proc->nnz;
     }
-    S->on_proc->idx2.resize(S->on_proc->nnz);
-    S->on_proc->idx2.shrink_to_fit();
-    S->off_proc->idx2.resize(S->off_proc->nnz);
-    S->off_proc->idx2.shrink_to_fit();
 
-    S->on_proc->vals.resize(S->on_proc->nnz);
-    S->on_proc->vals.shrink_to_fit();
-    S->off_proc->vals.resize(S->off_proc->nnz);
-    S->off_proc->vals.shrink_to_fit();
+    S->on_proc->idx1[0] = 0;
+    S->off_proc->idx1[0] = 0;
+    for (int i = 0; i < n_rows; i++)
+    {
+        S->on_proc->idx1[i+1] += S->on_proc->idx1[i];
+        S->off_proc->idx1[i+1] += S->off_proc->idx1[i];
+    }
+    S->on_proc->nnz = S->on_proc->idx2.size();
+    S->off_proc->nnz = S->off_proc->idx2.size();
+    S->on_proc->sorted = true;
+    S->on_proc->diag_first = true;
+    S->off_proc->sorted = true;
 
     S->local_nnz = S->on_proc->nnz + S->off_proc->nnz;
 
@@ -340,217 +194,211 @@ ParCSRMatrix* classical_strength(ParCSRMatrix* A, double theta, bool tap_amg, in
     if (S->tap_mat_comm) S->tap_mat_comm->num_shared++;
 
     return S;
-
 }
 
-// TODO -- currently this assumes all diags are same sign...
-ParCSRMatrix* symmetric_strength(ParCSRMatrix* A, double theta, bool tap_amg)
+/**************************************************************
+*****   Classical Strength
+**************************************************************
+***** a_ij is strong if -sign(a_ii) * a_ij is at least theta
+***** times the largest such entry in row i.
+**************************************************************/
+ParCSRMatrix* classical_strength(ParCSRMatrix* A, double theta, bool tap_amg,
+        int num_variables, int* variables, bool pattern_only)
 {
-    int row_start_on, row_end_on;
-    int row_start_off, row_end_off;
-    int col;
-    double val;
-    double row_scale;
-    double threshold;
-    double diag;
-
     CommPkg* comm = A->comm;
     if (tap_amg)
     {
         comm = A->tap_comm;
     }
 
-    std::vector<int> neg_diags;
-    std::vector<double> row_scales;
-    if (A->local_num_rows) 
+    int* off_variables = NULL;
+    if (num_variables > 1)
     {
-        row_scales.resize(A->local_num_rows, 0);
-        neg_diags.resize(A->local_num_rows);
+        std::vector<int>& recvbuf = comm->communicate(variables);
+        off_variables = recvbuf.data();
     }
 
-    ParCSRMatrix* S = new ParCSRMatrix(A->partition, A->global_num_rows, A->global_num_cols,
-            A->local_num_rows, A->on_proc_num_cols, A->off_proc_num_cols);
-    
+    // A and S will be sorted, with the diagonal first
     A->sort();
     A->on_proc->move_diag();
 
-    if (A->on_proc->nnz)
+    return form_strength_rows(A, pattern_only,
+            [&](int i, std::vector<int>& on_idx2, std::vector<double>& on_vals,
+                std::vector<int>& off_idx2, std::vector<double>& off_vals)
     {
-        S->on_proc->idx2.resize(A->on_proc->nnz);
-        S->on_proc->vals.resize(A->on_proc->nnz);
-        S->on_proc->nnz = 0;
-    }
-    if (A->off_proc->nnz)
-    {
-        S->off_proc->idx2.resize(A->off_proc->nnz);
-        S->off_proc->vals.resize(A->off_proc->nnz);
-        S->off_proc->nnz = 0;
-    }
+        int row_start_on = A->on_proc->idx1[i];
+        int row_end_on = A->on_proc->idx1[i+1];
+        int row_start_off = A->off_proc->idx1[i];
+        int row_end_off = A->off_proc->idx1[i+1];
+        if (row_end_on - row_start_on == 0 && row_end_off - row_start_off == 0)
+        {
+            return;
+        }
 
-    for (int i = 0; i < A->local_num_rows; i++)
-    {
-        row_start_on = A->on_proc->idx1[i];
-        row_end_on = A->on_proc->idx1[i+1];
-        row_start_off = A->off_proc->idx1[i];
-        row_end_off = A->off_proc->idx1[i+1];
-        if (row_end_on - row_start_on || row_end_off - row_start_off)
+        double diag = row_diag(A, i, row_start_on);
+        double sign = diag < 0.0 ? -1.0 : 1.0;
+        double threshold = row_threshold(A, i, row_start_on, sign, theta,
+                num_variables, variables, off_variables);
+
+        // Always add diagonal
+        on_idx2.push_back(i);
+        if (!pattern_only) on_vals.push_back(diag);
+
+        // Add all off-diagonal entries to strength if magnitude 
+        // greater than row_max * theta
+        for (int j = row_start_on; j < row_end_on; j++)
         {
-            if (A->on_proc->idx2[row_start_on] == i)
+            int col = A->on_proc->idx2[j];
+            if (num_variables > 1 && variables[i] != variables[col]) continue;
+            if (sign * A->on_proc->vals[j] < threshold)
             {
-                diag = A->on_proc->vals[row_start_on];
-                row_start_on++;
+                on_idx2.push_back(col);
+                if (!pattern_only) on_vals.push_back(A->on_proc->vals[j]);
             }
-            else
+        }
+        for (int j = row_start_off; j < row_end_off; j++)
+        {
+            int col = A->off_proc->idx2[j];
+            if (num_variables > 1 && variables[i] != off_variables[col]) continue;
+            if (sign * A->off_proc->vals[j] < threshold)
             {
-                diag = 0.0;
+                off_idx2.push_back(col);
+                if (!pattern_only) off_vals.push_back(A->off_proc->vals[j]);
             }
+        }
+    });
+}
 
-            // Find value with max magnitude in row
-            if (diag < 0.0)
-            {
-                neg_diags[i] = 1;
-                row_scale = -RAND_MAX; 
-                for (int j = row_start_on; j < row_end_on; j++)
-                {
-                    val = A->on_proc->vals[j];
-                    if (val > row_scale)
-                    {
-                        row_scale = val;
-                    }
-                }    
-                for (int j = row_start_off; j < row_end_off; j++)
-                {
-                    val = A->off_proc->vals[j];
-                    if (val > row_scale)
-                    {
-                        row_scale = val;
-                    }
-                } 
-            }
-            else
-            {
-                neg_diags[i] = 0;
-                row_scale = RAND_MAX;
-                for (int j = row_start_on; j < row_end_on; j++)
-                {
-                    val = A->on_proc->vals[j];
-                    if (val < row_scale)
-                    {
-                        row_scale = val;
-                    }
-                }    
-                for (int j = row_start_off; j < row_end_off; j++)
-                {
-                    val = A->off_proc->vals[j];
-                    if (val < row_scale)
-                    {
-                        row_scale = val;
-                    }
-                } 
-            }
+// TODO -- currently this assumes all diags are same sign...
+ParCSRMatrix* symmetric_strength(ParCSRMatrix* A, double theta, bool tap_amg,
+        bool pattern_only)
+{
+    CommPkg* comm = A->comm;
+    if (tap_amg)
+    {
+        comm = A->tap_comm;
+    }
 
-            // Multiply row max magnitude by theta
-            row_scales[i] = row_scale * theta;
-        }
+    std::vector<int> neg_diags;
+    std::vector<double> row_scales;
+    if (A->local_num_rows)
+    {
+        row_scales.resize(A->local_num_rows, 0);
+        neg_diags.resize(A->local_num_rows);
     }
 
-    std::vector<double>& off_proc_row_scales = comm->communicate(row_scales);
-    std::vector<int>& off_proc_neg_diags = comm->communicate(neg_diags);
-    
-    S->on_proc->idx1[0] = 0;
-    S->off_proc->idx1[0] = 0;
+    // A and S will be sorted, with the diagonal first
+    A->sort();
+    A->on_proc->move_diag();
+
     for (int i = 0; i < A->local_num_rows; i++)
     {
-        row_start_on = A->on_proc->idx1[i];
-        row_end_on = A->on_proc->idx1[i+1];
-        row_start_off = A->off_proc->idx1[i];
-        row_end_off = A->off_proc->idx1[i+1];
+        int row_start_on = A->on_proc->idx1[i];
+        int row_end_on = A->on_proc->idx1[i+1];
+        int row_start_off = A->off_proc->idx1[i];
+        int row_end_off = A->off_proc->idx1[i+1];
         if (row_end_on - row_start_on || row_end_off - row_start_off)
         {
-            bool neg_diag = neg_diags[i];           
-            threshold = row_scales[i];
-
-            // Always add diagonal
-            S->on_proc->idx2[S->on_proc->nnz] = i;
-            S->on_proc->vals[S->on_proc->nnz] = A->on_proc->vals[row_start_on++];
-            S->on_proc->nnz++;
-
-            // Add all off-diagonal entries to strength
-            // if magnitude greater than equal to 
-            // row_max * theta
-            for (int j = row_start_on; j < row_end_on; j++)
-            {
-                val = A->on_proc->vals[j];
-                col = A->on_proc->idx2[j];
-                if ((neg_diag && val > threshold) || (!neg_diag && val < threshold) 
-                        || (neg_diags[col] && val > row_scales[col])
-                        || (!neg_diags[col] && val < row_scales[col]))
-                {
-                    S->on_proc->idx2[S->on_proc->nnz] = col;
-                    S->on_proc->vals[S->on_proc->nnz] = val;
-                    S->on_proc->nnz++;
-                }
-            }
-            for (int j = row_start_off; j < row_end_off; j++)
-            {
-                val = A->off_proc->vals[j];
-                col = A->off_proc->idx2[j];
-                if ((neg_diag && val > threshold) || (!neg_diag && val < threshold)
-                        || (off_proc_neg_diags[col] && val > off_proc_row_scales[col])
-                        || (!off_proc_neg_diags[col] && val < off_proc_row_scales[col]))
-                {
-                    S->off_proc->idx2[S->off_proc->nnz] = col;
-                    S->off_proc->vals[S->off_proc->nnz] = val;
-                    S->off_proc->nnz++;
-                }
-            }                    
+            double sign = row_diag(A, i, row_start_on) < 0.0 ? -1.0 : 1.0;
+            neg_diags[i] = sign < 0.0;
+
+            // Threshold, in terms of the unscaled values
+            row_scales[i] = sign * row_threshold(A, i, row_start_on, sign, theta,
+                    1, NULL, NULL);
         }
-        S->on_proc->idx1[i+1] = S->on_proc->nnz;
-        S->off_proc->idx1[i+1] = S->off_proc->nnz;
     }
-    S->on_proc->idx2.resize(S->on_proc->nnz);
-    S->on_proc->idx2.shrink_to_fit();
-    S->off_proc->idx2.resize(S->off_proc->nnz);
-    S->off_proc->idx2.shrink_to_fit();
-
-    S->on_proc->vals.resize(S->on_proc->nnz);
-    S->on_proc->vals.shrink_to_fit();
-    S->off_proc->vals.resize(S->off_proc->nnz);
-    S->off_proc->vals.shrink_to_fit();
 
-    S->local_nnz = S->on_proc->nnz + S->off_proc->nnz;
+    std::vector<double>& off_proc_row_scales = comm->communicate(row_scales);
+    std::vector<int>& off_proc_neg_diags = comm->communicate(neg_diags);
 
-    S->on_proc_column_map = A->get_on_proc_column_map();
-    S->local_row_map = A->get_local_row_map();
-    S->off_proc_column_map = A->get_off_proc_column_map();
+    return form_strength_rows(A, pattern_only,
+            [&](int i, std::vector<int>& on_idx2, std::vector<double>& on_vals,
+                std::vector<int>& off_idx2, std::vector<double>& off_vals)
+    {
+        int row_start_on = A->on_proc->idx1[i];
+        int row_end_on = A->on_proc->idx1[i+1];
+        int row_start_off = A->off_proc->idx1[i];
+        int row_end_off = A->off_proc->idx1[i+1];
+        if (row_end_on - row_start_on == 0 && row_end_off - row_start_off == 0)
+        {
+            return;
+        }
 
-    S->comm = A->comm;
-    S->tap_comm = A->tap_comm;
-    S->tap_mat_comm = A->tap_mat_comm;
+        double diag = row_diag(A, i, row_start_on);
+        bool neg_diag = neg_diags[i];
+        double threshold = row_scales[i];
 
-    if (S->comm) S->comm->num_shared++;
-    if (S->tap_comm) S->tap_comm->num_shared++;
-    if (S->tap_mat_comm) S->tap_mat_comm->num_shared++;
+        // Always add diagonal
+        on_idx2.push_back(i);
+        if (!pattern_only) on_vals.push_back(diag);
 
-    return S;
+        // Add all off-diagonal entries to strength if magnitude
+        // greater than row_max * theta, in either row or column
+        for (int j = row_start_on; j < row_end_on; j++)
+        {
+            double val = A->on_proc->vals[j];
+            int col = A->on_proc->idx2[j];
+            if ((neg_diag && val > threshold) || (!neg_diag && val < threshold)
+                    || (neg_diags[col] && val > row_scales[col])
+                    || (!neg_diags[col] && val < row_scales[col]))
+            {
+                on_idx2.push_back(col);
+                if (!pattern_only) on_vals.push_back(val);
+            }
+        }
+        for (int j = row_start_off; j < row_end_off; j++)
+        {
+            double val = A->off_proc->vals[j];
+            int col = A->off_proc->idx2[j];
+            if ((neg_diag && val > threshold) || (!neg_diag && val < threshold)
+                    || (off_proc_neg_diags[col] && val > off_proc_row_scales[col])
+                    || (!off_proc_neg_diags[col] && val < off_proc_row_scales[col]))
+            {
+                off_idx2.push_back(col);
+                if (!pattern_only) off_vals.push_back(val);
+            }
+        }
+    });
 }
 
-
-// Assumes ParCSRMatrix is previously sorted
-// TODO -- have ParCSRMatrix bool sorted (and sort if not previously)
+/**************************************************************
+*****   ParCSRMatrix Strength
+**************************************************************
+***** Returns the strength matrix S: the diagonal of each 
+***** nonempty row, followed by the strong connections.  S shares
+***** the column maps and communicators of A, and is sorted with
+***** the diagonal first.  Sorts A, with the diagonal first.
+*****
+***** Parameters
+***** -------------
+***** strength_type : strength_t
+*****    Classical or Symmetric
+***** theta : double (optional)
+*****    Strength threshold
+***** tap_amg : bool (optional)
+*****    Communicate with the TAP communicator of A
+***** num_variables : int (optional)
+*****    Number of variables (connections between variables are 
+*****    not strong)
+***** variables : int* (optional)
+*****    Variable of each local row
+***** pattern_only : bool (optional)
+*****    If true, the values of S are not stored (S is then only a
+*****    graph; splitting, aggregation and interpolation take
+*****    values from A).  Default is false.
+**************************************************************/
 ParCSRMatrix* ParCSRMatrix::strength(strength_t strength_type,
-        double theta, bool tap_amg, int num_variables, int* variables)
+        double theta, bool tap_amg, int num_variables, int* variables,
+        bool pattern_only)
 {
     switch (strength_type)
     {
         case Classical:
-            return classical_strength(this, theta, tap_amg, num_variables, variables);
+            return classical_strength(this, theta, tap_amg, num_variables,
+                    variables, pattern_only);
         case Symmetric:
-            return symmetric_strength(this, theta, tap_amg);
-        default : 
+            return symmetric_strength(this, theta, tap_amg, pattern_only);
+        default:
             return NULL;
     }
-
-    return NULL;
 }
-
@@ -0,0 +1,200 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include <algorithm>
+#include "comm_stats.hpp"
+
+namespace raptor {
+
+static const char* locality_labels[NUM_LOCALITIES] = {"socket", "node", "network"};
+
+/**************************************************************
+*****   CommStats Add Sends
+**************************************************************
+***** Locality follows the topology : for SocketLevel, a process
+***** on rank's node shares its socket, and one on another node of
+***** the same host is intra-node.  NodeLevel topologies have no
+***** socket information, so messages on the node are intra-node
+**************************************************************/
+static int get_host(Topology* topology, int node)
+{
+    if (topology->node_to_host.size()) return topology->node_to_host[node];
+    return node;
+}
+
+void CommStats::add_sends(CommData* send_data, Topology* topology, bool on_node)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    int rank_node = topology->get_node(rank);
+    int rank_host = get_host(topology, rank_node);
+
+    for (int i = 0; i < send_data->num_msgs; i++)
+    {
+        int proc = send_data->procs[i];
+        if (on_node)
+        {
+            proc = topology->get_global_proc(rank_node, proc);
+        }
+        long bytes = (long)(send_data->indptr[i+1] - send_data->indptr[i])
+            * value_bytes;
+
+        int node = topology->get_node(proc);
+        int locality = InterNode;
+        if (node == rank_node)
+        {
+            locality = topology->level == SocketLevel ? IntraSocket : IntraNode;
+        }
+        else if (get_host(topology, node) == rank_host)
+        {
+            locality = IntraNode;
+        }
+        num_msgs[locality]++;
+        num_bytes[locality] += bytes;
+        neighbors.push_back(proc);
+    }
+}
+
+void CommStats::reduce()
+{
+    int num_procs;
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+            neighbors.end());
+
+    // Local values, in the order msgs, bytes, neighbors
+    std::vector<double> vals(2*NUM_LOCALITIES + 1);
+    std::vector<double> max_vals(vals.size());
+    std::vector<double> sum_vals(vals.size());
+    for (int i = 0; i < NUM_LOCALITIES; i++)
+    {
+        vals[i] = num_msgs[i];
+        vals[NUM_LOCALITIES + i] = num_bytes[i];
+    }
+    vals[2*NUM_LOCALITIES] = neighbors.size();
+
+    RAPtor_MPI_Allreduce(vals.data(), max_vals.data(), vals.size(),
+            RAPtor_MPI_DOUBLE, RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+    RAPtor_MPI_Allreduce(vals.data(), sum_vals.data(), vals.size(),
+            RAPtor_MPI_DOUBLE, RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+
+    for (int i = 0; i < NUM_LOCALITIES; i++)
+    {
+        max_msgs[i] = max_vals[i];
+        avg_msgs[i] = sum_vals[i] / num_procs;
+        max_bytes[i] = max_vals[NUM_LOCALITIES + i];
+        avg_bytes[i] = sum_vals[NUM_LOCALITIES + i] / num_procs;
+    }
+    max_neighbors = max_vals[2*NUM_LOCALITIES];
+    avg_neighbors = sum_vals[2*NUM_LOCALITIES] / num_procs;
+}
+
+void ParComm::add_comm_stats(CommStats& stats)
+{
+    stats.comm_type = "ParComm";
+    stats.add_sends(send_data, topology, mpi_comm == topology->local_comm);
+}
+
+void TAPComm::add_comm_stats(CommStats& stats)
+{
+    if (local_S_par_comm)
+    {
+        stats.comm_type = "TAPComm3";
+        stats.add_sends(local_S_par_comm->send_data, topology, true);
+    }
+    else
+    {
+        stats.comm_type = "TAPComm2";
+    }
+    stats.add_sends(local_L_par_comm->send_data, topology, true);
+    stats.add_sends(local_R_par_comm->send_data, topology, true);
+    stats.add_sends(global_par_comm->send_data, topology, false);
+}
+
+CommStats comm_stats(CommPkg* comm, int level, const char* name, int value_bytes)
+{
+    CommStats stats(level, name, value_bytes);
+    comm->add_comm_stats(stats);
+    stats.reduce();
+    return stats;
+}
+
+static FILE* open_stats(const char* filename)
+{
+    if (filename == NULL) return stdout;
+    return fopen(filename, "w");
+}
+
+static void close_stats(FILE* f, const char* filename)
+{
+    if (filename) fclose(f);
+    else fflush(f);
+}
+
+void write_comm_stats_json(const std::vector<CommStats>& stats, const char* filename)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    if (rank) return;
+
+    FILE* f = open_stats(filename);
+    if (f == NULL) return;
+
+    fprintf(f, "[\n");
+    for (int s = 0; s < (int)stats.size(); s++)
+    {
+        const CommStats& st = stats[s];
+        fprintf(f, "  {\"level\": %d, \"name\": \"%s\", \"comm\": \"%s\", "
+                "\"value_bytes\": %d,\n", st.level, st.name.c_str(),
+                st.comm_type.c_str(), st.value_bytes);
+        for (int i = 0; i < NUM_LOCALITIES; i++)
+        {
+            fprintf(f, "   \"%s\": {\"max_msgs\": %.10g, \"avg_msgs\": %.10g, "
+                    "\"max_bytes\": %.10g, \"avg_bytes\": %.10g},\n", locality_labels[i],
+                    st.max_msgs[i], st.avg_msgs[i], st.max_bytes[i], st.avg_bytes[i]);
+        }
+        fprintf(f, "   \"neighbors\": {\"max\": %.10g, \"avg\": %.10g}}%s\n",
+                st.max_neighbors, st.avg_neighbors,
+                s + 1 < (int)stats.size() ? "," : "");
+    }
+    fprintf(f, "]\n");
+
+    close_stats(f, filename);
+}
+
+void write_comm_stats_csv(const std::vector<CommStats>& stats, const char* filename)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    if (rank) return;
+
+    FILE* f = open_stats(filename);
+    if (f == NULL) return;
+
+    fprintf(f, "level,name,comm,value_bytes");
+    for (int i = 0; i < NUM_LOCALITIES; i++)
+    {
+        fprintf(f, ",%s_max_msgs,%s_avg_msgs,%s_max_bytes,%s_avg_bytes",
+                locality_labels[i], locality_labels[i], locality_labels[i],
+                locality_labels[i]);
+    }
+    fprintf(f, ",max_neighbors,avg_neighbors\n");
+
+    for (int s = 0; s < (int)stats.size(); s++)
+    {
+        const CommStats& st = stats[s];
+        fprintf(f, "%d,%s,%s,%d", st.level, st.name.c_str(),
+                st.comm_type.c_str(), st.value_bytes);
+        for (int i = 0; i < NUM_LOCALITIES; i++)
+        {
+            fprintf(f, ",%.10g,%.10g,%.10g,%.10g", st.max_msgs[i], st.avg_msgs[i],
+                    st.max_bytes[i], st.avg_bytes[i]);
+        }
+        fprintf(f, ",%.10g,%.10g\n", st.max_neighbors, st.avg_neighbors);
+    }
+
+    close_stats(f, filename);
+}
+
+}
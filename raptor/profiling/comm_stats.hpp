@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#ifndef RAPTOR_PROFILING_COMM_STATS_HPP
+#define RAPTOR_PROFILING_COMM_STATS_HPP
+
+#include <string>
+#include <vector>
+#include "raptor/core/comm_pkg.hpp"
+
+/**************************************************************
+ *****   CommStats Struct
+ **************************************************************
+ ***** Statistics of the messages sent by a communication package,
+ ***** split by locality of the destination : intra-socket,
+ ***** intra-node (other socket), and inter-node.  Intra-socket
+ ***** counts need a SocketLevel topology, and are zero otherwise.
+ ***** Counts are gathered on each process with
+ ***** CommPkg::add_comm_stats, and reduced to max and average over
+ ***** all processes with reduce().
+ *****
+ ***** Attributes
+ ***** -------------
+ ***** level : int
+ *****    Level of the hierarchy (or -1 if not part of one)
+ ***** name : std::string
+ *****    Operation the communicator is used for (e.g. "A", "P")
+ ***** comm_type : std::string
+ *****    "ParComm", "TAPComm2" or "TAPComm3"
+ ***** value_bytes : int
+ *****    Bytes communicated per index
+ ***** num_msgs, num_bytes : long[3]
+ *****    Messages and bytes sent by this process to each locality
+ ***** neighbors : std::vector<int>
+ *****    Processes to which this process sends (in any step)
+ ***** max_msgs, avg_msgs, max_bytes, avg_bytes : double[3]
+ *****    Reduced messages and bytes of each locality
+ ***** max_neighbors, avg_neighbors : double
+ *****    Reduced number of distinct processes sent to
+ **************************************************************/
+namespace raptor
+{
+    enum comm_locality_t {IntraSocket, IntraNode, InterNode};
+    const int NUM_LOCALITIES = InterNode + 1;
+
+    struct CommStats
+    {
+        CommStats(int _level = -1, const char* _name = "",
+                int _value_bytes = sizeof(double))
+        {
+            level = _level;
+            name = _name;
+            value_bytes = _value_bytes;
+            for (int i = 0; i < NUM_LOCALITIES; i++)
+            {
+                num_msgs[i] = 0;
+                num_bytes[i] = 0;
+                max_msgs[i] = 0.0;
+                avg_msgs[i] = 0.0;
+                max_bytes[i] = 0.0;
+                avg_bytes[i] = 0.0;
+            }
+            max_neighbors = 0.0;
+            avg_neighbors = 0.0;
+        }
+
+        // Adds messages of send_data to this process's counts.  If
+        // on_node is true, procs are ranks in topology->local_comm
+        void add_sends(CommData* send_data, Topology* topology, bool on_node);
+
+        // Reduces counts over RAPtor_MPI_COMM_WORLD (collective)
+        void reduce();
+
+        int level;
+        std::string name;
+        std::string comm_type;
+        int value_bytes;
+
+        long num_msgs[NUM_LOCALITIES];
+        long num_bytes[NUM_LOCALITIES];
+        std::vector<int> neighbors;
+
+        double max_msgs[NUM_LOCALITIES];
+        double avg_msgs[NUM_LOCALITIES];
+        double max_bytes[NUM_LOCALITIES];
+        double avg_bytes[NUM_LOCALITIES];
+        double max_neighbors;
+        double avg_neighbors;
+    };
+
+    // Gathers and reduces the statistics of comm (collective)
+    CommStats comm_stats(CommPkg* comm, int level = -1, const char* name = "",
+            int value_bytes = sizeof(double));
+
+    // Writes stats on rank 0, to filename or stdout if filename is NULL
+    void write_comm_stats_json(const std::vector<CommStats>& stats,
+            const char* filename = NULL);
+    void write_comm_stats_csv(const std::vector<CommStats>& stats,
+            const char* filename = NULL);
+}
+
+#endif
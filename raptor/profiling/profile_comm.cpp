@@ -22,7 +22,7 @@ void print_internode_comm(Topology* topology, std::vector<int> num_msgs, std::ve
     RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
     RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
     rank_node = topology->get_node(rank);
-    num_nodes = num_procs / topology->PPN;
+    num_nodes = topology->num_nodes;
 
     // Number of processes each process talks to 
     n = num_msgs[6] + num_msgs[7] + num_msgs[8];
@@ -177,8 +177,9 @@ void calc_and_print(Topology* topology, CommData* comm_data)
     RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
     rank_node = topology->get_node(rank);
     ranks_per_socket = topology->PPN / 2;
+    if (ranks_per_socket == 0) ranks_per_socket = 1;
     rank_socket = rank / ranks_per_socket;
-    num_nodes = num_procs / topology->PPN;
+    num_nodes = topology->num_nodes;
 
     int n_arch_types = 3;
     int n_protocols = 3;
@@ -251,8 +252,9 @@ void calc_and_print(CSRMatrix* A, CSRMatrix* B, Topology* topology, T* comm_data
     RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
     rank_node = topology->get_node(rank);
     ranks_per_socket = topology->PPN / 2;
+    if (ranks_per_socket == 0) ranks_per_socket = 1;
     rank_socket = rank / ranks_per_socket;
-    num_nodes = num_procs / topology->PPN;
+    num_nodes = topology->num_nodes;
 
     int n_arch_types = 3;
     int n_protocols = 3;
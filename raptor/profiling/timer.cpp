@@ -0,0 +1,357 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "timer.hpp"
+#include "raptor/core/mpi_types.hpp"
+
+namespace raptor {
+
+Timers timers;
+
+// Region used by init_profile / finalize_profile
+static TimerRegion* profile_r = NULL;
+
+static const char* comm_time_labels[NUM_COMM_TIMES] = {"collective", "p2p",
+    "vec_comm", "mat_comm", "new_comm"};
+
+std::string TimerRegion::path() const
+{
+    if (parent == NULL) return "";
+
+    std::string p = name;
+    if (level >= 0) p += "@" + std::to_string(level);
+    std::string parent_path = parent->path();
+    if (parent_path.empty()) return p;
+    return parent_path + "/" + p;
+}
+
+TimerRegion* TimerRegion::child(const char* child_name, int child_level)
+{
+    for (int i = 0; i < (int)children.size(); i++)
+    {
+        TimerRegion* c = children[i];
+        if (c->level == child_level && c->name == child_name)
+        {
+            return c;
+        }
+    }
+    children.push_back(new TimerRegion(child_name, child_level, this));
+    return children.back();
+}
+
+void Timers::enable(bool trace)
+{
+    enabled = true;
+    tracing = trace;
+    if (events.empty()) origin = MPI_Wtime();
+}
+
+void Timers::disable()
+{
+    enabled = false;
+}
+
+void Timers::reset()
+{
+    root.clear();
+    profile_r = NULL;
+    current = &root;
+    active = false;
+    events.clear();
+    origin = MPI_Wtime();
+}
+
+void Timers::start(const char* name, int level)
+{
+    current = current->child(name, level);
+    current->start_t = MPI_Wtime();
+    for (int i = 0; i < NUM_COMM_TIMES; i++)
+    {
+        current->start_comm[i] = comm_t[i];
+    }
+    active = true;
+}
+
+void Timers::stop()
+{
+    if (current == &root) return;
+
+    double t = MPI_Wtime();
+    TimerRegion* r = current;
+    r->count++;
+    r->time += t - r->start_t;
+    for (int i = 0; i < NUM_COMM_TIMES; i++)
+    {
+        r->comm_times[i] += comm_t[i] - r->start_comm[i];
+    }
+    if (tracing)
+    {
+        TraceEvent e;
+        e.name = r->name;
+        e.level = r->level;
+        e.start = r->start_t - origin;
+        e.duration = t - r->start_t;
+        events.push_back(e);
+    }
+
+    current = r->parent;
+    active = (current != &root);
+}
+
+TimerRegion* Timers::find(const std::string& path)
+{
+    TimerRegion* r = &root;
+    size_t pos = 0;
+    while (r && pos < path.size())
+    {
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) end = path.size();
+        std::string key = path.substr(pos, end - pos);
+
+        TimerRegion* next = NULL;
+        for (int i = 0; i < (int)r->children.size(); i++)
+        {
+            TimerRegion* c = r->children[i];
+            std::string c_key = c->name;
+            if (c->level >= 0) c_key += "@" + std::to_string(c->level);
+            if (c_key == key)
+            {
+                next = c;
+                break;
+            }
+        }
+        r = next;
+        pos = end + 1;
+    }
+    return r;
+}
+
+/**************************************************************
+*****   Timers Write Trace
+**************************************************************
+***** Writes this rank's events as complete ("X") events of the
+***** Chrome trace format (times in microseconds), loadable in
+***** chrome://tracing or Perfetto.  Each rank is its own pid.
+**************************************************************/
+void Timers::write_trace(const char* prefix)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+    std::string filename = std::string(prefix) + "." + std::to_string(rank) + ".json";
+    FILE* f = fopen(filename.c_str(), "w");
+    if (f == NULL) return;
+
+    fprintf(f, "{\"traceEvents\": [\n");
+    for (int i = 0; i < (int)events.size(); i++)
+    {
+        TraceEvent& e = events[i];
+        fprintf(f, "{\"name\": \"%s\", \"cat\": \"raptor\", \"ph\": \"X\", "
+                "\"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": 0, "
+                "\"args\": {\"level\": %d}}%s\n", e.name.c_str(),
+                e.start * 1e6, e.duration * 1e6, rank, e.level,
+                i + 1 < (int)events.size() ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+}
+
+static void add_paths(TimerRegion* r, std::string& paths)
+{
+    for (int i = 0; i < (int)r->children.size(); i++)
+    {
+        paths += r->children[i]->path() + "\n";
+        add_paths(r->children[i], paths);
+    }
+}
+
+// Regions of rank 0, with this rank's values reduced to max and sum
+static void reduce_regions(Timers* t, std::vector<std::string>& paths,
+        std::vector<double>& max_vals, std::vector<double>& sum_vals)
+{
+    int rank;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+    std::string all_paths;
+    if (rank == 0) add_paths(&(t->root), all_paths);
+    int size = all_paths.size();
+    RAPtor_MPI_Bcast(&size, 1, RAPtor_MPI_INT, 0, RAPtor_MPI_COMM_WORLD);
+    all_paths.resize(size);
+    RAPtor_MPI_Bcast(&(all_paths[0]), size, RAPtor_MPI_CHAR, 0, RAPtor_MPI_COMM_WORLD);
+
+    paths.clear();
+    size_t pos = 0;
+    while (pos < all_paths.size())
+    {
+        size_t end = all_paths.find('\n', pos);
+        paths.push_back(all_paths.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    // Values per region : count, time, comm times
+    int n_vals = NUM_COMM_TIMES + 2;
+    std::vector<double> vals(paths.size() * n_vals, 0.0);
+    for (int i = 0; i < (int)paths.size(); i++)
+    {
+        TimerRegion* r = t->find(paths[i]);
+        if (r == NULL) continue;
+        vals[i*n_vals] = r->count;
+        vals[i*n_vals + 1] = r->time;
+        for (int j = 0; j < NUM_COMM_TIMES; j++)
+        {
+            vals[i*n_vals + 2 + j] = r->comm_times[j];
+        }
+    }
+    max_vals.resize(vals.size());
+    sum_vals.resize(vals.size());
+    RAPtor_MPI_Allreduce(vals.data(), max_vals.data(), vals.size(), RAPtor_MPI_DOUBLE,
+            RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+    RAPtor_MPI_Allreduce(vals.data(), sum_vals.data(), vals.size(), RAPtor_MPI_DOUBLE,
+            RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+}
+
+void Timers::write_summary(const char* filename)
+{
+    int rank, num_procs;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    std::vector<std::string> paths;
+    std::vector<double> max_vals, sum_vals;
+    reduce_regions(this, paths, max_vals, sum_vals);
+    if (rank) return;
+
+    FILE* f = stdout;
+    if (filename) f = fopen(filename, "w");
+    if (f == NULL) return;
+
+    int n_vals = NUM_COMM_TIMES + 2;
+    fprintf(f, "[\n");
+    for (int i = 0; i < (int)paths.size(); i++)
+    {
+        double* max_v = &(max_vals[i*n_vals]);
+        double* sum_v = &(sum_vals[i*n_vals]);
+        fprintf(f, "  {\"path\": \"%s\", \"max_count\": %.0f, "
+                "\"max_time\": %.6e, \"avg_time\": %.6e", paths[i].c_str(),
+                max_v[0], max_v[1], sum_v[1] / num_procs);
+        for (int j = 0; j < NUM_COMM_TIMES; j++)
+        {
+            fprintf(f, ", \"max_%s\": %.6e, \"avg_%s\": %.6e", comm_time_labels[j],
+                    max_v[2+j], comm_time_labels[j], sum_v[2+j] / num_procs);
+        }
+        fprintf(f, "}%s\n", i + 1 < (int)paths.size() ? "," : "");
+    }
+    fprintf(f, "]\n");
+
+    if (filename) fclose(f);
+    else fflush(f);
+}
+
+void Timers::print_summary()
+{
+    int rank, num_procs;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    std::vector<std::string> paths;
+    std::vector<double> max_vals, sum_vals;
+    reduce_regions(this, paths, max_vals, sum_vals);
+    if (rank) return;
+
+    int n_vals = NUM_COMM_TIMES + 2;
+    printf("%-40s %8s %12s %12s %12s\n", "Region", "Calls", "Max Time",
+            "Avg Time", "Max Comm");
+    for (int i = 0; i < (int)paths.size(); i++)
+    {
+        double* max_v = &(max_vals[i*n_vals]);
+        double max_comm = 0.0;
+        for (int j = 0; j < NUM_COMM_TIMES; j++)
+        {
+            max_comm += max_v[2+j];
+        }
+        printf("%-40s %8.0f %12e %12e %12e\n", paths[i].c_str(), max_v[0],
+                max_v[1], sum_vals[i*n_vals + 1] / num_procs, max_comm);
+    }
+}
+
+/**************************************************************
+*****   Profile
+**************************************************************
+***** Times a single region "profile" (total and communication
+***** times), enabling timers for its duration if needed
+**************************************************************/
+static bool profile_enabled = false;
+
+TimerRegion* profile_region()
+{
+    if (profile_r == NULL) profile_r = timers.current->child("profile", -1);
+    return profile_r;
+}
+
+void init_profile()
+{
+    if (!timers.enabled)
+    {
+        timers.enable();
+        profile_enabled = true;
+    }
+    profile_r = timers.current->child("profile", -1);
+    profile_r->reset();
+    timers.start("profile");
+}
+
+void reset_profile()
+{
+    TimerRegion* r = profile_region();
+    if (timers.current == r)
+    {
+        r->start_t = MPI_Wtime();
+        for (int i = 0; i < NUM_COMM_TIMES; i++)
+        {
+            r->start_comm[i] = timers.comm_t[i];
+        }
+    }
+    r->reset();
+}
+
+void finalize_profile()
+{
+    if (timers.current == profile_region())
+    {
+        timers.stop();
+    }
+    if (profile_enabled)
+    {
+        timers.disable();
+        profile_enabled = false;
+    }
+}
+
+void average_profile(int n_iter)
+{
+    TimerRegion* r = profile_region();
+    r->time /= n_iter;
+    for (int i = 0; i < NUM_COMM_TIMES; i++)
+    {
+        r->comm_times[i] /= n_iter;
+    }
+}
+
+void print_profile(const char* string)
+{
+    int rank;
+    double t0;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+
+    TimerRegion* r = profile_region();
+    const char* labels[4] = {"Collective Comm", "P2P Comm", "Vec Comm", "Mat Comm"};
+
+    MPI_Allreduce(&(r->time), &t0, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    if (rank == 0) printf("%s Total Time: %e\n", string, t0);
+    for (int i = 0; i < 4; i++)
+    {
+        MPI_Reduce(&(r->comm_times[i]), &t0, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0 && t0 > 0) printf("%s %s Time: %e\n", string, labels[i], t0);
+    }
+}
+
+}
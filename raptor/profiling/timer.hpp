@@ -0,0 +1,204 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#ifndef RAPTOR_PROFILING_TIMER_HPP
+#define RAPTOR_PROFILING_TIMER_HPP
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+/**************************************************************
+ *****   Timers Class
+ **************************************************************
+ ***** Scoped, nestable timing regions.  Each region is a node of
+ ***** a tree (keyed by name and level under its parent), storing
+ ***** the number of calls, total time and the communication time
+ ***** spent within it, split into collective, point-to-point,
+ ***** vector communication, matrix communication and communicator
+ ***** creation.  Communication times are accumulated by the
+ ***** RAPtor_MPI wrappers and CommPkg while any region is active.
+ *****
+ ***** Regions are opened and closed with ScopedTimer, and cost a
+ ***** single branch when timers are disabled.  If tracing, each
+ ***** region also records an event, written per rank in Chrome
+ ***** trace format with write_trace().  Summaries reduce each
+ ***** region (by path on rank 0) to max and average over ranks.
+ *****
+ ***** Methods
+ ***** -------
+ ***** enable(bool trace = false)
+ *****    Starts recording regions (and trace events if trace)
+ ***** disable()
+ *****    Stops recording regions
+ ***** reset()
+ *****    Removes all regions and events
+ ***** find(path)
+ *****    Returns region with path ("setup/strength@0"), or NULL
+ ***** write_trace(prefix)
+ *****    Writes events to <prefix>.<rank>.json
+ ***** write_summary(filename), print_summary()
+ *****    Reduced summary as JSON on rank 0, or table to stdout
+ **************************************************************/
+namespace raptor
+{
+    enum comm_time_t {CollectiveTime, P2PTime, VecCommTime, MatCommTime,
+        NewCommTime};
+    const int NUM_COMM_TIMES = NewCommTime + 1;
+
+    struct TimerRegion
+    {
+        TimerRegion(const char* _name = "", int _level = -1,
+                TimerRegion* _parent = NULL)
+        {
+            name = _name;
+            level = _level;
+            parent = _parent;
+            reset();
+        }
+
+        ~TimerRegion()
+        {
+            clear();
+        }
+
+        // Removes all child regions and resets times
+        void clear()
+        {
+            for (int i = 0; i < (int)children.size(); i++)
+            {
+                delete children[i];
+            }
+            children.clear();
+            reset();
+        }
+
+        void reset()
+        {
+            count = 0;
+            time = 0.0;
+            for (int i = 0; i < NUM_COMM_TIMES; i++)
+            {
+                comm_times[i] = 0.0;
+            }
+        }
+
+        // Path from the root, with levels as name@level
+        std::string path() const;
+
+        TimerRegion* child(const char* child_name, int child_level);
+
+        std::string name;
+        int level;
+        TimerRegion* parent;
+        std::vector<TimerRegion*> children;
+
+        long count;
+        double time;
+        double comm_times[NUM_COMM_TIMES];
+
+        double start_t;
+        double start_comm[NUM_COMM_TIMES];
+    };
+
+    struct TraceEvent
+    {
+        std::string name;
+        int level;
+        double start;
+        double duration;
+    };
+
+    class Timers
+    {
+      public:
+        Timers() : root("root")
+        {
+            enabled = false;
+            tracing = false;
+            active = false;
+            current = &root;
+            current_comm = P2PTime;
+            for (int i = 0; i < NUM_COMM_TIMES; i++)
+            {
+                comm_t[i] = 0.0;
+            }
+            origin = 0.0;
+        }
+
+        void enable(bool trace = false);
+        void disable();
+        void reset();
+
+        void start(const char* name, int level = -1);
+        void stop();
+
+        // Communication time, accumulated while any region is open
+        inline void comm_start(int type)
+        {
+            if (active) comm_t[type] -= MPI_Wtime();
+        }
+        inline void comm_stop(int type)
+        {
+            if (active) comm_t[type] += MPI_Wtime();
+        }
+
+        TimerRegion* find(const std::string& path);
+
+        void write_trace(const char* prefix);
+        void write_summary(const char* filename = NULL);
+        void print_summary();
+
+        bool enabled;
+        bool tracing;
+        bool active;
+        TimerRegion root;
+        TimerRegion* current;
+        int current_comm;
+        double comm_t[NUM_COMM_TIMES];
+        double origin;
+        std::vector<TraceEvent> events;
+    };
+
+    extern Timers timers;
+
+    // Times the enclosing scope (or until stop()) as region (name, level).
+    // If enable is true, timers are enabled for the scope if they are not
+    // already.
+    class ScopedTimer
+    {
+      public:
+        ScopedTimer(const char* name, int level = -1, bool enable = false)
+        {
+            enabled_here = enable && !timers.enabled;
+            if (enabled_here) timers.enable();
+            started = timers.enabled;
+            if (started) timers.start(name, level);
+        }
+        ~ScopedTimer()
+        {
+            stop();
+            if (enabled_here) timers.disable();
+        }
+
+        // Ends the region before the end of the scope
+        void stop()
+        {
+            if (started) timers.stop();
+            started = false;
+        }
+
+      private:
+        bool started;
+        bool enabled_here;
+    };
+
+    // Single-region profiling (region "profile" under the root)
+    void init_profile();
+    void reset_profile();
+    void finalize_profile();
+    void average_profile(int n_iter);
+    void print_profile(const char* string);
+    TimerRegion* profile_region();
+}
+
+#endif
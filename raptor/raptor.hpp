@@ -6,6 +6,8 @@
 // Define types such as int and double sizes
 #include "core/types.hpp"
 #include "core/utilities.hpp"
+#include "core/workspace.hpp"
+#include "core/index_map.hpp"
 
 // Data about topology and matrix partitions
 #ifndef NO_MPI
@@ -35,6 +37,7 @@
 #include "gallery/random.hpp"
 #ifndef NO_MPI
     #include "gallery/par_stencil.hpp"
+    #include "gallery/par_stencil_matrix.hpp"
     #include "gallery/par_random.hpp"
 #endif
 
@@ -87,6 +90,11 @@
 #ifndef NO_MPI
     #include "multilevel/par_multilevel.hpp"
     #include "multilevel/par_level.hpp"
+#endif
+
+// Profiling
+#ifndef NO_MPI
+    #include "profiling/comm_stats.hpp"
 #endif 
 
 // Krylov methods
@@ -94,6 +102,7 @@
 #include "krylov/par_cg.hpp"
 #include "krylov/bicgstab.hpp"
 #include "krylov/par_bicgstab.hpp"
+#include "krylov/par_gmres.hpp"
 
 // Relaxation methods
 #include "util/linalg/relax.hpp"
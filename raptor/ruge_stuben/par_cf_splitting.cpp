@@ -1,10 +1,13 @@
 // Copyright (c) 2015-2017, RAPtor Developer Team
 // License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
 #include "par_cf_splitting.hpp"
+#include "raptor/core/threads.hpp"
 
 namespace raptor {
 
 // Declare Private Methods
+void transpose_pattern(const Matrix* mat, int n_rows, int n_cols, bool skip_diag,
+        std::vector<int>& col_ptr, std::vector<int>& col_indices);
 void transpose(const ParCSRMatrix* S, std::vector<int>& on_col_ptr, 
         std::vector<int>& off_col_ptr, std::vector<int>& on_col_indices,
         std::vector<int>& off_col_indices);
@@ -45,7 +48,7 @@ void find_off_proc_weights(CommPkg* comm, const std::vector<int>& states,
 int find_off_proc_states(CommPkg* comm, const std::vector<int>& states,
         std::vector<int>& off_proc_states, bool first_pass = false);
 void find_off_proc_new_coarse(const ParCSRMatrix* S, CommPkg* comm,
-        const std::map<int, int>& global_to_local, const std::vector<int>& states,
+        const IndexMap& global_to_local, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, const int* part_to_col,
         std::vector<int>& off_proc_col_ptr, std::vector<int>& off_proc_col_coarse,
         bool first_pass = false);
@@ -162,6 +165,222 @@ void split_hmis(ParCSRMatrix* S, std::vector<int>& states,
     pmis_main_loop(S, states, off_proc_states, tap_cf, rand_vals);
 }
 
+/**************************************************************
+*****   Split Aggressive
+**************************************************************
+***** Aggressive coarsening: refines an existing splitting with a
+***** second PMIS pass over its coarse points, on distance-two
+***** strength.  Coarse point i strongly depends on coarse point j
+***** in S2 if there is a path of at most two strong connections
+***** from i to j in S.  Coarse points not selected by the second
+***** pass become fine, and off_proc_states are updated to match.
+*****
+***** Parameters
+***** -------------
+***** S : ParCSRMatrix*
+*****    Strength of connection matrix
+***** states : std::vector<int>&
+*****    Splitting of the first pass, replaced by the coarser one
+***** off_proc_states : std::vector<int>&
+*****    States of off_proc columns of S
+***** tap_cf : bool
+*****    Use node-aware communication with S
+***** rand_vals : double* (optional)
+*****    Random weights of local rows of S (those of coarse points
+*****    are used in the second pass)
+**************************************************************/
+void split_aggressive(ParCSRMatrix* S, std::vector<int>& states,
+        std::vector<int>& off_proc_states, bool tap_cf,
+        double* rand_vals)
+{
+    int rank, num_procs;
+    RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
+    RAPtor_MPI_Comm_size(RAPtor_MPI_COMM_WORLD, &num_procs);
+
+    int start, end, col, row;
+    int num_coarse, first_coarse, global_num_coarse;
+
+    CommPkg* comm = S->comm;
+    CommPkg* mat_comm = S->comm;
+    if (tap_cf)
+    {
+        comm = S->tap_comm;
+        mat_comm = S->tap_mat_comm;
+    }
+
+    S->sort();
+    S->on_proc->move_diag();
+
+    // Number coarse points contiguously across processes
+    std::vector<int> coarse_id(S->local_num_rows, -1);
+    num_coarse = 0;
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        if (states[i] == Selected)
+        {
+            coarse_id[i] = num_coarse++;
+        }
+    }
+    std::vector<int> proc_num_coarse(num_procs);
+    RAPtor_MPI_Allgather(&num_coarse, 1, RAPtor_MPI_INT, proc_num_coarse.data(), 1,
+            RAPtor_MPI_INT, RAPtor_MPI_COMM_WORLD);
+    first_coarse = 0;
+    global_num_coarse = 0;
+    for (int p = 0; p < num_procs; p++)
+    {
+        if (p < rank) first_coarse += proc_num_coarse[p];
+        global_num_coarse += proc_num_coarse[p];
+    }
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        if (coarse_id[i] >= 0)
+        {
+            coarse_id[i] += first_coarse;
+        }
+    }
+    std::vector<int>& recv_ids = comm->communicate(coarse_id);
+    std::vector<int> off_coarse_id(recv_ids.begin(), 
+            recv_ids.begin() + S->off_proc_num_cols);
+
+    // Coarse points each row strongly depends on, exchanged for
+    // off_proc rows
+    std::vector<int> rowptr(S->local_num_rows + 1);
+    std::vector<int> coarse_cols;
+    std::vector<double> no_vals;
+    rowptr[0] = 0;
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        start = S->on_proc->idx1[i];
+        end = S->on_proc->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            col = S->on_proc->idx2[j];
+            if (col != i && coarse_id[col] >= 0)
+            {
+                coarse_cols.emplace_back(coarse_id[col]);
+            }
+        }
+        start = S->off_proc->idx1[i];
+        end = S->off_proc->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            col = S->off_proc->idx2[j];
+            if (off_coarse_id[col] >= 0)
+            {
+                coarse_cols.emplace_back(off_coarse_id[col]);
+            }
+        }
+        rowptr[i+1] = coarse_cols.size();
+    }
+    CSRMatrix* recv_mat = mat_comm->communicate(rowptr, coarse_cols, no_vals,
+            1, 1, false);
+
+    // Form distance-two strength between coarse points (diagonal
+    // first in each row)
+    ParCSRMatrix* S2 = new ParCSRMatrix(global_num_coarse, global_num_coarse,
+            num_coarse, num_coarse, first_coarse, first_coarse);
+    Matrix* S2_on = S2->on_proc;
+    Matrix* S2_off = S2->off_proc;
+    std::vector<int> row_cols;
+    S2_on->idx1[0] = 0;
+    S2_off->idx1[0] = 0;
+    row = 0;
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        if (coarse_id[i] < 0) continue;
+
+        row_cols.assign(coarse_cols.begin() + rowptr[i], 
+                coarse_cols.begin() + rowptr[i+1]);
+        start = S->on_proc->idx1[i];
+        end = S->on_proc->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            col = S->on_proc->idx2[j];
+            if (col == i) continue;
+            row_cols.insert(row_cols.end(), coarse_cols.begin() + rowptr[col],
+                    coarse_cols.begin() + rowptr[col+1]);
+        }
+        start = S->off_proc->idx1[i];
+        end = S->off_proc->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            col = S->off_proc->idx2[j];
+            row_cols.insert(row_cols.end(), 
+                    recv_mat->idx2.begin() + recv_mat->idx1[col],
+                    recv_mat->idx2.begin() + recv_mat->idx1[col+1]);
+        }
+        sort_unique(row_cols);
+
+        S2_on->idx2.emplace_back(row);
+        S2_on->vals.emplace_back(1.0);
+        for (std::vector<int>::iterator it = row_cols.begin(); 
+                it != row_cols.end(); ++it)
+        {
+            col = *it;
+            if (col == coarse_id[i]) continue;
+            if (col >= first_coarse && col < first_coarse + num_coarse)
+            {
+                S2_on->idx2.emplace_back(col - first_coarse);
+                S2_on->vals.emplace_back(1.0);
+            }
+            else
+            {
+                S2_off->idx2.emplace_back(col);
+                S2_off->vals.emplace_back(1.0);
+            }
+        }
+        row++;
+        S2_on->idx1[row] = S2_on->idx2.size();
+        S2_off->idx1[row] = S2_off->idx2.size();
+    }
+    S2_on->nnz = S2_on->idx2.size();
+    S2_off->nnz = S2_off->idx2.size();
+    S2->off_proc_num_cols = global_num_coarse;
+    S2->finalize();
+    delete recv_mat;
+
+    // Second PMIS pass, over coarse points only
+    std::vector<double> coarse_rand_vals;
+    double* coarse_rand_ptr = NULL;
+    if (rand_vals)
+    {
+        coarse_rand_vals.resize(num_coarse + 1);
+        for (int i = 0; i < S->local_num_rows; i++)
+        {
+            if (coarse_id[i] >= 0)
+            {
+                coarse_rand_vals[coarse_id[i] - first_coarse] = rand_vals[i];
+            }
+        }
+        coarse_rand_ptr = coarse_rand_vals.data();
+    }
+    std::vector<int> coarse_states;
+    std::vector<int> off_coarse_states;
+    split_pmis(S2, coarse_states, off_coarse_states, false, coarse_rand_ptr);
+
+    // Coarse points without distance-two neighbors stay coarse
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        if (coarse_id[i] >= 0)
+        {
+            row = coarse_id[i] - first_coarse;
+            if (coarse_states[row] != Selected && coarse_states[row] != NoNeighbors)
+            {
+                states[i] = Unselected;
+            }
+        }
+    }
+    delete S2;
+
+    if (S->off_proc_num_cols)
+    {
+        off_proc_states.resize(S->off_proc_num_cols);
+    }
+    std::vector<int>& recvbuf = comm->communicate(states);
+    std::copy(recvbuf.begin(), recvbuf.begin() + S->off_proc_num_cols, 
+            off_proc_states.begin());
+}
+
 void set_initial_states(ParCSRMatrix* S, std::vector<int>& states)
 {
     if (S->local_num_rows == 0) return;
@@ -206,92 +425,112 @@ void reset_boundaries(ParCSRMatrix* S, std::vector<int>& states)
     }
 }
 
+/**************************************************************
+*****   Transpose Pattern
+**************************************************************
+***** Forms the column pointer and (row) indices of the pattern of
+***** mat, with n_rows rows and n_cols columns, skipping the
+***** diagonal of each row if skip_diag.  Row indices of each column are increasing.
+*****
+***** Large patterns are transposed by multiple threads, each 
+***** counting the columns of a contiguous range of rows, so that
+***** threads place their rows into disjoint positions.
+**************************************************************/
+void transpose_pattern(const Matrix* mat, int n_rows, int n_cols, bool skip_diag,
+        std::vector<int>& col_ptr, std::vector<int>& col_indices)
+{
+    int n_threads = work_threads(mat->idx1[n_rows]);
+
+    // Position of each thread's rows within each column
+    std::vector<int> thread_pos((long) n_threads * n_cols, 0);
+    std::fill(col_ptr.begin(), col_ptr.end(), 0);
+
+    RAPTOR_OMP(omp parallel num_threads(n_threads))
+    {
+        int tid = thread_id();
+        int n_team = team_size();
+        int first, last;
+        int start, end, col;
+        thread_range(mat->idx1, n_rows, tid, n_team, first, last);
+        int* pos = thread_pos.data() + (long) tid * n_cols;
+
+        // Calculate nnz in each col
+        for (int i = first; i < last; i++)
+        {
+            start = mat->idx1[i];
+            end = mat->idx1[i+1];
+            if (skip_diag && start < end && mat->idx2[start] == i)
+            {
+                start++;
+            }
+            for (int j = start; j < end; j++)
+            {
+                pos[mat->idx2[j]]++;
+            }
+        }
+
+        // Create col_ptrs
+        RAPTOR_OMP(omp barrier)
+        RAPTOR_OMP(omp for)
+        for (int c = 0; c < n_cols; c++)
+        {
+            int size = 0;
+            for (int t = 0; t < n_team; t++)
+            {
+                int count = thread_pos[(long) t * n_cols + c];
+                thread_pos[(long) t * n_cols + c] = size;
+                size += count;
+            }
+            col_ptr[c+1] = size;
+        }
+        RAPTOR_OMP(omp single)
+        {
+            for (int c = 0; c < n_cols; c++)
+            {
+                col_ptr[c+1] += col_ptr[c];
+            }
+        }
+
+        // Add indices to col_indices
+        for (int i = first; i < last; i++)
+        {
+            start = mat->idx1[i];
+            end = mat->idx1[i+1];
+            if (skip_diag && start < end && mat->idx2[start] == i)
+            {
+                start++;
+            }
+            for (int j = start; j < end; j++)
+            {
+                col = mat->idx2[j];
+                col_indices[col_ptr[col] + pos[col]++] = i;
+            }
+        }
+    }
+}
+
 void transpose(const ParCSRMatrix* S,
         std::vector<int>& on_col_ptr, 
         std::vector<int>& off_col_ptr, 
         std::vector<int>& on_col_indices,
         std::vector<int>& off_col_indices)
 {
-    int start, end;
-    int col, idx;
-    std::vector<int> on_col_sizes;
-    std::vector<int> off_col_sizes;
-
     // Resize to corresponding dimensions of S
     on_col_ptr.resize(S->on_proc_num_cols+1);
     off_col_ptr.resize(S->off_proc_num_cols+1);
     if (S->on_proc_num_cols)
     {
-        on_col_sizes.resize(S->on_proc_num_cols, 0);
         on_col_indices.resize(S->on_proc->nnz);
     }
     if (S->off_proc_num_cols)
     {
-        off_col_sizes.resize(S->off_proc_num_cols, 0);
         off_col_indices.resize(S->off_proc->nnz);
     }
 
-    // Calculate nnz in each col
-    for (int i = 0; i < S->local_num_rows; i++)
-    {
-        start = S->on_proc->idx1[i];
-        end = S->on_proc->idx1[i+1];
-        if (S->on_proc->idx2[start] == i)
-        {
-            start++;
-        }
-        for (int j = start; j < end; j++)
-        {
-            col = S->on_proc->idx2[j];
-            on_col_sizes[col]++;
-        }
-        start = S->off_proc->idx1[i];
-        end = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->off_proc->idx2[j];
-            off_col_sizes[col]++;
-        }
-    }
-
-    // Create col_ptrs
-    on_col_ptr[0] = 0;
-    for (int i = 0; i < S->on_proc_num_cols; i++)
-    {
-        on_col_ptr[i+1] = on_col_ptr[i] + on_col_sizes[i];
-        on_col_sizes[i] = 0;
-    }
-    off_col_ptr[0] = 0;
-    for (int i = 0; i < S->off_proc_num_cols; i++)
-    {
-        off_col_ptr[i+1] = off_col_ptr[i] + off_col_sizes[i];
-        off_col_sizes[i] = 0;
-    }
-
-    // Add indices to col_indices
-    for (int i = 0; i < S->local_num_rows; i++)
-    {
-        start = S->on_proc->idx1[i];
-        end = S->on_proc->idx1[i+1];
-        if (S->on_proc->idx2[start] == i)
-        {
-            start++;
-        }
-        for (int j = start; j < end; j++)
-        {
-            col = S->on_proc->idx2[j];
-            idx = on_col_ptr[col] + on_col_sizes[col]++;
-            on_col_indices[idx] = i;
-        }
-        start = S->off_proc->idx1[i];
-        end = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->off_proc->idx2[j];
-            idx = off_col_ptr[col] + off_col_sizes[col]++;
-            off_col_indices[idx] = i;
-        }
-    }
+    transpose_pattern(S->on_proc, S->local_num_rows, S->on_proc_num_cols, true,
+            on_col_ptr, on_col_indices);
+    transpose_pattern(S->off_proc, S->local_num_rows, S->off_proc_num_cols, false,
+            off_col_ptr, off_col_indices);
 }
 
 void initial_weights(const ParCSRMatrix* S,
@@ -446,6 +685,18 @@ void find_max_off_weights(CommPkg* comm,
     }
 }
 
+/**************************************************************
+*****   Select Independent Set
+**************************************************************
+***** Adds each unassigned u with weight at least that of all its
+***** unassigned strong neighbors (on_proc and off_proc, in rows
+***** and columns of S) to new_coarse_list, setting its state to
+***** NewSelection.  Returns the number of new coarse points.
+*****
+***** Each test only reads weights, so large sets are tested by
+***** multiple threads over contiguous blocks of unassigned, and
+***** their selections appended in order, as a single thread would.
+**************************************************************/
 int select_independent_set(const ParCSRMatrix* S, 
         const int remaining,
         const std::vector<int>& unassigned,
@@ -458,22 +709,16 @@ int select_independent_set(const ParCSRMatrix* S,
         const std::vector<int>& off_proc_states,
         std::vector<int>& new_coarse_list)
 {
-    int start, end, idx;
-    
-    int j, u;
-    int num_new_coarse = 0;
-    double weight;
-
-    for (int i = 0; i < remaining; i++)
+    auto local_max = [&](int u)
     {
-        u = unassigned[i];
-        weight = weights[u];
+        int start, end;
+        double weight = weights[u];
 
         // Compare to max weight (with unassigned state), strongly connected
         // in a column of S (off_proc)
         if (max_off_weights[u] > weight)
         {
-           continue; 
+            return false;
         }
 
         // Compare to weights of unassigned states, strongly connected in
@@ -484,60 +729,95 @@ int select_independent_set(const ParCSRMatrix* S,
         {
             start++;
         }
-        for (j = start; j < end; j++)
+        for (int j = start; j < end; j++)
         {
-            idx = S->on_proc->idx2[j];
-            if (weights[idx] > weight)
+            if (weights[S->on_proc->idx2[j]] > weight)
             {
-                break;
+                return false;
             }
         }
-        if (j != end)
-        {
-            continue;
-        }
 
         // Compare to weights of unassigned states, strongly connected in
         // row of S (off_proc)
         start = S->off_proc->idx1[u];
         end = S->off_proc->idx1[u+1];
-        for (j = start; j < end; j++)
+        for (int j = start; j < end; j++)
         {
-            idx = S->off_proc->idx2[j];
-            if (off_proc_weights[idx] > weight)
+            if (off_proc_weights[S->off_proc->idx2[j]] > weight)
             {
-                break;
+                return false;
             }
         }
-        if (j != end)
-        {
-            continue;
-        }
                
         // Compare to weights of unassigned states, strongly connected in
         // column of S (on_proc)
         start = on_col_ptr[u];
         end = on_col_ptr[u+1];
-        for (j = start; j < end; j++)
+        for (int j = start; j < end; j++)
         {
-            idx = on_col_indices[j];
-            if (weights[idx] > weight)
+            if (weights[on_col_indices[j]] > weight)
             {
-                break;
+                return false;
             }
         }
-        if (j != end)
+
+        // If u made it this far, weight is greater than all unassigned
+        // neighbors
+        return true;
+    };
+
+    int num_new_coarse = 0;
+    long nnz = S->on_proc->idx1[S->local_num_rows] + S->off_proc->idx1[S->local_num_rows];
+    long work = S->local_num_rows ? (remaining * nnz) / S->local_num_rows : 0;
+    int n_threads = work_threads(work);
+
+    if (n_threads == 1)
+    {
+        for (int i = 0; i < remaining; i++)
         {
-            continue;
+            int u = unassigned[i];
+            if (local_max(u))
+            {
+                states[u] = NewSelection;
+                new_coarse_list[num_new_coarse++] = u;
+            }
         }
+        return num_new_coarse;
+    }
 
-        // If i made it this far, weight is greater than all unassigned
-        // neighbors
-        states[u] = NewSelection;
-        new_coarse_list[num_new_coarse++] = u;
+    std::vector<std::vector<int> > thread_coarse(n_threads);
+    std::vector<int> thread_ptr(n_threads + 1, 0);
+    RAPTOR_OMP(omp parallel num_threads(n_threads))
+    {
+        int tid = thread_id();
+        int n_team = team_size();
+        int first = ((long) remaining * tid) / n_team;
+        int last = ((long) remaining * (tid + 1)) / n_team;
+        std::vector<int>& coarse = thread_coarse[tid];
+        for (int i = first; i < last; i++)
+        {
+            int u = unassigned[i];
+            if (local_max(u))
+            {
+                states[u] = NewSelection;
+                coarse.emplace_back(u);
+            }
+        }
+        thread_ptr[tid+1] = coarse.size();
+
+        RAPTOR_OMP(omp barrier)
+        RAPTOR_OMP(omp single)
+        {
+            for (int t = 0; t < n_threads; t++)
+            {
+                thread_ptr[t+1] += thread_ptr[t];
+            }
+        }
+        std::copy(coarse.begin(), coarse.end(), 
+                new_coarse_list.begin() + thread_ptr[tid]);
     }
 
-    return num_new_coarse;
+    return thread_ptr[n_threads];
 }
 
 void update_row_weights(const ParCSRMatrix* S,
@@ -734,20 +1014,13 @@ void update_off_proc_dist2_weights(const ParCSRMatrix* S,
     std::vector<int> off_indices;
     std::vector<int> on_proc_col_to_coarse;
     std::vector<int> off_proc_col_to_coarse;
-    std::map<int, int> map_to_local;
-    
+
     std::vector<int> c_dep_cache;
     if (S->off_proc_num_cols)
     {
         c_dep_cache.resize(S->off_proc_num_cols, Unassigned);
     }
 
-    // Map global off_proc columns to local indices
-    for (int i = 0; i < S->off_proc_num_cols; i++)
-    {
-        map_to_local[S->off_proc_column_map[i]] = i;
-    }
-
     // Map index i in on(/off)_proc_num_cols to coarse_list
     if (S->on_proc_num_cols)
     {
@@ -979,7 +1252,7 @@ int find_off_proc_states(CommPkg* comm,
 
 void find_off_proc_new_coarse(const ParCSRMatrix* S,
         CommPkg* comm,
-        const std::map<int, int>& global_to_local,
+        const IndexMap& global_to_local,
         const std::vector<int>& states,
         const std::vector<int>& off_proc_states,
         const int* part_to_col,
@@ -1062,11 +1335,10 @@ void find_off_proc_new_coarse(const ParCSRMatrix* S,
                 }
                 else
                 {
-                    std::map<int, int>::const_iterator ptr = 
-                    global_to_local.find(global_col);
-                    if (ptr != global_to_local.end())
+                    int local_col = global_to_local.find(global_col);
+                    if (local_col >= 0)
                     {
-                        off_proc_col_coarse.emplace_back(ptr->second + S->on_proc_num_cols);
+                        off_proc_col_coarse.emplace_back(local_col + S->on_proc_num_cols);
                     }   
                 }
             }
@@ -1195,11 +1467,10 @@ void find_off_proc_new_coarse(const ParCSRMatrix* S,
                         }
                         else
                         {
-                            std::map<int, int>::const_iterator ptr = 
-                            global_to_local.find(global_col);
-                            if (ptr != global_to_local.end())
+                            int local_col = global_to_local.find(global_col);
+                            if (local_col >= 0)
                             {
-                                off_proc_col_coarse.emplace_back(ptr->second + S->on_proc_num_cols);
+                                off_proc_col_coarse.emplace_back(local_col + S->on_proc_num_cols);
                             }   
                         }
                     }
@@ -1276,15 +1547,21 @@ void pmis_main_loop(ParCSRMatrix* S,
         bool tap_comm, double* rand_vals)
 {
     int start, end, row;
-    int idx;
+    int idx, ctr, new_state;
     int num_new_coarse;
     int num_remaining;
     int num_remaining_off;
+    int num_unsent;
+    double max_weight;
     std::vector<double> off_proc_weights;
+    std::vector<double> send_weights;
     std::vector<double> max_weights;
     std::vector<int> new_coarse_list;
     std::vector<int> unassigned;
     std::vector<int> unassigned_off;
+    std::vector<int> sent_states;
+    std::vector<int> recv_states;
+    std::vector<int> unsent;
 
     std::vector<int> on_col_ptr;
     std::vector<int> off_col_ptr;
@@ -1301,12 +1578,16 @@ void pmis_main_loop(ParCSRMatrix* S,
         unassigned.resize(S->local_num_rows);
         max_weights.resize(S->local_num_rows);
         new_coarse_list.resize(S->local_num_rows);
+        sent_states.resize(S->local_num_rows);
+        unsent.resize(S->local_num_rows);
     }
     if (S->off_proc_num_cols)
     {
         unassigned_off.resize(S->off_proc_num_cols);
         off_proc_weights.resize(S->off_proc_num_cols);
         off_proc_states.resize(S->off_proc_num_cols);
+        send_weights.resize(S->off_proc_num_cols);
+        recv_states.resize(S->off_proc_num_cols);
     }
 
     transpose(S, on_col_ptr, off_col_ptr, on_col_indices, off_col_indices);
@@ -1349,56 +1630,101 @@ void pmis_main_loop(ParCSRMatrix* S,
         }
     }   
     
-    std::vector<int>& recvbuf = comm->communicate(states);
-
+    // Off_proc states are found in the first exchange of the main loop,
+    // which sends every state: off_proc_states (and sent_states, the
+    // states each neighbor last received) start as Unassigned
     num_remaining_off = 0;
     for (int i = 0; i < S->off_proc_num_cols; i++)
     {
-        off_proc_states[i] = recvbuf[i];
-        if (off_proc_states[i] == Unassigned)
-        {
-            unassigned_off[num_remaining_off++] = i;
-        }
+        off_proc_states[i] = Unassigned;
+        unassigned_off[num_remaining_off++] = i;
+    }
+    num_unsent = S->local_num_rows;
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        sent_states[i] = Unassigned;
+        unsent[i] = i;
     }
 
     // Find off_proc_weights
-    bool first_pass = true;
-
     find_off_proc_weights(comm, states, off_proc_states, 
-            weights, off_proc_weights, first_pass);
-
-    while (num_remaining || num_remaining_off || first_pass)
+            weights, off_proc_weights, true);
+
+    // Each iteration is a single exchange with each neighbor, sending
+    // states selected last iteration and receiving the max weights
+    // of unassigned off_proc rows in each column.  Selections made
+    // by neighbors are seen an iteration late, which can only delay
+    // (not change) selections, so the splitting is unchanged.
+    // Neighbors stop exchanging once both sides have sent all final
+    // states, and a process is done once it has no unassigned rows,
+    // off_proc columns, or unsent states.  A TAPComm exchanges every
+    // entry, and routes messages through other processes of each node,
+    // so with tap_comm all processes continue until every one is done.
+    std::function<bool(int)> compare_func = [](const int a)
+    {
+        return a == Unassigned;
+    };
+    std::function<double(double, double)> result_max = [](double c, double d)
     {
-        // Find max unassigned weight in each row / column
-        find_max_off_weights(comm, off_col_ptr, off_col_indices, 
-                states, off_proc_states, weights, max_weights, first_pass);
-        
-        // For each vertex, if max in neighborhood, add to C
-        num_new_coarse = select_independent_set(S, num_remaining, unassigned,
-                weights, off_proc_weights, max_weights, on_col_ptr,
-                on_col_indices, states, off_proc_states, new_coarse_list);
-
-        find_off_proc_states(comm, states, off_proc_states, first_pass);
-
-        // For each row, if new C point in row, add row to F
-        for (int i = 0; i < num_new_coarse; i++)
+        if (c > d) return c;
+        else return d;
+    };
+    int active = num_remaining || num_remaining_off || num_unsent;
+    if (tap_comm)
+    {
+        RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &active, 1, RAPtor_MPI_INT,
+                RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+    }
+    while (active)
+    {
+        // Find max weight of unassigned rows in each unassigned
+        // off_proc column
+        for (int i = 0; i < num_remaining_off; i++)
         {
-            idx = new_coarse_list[i];
-            start = on_col_ptr[idx];
-            end = on_col_ptr[idx+1];
+            idx = unassigned_off[i];
+            max_weight = 0;
+            start = off_col_ptr[idx];
+            end = off_col_ptr[idx+1];
             for (int j = start; j < end; j++)
             {
-                row = on_col_indices[j];
-                if (states[row] == Unassigned)
+                row = off_col_indices[j];
+                if (states[row] == Unassigned && weights[row] > max_weight)
                 {
-                    states[row] = NewUnselection;
+                    max_weight = weights[row];
                 }
             }
+            send_weights[idx] = max_weight;
         }
+        std::fill(max_weights.begin(), max_weights.end(), 0);
+
+        comm->conditional_exchange(states, send_weights, sent_states,
+                off_proc_states, compare_func, recv_states, max_weights,
+                result_max);
+
+        ctr = 0;
+        for (int i = 0; i < num_unsent; i++)
+        {
+            row = unsent[i];
+            sent_states[row] = states[row];
+            if (states[row] == Unassigned)
+            {
+                unsent[ctr++] = row;
+            }
+        }
+        num_unsent = ctr;
+
+        // For each row, if new off_proc C point in row, add row to F
+        ctr = 0;
         for (int i = 0; i < num_remaining_off; i++)
         {
             idx = unassigned_off[i];
-            if (off_proc_states[idx] == NewSelection)
+            new_state = recv_states[idx];
+            if (new_state == Unassigned)
+            {
+                unassigned_off[ctr++] = idx;
+                continue;
+            }
+            if (new_state == NewSelection)
             {
                 start = off_col_ptr[idx];
                 end = off_col_ptr[idx+1];
@@ -1410,17 +1736,46 @@ void pmis_main_loop(ParCSRMatrix* S,
                         states[row] = NewUnselection;
                     }
                 }
-            }       
+                new_state = Selected;
+            }
+            else if (new_state == NewUnselection)
+            {
+                new_state = Unselected;
+            }
+            off_proc_states[idx] = new_state;
+            off_proc_weights[idx] = 0.0;
         }
-
-        find_off_proc_states(comm, states, off_proc_states, first_pass);
+        num_remaining_off = ctr;
 
         num_remaining = update_states(weights, states, num_remaining, unassigned);
-        num_remaining_off = update_states(off_proc_weights,
-               off_proc_states, num_remaining_off, unassigned_off);
 
-        first_pass = false;
-        comm = S->comm;
+        // For each vertex, if max in neighborhood, add to C
+        num_new_coarse = select_independent_set(S, num_remaining, unassigned,
+                weights, off_proc_weights, max_weights, on_col_ptr,
+                on_col_indices, states, off_proc_states, new_coarse_list);
+
+        // For each row, if new C point in row, add row to F
+        for (int i = 0; i < num_new_coarse; i++)
+        {
+            idx = new_coarse_list[i];
+            start = on_col_ptr[idx];
+            end = on_col_ptr[idx+1];
+            for (int j = start; j < end; j++)
+            {
+                row = on_col_indices[j];
+                if (states[row] == Unassigned)
+                {
+                    states[row] = NewUnselection;
+                }
+            }
+        }
+
+        active = num_remaining || num_remaining_off || num_unsent;
+        if (tap_comm)
+        {
+            RAPtor_MPI_Allreduce(RAPtor_MPI_IN_PLACE, &active, 1, RAPtor_MPI_INT,
+                    RAPtor_MPI_MAX, RAPtor_MPI_COMM_WORLD);
+        }
     }
 }
 
@@ -1433,9 +1788,11 @@ void cljp_main_loop(ParCSRMatrix* S,
      * Declare and Initialize Variables
      **********************************************/
     int ctr;
+    int start, end, row, idx;
     int num_new_coarse;
     int off_num_new_coarse;
     int remaining, off_remaining;
+    double max_weight;
 
     CommPkg* comm = S->comm;
     CommPkg* mat_comm = S->comm;
@@ -1448,10 +1805,11 @@ void cljp_main_loop(ParCSRMatrix* S,
     std::vector<double> max_weights;
     std::vector<int> weight_updates;
     std::vector<double> off_proc_weights;
+    std::vector<double> send_weights;
     std::vector<int> off_proc_col_coarse;
     std::vector<int> off_proc_weight_updates;
     std::vector<int> off_proc_col_ptr;
-    std::map<int, int> global_to_local;
+    IndexMap global_to_local;
     std::vector<int> new_coarse_list;
     std::vector<int> off_new_coarse_list;
     std::vector<int> unassigned;
@@ -1477,6 +1835,7 @@ void cljp_main_loop(ParCSRMatrix* S,
     {
         off_proc_weight_updates.resize(S->off_proc_num_cols);
         off_proc_weights.resize(S->off_proc_num_cols, 0);
+        send_weights.resize(S->off_proc_num_cols, 0);
         off_proc_states.resize(S->off_proc_num_cols);
         off_new_coarse_list.resize(S->off_proc_num_cols);
         unassigned_off.resize(S->off_proc_num_cols);
@@ -1498,10 +1857,7 @@ void cljp_main_loop(ParCSRMatrix* S,
     }
     off_proc_col_ptr.resize(S->off_proc_num_cols + 1);
 
-    for (int i = 0; i < S->off_proc_num_cols; i++)
-    {
-        global_to_local[S->off_proc_column_map[i]] = i;
-    }
+    global_to_local.init(S->off_proc_column_map);
 
     initial_weights(S, comm, weights, rand_vals);
 
@@ -1557,6 +1913,16 @@ void cljp_main_loop(ParCSRMatrix* S,
 	    }
     }
 
+    std::function<bool(int)> compare_func = [](const int a)
+    {
+        return a == Unassigned;
+    };
+    std::function<double(double, double)> result_max = [](double c, double d)
+    {
+        if (c > d) return c;
+        else return d;
+    };
+
     /**********************************************
      * While any local vertices still need assigned,
      * select independent set and update weights
@@ -1567,9 +1933,14 @@ void cljp_main_loop(ParCSRMatrix* S,
         /**********************************************
         * For each local row i, find max weight in 
         * column i on all other processors (max_weights)
+        * After the first pass, these are exchanged
+        * along with off_proc_weights
         **********************************************/
-        find_max_off_weights(comm, off_col_ptr, off_col_indices, 
-                states, off_proc_states, weights, max_weights, first_pass);
+        if (first_pass)
+        {
+            find_max_off_weights(comm, off_col_ptr, off_col_indices, 
+                    states, off_proc_states, weights, max_weights, first_pass);
+        }
 
         /**********************************************
         * Selectedt independent set: all indices with
@@ -1619,9 +1990,31 @@ void cljp_main_loop(ParCSRMatrix* S,
         combine_weight_updates(comm, states, off_proc_states,
                 off_proc_weight_updates, weights, first_pass);
 
-        // Find weights of unassigned neighbors (off proc cols)
-        find_off_proc_weights(comm, states, off_proc_states, 
-                weights, off_proc_weights, first_pass);
+        // Find weights of unassigned neighbors (off proc cols), and
+        // max weights for the next iteration, in a single exchange.
+        // Max weights only include rows that stay unassigned (weight
+        // at least 1) after update_states below.
+        for (int i = 0; i < off_remaining; i++)
+        {
+            idx = unassigned_off[i];
+            max_weight = 0;
+            start = off_col_ptr[idx];
+            end = off_col_ptr[idx+1];
+            for (int j = start; j < end; j++)
+            {
+                row = off_col_indices[j];
+                if (states[row] == Unassigned && weights[row] >= 1.0
+                        && weights[row] > max_weight)
+                {
+                    max_weight = weights[row];
+                }
+            }
+            send_weights[idx] = max_weight;
+        }
+        std::fill(max_weights.begin(), max_weights.end(), 0);
+        comm->conditional_exchange(weights, send_weights, states,
+                off_proc_states, compare_func, off_proc_weights, max_weights,
+                result_max);
 
         // Update states, changing any new coarse states
         // from 2 to 1 (and changes weight to 0) and
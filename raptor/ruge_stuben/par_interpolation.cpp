@@ -1,8 +1,12 @@
 // Copyright (c) 2015-2017, RAPtor Developer Team
 // License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
 #include "assert.h"
+#include <algorithm>
+#include <functional>
 #include "raptor/core/types.hpp"
 #include "raptor/core/par_matrix.hpp"
+#include "raptor/core/workspace.hpp"
+#include "raptor/core/threads.hpp"
 
 namespace raptor {
 
@@ -11,18 +15,27 @@ CSRMatrix* communicate(ParCSRMatrix* A, ParCSRMatrix* S, const std::vector<int>&
         const std::vector<int>& off_proc_states, CommPkg* comm);
 CSRMatrix*  communicate(ParCSRMatrix* A, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, CommPkg* comm);
-void filter_interp(ParCSRMatrix* P, const double filter_threshold);
+void filter_interp(ParCSRMatrix* P, const double filter_threshold,
+        const int max_elmts = 0, std::vector<bool>* col_exists = NULL);
 ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, const double filter_threshold, 
-        bool tap_interp, int num_variables, int* variables);
+        bool tap_interp, int num_variables, int* variables, int max_elmts);
 ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, 
-        bool tap_interp, int num_variables, int* variables);
+        bool tap_interp, int num_variables, int* variables, int max_elmts);
 ParCSRMatrix* direct_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, bool tap_interp);
+ParCSRMatrix* multipass_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states,
+        const std::vector<int>& off_proc_states, bool tap_interp);
+ParCSRMatrix* two_stage_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states_1,
+        const std::vector<int>& off_proc_states_1,
+        const std::vector<int>& states, const std::vector<int>& off_proc_states,
+        const double filter_threshold, bool tap_interp, int max_elmts);
 
 
 
@@ -193,7 +206,18 @@ CSRMatrix*  communicate(ParCSRMatrix* A, const std::vector<int>& states,
     return comm->communicate(rowptr, col_indices, values);
 }
 
-void filter_interp(ParCSRMatrix* P, const double filter_threshold)
+/**************************************************************
+*****   Filter Interpolation
+**************************************************************
+***** Drops entries of P smaller than filter_threshold times the
+***** largest entry in the row, and then (if max_elmts > 0) keeps
+***** only the max_elmts largest entries of each row.  Remaining
+***** entries are rescaled so that each row sum is unchanged.
+***** If col_exists is passed, it is set to mark the off_proc
+***** columns still referenced by P.
+**************************************************************/
+void filter_interp(ParCSRMatrix* P, const double filter_threshold,
+        const int max_elmts, std::vector<bool>* col_exists)
 {
     int row_start_on = 0;
     int row_start_off = 0;
@@ -201,12 +225,17 @@ void filter_interp(ParCSRMatrix* P, const double filter_threshold)
     int ctr_on = 0;
     int ctr_off = 0;
     int prev_ctr_on, prev_ctr_off;
+    int row_size, num_ties;
 
     double val, abs_val;
     double row_max, row_sum, row_scale;
-    double remain_sum;
+    double remain_sum, cutoff;
 
-    if (filter_threshold > zero_tol && filter_threshold <= 1)
+    bool filter = (filter_threshold > zero_tol && filter_threshold <= 1);
+    bool truncate = (max_elmts > 0);
+    std::vector<double> row_abs;
+
+    if (filter || truncate)
     {
         for (int i = 0; i < P->local_num_rows; i++)
         {
@@ -217,30 +246,70 @@ void filter_interp(ParCSRMatrix* P, const double filter_threshold)
             row_end_off = P->off_proc->idx1[i+1];
 
             row_max = 0;
-            for (int j = row_start_on; j < row_end_on; j++)
+            if (filter)
             {
-                val = P->on_proc->vals[j];
-                abs_val = fabs(val);
-                if (abs_val > row_max) 
-                    row_max = abs_val;
+                for (int j = row_start_on; j < row_end_on; j++)
+                {
+                    val = P->on_proc->vals[j];
+                    abs_val = fabs(val);
+                    if (abs_val > row_max) 
+                        row_max = abs_val;
+                }
+                for (int j = row_start_off; j < row_end_off; j++)
+                {
+                    val = P->off_proc->vals[j];
+                    abs_val = fabs(val);
+                    if (abs_val > row_max) 
+                        row_max = abs_val;
+                }
+                row_max *= filter_threshold;
             }
-            for (int j = row_start_off; j < row_end_off; j++)
+
+            // Truncate to the max_elmts largest entries: keep those
+            // above the cutoff, and ties with the cutoff until the
+            // row is full
+            cutoff = 0;
+            num_ties = -1;
+            row_size = (row_end_on - row_start_on) + (row_end_off - row_start_off);
+            if (truncate && row_size > max_elmts)
             {
-                val = P->off_proc->vals[j];
-                abs_val = fabs(val);
-                if (abs_val > row_max) 
-                    row_max = abs_val;
+                row_abs.clear();
+                for (int j = row_start_on; j < row_end_on; j++)
+                    row_abs.push_back(fabs(P->on_proc->vals[j]));
+                for (int j = row_start_off; j < row_end_off; j++)
+                    row_abs.push_back(fabs(P->off_proc->vals[j]));
+                std::nth_element(row_abs.begin(), row_abs.begin() + (max_elmts - 1),
+                        row_abs.end(), std::greater<double>());
+                cutoff = row_abs[max_elmts - 1];
+                num_ties = 0;
+                for (int j = 0; j < max_elmts; j++)
+                {
+                    if (row_abs[j] == cutoff) num_ties++;
+                }
+                if (cutoff >= row_max)
+                {
+                    row_max = cutoff;
+                }
+                else
+                {
+                    num_ties = -1;
+                }
             }
 
-            row_max *= filter_threshold;
             row_sum = 0;
             remain_sum = 0;
             for (int j = row_start_on; j < row_end_on; j++)
             {
                 val = P->on_proc->vals[j];
+                abs_val = fabs(val);
                 row_sum += val;
-                if (fabs(val) >= row_max)
+                if (abs_val >= row_max)
                 {
+                    if (num_ties >= 0 && abs_val == row_max)
+                    {
+                        if (num_ties == 0) continue;
+                        num_ties--;
+                    }
                     P->on_proc->idx2[ctr_on] = P->on_proc->idx2[j];
                     P->on_proc->vals[ctr_on] = val;
                     ctr_on++;
@@ -250,9 +319,15 @@ void filter_interp(ParCSRMatrix* P, const double filter_threshold)
             for (int j = row_start_off; j < row_end_off; j++)
             {
                 val = P->off_proc->vals[j];
+                abs_val = fabs(val);
                 row_sum += val;
-                if (fabs(val) >= row_max)
+                if (abs_val >= row_max)
                 {
+                    if (num_ties >= 0 && abs_val == row_max)
+                    {
+                        if (num_ties == 0) continue;
+                        num_ties--;
+                    }
                     P->off_proc->idx2[ctr_off] = P->off_proc->idx2[j];
                     P->off_proc->vals[ctr_off] = val;
                     ctr_off++;
@@ -295,28 +370,118 @@ void filter_interp(ParCSRMatrix* P, const double filter_threshold)
     P->on_proc->vals.shrink_to_fit();
     P->off_proc->idx2.shrink_to_fit();
     P->off_proc->vals.shrink_to_fit();
+
+    if (col_exists)
+    {
+        std::fill(col_exists->begin(), col_exists->end(), false);
+        for (int j = 0; j < ctr_off; j++)
+        {
+            (*col_exists)[P->off_proc->idx2[j]] = true;
+        }
+    }
 }
 
+/**************************************************************
+*****   Form Interpolation Rows
+**************************************************************
+***** Forms the local rows of P->on_proc and P->off_proc with
+***** form_row_range(start, end, pos, off_pos, on_idx2, on_vals,
+***** off_idx2, off_vals), which appends rows [start, end) to the
+***** given buffers and sets P->on_proc->idx1[i+1] and 
+***** P->off_proc->idx1[i+1] to the sizes of each row i.  pos and
+***** off_pos mark the n_on on_proc and n_off off_proc columns 
+***** with positions in the buffers (initially -1).
+*****
+***** With multiple threads, each forms a contiguous range of rows
+***** (balanced by the row pointer ptr) in its own buffers, which
+***** are then copied into place, so P is unchanged by threading.
+**************************************************************/
+template <typename RowFunc>
+void form_interp_rows(ParCSRMatrix* P, const std::vector<int>& ptr,
+        int n_on, int n_off, RowFunc form_row_range)
+{
+    int n_rows = P->local_num_rows;
+    int n_threads = work_threads(ptr[n_rows]);
+
+    P->on_proc->idx2.clear();
+    P->on_proc->vals.clear();
+    P->off_proc->idx2.clear();
+    P->off_proc->vals.clear();
+
+    if (n_threads == 1)
+    {
+        WorkVector<int> pos(n_on, -1);
+        WorkVector<int> off_pos(n_off, -1);
+        form_row_range(0, n_rows, pos.vec(), off_pos.vec(), 
+                P->on_proc->idx2, P->on_proc->vals,
+                P->off_proc->idx2, P->off_proc->vals);
+    }
+    else
+    {
+        std::vector<std::vector<int> > on_idx2(n_threads);
+        std::vector<std::vector<double> > on_vals(n_threads);
+        std::vector<std::vector<int> > off_idx2(n_threads);
+        std::vector<std::vector<double> > off_vals(n_threads);
+        std::vector<int> on_ptr(n_threads + 1, 0);
+        std::vector<int> off_ptr(n_threads + 1, 0);
+
+        RAPTOR_OMP(omp parallel num_threads(n_threads))
+        {
+            int tid = thread_id();
+            int start, end;
+            thread_range(ptr, n_rows, tid, team_size(), start, end);
+
+            std::vector<int> pos(n_on, -1);
+            std::vector<int> off_pos(n_off, -1);
+            form_row_range(start, end, pos, off_pos, on_idx2[tid], on_vals[tid],
+                    off_idx2[tid], off_vals[tid]);
+            on_ptr[tid+1] = on_idx2[tid].size();
+            off_ptr[tid+1] = off_idx2[tid].size();
+
+            RAPTOR_OMP(omp barrier)
+            RAPTOR_OMP(omp single)
+            {
+                for (int t = 0; t < n_threads; t++)
+                {
+                    on_ptr[t+1] += on_ptr[t];
+                    off_ptr[t+1] += off_ptr[t];
+                }
+                P->on_proc->idx2.resize(on_ptr[n_threads]);
+                P->on_proc->vals.resize(on_ptr[n_threads]);
+                P->off_proc->idx2.resize(off_ptr[n_threads]);
+                P->off_proc->vals.resize(off_ptr[n_threads]);
+            }
+
+            std::copy(on_idx2[tid].begin(), on_idx2[tid].end(),
+                    P->on_proc->idx2.begin() + on_ptr[tid]);
+            std::copy(on_vals[tid].begin(), on_vals[tid].end(),
+                    P->on_proc->vals.begin() + on_ptr[tid]);
+            std::copy(off_idx2[tid].begin(), off_idx2[tid].end(),
+                    P->off_proc->idx2.begin() + off_ptr[tid]);
+            std::copy(off_vals[tid].begin(), off_vals[tid].end(),
+                    P->off_proc->vals.begin() + off_ptr[tid]);
+        }
+    }
+
+    P->on_proc->idx1[0] = 0;
+    P->off_proc->idx1[0] = 0;
+    for (int i = 0; i < n_rows; i++)
+    {
+        P->on_proc->idx1[i+1] += P->on_proc->idx1[i];
+        P->off_proc->idx1[i+1] += P->off_proc->idx1[i];
+    }
+    P->on_proc->nnz = P->on_proc->idx2.size();
+    P->off_proc->nnz = P->off_proc->idx2.size();
+}
 
 ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states,
         const double filter_threshold, 
-        bool tap_interp, int num_variables, int* variables)
+        bool tap_interp, int num_variables, int* variables, int max_elmts)
 {
-    int start, end, idx;
-    int ctr, end_S;
-    int start_k, end_k;
-    int col;
-    int col_k, col_P;
     int global_num_cols;
     int on_proc_cols, off_proc_cols;
-    int sign;
-    int row_start_on, row_start_off;
-    int row_end_on = 0;
-    int row_end_off = 0;
-    double val, val_k, weak_sum;
-    double diag, col_sum;
 
     CommPkg* comm = A->comm;
     CommPkg* mat_comm = A->comm;
@@ -326,8 +491,7 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
         mat_comm = A->tap_mat_comm;
     }
 
-    std::set<int> global_set;
-    std::map<int, int> global_to_local;
+    IndexMap global_to_local;
     std::vector<int> off_proc_column_map;
     std::vector<int> off_variables;
 
@@ -377,12 +541,11 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
     int S_recv_off_ctr = 0;
     for (int i = 0; i < recv_mat->n_rows; i++)
     {
-        start = recv_mat->idx1[i];
-        end = recv_mat->idx1[i+1];
+        int start = recv_mat->idx1[i];
+        int end = recv_mat->idx1[i+1];
         for (int j = start; j < end; j++)
         {
-            col = recv_mat->idx2[j];
-            val = recv_mat->vals[j];
+            int col = recv_mat->idx2[j];
 
             tmp_col = col;
             if (col < 0) 
@@ -442,26 +605,23 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
     {
         if (off_proc_states[i] == Selected)
         {
-            global_set.insert(S->off_proc_column_map[i]);
+            off_proc_column_map.emplace_back(S->off_proc_column_map[i]);
         }
     }
     for (int i = 0; i < S->off_proc_num_cols; i++)
     {
         if (off_proc_states[i] == Unselected)
         {
-            start = A_recv_off_ptr[i];
-            end = A_recv_off_ptr[i+1];
+            int start = A_recv_off_ptr[i];
+            int end = A_recv_off_ptr[i+1];
             for (int j = start; j < end; j++)
             {
-                global_set.insert(recv_mat->idx2[A_recv_off_idx[j]]);
+                off_proc_column_map.emplace_back(recv_mat->idx2[A_recv_off_idx[j]]);
             }
         }
     }
-    for (std::set<int>::iterator it = global_set.begin(); it != global_set.end(); ++it)
-    {
-        global_to_local[*it] = off_proc_column_map.size();
-        off_proc_column_map.push_back(*it);
-    }
+    sort_unique(off_proc_column_map);
+    global_to_local.init(off_proc_column_map);
     off_proc_cols = off_proc_column_map.size();
 
     for (std::vector<int>::iterator it = A_recv_off_idx.begin(); 
@@ -513,7 +673,7 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
     {
 	    off_proc_A_to_P.resize(A->off_proc_num_cols, -1);
     }
-    ctr = 0;
+    int P_ctr = 0;
     for (int i = 0; i < S->off_proc_num_cols; i++)
     {
         if (off_proc_states[i] != Selected)
@@ -521,383 +681,297 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
             continue; // Only for coarse points
         }
 
-        while (off_proc_column_map[ctr] < A->off_proc_column_map[i])
+        while (off_proc_column_map[P_ctr] < A->off_proc_column_map[i])
         {
-            ctr++;
+            P_ctr++;
         }
-        off_proc_A_to_P[i] = ctr;
+        off_proc_A_to_P[i] = P_ctr;
     }
 
     // For each row, will calculate coarse sums and store 
     // strong connections in vector
-    std::vector<int> pos;
-    std::vector<int> off_proc_pos;
-    std::vector<double> coarse_sum;
-    std::vector<double> off_proc_coarse_sum;
-    if (A->on_proc_num_cols)
-    {
-        pos.resize(A->on_proc_num_cols, -1);
-        coarse_sum.resize(A->on_proc_num_cols);
-    }
-    if (A->off_proc_num_cols)
-    {
-        off_proc_coarse_sum.resize(A->off_proc_num_cols);
-    }
-    if (P->off_proc_num_cols)
-    {
-        off_proc_pos.resize(P->off_proc_num_cols, -1);
-    }
-
-
-    // Find upperbound size of P->on_proc and P->off_proc
-    int nnz_on = 0;
-    int nnz_off = 0;
-    for (int i = 0; i < A->local_num_rows; i++)
+    form_interp_rows(P, A->on_proc->idx1, A->on_proc_num_cols, P->off_proc_num_cols,
+            [&](int row_start, int row_end, std::vector<int>& pos, std::vector<int>& off_pos,
+                std::vector<int>& on_idx2, std::vector<double>& on_vals,
+                std::vector<int>& off_idx2, std::vector<double>& off_vals)
     {
-        if (states[i] == Unselected)
+        int start, end, idx;
+        int ctr, end_S;
+        int start_k, end_k;
+        int col;
+        int col_k, col_P;
+        int sign;
+        int row_start_on, row_start_off;
+        int row_end_on, row_end_off;
+        double val, val_k, weak_sum;
+        double diag, col_sum;
+
+        for (int i = row_start; i < row_end; i++)
         {
-            nnz_on += (S->on_proc->idx1[i+1] - S->on_proc->idx1[i]);
-            nnz_off += (S->off_proc->idx1[i+1] - S->off_proc->idx1[i]);
-
-            start = S->on_proc->idx1[i]+1;
-            end = S->on_proc->idx1[i+1];
-            for (int j = start; j < end; j++)
-            {
-                col = S->on_proc->idx2[j];
-                if (states[col] == Unselected)
-                {
-                    nnz_on += (S->on_proc->idx1[col+1] - S->on_proc->idx1[col]);
-                    nnz_off += (S->off_proc->idx1[col+1] - S->off_proc->idx1[col]);
-                }
-            }
-            start = S->off_proc->idx1[i];
-            end = S->off_proc->idx1[i+1];
-            for (int j = start; j < end; j++)
+            // If coarse row, add to P
+            if (states[i] != Unselected)
             {
-                col = S->off_proc->idx2[j];
-                if (off_proc_states[col] == Unselected)
+                P->on_proc->idx1[i+1] = 0;
+                P->off_proc->idx1[i+1] = 0;
+                if (states[i] == Selected)
                 {
-                    nnz_on += (S_recv_on_ptr[col+1] - S_recv_on_ptr[col]);
-                    nnz_off += (S_recv_off_ptr[col+1] - S_recv_off_ptr[col]);
+                    on_idx2.emplace_back(on_proc_col_to_new[i]);
+                    on_vals.emplace_back(1);
+                    P->on_proc->idx1[i+1] = 1;
                 }
+                continue;
             }
-        }
-        else
-        {
-            nnz_on++;
-        }
-    }
-    P->on_proc->idx2.resize(nnz_on);
-    P->on_proc->vals.resize(nnz_on);
-    P->off_proc->idx2.resize(nnz_off);
-    P->off_proc->vals.resize(nnz_off);
-
-    nnz_on = 0;
-    nnz_off = 0;
-    for (int i = 0; i < A->local_num_rows; i++)
-    {
-        // If coarse row, add to P
-        if (states[i] != Unselected)
-        {
-            if (states[i] == Selected)
-            {
-                P->on_proc->idx2[nnz_on] = on_proc_col_to_new[i];
-                P->on_proc->vals[nnz_on++] = 1;
-            }
-            P->on_proc->idx1[i+1] = nnz_on;
-            P->off_proc->idx1[i+1] = nnz_off;
-            continue;
-        }
 
-        // Go through strong coarse points, 
-        // add to row coarse and create sparsity of P (dist1)
-        row_start_on = nnz_on;
-        row_start_off = nnz_off;
+            // Go through strong coarse points, 
+            // add to row coarse and create sparsity of P (dist1)
+            row_start_on = on_idx2.size();
+            row_start_off = off_idx2.size();
 
-        start = S->on_proc->idx1[i]+1;
-        end = S->on_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->on_proc->idx2[j];
-            val = S->on_proc->vals[j];
-            if (states[col] == Selected)
+            start = S->on_proc->idx1[i]+1;
+            end = S->on_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
             {
-                if (pos[col] < row_start_on)
+                col = S->on_proc->idx2[j];
+                if (states[col] == Selected)
                 {
-                    pos[col] = nnz_on;
-                    P->on_proc->idx2[nnz_on] = on_proc_col_to_new[col];
-                    P->on_proc->vals[nnz_on++] = 0.0;
+                    if (pos[col] < row_start_on)
+                    {
+                        pos[col] = on_idx2.size();
+                        on_idx2.emplace_back(on_proc_col_to_new[col]);
+                        on_vals.emplace_back(0.0);
+                    }
                 }
-            }
-            else if (states[col] == Unselected)
-            {
-                start_k = S->on_proc->idx1[col]+1;
-                end_k = S->on_proc->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
+                else if (states[col] == Unselected)
                 {
-                    col_k = S->on_proc->idx2[k];
-                    if (states[col_k] == Selected && pos[col_k] < row_start_on)
+                    start_k = S->on_proc->idx1[col]+1;
+                    end_k = S->on_proc->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        pos[col_k] = nnz_on;
-                        P->on_proc->idx2[nnz_on] = on_proc_col_to_new[col_k];
-                        P->on_proc->vals[nnz_on++] = 0.0;
+                        col_k = S->on_proc->idx2[k];
+                        if (states[col_k] == Selected && pos[col_k] < row_start_on)
+                        {
+                            pos[col_k] = on_idx2.size();
+                            on_idx2.emplace_back(on_proc_col_to_new[col_k]);
+                            on_vals.emplace_back(0.0);
+                        }
                     }
-                }
 
-                start_k = S->off_proc->idx1[col];
-                end_k = S->off_proc->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    col_k = S->off_proc->idx2[k];
-                    col_P = off_proc_A_to_P[col_k];
-                    if (off_proc_states[col_k] == Selected && off_proc_pos[col_P] < row_start_off)
+                    start_k = S->off_proc->idx1[col];
+                    end_k = S->off_proc->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        col_exists[col_P] = true;
-                        off_proc_pos[col_P] = nnz_off;
-                        P->off_proc->idx2[nnz_off] = col_P;
-                        P->off_proc->vals[nnz_off++] = 0.0;
+                        col_k = S->off_proc->idx2[k];
+                        col_P = off_proc_A_to_P[col_k];
+                        if (off_proc_states[col_k] == Selected && off_pos[col_P] < row_start_off)
+                        {
+                            off_pos[col_P] = off_idx2.size();
+                            off_idx2.emplace_back(col_P);
+                            off_vals.emplace_back(0.0);
+                        }
                     }
                 }
             }
-        }
 
-        start = S->off_proc->idx1[i];
-        end = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->off_proc->idx2[j];
-            val = S->off_proc->vals[j];
-            if (off_proc_states[col] == Selected)
+            start = S->off_proc->idx1[i];
+            end = S->off_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
             {
-                col_P = off_proc_A_to_P[col];
-                if (off_proc_pos[col_P] < row_start_off)
+                col = S->off_proc->idx2[j];
+                if (off_proc_states[col] == Selected)
                 {
-                    off_proc_pos[col_P] = nnz_off;
-                    col_exists[col_P] = true;
-                    P->off_proc->idx2[nnz_off] = col_P;
-                    P->off_proc->vals[nnz_off++] = 0.0;
+                    col_P = off_proc_A_to_P[col];
+                    if (off_pos[col_P] < row_start_off)
+                    {
+                        off_pos[col_P] = off_idx2.size();
+                        off_idx2.emplace_back(col_P);
+                        off_vals.emplace_back(0.0);
+                    }
                 }
-            }
-            else if (off_proc_states[col] == Unselected)
-            {
-                start_k = S_recv_on_ptr[col];
-                end_k = S_recv_on_ptr[col+1];
-                for (int k = start_k; k < end_k; k++)
+                else if (off_proc_states[col] == Unselected)
                 {
-                    idx = S_recv_on_idx[k];
-                    col_k = recv_mat->idx2[idx];
-                    if (pos[col_k] < row_start_on)
+                    start_k = S_recv_on_ptr[col];
+                    end_k = S_recv_on_ptr[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        pos[col_k] = nnz_on;
-                        P->on_proc->idx2[nnz_on] = on_proc_col_to_new[col_k];
-                        P->on_proc->vals[nnz_on++] = 0.0;
+                        idx = S_recv_on_idx[k];
+                        col_k = recv_mat->idx2[idx];
+                        if (pos[col_k] < row_start_on)
+                        {
+                            pos[col_k] = on_idx2.size();
+                            on_idx2.emplace_back(on_proc_col_to_new[col_k]);
+                            on_vals.emplace_back(0.0);
+                        }
                     }
-                }
 
-                start_k = S_recv_off_ptr[col];
-                end_k = S_recv_off_ptr[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    idx = S_recv_off_idx[k];
-                    col_k = recv_mat->idx2[idx];
-                    if (off_proc_pos[col_k] < row_start_off)
+                    start_k = S_recv_off_ptr[col];
+                    end_k = S_recv_off_ptr[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        off_proc_pos[col_k] = nnz_off;
-                        P->off_proc->idx2[nnz_off] = col_k;
-                        P->off_proc->vals[nnz_off++] = 0.0;
-                        col_exists[col_k] = true;
+                        idx = S_recv_off_idx[k];
+                        col_k = recv_mat->idx2[idx];
+                        if (off_pos[col_k] < row_start_off)
+                        {
+                            off_pos[col_k] = off_idx2.size();
+                            off_idx2.emplace_back(col_k);
+                            off_vals.emplace_back(0.0);
+                        }
                     }
                 }
             }
-        }
-        pos[i] = nnz_on;
-        row_end_on = nnz_on;
-        row_end_off = nnz_off;
+            pos[i] = on_idx2.size();
+            row_end_on = on_idx2.size();
+            row_end_off = off_idx2.size();
 
 
-        start = A->on_proc->idx1[i];
-        end = A->on_proc->idx1[i+1];
-        weak_sum = A->on_proc->vals[start++]; // Add a_ii to weak sum
-        ctr = S->on_proc->idx1[i]+1;
-        end_S = S->on_proc->idx1[i+1];
+            start = A->on_proc->idx1[i];
+            end = A->on_proc->idx1[i+1];
+            weak_sum = A->on_proc->vals[start++]; // Add a_ii to weak sum
+            ctr = S->on_proc->idx1[i]+1;
+            end_S = S->on_proc->idx1[i+1];
 
-        for (int j = start; j < end; j++)
-        {
-            col = A->on_proc->idx2[j];
-            val = A->on_proc->vals[j];
-            idx = pos[col];
-            if (idx >= row_start_on)
-            {
-                P->on_proc->vals[idx] += val;
-                if (ctr < end_S && S->on_proc->idx2[ctr] == col)
-                    ctr++;
-            }
-            else if (ctr < end_S && S->on_proc->idx2[ctr] == col)
+            for (int j = start; j < end; j++)
             {
-                ctr++;
-
-                if (states[col] != Unselected) continue;
-                
-                // sum a_kl for k in F-points of S and l in C^_i U {i}
-                // k = col (unselected, in S)
-                col_sum = 0;
-
-                // Find sum of all coarse points in row k (with sign NOT equal to diag)
-                start_k = A->on_proc->idx1[col];
-                end_k = A->on_proc->idx1[col+1];
-
-                // Only add a_kl if sign(a_kl) != sign (a_kk)
-                diag = A->on_proc->vals[start_k++];
-                if (diag > 0) sign = 1;
-                else sign = -1;
-
-                for (int k = start_k; k < end_k; k++)
+                col = A->on_proc->idx2[j];
+                val = A->on_proc->vals[j];
+                idx = pos[col];
+                if (idx >= row_start_on)
                 {
-                    col_k = A->on_proc->idx2[k]; // a_kl
-                    val_k = A->on_proc->vals[k];
-
-                    // sign(a_kl) != sign(a_kk) and a_kl in row of P (or == i)
-                    if (val_k * sign < 0 && pos[col_k] >= row_start_on)
-                    {
-                        col_sum += val_k;
-                    }
+                    on_vals[idx] += val;
+                    if (ctr < end_S && S->on_proc->idx2[ctr] == col)
+                        ctr++;
                 }
-
-                start_k = A->off_proc->idx1[col];
-                end_k = A->off_proc->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
+                else if (ctr < end_S && S->on_proc->idx2[ctr] == col)
                 {
-                    col_k = A->off_proc->idx2[k]; // a_kl
-                    val_k = A->off_proc->vals[k];
-                    col_P = off_proc_A_to_P[col_k];
-                    // sign(a_kl) != sign(a_kk) and a_kl in row of P
-                    if (col_P >= 0 && val_k * sign < 0 && off_proc_pos[col_P] >= row_start_off)
-                    {
-                        col_sum += val_k;
-                    }
-                }
+                    ctr++;
 
-                // If no strong connections (col_sum == 0), add to weak_sum
-                if (fabs(col_sum) < zero_tol)
-                {
-                    weak_sum += val;
-                }
-                else // Otherwise, add products to P
-                {
-                    col_sum = val / col_sum;  // product = a_ik / col_sum
+                    if (states[col] != Unselected) continue;
+                
+                    // sum a_kl for k in F-points of S and l in C^_i U {i}
+                    // k = col (unselected, in S)
+                    col_sum = 0;
 
-                    start_k = A->on_proc->idx1[col]+1; 
+                    // Find sum of all coarse points in row k (with sign NOT equal to diag)
+                    start_k = A->on_proc->idx1[col];
                     end_k = A->on_proc->idx1[col+1];
+
+                    // Only add a_kl if sign(a_kl) != sign (a_kk)
+                    diag = A->on_proc->vals[start_k++];
+                    if (diag > 0) sign = 1;
+                    else sign = -1;
+
                     for (int k = start_k; k < end_k; k++)
                     {
-                        col_k = A->on_proc->idx2[k]; // a_kj for some j
+                        col_k = A->on_proc->idx2[k]; // a_kl
                         val_k = A->on_proc->vals[k];
-                        idx = pos[col_k]; // Find idx of w_ij for j^^
-                        // if sign(a_kj) != sign(a_kk) and j in C^_{i} U {i}
-                        if (val_k * sign < 0 && idx >= row_start_on)
+
+                        // sign(a_kl) != sign(a_kk) and a_kl in row of P (or == i)
+                        if (val_k * sign < 0 && pos[col_k] >= row_start_on)
                         {
-                            if (col_k == i) // if j == i, add to weak sum
-                            {
-                                weak_sum += (col_sum * val_k);
-                            }
-                            else // Otherwise, add to w_ij
-                            {
-                                P->on_proc->vals[idx] += (col_sum * val_k);
-                            }
+                            col_sum += val_k;
                         }
                     }
-                
+
                     start_k = A->off_proc->idx1[col];
                     end_k = A->off_proc->idx1[col+1];
                     for (int k = start_k; k < end_k; k++)
                     {
-                        col_k = A->off_proc->idx2[k]; // a_kj for some j
+                        col_k = A->off_proc->idx2[k]; // a_kl
+                        val_k = A->off_proc->vals[k];
                         col_P = off_proc_A_to_P[col_k];
-                        if (col_P >= 0) // If column not in P, col not in C^_{i}
+                        // sign(a_kl) != sign(a_kk) and a_kl in row of P
+                        if (col_P >= 0 && val_k * sign < 0 && off_pos[col_P] >= row_start_off)
                         {
-                            val_k = A->off_proc->vals[k];
-                            idx = off_proc_pos[col_P]; // Find idx of w_ij 
-                            // If sign(a_kj) != sign(a_kk) and j in C^_{i}
-                            if (val_k * sign < 0 && idx >= row_start_off)
-                            {
-                                // Add to w_ij
-                                P->off_proc->vals[idx] += (col_sum * val_k);
-                            }
+                            col_sum += val_k;
                         }
-                    } 
-                }
-            }
-            else // Weak connection, add to weak_sum if not in C^_{i}
-            {
-                if (num_variables == 1 || variables[i] == variables[col])// weak connection
-                {
-                    if (states[col] != NoNeighbors)
+                    }
+
+                    // If no strong connections (col_sum == 0), add to weak_sum
+                    if (fabs(col_sum) < zero_tol)
                     {
                         weak_sum += val;
                     }
-                }
-            }
-        }
-        start = A->off_proc->idx1[i];
-        end = A->off_proc->idx1[i+1];
-        ctr = S->off_proc->idx1[i];
-        end_S = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = A->off_proc->idx2[j];
-            val = A->off_proc->vals[j];
-            col_P = off_proc_A_to_P[col];
-            idx = -1;
-            if (col_P > -1) idx = off_proc_pos[col_P];
-            if (idx >= row_start_off)
-            {
-                P->off_proc->vals[idx] += val;
-                if (ctr < end_S && S->off_proc->idx2[ctr] == col)
-                    ctr++;
-            }
-            else if (ctr < end_S && S->off_proc->idx2[ctr] == col)
-            {
-                ctr++;
-
-                if (off_proc_states[col] != Unselected) continue;
-
-                col_sum = 0;
-
-                // Add recvd values not in S
-                start_k = A_recv_on_ptr[col];
-                end_k = A_recv_on_ptr[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    idx = A_recv_on_idx[k];
-                    col_k = recv_mat->idx2[idx];
-                    val_k = recv_mat->vals[idx];
-                    if (pos[col_k] >= row_start_on) // Checked val * sign before communication
+                    else // Otherwise, add products to P
                     {
-                        col_sum += val_k;
+                        col_sum = val / col_sum;  // product = a_ik / col_sum
+
+                        start_k = A->on_proc->idx1[col]+1; 
+                        end_k = A->on_proc->idx1[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            col_k = A->on_proc->idx2[k]; // a_kj for some j
+                            val_k = A->on_proc->vals[k];
+                            idx = pos[col_k]; // Find idx of w_ij for j^^
+                            // if sign(a_kj) != sign(a_kk) and j in C^_{i} U {i}
+                            if (val_k * sign < 0 && idx >= row_start_on)
+                            {
+                                if (col_k == i) // if j == i, add to weak sum
+                                {
+                                    weak_sum += (col_sum * val_k);
+                                }
+                                else // Otherwise, add to w_ij
+                                {
+                                    on_vals[idx] += (col_sum * val_k);
+                                }
+                            }
+                        }
+                
+                        start_k = A->off_proc->idx1[col];
+                        end_k = A->off_proc->idx1[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            col_k = A->off_proc->idx2[k]; // a_kj for some j
+                            col_P = off_proc_A_to_P[col_k];
+                            if (col_P >= 0) // If column not in P, col not in C^_{i}
+                            {
+                                val_k = A->off_proc->vals[k];
+                                idx = off_pos[col_P]; // Find idx of w_ij 
+                                // If sign(a_kj) != sign(a_kk) and j in C^_{i}
+                                if (val_k * sign < 0 && idx >= row_start_off)
+                                {
+                                    // Add to w_ij
+                                    off_vals[idx] += (col_sum * val_k);
+                                }
+                            }
+                        } 
                     }
                 }
-
-                start_k = A_recv_off_ptr[col];
-                end_k = A_recv_off_ptr[col+1];
-                for (int k = start_k; k < end_k; k++)
+                else // Weak connection, add to weak_sum if not in C^_{i}
                 {
-                    idx = A_recv_off_idx[k];
-                    col_k = recv_mat->idx2[idx];
-                    val_k = recv_mat->vals[idx];
-                    if (off_proc_pos[col_k] >= row_start_off) // Checked val * sign before communication
+                    if (num_variables == 1 || variables[i] == variables[col])// weak connection
                     {
-                        col_sum += val_k;
+                        if (states[col] != NoNeighbors)
+                        {
+                            weak_sum += val;
+                        }
                     }
                 }
-
-                if (fabs(col_sum) < zero_tol)
+            }
+            start = A->off_proc->idx1[i];
+            end = A->off_proc->idx1[i+1];
+            ctr = S->off_proc->idx1[i];
+            end_S = S->off_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
+            {
+                col = A->off_proc->idx2[j];
+                val = A->off_proc->vals[j];
+                col_P = off_proc_A_to_P[col];
+                idx = -1;
+                if (col_P > -1) idx = off_pos[col_P];
+                if (idx >= row_start_off)
                 {
-                    weak_sum += val;
+                    off_vals[idx] += val;
+                    if (ctr < end_S && S->off_proc->idx2[ctr] == col)
+                        ctr++;
                 }
-                else
+                else if (ctr < end_S && S->off_proc->idx2[ctr] == col)
                 {
-                    col_sum = val / col_sum;
+                    ctr++;
+
+                    if (off_proc_states[col] != Unselected) continue;
 
+                    col_sum = 0;
+
+                    // Add recvd values not in S
                     start_k = A_recv_on_ptr[col];
                     end_k = A_recv_on_ptr[col+1];
                     for (int k = start_k; k < end_k; k++)
@@ -905,17 +979,9 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
                         idx = A_recv_on_idx[k];
                         col_k = recv_mat->idx2[idx];
                         val_k = recv_mat->vals[idx];
-                        idx = pos[col_k];
-                        if (idx >= row_start_on) // Checked val * sign before communication
+                        if (pos[col_k] >= row_start_on) // Checked val * sign before communication
                         {
-                            if (col_k == i)
-                            {
-                                weak_sum += (col_sum * val_k);
-                            }
-                            else
-                            {
-                                P->on_proc->vals[idx] += (col_sum * val_k);
-                            }
+                            col_sum += val_k;
                         }
                     }
 
@@ -926,45 +992,88 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
                         idx = A_recv_off_idx[k];
                         col_k = recv_mat->idx2[idx];
                         val_k = recv_mat->vals[idx];
-                        idx = off_proc_pos[col_k];
-                        if (idx >= row_start_off) // Checked val * sign before communication
+                        if (off_pos[col_k] >= row_start_off) // Checked val * sign before communication
                         {
-                            P->off_proc->vals[idx] += (col_sum * val_k);
+                            col_sum += val_k;
                         }
                     }
-                }
-            }
-            else // Weak connection, add to weak sum if not in C^_{i}
-            {
-                if (num_variables == 1 || variables[i] == off_variables[col])
-                {
-                    if (off_proc_states[col] != NoNeighbors)
+
+                    if (fabs(col_sum) < zero_tol)
                     {
                         weak_sum += val;
                     }
-                }
-            }
-        }
+                    else
+                    {
+                        col_sum = val / col_sum;
 
-        // Divide by weak sum and clear row values
-        if (fabs(weak_sum) > zero_tol)
-        {
-            for (int j = row_start_on; j < row_end_on; j++)
-            {
-                P->on_proc->vals[j] /= -weak_sum;
-            }
-            for (int j = row_start_off; j < row_end_off; j++)
+                        start_k = A_recv_on_ptr[col];
+                        end_k = A_recv_on_ptr[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            idx = A_recv_on_idx[k];
+                            col_k = recv_mat->idx2[idx];
+                            val_k = recv_mat->vals[idx];
+                            idx = pos[col_k];
+                            if (idx >= row_start_on) // Checked val * sign before communication
+                            {
+                                if (col_k == i)
+                                {
+                                    weak_sum += (col_sum * val_k);
+                                }
+                                else
+                                {
+                                    on_vals[idx] += (col_sum * val_k);
+                                }
+                            }
+                        }
+
+                        start_k = A_recv_off_ptr[col];
+                        end_k = A_recv_off_ptr[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            idx = A_recv_off_idx[k];
+                            col_k = recv_mat->idx2[idx];
+                            val_k = recv_mat->vals[idx];
+                            idx = off_pos[col_k];
+                            if (idx >= row_start_off) // Checked val * sign before communication
+                            {
+                                off_vals[idx] += (col_sum * val_k);
+                            }
+                        }
+                    }
+                }
+                else // Weak connection, add to weak sum if not in C^_{i}
+                {
+                    if (num_variables == 1 || variables[i] == off_variables[col])
+                    {
+                        if (off_proc_states[col] != NoNeighbors)
+                        {
+                            weak_sum += val;
+                        }
+                    }
+                }
+            }
+
+            // Divide by weak sum and clear row values
+            if (fabs(weak_sum) > zero_tol)
             {
-                P->off_proc->vals[j] /= -weak_sum;
+                for (int j = row_start_on; j < row_end_on; j++)
+                {
+                    on_vals[j] /= -weak_sum;
+                }
+                for (int j = row_start_off; j < row_end_off; j++)
+                {
+                    off_vals[j] /= -weak_sum;
+                }
             }
-        }
-        pos[i] = -1;
+            pos[i] = -1;
    
-        P->on_proc->idx1[i+1] = row_end_on;
-        P->off_proc->idx1[i+1] = row_end_off;
-    }
+            P->on_proc->idx1[i+1] = row_end_on - row_start_on;
+            P->off_proc->idx1[i+1] = row_end_off - row_start_off;
+        }
+    });
 
-    filter_interp(P, filter_threshold);
+    filter_interp(P, filter_threshold, max_elmts, &col_exists);
 
     // Update off_proc columns in P (remove col j if col_exists[j] is false)
     if (P->off_proc_num_cols)
@@ -1012,21 +1121,12 @@ ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
 ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states, 
-        bool tap_interp, int num_variables, int* variables)
+        bool tap_interp, int num_variables, int* variables, int max_elmts)
 {
     int rank;
     RAPtor_MPI_Comm_rank(RAPtor_MPI_COMM_WORLD, &rank);
 
-    int start, end;
-    int start_k, end_k;
-    int end_S;
-    int col, col_k;
-    int ctr, idx;
-    int global_col, sign;
     int global_num_cols;
-    int row_start_on, row_start_off;
-    double diag, val, val_k;
-    double weak_sum, coarse_sum;
     std::vector<int> off_variables;
     if (A->off_proc_num_cols) off_variables.resize(A->off_proc_num_cols);
 
@@ -1107,11 +1207,11 @@ ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
     CSRMatrix* recv_off = new CSRMatrix(recv_mat->n_rows, -1, recv_mat->nnz);
     for (int i = 0; i < recv_mat->n_rows; i++)
     {
-        start = recv_mat->idx1[i];
-        end = recv_mat->idx1[i+1];
+        int start = recv_mat->idx1[i];
+        int end = recv_mat->idx1[i+1];
         for (int j = start; j < end; j++)
         {
-            col = recv_mat->idx2[j];
+            int col = recv_mat->idx2[j];
             if (col < A->partition->first_local_col || col > A->partition->last_local_col)
             {
                 recv_off->idx2.push_back(col);
@@ -1142,167 +1242,129 @@ ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
     delete[] on_proc_partition_to_col;
 
     // Change off_proc_cols to local (remove cols not on rank)
-    ctr = 0;
-    std::map<int, int> global_to_local;
-    for (std::vector<int>::iterator it = A->off_proc_column_map.begin();
-            it != A->off_proc_column_map.end(); ++it)
-    {
-        global_to_local[*it] = ctr++;
-    }
+    IndexMap global_to_local(A->off_proc_column_map);
     recv_off->n_cols = A->off_proc_num_cols;
-    ctr = 0;
-    start = recv_off->idx1[0];
+    int recv_ctr = 0;
+    int recv_start = recv_off->idx1[0];
     for (int i = 0; i < recv_off->n_rows; i++)
     {
-        end = recv_off->idx1[i+1];
-        for (int j = start; j < end; j++)
+        int recv_end = recv_off->idx1[i+1];
+        for (int j = recv_start; j < recv_end; j++)
         {
-            global_col = recv_off->idx2[j];
-            std::map<int, int>::iterator it = global_to_local.find(global_col);
-            if (it != global_to_local.end())
+            int col = global_to_local.find(recv_off->idx2[j]);
+            if (col >= 0)
             {
-                recv_off->idx2[ctr] = it->second;
-                recv_off->vals[ctr++] = recv_off->vals[j];
+                recv_off->idx2[recv_ctr] = col;
+                recv_off->vals[recv_ctr++] = recv_off->vals[j];
             }
         }
-        recv_off->idx1[i+1] = ctr;
-        start = end;
+        recv_off->idx1[i+1] = recv_ctr;
+        recv_start = recv_end;
     }
-    recv_off->nnz = ctr;
-    recv_off->idx2.resize(ctr);
-    recv_off->vals.resize(ctr);
+    recv_off->nnz = recv_ctr;
+    recv_off->idx2.resize(recv_ctr);
+    recv_off->vals.resize(recv_ctr);
 
     // For each row, will calculate coarse sums and store 
     // strong connections in vector
-    std::vector<int> pos;
-    std::vector<int> off_proc_pos;
-    if (A->on_proc_num_cols)
-    {
-        pos.resize(A->on_proc_num_cols, -1);
-    }
-    if (A->off_proc_num_cols)
-    {
-        off_proc_pos.resize(A->off_proc_num_cols, -1);
-    }
-
-    P->on_proc->idx1[0] = 0;
-    P->off_proc->idx1[0] = 0;
-    for (int i = 0; i < A->local_num_rows; i++)
+    form_interp_rows(P, A->on_proc->idx1, A->on_proc_num_cols, A->off_proc_num_cols,
+            [&](int row_start, int row_end, std::vector<int>& pos, std::vector<int>& off_pos,
+                std::vector<int>& on_idx2, std::vector<double>& on_vals,
+                std::vector<int>& off_idx2, std::vector<double>& off_vals)
     {
-        // If coarse row, add to P
-        if (states[i] == Selected)
+        int start, end;
+        int start_k, end_k;
+        int end_S;
+        int col, col_k;
+        int ctr, idx;
+        int sign;
+        int row_start_on, row_start_off;
+        double diag, val, val_k;
+        double weak_sum, coarse_sum;
+
+        for (int i = row_start; i < row_end; i++)
         {
-            P->on_proc->idx2.push_back(on_proc_col_to_new[i]);
-            P->on_proc->vals.push_back(1);
-            P->on_proc->idx1[i+1] = P->on_proc->idx2.size();
-            P->off_proc->idx1[i+1] = P->off_proc->idx2.size();
-            continue;
-        }
-
-        row_start_on = P->on_proc->idx1[i];
-        row_start_off = P->off_proc->idx1[i];
-
-        // Add selected states to P
-        start = S->on_proc->idx1[i] + 1;
-        end = S->on_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->on_proc->idx2[j];
-            if (states[col] == Selected)
-            {
-                val = S->on_proc->vals[j];
-                pos[col] = P->on_proc->idx2.size();
-                P->on_proc->idx2.push_back(on_proc_col_to_new[col]);
-                P->on_proc->vals.push_back(val);
-            }
-        }
-        start = S->off_proc->idx1[i];
-        end = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = S->off_proc->idx2[j];
-            if (off_proc_states[col] == Selected)
+            // If coarse row, add to P
+            if (states[i] == Selected)
             {
-                val = S->off_proc->vals[j];
-                off_proc_pos[col] = P->off_proc->idx2.size();
-                col_exists[col] = true;
-                P->off_proc->idx2.push_back(col);
-                P->off_proc->vals.push_back(val);
+                on_idx2.push_back(on_proc_col_to_new[i]);
+                on_vals.push_back(1);
+                P->on_proc->idx1[i+1] = 1;
+                P->off_proc->idx1[i+1] = 0;
+                continue;
             }
-        }
 
-        start = A->on_proc->idx1[i];
-        end = A->on_proc->idx1[i+1];
-        ctr = S->on_proc->idx1[i]+1;
-        end_S = S->on_proc->idx1[i+1];
-        weak_sum = A->on_proc->vals[start++];
-        for (int j = start; j < end; j++)
-        {
-            col = A->on_proc->idx2[j];
-            val = A->on_proc->vals[j];
-            if (ctr < end_S && S->on_proc->idx2[ctr] == col)
+            row_start_on = on_idx2.size();
+            row_start_off = off_idx2.size();
+
+            // Add selected states to P (S may hold only a pattern, so
+            // values are taken from A, walked together with S)
+            start = A->on_proc->idx1[i] + 1;
+            end = A->on_proc->idx1[i+1];
+            ctr = S->on_proc->idx1[i] + 1;
+            end_S = S->on_proc->idx1[i+1];
+            for (int j = start; j < end && ctr < end_S; j++)
             {
+                col = A->on_proc->idx2[j];
+                if (S->on_proc->idx2[ctr] != col) continue;
                 ctr++;
-
-                if (states[col] == Selected) continue;
-
-                // Find sum of all coarse points in row k (with sign NOT equal to diag)
-                coarse_sum = 0;
-                start_k = A->on_proc->idx1[col];
-                end_k = A->on_proc->idx1[col+1];
-
-                diag = A->on_proc->vals[start_k++];
-                if (diag > 0) sign = 1;
-                else sign = -1;
-
-                for (int k = start_k; k < end_k; k++)
+                if (states[col] == Selected)
                 {
-                    col_k = A->on_proc->idx2[k];
-                    if (states[col_k] == Selected)
-                    {
-                        val_k = A->on_proc->vals[k];
-                        if (val_k * sign < 0 && pos[col_k] >= row_start_on)
-                        {
-                            coarse_sum += val_k;
-                        }
-                    }
+                    pos[col] = on_idx2.size();
+                    on_idx2.push_back(on_proc_col_to_new[col]);
+                    on_vals.push_back(A->on_proc->vals[j]);
                 }
-
-                start_k = A->off_proc->idx1[col];
-                end_k = A->off_proc->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    col_k = A->off_proc->idx2[k];
-                    val_k = A->off_proc->vals[k];
-                    if (val_k * sign < 0 && off_proc_pos[col_k] >= row_start_off)
-                    {
-                        coarse_sum += val_k;
-                    }
-                }
-                        
-                if (fabs(coarse_sum) < zero_tol)
-                {
-                    weak_sum += val;
-                }
-                else
+            }
+            start = A->off_proc->idx1[i];
+            end = A->off_proc->idx1[i+1];
+            ctr = S->off_proc->idx1[i];
+            end_S = S->off_proc->idx1[i+1];
+            for (int j = start; j < end && ctr < end_S; j++)
+            {
+                col = A->off_proc->idx2[j];
+                if (S->off_proc->idx2[ctr] != col) continue;
+                ctr++;
+                if (off_proc_states[col] == Selected)
                 {
-                    coarse_sum = val / coarse_sum;
+                    off_pos[col] = off_idx2.size();
+                    off_idx2.push_back(col);
+                    off_vals.push_back(A->off_proc->vals[j]);
                 }
+            }
 
-                if (coarse_sum) // k in D_i^S
+            start = A->on_proc->idx1[i];
+            end = A->on_proc->idx1[i+1];
+            ctr = S->on_proc->idx1[i]+1;
+            end_S = S->on_proc->idx1[i+1];
+            weak_sum = A->on_proc->vals[start++];
+            for (int j = start; j < end; j++)
+            {
+                col = A->on_proc->idx2[j];
+                val = A->on_proc->vals[j];
+                if (ctr < end_S && S->on_proc->idx2[ctr] == col)
                 {
-                    start_k = A->on_proc->idx1[col]+1;
+                    ctr++;
+
+                    if (states[col] == Selected) continue;
+
+                    // Find sum of all coarse points in row k (with sign NOT equal to diag)
+                    coarse_sum = 0;
+                    start_k = A->on_proc->idx1[col];
                     end_k = A->on_proc->idx1[col+1];
+
+                    diag = A->on_proc->vals[start_k++];
+                    if (diag > 0) sign = 1;
+                    else sign = -1;
+
                     for (int k = start_k; k < end_k; k++)
                     {
                         col_k = A->on_proc->idx2[k];
                         if (states[col_k] == Selected)
                         {
                             val_k = A->on_proc->vals[k];
-                            idx = pos[col_k];
-                            if (val_k * sign < 0 && idx >= row_start_on)
+                            if (val_k * sign < 0 && pos[col_k] >= row_start_on)
                             {
-                                P->on_proc->vals[idx] += (coarse_sum * val_k);
+                                coarse_sum += val_k;
                             }
                         }
                     }
@@ -1312,129 +1374,162 @@ ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
                     for (int k = start_k; k < end_k; k++)
                     {
                         col_k = A->off_proc->idx2[k];
-                        if (off_proc_states[col_k] == Selected)
+                        val_k = A->off_proc->vals[k];
+                        if (val_k * sign < 0 && off_pos[col_k] >= row_start_off)
                         {
-                            val_k = A->off_proc->vals[k];
-                            idx = off_proc_pos[col_k];
-                            if (val_k * sign < 0 && idx >= row_start_off)
+                            coarse_sum += val_k;
+                        }
+                    }
+                        
+                    if (fabs(coarse_sum) < zero_tol)
+                    {
+                        weak_sum += val;
+                    }
+                    else
+                    {
+                        coarse_sum = val / coarse_sum;
+                    }
+
+                    if (coarse_sum) // k in D_i^S
+                    {
+                        start_k = A->on_proc->idx1[col]+1;
+                        end_k = A->on_proc->idx1[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            col_k = A->on_proc->idx2[k];
+                            if (states[col_k] == Selected)
                             {
-                                P->off_proc->vals[idx] += (coarse_sum * val_k);
+                                val_k = A->on_proc->vals[k];
+                                idx = pos[col_k];
+                                if (val_k * sign < 0 && idx >= row_start_on)
+                                {
+                                    on_vals[idx] += (coarse_sum * val_k);
+                                }
+                            }
+                        }
+
+                        start_k = A->off_proc->idx1[col];
+                        end_k = A->off_proc->idx1[col+1];
+                        for (int k = start_k; k < end_k; k++)
+                        {
+                            col_k = A->off_proc->idx2[k];
+                            if (off_proc_states[col_k] == Selected)
+                            {
+                                val_k = A->off_proc->vals[k];
+                                idx = off_pos[col_k];
+                                if (val_k * sign < 0 && idx >= row_start_off)
+                                {
+                                    off_vals[idx] += (coarse_sum * val_k);
+                                }
                             }
                         }
                     }
                 }
-            }
-            else if (states[col] != NoNeighbors)
-            {
-                if (num_variables == 1 || variables[i] == variables[col])
+                else if (states[col] != NoNeighbors)
                 {
-                    weak_sum += val;
+                    if (num_variables == 1 || variables[i] == variables[col])
+                    {
+                        weak_sum += val;
+                    }
                 }
             }
-        }
 
-        start = A->off_proc->idx1[i];
-        end = A->off_proc->idx1[i+1];
-        ctr = S->off_proc->idx1[i];
-        end_S = S->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            col = A->off_proc->idx2[j];
-            val = A->off_proc->vals[j];
-            if (ctr < end_S && S->off_proc->idx2[ctr] == col)
+            start = A->off_proc->idx1[i];
+            end = A->off_proc->idx1[i+1];
+            ctr = S->off_proc->idx1[i];
+            end_S = S->off_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
             {
-                ctr++;
+                col = A->off_proc->idx2[j];
+                val = A->off_proc->vals[j];
+                if (ctr < end_S && S->off_proc->idx2[ctr] == col)
+                {
+                    ctr++;
 
-                if (off_proc_states[col] == Selected) continue;
+                    if (off_proc_states[col] == Selected) continue;
 
-                // Strong connection... create 
-                coarse_sum = 0;
-                start_k = recv_on->idx1[col];
-                end_k = recv_on->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    col_k = recv_on->idx2[k];
-                    val_k = recv_on->vals[k];
-                    if (pos[col_k] >= row_start_on)
+                    // Strong connection... create 
+                    coarse_sum = 0;
+                    start_k = recv_on->idx1[col];
+                    end_k = recv_on->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        coarse_sum += val_k;
+                        col_k = recv_on->idx2[k];
+                        val_k = recv_on->vals[k];
+                        if (pos[col_k] >= row_start_on)
+                        {
+                            coarse_sum += val_k;
+                        }
                     }
-                }
-                start_k = recv_off->idx1[col];
-                end_k = recv_off->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    col_k = recv_off->idx2[k];
-                    val_k = recv_off->vals[k];
-                    if (off_proc_pos[col_k] >= row_start_off)
+                    start_k = recv_off->idx1[col];
+                    end_k = recv_off->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        coarse_sum += val_k;
+                        col_k = recv_off->idx2[k];
+                        val_k = recv_off->vals[k];
+                        if (off_pos[col_k] >= row_start_off)
+                        {
+                            coarse_sum += val_k;
+                        }
+                    }
+                    if (fabs(coarse_sum) < zero_tol)
+                    {
+                        weak_sum += val;
+                    }
+                    else
+                    {
+                        coarse_sum = val / coarse_sum;
                     }
-                }
-                if (fabs(coarse_sum) < zero_tol)
-                {
-                    weak_sum += val;
-                }
-                else
-                {
-                    coarse_sum = val / coarse_sum;
-                }
 
-                start_k = recv_on->idx1[col];
-                end_k = recv_on->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    val_k = recv_on->vals[k];
-                    col_k = recv_on->idx2[k];
-                    idx = pos[col_k];
-                    if (idx >= row_start_on)
+                    start_k = recv_on->idx1[col];
+                    end_k = recv_on->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        P->on_proc->vals[idx] += (coarse_sum * val_k);
+                        val_k = recv_on->vals[k];
+                        col_k = recv_on->idx2[k];
+                        idx = pos[col_k];
+                        if (idx >= row_start_on)
+                        {
+                            on_vals[idx] += (coarse_sum * val_k);
+                        }
                     }
-                }
 
-                start_k = recv_off->idx1[col];
-                end_k = recv_off->idx1[col+1];
-                for (int k = start_k; k < end_k; k++)
-                {
-                    val_k = recv_off->vals[k];
-                    col_k = recv_off->idx2[k];
-                    idx = off_proc_pos[col_k];
-                    if (idx >= row_start_off)
+                    start_k = recv_off->idx1[col];
+                    end_k = recv_off->idx1[col+1];
+                    for (int k = start_k; k < end_k; k++)
                     {
-                        P->off_proc->vals[idx] += (coarse_sum * val_k);
+                        val_k = recv_off->vals[k];
+                        col_k = recv_off->idx2[k];
+                        idx = off_pos[col_k];
+                        if (idx >= row_start_off)
+                        {
+                            off_vals[idx] += (coarse_sum * val_k);
+                        }
                     }
                 }
-            }
-            else if (off_proc_states[col] != NoNeighbors)
-            {
-                if (num_variables == 1 || variables[i] == off_variables[col])
+                else if (off_proc_states[col] != NoNeighbors)
                 {
-                    weak_sum += val;
+                    if (num_variables == 1 || variables[i] == off_variables[col])
+                    {
+                        weak_sum += val;
+                    }
                 }
             }
-        }
 
-        P->on_proc->idx1[i+1] = P->on_proc->idx2.size();
-        P->off_proc->idx1[i+1] = P->off_proc->idx2.size();
-
-        start = P->on_proc->idx1[i];
-        end = P->on_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            P->on_proc->vals[j] /= -weak_sum;
-        }
-        start = P->off_proc->idx1[i];
-        end = P->off_proc->idx1[i+1];
-        for (int j = start; j < end; j++)
-        {
-            P->off_proc->vals[j] /= -weak_sum;
+            P->on_proc->idx1[i+1] = on_idx2.size() - row_start_on;
+            P->off_proc->idx1[i+1] = off_idx2.size() - row_start_off;
 
+            for (int j = row_start_on; j < (int) on_idx2.size(); j++)
+            {
+                on_vals[j] /= -weak_sum;
+            }
+            for (int j = row_start_off; j < (int) off_idx2.size(); j++)
+            {
+                off_vals[j] /= -weak_sum;
+            }
         }
-    }
-    P->on_proc->nnz = P->on_proc->idx2.size();
-    P->off_proc->nnz = P->off_proc->idx2.size();
-    P->local_nnz = P->on_proc->nnz + P->off_proc->nnz;
+    });
+    filter_interp(P, 0.0, max_elmts, &col_exists);
 
     for (int i = 0; i < S->off_proc_num_cols; i++)
     {
@@ -1773,4 +1868,473 @@ ParCSRMatrix* direct_interpolation(ParCSRMatrix* A,
 
     return P;
 }
+
+/**************************************************************
+*****   Multipass Interpolation
+**************************************************************
+***** Interpolation for aggressive coarsening, where fine points
+***** need not be strongly connected to any coarse point.  Fine
+***** points are interpolated in passes: in the first, those with
+***** strong coarse neighbors interpolate directly from them, as in
+***** direct interpolation.  In pass k, fine points strongly
+***** connected to points of earlier passes interpolate from their
+***** rows of P, weighted as in direct interpolation.  Before each
+***** pass, the rows of P formed in the last pass are sent to 
+***** neighboring processes.
+*****
+***** Fine points with no strong path to a coarse point have an
+***** empty row in P.
+**************************************************************/
+ParCSRMatrix* multipass_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states,
+        const std::vector<int>& off_proc_states,
+        bool tap_interp)
+{
+    int start, end, col, idx;
+    int ctr_S, end_S;
+    int pass, num_new, global_num_new;
+    int on_proc_cols, global_num_cols;
+    double val, diag, alpha, beta;
+    double sum_all_neg, sum_all_pos;
+    double sum_neg, sum_pos;
+    double neg_coeff, pos_coeff, weight;
+
+    CommPkg* comm = A->comm;
+    CommPkg* mat_comm = A->comm;
+    if (tap_interp)
+    {
+        comm = A->tap_comm;
+        mat_comm = A->tap_mat_comm;
+    }
+
+    A->sort();
+    S->sort();
+    A->on_proc->move_diag();
+    S->on_proc->move_diag();
+
+    on_proc_cols = 0;
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (states[i] == Selected)
+        {
+            on_proc_cols++;
+        }
+    }
+    RAPtor_MPI_Allreduce(&on_proc_cols, &global_num_cols, 1, RAPtor_MPI_INT,
+            RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+
+    // Pass of each row (0 for coarse points, -1 if not yet assigned)
+    std::vector<int> row_pass(A->local_num_rows, -1);
+    std::vector<int> off_pass(A->off_proc_num_cols, -1);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (states[i] == Selected) row_pass[i] = 0;
+    }
+    for (int i = 0; i < A->off_proc_num_cols; i++)
+    {
+        if (off_proc_states[i] == Selected) off_pass[i] = 0;
+    }
+
+    // Rows of P (local and off_proc), in the order they are formed,
+    // with global columns
+    std::vector<int> P_start(A->local_num_rows, 0);
+    std::vector<int> P_end(A->local_num_rows, 0);
+    std::vector<int> P_cols;
+    std::vector<double> P_vals;
+    std::vector<int> off_P_start(A->off_proc_num_cols, 0);
+    std::vector<int> off_P_end(A->off_proc_num_cols, 0);
+    std::vector<int> off_P_cols;
+    std::vector<double> off_P_vals;
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (row_pass[i] == 0)
+        {
+            P_start[i] = P_cols.size();
+            P_cols.emplace_back(A->on_proc_column_map[i]);
+            P_vals.emplace_back(1.0);
+            P_end[i] = P_cols.size();
+        }
+    }
+
+    std::vector<int> new_rows;
+    std::vector<int> rowptr(A->local_num_rows + 1);
+    std::vector<int> send_cols;
+    std::vector<double> send_vals;
+    std::vector<std::pair<int, double> > on_nbrs;
+    std::vector<std::pair<int, double> > off_nbrs;
+    std::vector<std::pair<int, double> > row_buf;
+    for (pass = 1; ; pass++)
+    {
+        // Fine points strongly connected to points of earlier passes
+        new_rows.clear();
+        for (int i = 0; i < A->local_num_rows; i++)
+        {
+            if (row_pass[i] >= 0) continue;
+
+            start = S->on_proc->idx1[i];
+            end = S->on_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
+            {
+                col = S->on_proc->idx2[j];
+                if (col != i && row_pass[col] >= 0 && row_pass[col] < pass)
+                {
+                    new_rows.emplace_back(i);
+                    break;
+                }
+            }
+            if (new_rows.size() && new_rows.back() == i) continue;
+
+            start = S->off_proc->idx1[i];
+            end = S->off_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
+            {
+                col = S->off_proc->idx2[j];
+                if (off_pass[col] >= 0 && off_pass[col] < pass)
+                {
+                    new_rows.emplace_back(i);
+                    break;
+                }
+            }
+        }
+        num_new = new_rows.size();
+        RAPtor_MPI_Allreduce(&num_new, &global_num_new, 1, RAPtor_MPI_INT,
+                RAPtor_MPI_SUM, RAPtor_MPI_COMM_WORLD);
+        if (global_num_new == 0) break;
+        for (int i = 0; i < num_new; i++)
+        {
+            row_pass[new_rows[i]] = pass;
+        }
+
+        // Off_proc rows of P formed in the last pass
+        if (pass > 1)
+        {
+            send_cols.clear();
+            send_vals.clear();
+            rowptr[0] = 0;
+            for (int i = 0; i < A->local_num_rows; i++)
+            {
+                if (row_pass[i] == pass - 1)
+                {
+                    send_cols.insert(send_cols.end(), P_cols.begin() + P_start[i],
+                            P_cols.begin() + P_end[i]);
+                    send_vals.insert(send_vals.end(), P_vals.begin() + P_start[i],
+                            P_vals.begin() + P_end[i]);
+                }
+                rowptr[i+1] = send_cols.size();
+            }
+            CSRMatrix* recv_mat = mat_comm->communicate(rowptr, send_cols, send_vals);
+            for (int i = 0; i < A->off_proc_num_cols; i++)
+            {
+                if (off_pass[i] == pass - 1)
+                {
+                    off_P_start[i] = off_P_cols.size();
+                    off_P_cols.insert(off_P_cols.end(), 
+                            recv_mat->idx2.begin() + recv_mat->idx1[i],
+                            recv_mat->idx2.begin() + recv_mat->idx1[i+1]);
+                    off_P_vals.insert(off_P_vals.end(), 
+                            recv_mat->vals.begin() + recv_mat->idx1[i],
+                            recv_mat->vals.begin() + recv_mat->idx1[i+1]);
+                    off_P_end[i] = off_P_cols.size();
+                }
+            }
+            delete recv_mat;
+        }
+
+        // Form rows of this pass
+        for (int n = 0; n < num_new; n++)
+        {
+            int i = new_rows[n];
+            on_nbrs.clear();
+            off_nbrs.clear();
+            sum_all_neg = 0;
+            sum_all_pos = 0;
+            sum_neg = 0;
+            sum_pos = 0;
+
+            start = A->on_proc->idx1[i];
+            end = A->on_proc->idx1[i+1];
+            diag = A->on_proc->vals[start++];
+            ctr_S = S->on_proc->idx1[i] + 1;
+            end_S = S->on_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
+            {
+                col = A->on_proc->idx2[j];
+                val = A->on_proc->vals[j];
+                if (val < 0) sum_all_neg += val;
+                else sum_all_pos += val;
+
+                if (ctr_S < end_S && S->on_proc->idx2[ctr_S] == col)
+                {
+                    ctr_S++;
+                    if (row_pass[col] >= 0 && row_pass[col] < pass)
+                    {
+                        on_nbrs.emplace_back(std::make_pair(col, val));
+                        if (val < 0) sum_neg += val;
+                        else sum_pos += val;
+                    }
+                }
+            }
+
+            start = A->off_proc->idx1[i];
+            end = A->off_proc->idx1[i+1];
+            ctr_S = S->off_proc->idx1[i];
+            end_S = S->off_proc->idx1[i+1];
+            for (int j = start; j < end; j++)
+            {
+                col = A->off_proc->idx2[j];
+                val = A->off_proc->vals[j];
+                if (val < 0) sum_all_neg += val;
+                else sum_all_pos += val;
+
+                if (ctr_S < end_S && S->off_proc->idx2[ctr_S] == col)
+                {
+                    ctr_S++;
+                    if (off_pass[col] >= 0 && off_pass[col] < pass)
+                    {
+                        off_nbrs.emplace_back(std::make_pair(col, val));
+                        if (val < 0) sum_neg += val;
+                        else sum_pos += val;
+                    }
+                }
+            }
+
+            if (sum_neg == 0)
+            {
+                alpha = 0;
+            }
+            else
+            {
+                alpha = sum_all_neg / sum_neg;
+            }
+            if (sum_pos == 0)
+            {
+                diag += sum_all_pos;
+                beta = 0;
+            }
+            else
+            {
+                beta = sum_all_pos / sum_pos;
+            }
+            neg_coeff = -alpha / diag;
+            pos_coeff = -beta / diag;
+
+            // Row i of P is the weighted sum of rows of its neighbors
+            row_buf.clear();
+            for (std::vector<std::pair<int, double> >::iterator it = on_nbrs.begin();
+                    it != on_nbrs.end(); ++it)
+            {
+                col = it->first;
+                val = it->second;
+                weight = val * (val < 0 ? neg_coeff : pos_coeff);
+                for (int k = P_start[col]; k < P_end[col]; k++)
+                {
+                    row_buf.emplace_back(std::make_pair(P_cols[k], weight * P_vals[k]));
+                }
+            }
+            for (std::vector<std::pair<int, double> >::iterator it = off_nbrs.begin();
+                    it != off_nbrs.end(); ++it)
+            {
+                col = it->first;
+                val = it->second;
+                weight = val * (val < 0 ? neg_coeff : pos_coeff);
+                if (off_pass[col] == 0)
+                {
+                    row_buf.emplace_back(std::make_pair(A->off_proc_column_map[col], 
+                                weight));
+                    continue;
+                }
+                for (int k = off_P_start[col]; k < off_P_end[col]; k++)
+                {
+                    row_buf.emplace_back(std::make_pair(off_P_cols[k], 
+                                weight * off_P_vals[k]));
+                }
+            }
+            std::sort(row_buf.begin(), row_buf.end());
+
+            P_start[i] = P_cols.size();
+            for (std::vector<std::pair<int, double> >::iterator it = row_buf.begin();
+                    it != row_buf.end(); ++it)
+            {
+                if ((int)P_cols.size() > P_start[i] && P_cols.back() == it->first)
+                {
+                    P_vals.back() += it->second;
+                }
+                else
+                {
+                    P_cols.emplace_back(it->first);
+                    P_vals.emplace_back(it->second);
+                }
+            }
+            P_end[i] = P_cols.size();
+        }
+
+        // Passes of off_proc columns
+        std::vector<int>& recvbuf = comm->communicate(row_pass);
+        std::copy(recvbuf.begin(), recvbuf.begin() + A->off_proc_num_cols, 
+                off_pass.begin());
+    }
+
+    // Form P, with coarse points numbered by global row (as in the other
+    // interpolations)
+    ParCSRMatrix* P = new ParCSRMatrix(A->partition, A->global_num_rows, 
+            global_num_cols, A->local_num_rows, on_proc_cols, 0);
+    P->local_row_map = A->get_local_row_map();
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (row_pass[i] == 0)
+        {
+            P->on_proc_column_map.emplace_back(A->on_proc_column_map[i]);
+        }
+    }
+    IndexMap on_proc_to_new(P->on_proc_column_map);
+
+    for (std::vector<int>::iterator it = P_cols.begin(); it != P_cols.end(); ++it)
+    {
+        if (on_proc_to_new.find(*it) < 0)
+        {
+            P->off_proc_column_map.emplace_back(*it);
+        }
+    }
+    sort_unique(P->off_proc_column_map);
+    IndexMap off_proc_to_new(P->off_proc_column_map);
+
+    P->on_proc->idx2.reserve(P_cols.size());
+    P->on_proc->vals.reserve(P_cols.size());
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        for (int k = P_start[i]; k < P_end[i]; k++)
+        {
+            idx = on_proc_to_new.find(P_cols[k]);
+            if (idx >= 0)
+            {
+                P->on_proc->idx2.emplace_back(idx);
+                P->on_proc->vals.emplace_back(P_vals[k]);
+            }
+            else
+            {
+                P->off_proc->idx2.emplace_back(off_proc_to_new[P_cols[k]]);
+                P->off_proc->vals.emplace_back(P_vals[k]);
+            }
+        }
+        P->on_proc->idx1[i+1] = P->on_proc->idx2.size();
+        P->off_proc->idx1[i+1] = P->off_proc->idx2.size();
+    }
+    P->on_proc->nnz = P->on_proc->idx2.size();
+    P->off_proc->nnz = P->off_proc->idx2.size();
+    P->local_nnz = P->on_proc->nnz + P->off_proc->nnz;
+
+    P->off_proc_num_cols = P->off_proc_column_map.size();
+    P->on_proc_num_cols = P->on_proc_column_map.size();
+    P->off_proc->n_cols = P->off_proc_num_cols;
+    P->on_proc->n_cols = P->on_proc_num_cols;
+
+    if (tap_interp)
+    {
+        P->init_tap_communicators(RAPtor_MPI_COMM_WORLD);
+    }
+    else
+    {
+        P->comm = new ParComm(P->partition, P->off_proc_column_map,
+                P->on_proc_column_map, 9243, RAPtor_MPI_COMM_WORLD);
+    }
+
+    return P;
+}
+
+/**************************************************************
+*****   Two-Stage Extended Interpolation
+**************************************************************
+***** Interpolation for aggressive coarsening, as the product of
+***** two extended+i interpolations on A.  P1 interpolates from
+***** the coarse points of the first splitting (states_1), and
+***** P2 from the final coarse points (states, a subset of those
+***** of states_1) to the other first-stage coarse points, through
+***** their distance-two connections in A.  These are the rows of
+***** extended+i interpolation with the final splitting at the
+***** first-stage coarse points, so P = P1 * P2 is formed by
+***** indexing the columns of P1 by rows of A.  The product is
+***** filtered and truncated to max_elmts per row (if positive).
+**************************************************************/
+ParCSRMatrix* two_stage_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states_1,
+        const std::vector<int>& off_proc_states_1,
+        const std::vector<int>& states, const std::vector<int>& off_proc_states,
+        const double filter_threshold, bool tap_interp, int max_elmts)
+{
+    // First stage, to the coarse points of the first splitting
+    ParCSRMatrix* P1 = extended_interpolation(A, S, states_1, off_proc_states_1,
+            filter_threshold, tap_interp, 1, NULL, 0);
+
+    // Second stage, to the final coarse points (only rows at the
+    // first-stage coarse points are used)
+    ParCSRMatrix* P2 = extended_interpolation(A, S, states, off_proc_states,
+            filter_threshold, tap_interp, 1, NULL, 0);
+
+    // Index on_proc columns of P1 by local rows of A (off_proc
+    // columns are already global rows of A), so that P1 multiplies
+    // the rows of P2 at the first-stage coarse points
+    std::vector<int> coarse_rows;
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (states_1[i] == Selected)
+        {
+            coarse_rows.emplace_back(i);
+        }
+    }
+    for (std::vector<int>::iterator it = P1->on_proc->idx2.begin();
+            it != P1->on_proc->idx2.end(); ++it)
+    {
+        *it = coarse_rows[*it];
+    }
+    P1->global_num_cols = A->global_num_rows;
+    P1->on_proc_column_map = A->get_local_row_map();
+    P1->on_proc_num_cols = P1->on_proc_column_map.size();
+    P1->on_proc->n_cols = P1->on_proc_num_cols;
+    if (P1->comm) P1->comm->delete_comm();
+    P1->comm = new ParComm(P1->partition, P1->off_proc_column_map,
+            P1->on_proc_column_map);
+
+    ParCSRMatrix* P = P1->mult(P2);
+    delete P1;
+    delete P2;
+
+    // Filter and truncate the product, and remove off_proc columns
+    // no longer in use
+    std::vector<bool> col_exists(P->off_proc_num_cols);
+    filter_interp(P, filter_threshold, max_elmts, &col_exists);
+    if (P->off_proc_num_cols)
+    {
+        std::vector<int> P_to_new(P->off_proc_num_cols);
+        std::vector<int> off_proc_column_map;
+        off_proc_column_map.swap(P->off_proc_column_map);
+        for (int i = 0; i < P->off_proc_num_cols; i++)
+        {
+            if (col_exists[i])
+            {
+                P_to_new[i] = P->off_proc_column_map.size();
+                P->off_proc_column_map.push_back(off_proc_column_map[i]);
+            }
+        }
+        for (std::vector<int>::iterator it = P->off_proc->idx2.begin();
+                it != P->off_proc->idx2.end(); ++it)
+        {
+            *it = P_to_new[*it];
+        }
+    }
+    P->off_proc_num_cols = P->off_proc_column_map.size();
+    P->off_proc->n_cols = P->off_proc_num_cols;
+
+    if (tap_interp)
+    {
+        P->init_tap_communicators(RAPtor_MPI_COMM_WORLD);
+    }
+    else
+    {
+        P->comm = new ParComm(P->partition, P->off_proc_column_map,
+                P->on_proc_column_map, 9243, RAPtor_MPI_COMM_WORLD);
+    }
+
+    return P;
+}
+
 }
@@ -16,13 +16,27 @@ ParCSRMatrix* direct_interpolation(ParCSRMatrix* A,
 ParCSRMatrix* mod_classical_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states,
-        bool tap_amg = false, int num_variables = 1, int* variables = NULL);
+        bool tap_amg = false, int num_variables = 1, int* variables = NULL,
+        int max_elmts = 0);
 
 ParCSRMatrix* extended_interpolation(ParCSRMatrix* A,
         ParCSRMatrix* S, const std::vector<int>& states,
         const std::vector<int>& off_proc_states,
         const double filter_threshold = 0.3,
-        bool tap_amg = false, int num_variables = 1, int* variables = NULL);
+        bool tap_amg = false, int num_variables = 1, int* variables = NULL,
+        int max_elmts = 0);
+
+ParCSRMatrix* multipass_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states,
+        const std::vector<int>& off_proc_states,
+        bool tap_amg = false);
+
+ParCSRMatrix* two_stage_interpolation(ParCSRMatrix* A,
+        ParCSRMatrix* S, const std::vector<int>& states_1,
+        const std::vector<int>& off_proc_states_1,
+        const std::vector<int>& states, const std::vector<int>& off_proc_states,
+        const double filter_threshold = 0.3, bool tap_amg = false,
+        int max_elmts = 0);
 
 }
 #endif
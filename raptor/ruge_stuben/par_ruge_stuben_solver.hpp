@@ -22,6 +22,9 @@ namespace raptor
             variables = NULL;
             num_variables = 1;
             interp_filter = 0.3; // Only used in HMIS/PMIS
+            interp_max_elmts = 0;
+            agg_num_levels = 0;
+            agg_interp_type = Multipass;
         }
 
         ~ParRugeStubenSolver()
@@ -56,7 +59,8 @@ namespace raptor
         void extend_hierarchy()
         {
             int level_ctr = levels.size() - 1;
-            bool tap_level = tap_amg >= 0 && tap_amg <= level_ctr;
+            select_A_comm(level_ctr);
+            bool tap_level = levels[level_ctr]->tap_A;
 
             ParCSRMatrix* A = levels[level_ctr]->A;
             ParCSRMatrix* S;
@@ -66,11 +70,15 @@ namespace raptor
             std::vector<int> states;
             std::vector<int> off_proc_states;
 
-            // Form strength of connection
+            // Form strength of connection (pattern only, as splitting
+            // and interpolation take values from A)
+            ScopedTimer strength_timer("strength", level_ctr);
             S = A->strength(strength_type, strong_threshold, tap_level, 
-                    num_variables, variables);
+                    num_variables, variables, true);
+            strength_timer.stop();
 
             // Form CF Splitting
+            ScopedTimer splitting_timer("splitting", level_ctr);
             switch (coarsen_type)
             {
                 case RS:
@@ -106,8 +114,35 @@ namespace raptor
                     break;
             }
 
+            // Aggressive coarsening: second pass on distance-two strength
+            bool aggressive = level_ctr < agg_num_levels;
+            std::vector<int> states_1;
+            std::vector<int> off_proc_states_1;
+            if (aggressive)
+            {
+                states_1 = states;
+                off_proc_states_1 = off_proc_states;
+                split_aggressive(S, states, off_proc_states, tap_level, weights);
+            }
+            splitting_timer.stop();
+
             // Form modified classical interpolation
-            switch (interp_type)
+            ScopedTimer interp_timer("interpolation", level_ctr);
+            if (aggressive)
+            {
+                if (agg_interp_type == TwoStageExtended)
+                {
+                    P = two_stage_interpolation(A, S, states_1, off_proc_states_1,
+                            states, off_proc_states, interp_filter, tap_level,
+                            interp_max_elmts);
+                }
+                else
+                {
+                    P = multipass_interpolation(A, S, states, off_proc_states, 
+                            tap_level);
+                }
+            }
+            else switch (interp_type)
             {
                 case Direct:
                     P = direct_interpolation(A, S, states, off_proc_states, 
@@ -115,18 +150,21 @@ namespace raptor
                     break;
                 case ModClassical:
                     P = mod_classical_interpolation(A, S, states, off_proc_states, 
-                            tap_level, num_variables, variables);
+                            tap_level, num_variables, variables, interp_max_elmts);
                     break;
                 case Extended:
                     P = extended_interpolation(A, S, states, off_proc_states, 
-                            interp_filter, tap_level, num_variables, variables);
+                            interp_filter, tap_level, num_variables, variables,
+                            interp_max_elmts);
                     break;
                 default:
                     P = direct_interpolation(A, S, states, off_proc_states, 
                             tap_level);
                     break;
             }
+            interp_timer.stop();
             levels[level_ctr]->P = P;
+            select_P_comm(level_ctr);
 
             if (num_variables > 1)
             {
@@ -143,13 +181,23 @@ namespace raptor
             // Form coarse grid operator
             levels.emplace_back(new ParLevel());
 
-            AP = A->mult(levels[level_ctr]->P, tap_level);
-            A = AP->mult_T(P, tap_level);
+            ScopedTimer spgemm_timer("spgemm", level_ctr);
+            AP = A->mult(levels[level_ctr]->P, levels[level_ctr]->tap_AP);
+            A = AP->mult_T(P, levels[level_ctr]->tap_PTAP);
 
             A->sort();
             A->on_proc->move_diag();
+            spgemm_timer.stop();
+
+            // Non-Galerkin sparsification of the coarse operator
+            if (get_sparsify_tol(level_ctr) > 0)
+            {
+                ScopedTimer sparsify_timer("sparsify", level_ctr);
+                sparsify_coarse(level_ctr, AP, A, states);
+            }
 
             level_ctr++;
+            ScopedTimer comm_timer("comm init", level_ctr);
             levels[level_ctr]->A = A;
             A->comm = new ParComm(A->partition, A->off_proc_column_map,
                     A->on_proc_column_map, levels[level_ctr-1]->A->comm->key,
@@ -159,7 +207,7 @@ namespace raptor
             levels[level_ctr]->tmp.resize(A->global_num_rows, A->local_num_rows);
             levels[level_ctr]->P = NULL;
 
-            if (tap_amg >= 0 && tap_amg <= level_ctr)
+            if (comm_select == ThresholdComm && tap_amg >= 0 && tap_amg <= level_ctr)
             {
                 levels[level_ctr]->A->init_tap_communicators(RAPtor_MPI_COMM_WORLD);
             }
@@ -172,6 +220,15 @@ namespace raptor
         interp_t interp_type;
         double interp_filter;
 
+        // Maximum entries kept per row of P (ModClassical and Extended),
+        // with rows rescaled to preserve their sums.  0 keeps all.
+        int interp_max_elmts;
+
+        // Aggressive coarsening is used on the first agg_num_levels
+        // levels, with multipass or two-stage extended+i interpolation
+        int agg_num_levels;
+        agg_interp_t agg_interp_type;
+
         int* variables;
 
     };
@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "gtest/gtest.h"
+
+#include "raptor/raptor.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+// 27-point Laplacian, with row sums moved to the diagonal so that
+// constants are in the null space (and interpolated exactly)
+ParCSRMatrix* zero_row_sum_laplacian(int n)
+{
+    int grid[3] = {n, n, n};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    A->sort();
+    A->on_proc->move_diag();
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        double row_sum = 0;
+        for (int j = A->on_proc->idx1[i]; j < A->on_proc->idx1[i+1]; j++)
+        {
+            row_sum += A->on_proc->vals[j];
+        }
+        for (int j = A->off_proc->idx1[i]; j < A->off_proc->idx1[i+1]; j++)
+        {
+            row_sum += A->off_proc->vals[j];
+        }
+        A->on_proc->vals[A->on_proc->idx1[i]] -= row_sum;
+    }
+    return A;
+}
+
+std::vector<double> row_weights(ParCSRMatrix* A)
+{
+    std::vector<double> rand_vals(A->local_num_rows);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        double w = A->local_row_map[i] * 0.6180339887498949;
+        rand_vals[i] = w - floor(w);
+    }
+    return rand_vals;
+}
+
+// Checks coarse rows are injected and fine rows sum to one
+void check_constant_interp(ParCSRMatrix* P, const std::vector<int>& states)
+{
+    for (int i = 0; i < P->local_num_rows; i++)
+    {
+        double row_sum = 0;
+        for (int j = P->on_proc->idx1[i]; j < P->on_proc->idx1[i+1]; j++)
+        {
+            row_sum += P->on_proc->vals[j];
+            if (states[i] == Selected)
+            {
+                ASSERT_EQ(P->on_proc_column_map[P->on_proc->idx2[j]], P->local_row_map[i]);
+            }
+        }
+        for (int j = P->off_proc->idx1[i]; j < P->off_proc->idx1[i+1]; j++)
+        {
+            row_sum += P->off_proc->vals[j];
+        }
+        ASSERT_NEAR(row_sum, 1.0, 1e-10);
+    }
+}
+
+TEST(TestParAggressive, TestsInRuge_Stuben)
+{ 
+    ParCSRMatrix* A = zero_row_sum_laplacian(12);
+    ParCSRMatrix* S = A->strength(Classical, 0.25, false, 1, NULL, true);
+    std::vector<double> rand_vals = row_weights(A);
+
+    std::vector<int> states;
+    std::vector<int> off_proc_states;
+    split_pmis(S, states, off_proc_states, false, rand_vals.data());
+    std::vector<int> states_1(states);
+    std::vector<int> off_proc_states_1(off_proc_states);
+    split_aggressive(S, states, off_proc_states, false, rand_vals.data());
+
+    // Aggressive coarse points are a subset of the first pass, and
+    // (as S is symmetric) no row is strongly connected to two of them
+    int num_c[2] = {0, 0};
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (states_1[i] == Selected) num_c[0]++;
+        if (states[i] == Selected)
+        {
+            num_c[1]++;
+            ASSERT_EQ(states_1[i], Selected);
+        }
+
+        int row_c = (states[i] == Selected);
+        for (int j = S->on_proc->idx1[i]; j < S->on_proc->idx1[i+1]; j++)
+        {
+            int col = S->on_proc->idx2[j];
+            if (col != i && states[col] == Selected) row_c++;
+        }
+        for (int j = S->off_proc->idx1[i]; j < S->off_proc->idx1[i+1]; j++)
+        {
+            if (off_proc_states[S->off_proc->idx2[j]] == Selected) row_c++;
+        }
+        ASSERT_LE(row_c, 1);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, num_c, 2, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    ASSERT_GT(num_c[1], 0);
+    ASSERT_LT(num_c[1], num_c[0]);
+
+    // Off_proc states match the owners
+    std::vector<int>& recvbuf = A->comm->communicate(states);
+    for (int i = 0; i < A->off_proc_num_cols; i++)
+    {
+        ASSERT_EQ(off_proc_states[i], recvbuf[i]);
+    }
+
+    ParCSRMatrix* P = multipass_interpolation(A, S, states, off_proc_states);
+    ASSERT_EQ(P->global_num_cols, num_c[1]);
+    check_constant_interp(P, states);
+    delete P;
+
+    P = two_stage_interpolation(A, S, states_1, off_proc_states_1, states,
+            off_proc_states);
+    ASSERT_EQ(P->global_num_cols, num_c[1]);
+    check_constant_interp(P, states);
+    delete P;
+
+    delete S;
+    delete A;
+} // end of TEST(TestParAggressive, TestsInRuge_Stuben) //
+
+TEST(TestParAggressive, TestsInSolver)
+{
+    int grid[3] = {12, 12, 12};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    ParVector x(A->global_num_rows, A->local_num_rows);
+    ParVector b(A->global_num_rows, A->local_num_rows);
+
+    long nnz[3];
+    for (int t = 0; t < 3; t++)
+    {
+        ParRugeStubenSolver* ml = new ParRugeStubenSolver(0.25, HMIS, Extended,
+                Classical, SOR);
+        if (t > 0)
+        {
+            ml->agg_num_levels = 1;
+            ml->agg_interp_type = (t == 1) ? Multipass : TwoStageExtended;
+        }
+        ml->setup(A);
+
+        // Total nonzeros of the hierarchy
+        nnz[t] = 0;
+        for (int i = 0; i < ml->num_levels; i++)
+        {
+            nnz[t] += ml->levels[i]->A->local_nnz;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &nnz[t], 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+        x.set_const_value(1.0);
+        A->mult(x, b);
+        x.set_const_value(0.0);
+        int iter = ml->solve(x, b);
+        std::vector<double>& res = ml->get_residuals();
+        ASSERT_LT(iter, ml->max_iterations);
+        ASSERT_LE(res[iter], ml->solve_tol);
+
+        delete ml;
+    }
+
+    // Aggressive coarsening gives smaller hierarchies
+    ASSERT_LT(nnz[1], nnz[0]);
+    ASSERT_LT(nnz[2], nnz[0]);
+
+    delete A;
+} // end of TEST(TestParAggressive, TestsInSolver) //
@@ -13,11 +13,13 @@ using namespace raptor;
 
 // Declare Private Methods 
 ParCSRMatrix* form_Prap(ParCSRMatrix* A, ParCSRMatrix* S, const char* filename, 
-        int* first_row_ptr, int* first_col_ptr, int interp_option = 0);
+        int* first_row_ptr, int* first_col_ptr, int interp_option = 0,
+        int max_elmts = 0);
 
 
 ParCSRMatrix* form_Prap(ParCSRMatrix* A, ParCSRMatrix* S, const char* filename, 
-        int* first_row_ptr, int* first_col_ptr, int interp_option)
+        int* first_row_ptr, int* first_col_ptr, int interp_option,
+        int max_elmts)
 {
     int rank, num_procs;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -62,11 +64,13 @@ ParCSRMatrix* form_Prap(ParCSRMatrix* A, ParCSRMatrix* S, const char* filename,
     }
     else if (interp_option == 1)
     {
-        P_rap = mod_classical_interpolation(A, S, splitting, S->comm->recv_data->int_buffer);
+        P_rap = mod_classical_interpolation(A, S, splitting, S->comm->recv_data->int_buffer,
+                false, 1, NULL, max_elmts);
     }
     else if (interp_option == 2)
     {
-        P_rap = extended_interpolation(A, S, splitting, S->comm->recv_data->int_buffer, 0.0);
+        P_rap = extended_interpolation(A, S, splitting, S->comm->recv_data->int_buffer, 0.0,
+                false, 1, NULL, max_elmts);
     }
     MPI_Allgather(&P_rap->on_proc_num_cols, 1, MPI_INT, proc_sizes.data(), 1, 
                 MPI_INT, MPI_COMM_WORLD);
@@ -174,3 +178,84 @@ TEST(TestParInterpolation, TestsInRuge_Stuben)
     delete A;
 
 } // end of TEST(TestParInterpolation, TestsInRuge_Stuben) //
+
+TEST(TestParInterpolation, TruncationInRuge_Stuben)
+{ 
+    int first_row, first_col;
+    int max_elmts = 3;
+    double row_sum, row_sum_trunc, val, min_kept, max_dropped;
+
+    ParCSRMatrix* A = readParMatrix("../../../../test_data/laplacian.pm");
+    ParCSRMatrix* S = readParMatrix("../../../../test_data/laplacian_S.pm");
+    const char* split_fn = "../../../../test_data/laplacian_split.txt";
+
+    for (int option = 1; option <= 2; option++)
+    {
+        ParCSRMatrix* P = form_Prap(A, S, split_fn, &first_row, &first_col, option);
+        ParCSRMatrix* P_trunc = form_Prap(A, S, split_fn, &first_row, &first_col, 
+                option, max_elmts);
+
+        long nnz[2] = {P->local_nnz, P_trunc->local_nnz};
+        MPI_Allreduce(MPI_IN_PLACE, nnz, 2, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+        ASSERT_LT(nnz[1], nnz[0]);
+
+        for (int i = 0; i < P->local_num_rows; i++)
+        {
+            // Entries kept are (global cols of) the largest of the row
+            std::map<int, double> row;
+            for (int j = P->on_proc->idx1[i]; j < P->on_proc->idx1[i+1]; j++)
+                row[P->on_proc_column_map[P->on_proc->idx2[j]]] = P->on_proc->vals[j];
+            for (int j = P->off_proc->idx1[i]; j < P->off_proc->idx1[i+1]; j++)
+                row[P->off_proc_column_map[P->off_proc->idx2[j]]] = P->off_proc->vals[j];
+
+            std::map<int, double> row_trunc;
+            for (int j = P_trunc->on_proc->idx1[i]; j < P_trunc->on_proc->idx1[i+1]; j++)
+                row_trunc[P_trunc->on_proc_column_map[P_trunc->on_proc->idx2[j]]] = 
+                    P_trunc->on_proc->vals[j];
+            for (int j = P_trunc->off_proc->idx1[i]; j < P_trunc->off_proc->idx1[i+1]; j++)
+                row_trunc[P_trunc->off_proc_column_map[P_trunc->off_proc->idx2[j]]] = 
+                    P_trunc->off_proc->vals[j];
+
+            ASSERT_LE((int) row_trunc.size(), max_elmts);
+            if ((int) row.size() <= max_elmts)
+            {
+                ASSERT_EQ(row.size(), row_trunc.size());
+            }
+
+            row_sum = 0;
+            row_sum_trunc = 0;
+            min_kept = 1e300;
+            max_dropped = 0;
+            for (std::map<int, double>::iterator it = row.begin(); it != row.end(); ++it)
+            {
+                val = fabs(it->second);
+                row_sum += it->second;
+                if (row_trunc.count(it->first))
+                {
+                    row_sum_trunc += row_trunc[it->first];
+                    if (val < min_kept) min_kept = val;
+                }
+                else if (val > max_dropped) max_dropped = val;
+            }
+            for (std::map<int, double>::iterator it = row_trunc.begin(); 
+                    it != row_trunc.end(); ++it)
+                ASSERT_TRUE(row.count(it->first));
+            ASSERT_GE(min_kept, max_dropped);
+            ASSERT_NEAR(row_sum, row_sum_trunc, 1e-10);
+        }
+
+        // Only off_proc columns still referenced are kept
+        std::vector<bool> col_used(P_trunc->off_proc_num_cols, false);
+        for (int j = 0; j < P_trunc->off_proc->nnz; j++)
+            col_used[P_trunc->off_proc->idx2[j]] = true;
+        for (int j = 0; j < P_trunc->off_proc_num_cols; j++)
+            ASSERT_TRUE(col_used[j]);
+
+        delete P_trunc;
+        delete P;
+    }
+
+    delete S;
+    delete A;
+
+} // end of TEST(TestParInterpolation, TruncationInRuge_Stuben) //
@@ -0,0 +1,104 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "gtest/gtest.h"
+
+#include "raptor/raptor.hpp"
+#include "raptor/core/threads.hpp"
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    int temp = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return temp;
+} // end of main() //
+
+struct SetupLevel
+{
+    ParCSRMatrix* S;
+    std::vector<int> states;
+    std::vector<int> off_proc_states;
+    ParCSRMatrix* P_mod;
+    ParCSRMatrix* P_ext;
+};
+
+void form_setup(ParCSRMatrix* A, std::vector<double>& rand_vals, SetupLevel& setup)
+{
+    setup.S = A->strength(Classical, 0.25);
+    split_pmis(setup.S, setup.states, setup.off_proc_states, false, rand_vals.data());
+    setup.P_mod = mod_classical_interpolation(A, setup.S, setup.states,
+            setup.off_proc_states);
+    setup.P_ext = extended_interpolation(A, setup.S, setup.states,
+            setup.off_proc_states, 0.3);
+}
+
+void compare(ParCSRMatrix* A, ParCSRMatrix* B)
+{
+    ASSERT_EQ(A->on_proc_column_map, B->on_proc_column_map);
+    ASSERT_EQ(A->off_proc_column_map, B->off_proc_column_map);
+    ASSERT_EQ(A->on_proc->idx1, B->on_proc->idx1);
+    ASSERT_EQ(A->on_proc->idx2, B->on_proc->idx2);
+    ASSERT_EQ(A->on_proc->vals, B->on_proc->vals);
+    ASSERT_EQ(A->off_proc->idx1, B->off_proc->idx1);
+    ASSERT_EQ(A->off_proc->idx2, B->off_proc->idx2);
+    ASSERT_EQ(A->off_proc->vals, B->off_proc->vals);
+}
+
+TEST(TestParThreadedSetup, TestsInRuge_Stuben)
+{
+    int grid[3] = {30, 30, 30};
+    double* stencil = laplace_stencil_27pt();
+    ParCSRMatrix* A = par_stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    std::vector<double> rand_vals(A->local_num_rows);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        double w = A->local_row_map[i] * 0.6180339887498949;
+        rand_vals[i] = w - floor(w);
+    }
+
+    // Setup on a single thread, and then on as many threads as
+    // available (at least 4), must match exactly.  Built only
+    // WITH_OPENMP
+    SetupLevel serial, threaded;
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    form_setup(A, rand_vals, serial);
+    omp_set_num_threads(max_threads < 4 ? 4 : max_threads);
+    form_setup(A, rand_vals, threaded);
+    omp_set_num_threads(max_threads);
+
+    compare(serial.S, threaded.S);
+    ASSERT_EQ(serial.states, threaded.states);
+    ASSERT_EQ(serial.off_proc_states, threaded.off_proc_states);
+    compare(serial.P_mod, threaded.P_mod);
+    compare(serial.P_ext, threaded.P_ext);
+
+    // Coarse points form an independent set in S
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        if (threaded.states[i] != Selected) continue;
+        for (int j = threaded.S->on_proc->idx1[i]; j < threaded.S->on_proc->idx1[i+1]; j++)
+        {
+            int col = threaded.S->on_proc->idx2[j];
+            if (col != i)
+            {
+                ASSERT_NE(threaded.states[col], Selected);
+            }
+        }
+    }
+
+    SetupLevel* setups[2] = {&serial, &threaded};
+    for (int s = 0; s < 2; s++)
+    {
+        delete setups[s]->S;
+        delete setups[s]->P_mod;
+        delete setups[s]->P_ext;
+    }
+    delete A;
+
+} // end of TEST(TestParThreadedSetup, TestsInRuge_Stuben) //
@@ -37,7 +37,9 @@ TEST(TestTAPSplitting, TestsInRuge_Stuben)
     const char* S0_fn = "../../../../test_data/rss_S0.pm";
     const char* S1_fn = "../../../../test_data/rss_S1.pm";
     const char* cf0_fn = "../../../../test_data/rss_cf0.txt";
+    const char* cf0_pmis = "../../../../test_data/rss_cf0_pmis.txt";
     const char* cf1_fn = "../../../../test_data/rss_cf1.txt";
+    const char* cf1_pmis = "../../../../test_data/rss_cf1_pmis.txt";
     const char* weights_fn = "../../../../test_data/weights.txt";
     int n_items_read;
 
@@ -74,6 +76,22 @@ TEST(TestTAPSplitting, TestsInRuge_Stuben)
     }
     fclose(f);
 
+    split_pmis(S, states, off_proc_states, true, weights.data());
+
+    f = fopen(cf0_pmis, "r");
+    for (int i = 0; i < S->partition->first_local_row; i++)
+    {
+        n_items_read = fscanf(f, "%d\n", &cf);
+        ASSERT_EQ(n_items_read, 1);
+    }
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        n_items_read = fscanf(f, "%d\n", &cf);
+        ASSERT_EQ(n_items_read, 1);
+        ASSERT_EQ(cf, states[i]);
+    }
+    fclose(f);
+
     delete S;
 
     // TEST LEVEL 1
@@ -109,6 +127,22 @@ TEST(TestTAPSplitting, TestsInRuge_Stuben)
     }
     fclose(f);
 
+    split_pmis(S, states, off_proc_states, true, weights.data());
+
+    f = fopen(cf1_pmis, "r");
+    for (int i = 0; i < S->partition->first_local_row; i++)
+    {
+        n_items_read = fscanf(f, "%d\n", &cf);
+        ASSERT_EQ(n_items_read, 1);
+    }
+    for (int i = 0; i < S->local_num_rows; i++)
+    {
+        n_items_read = fscanf(f, "%d\n", &cf);
+        ASSERT_EQ(n_items_read, 1);
+        ASSERT_EQ(cf, states[i]);
+    }
+    fclose(f);
+
     delete S;
 
     setenv("PPN", "16", 1);    
@@ -75,3 +75,63 @@ TEST(ParStrengthTest, TestsInTests)
     delete S_rap;
 
 } // end of  TEST(ParStrengthTest, TestsInTests) //
+
+TEST(ParStrengthPatternTest, TestsInTests)
+{
+    int rank, num_procs;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+
+    ParCSRMatrix* A;
+    ParCSRMatrix* S;
+    ParCSRMatrix* S_rap;
+    ParCSRMatrix* S_pattern;
+    ParCSRMatrix* P;
+    ParCSRMatrix* P_pattern;
+    std::vector<int> states;
+    std::vector<int> off_proc_states;
+
+    const char* A0_fn = "../../../test_data/aniso.pm";
+    const char* S0_fn = "../../../test_data/aniso_S.pm";
+
+    A = readParMatrix(A0_fn);
+    S = readParMatrix(S0_fn);
+    S_rap = A->strength(Classical, 0.25);
+    S_pattern = A->strength(Classical, 0.25, false, 1, NULL, true);
+
+    // Pattern only strength matrix matches, without values
+    ASSERT_EQ(S_pattern->on_proc->nnz, S_rap->on_proc->nnz);
+    ASSERT_EQ(S_pattern->off_proc->nnz, S_rap->off_proc->nnz);
+    ASSERT_EQ(S_pattern->on_proc->vals.size(), 0);
+    ASSERT_EQ(S_pattern->off_proc->vals.size(), 0);
+    for (int i = 0; i <= A->local_num_rows; i++)
+    {
+        ASSERT_EQ(S_pattern->on_proc->idx1[i], S_rap->on_proc->idx1[i]);
+        ASSERT_EQ(S_pattern->off_proc->idx1[i], S_rap->off_proc->idx1[i]);
+    }
+    for (int j = 0; j < S_rap->on_proc->nnz; j++)
+    {
+        ASSERT_EQ(S_pattern->on_proc->idx2[j], S_rap->on_proc->idx2[j]);
+    }
+    for (int j = 0; j < S_rap->off_proc->nnz; j++)
+    {
+        ASSERT_EQ(S_pattern->off_proc->idx2[j], S_rap->off_proc->idx2[j]);
+    }
+
+    // Interpolation takes values from A, so is unchanged
+    split_pmis(S_rap, states, off_proc_states);
+    P = mod_classical_interpolation(A, S_rap, states, off_proc_states);
+    P_pattern = mod_classical_interpolation(A, S_pattern, states, off_proc_states);
+    compare(P, P_pattern);
+    delete P;
+    delete P_pattern;
+
+    remove_empty_cols(S_pattern);
+    compare_pattern(S, S_pattern);
+
+    delete A;
+    delete S;
+    delete S_rap;
+    delete S_pattern;
+
+} // end of  TEST(ParStrengthPatternTest, TestsInTests) //
@@ -1,4 +1,6 @@
 #include "raptor/core/matrix.hpp"
+#include "raptor/core/workspace.hpp"
+#include "raptor/core/threads.hpp"
 
 using namespace raptor;
 
@@ -86,18 +88,175 @@ void finalize_sums(std::vector<double*>& sums)
         delete[] *it;
 }
 
+/**************************************************************
+*****   Form Rows
+**************************************************************
+***** Forms the n_rows rows of a product C, calling 
+***** form_rows(start, end, next, sums, idx2, vals, row_sizes) to 
+***** append rows [start, end) to idx2 and vals, and set the size
+***** of each row i in row_sizes[i].  next and sums are dense
+***** accumulators over the n_cols columns of C.
+*****
+***** Large products are formed by multiple threads, each with its
+***** own accumulators and a contiguous range of rows (balanced by
+***** the row pointer ptr of the left operand).  Row sizes are 
+***** prefix summed, and each thread copies its rows into place.
+**************************************************************/
+template <typename T, typename RowFunc>
+void form_rows(CSRMatrix* C, std::vector<T>& C_vals, const std::vector<int>& ptr,
+        int n_rows, int n_cols, int b_size, RowFunc form_row_range)
+{
+    int n_threads = work_threads(ptr[n_rows]);
+    int* row_sizes = C->idx1.data() + 1;
+
+    if (n_threads == 1)
+    {
+        // Rows of C are formed in workspace buffers, and copied into
+        // exactly sized storage once nnz is known
+        WorkVector<int> next(n_cols, -1);
+        WorkVector<T> sums;
+        init_sums(sums.vec(), n_cols, b_size);
+        WorkVector<int> C_idx2;
+        WorkVector<T> C_vals_tmp;
+        std::vector<int>& idx2 = C_idx2.vec();
+        std::vector<T>& vals = C_vals_tmp.vec();
+        idx2.reserve(1.5*ptr[n_rows]);
+        vals.reserve(1.5*ptr[n_rows]);
+
+        form_row_range(0, n_rows, next.vec(), sums.vec(), idx2, vals, row_sizes);
+
+        finalize_sums(sums.vec());
+        C->idx2.assign(idx2.begin(), idx2.end());
+        C_vals.assign(vals.begin(), vals.end());
+    }
+    else
+    {
+        std::vector<std::vector<int> > thread_idx2(n_threads);
+        std::vector<std::vector<T> > thread_vals(n_threads);
+        std::vector<long> thread_ptr(n_threads + 1, 0);
+
+        RAPTOR_OMP(omp parallel num_threads(n_threads))
+        {
+            int tid = thread_id();
+            int start, end;
+            thread_range(ptr, n_rows, tid, team_size(), start, end);
+
+            std::vector<int> next(n_cols, -1);
+            std::vector<T> sums;
+            init_sums(sums, n_cols, b_size);
+            form_row_range(start, end, next, sums, thread_idx2[tid], 
+                    thread_vals[tid], row_sizes);
+            finalize_sums(sums);
+            thread_ptr[tid+1] = thread_idx2[tid].size();
+
+            RAPTOR_OMP(omp barrier)
+            RAPTOR_OMP(omp single)
+            {
+                for (int t = 0; t < n_threads; t++)
+                {
+                    thread_ptr[t+1] += thread_ptr[t];
+                }
+                C->idx2.resize(thread_ptr[n_threads]);
+                C_vals.resize(thread_ptr[n_threads]);
+            }
+
+            std::copy(thread_idx2[tid].begin(), thread_idx2[tid].end(),
+                    C->idx2.begin() + thread_ptr[tid]);
+            std::copy(thread_vals[tid].begin(), thread_vals[tid].end(),
+                    C_vals.begin() + thread_ptr[tid]);
+        }
+    }
+
+    C->idx1[0] = 0;
+    for (int i = 0; i < n_rows; i++)
+    {
+        C->idx1[i+1] += C->idx1[i];
+    }
+    C->nnz = C->idx2.size();
+}
+
 template <typename T>
 CSRMatrix* spgemm_helper(const CSRMatrix* A, const CSRMatrix* B, 
         std::vector<T>& A_vals, std::vector<T>& B_vals,
         int* B_to_C = NULL)
 {
-    std::vector<int> next(B->n_cols, -1);
-    std::vector<T> sums;
-    init_sums(sums, B->n_cols, B->b_size);
-
     CSRMatrix* C = NULL;
     std::vector<T>& C_vals = form_new(A, B, &C, A_vals);
-    C->reserve_size(1.5*A->nnz);
+
+    form_rows(C, C_vals, A->idx1, A->n_rows, B->n_cols, B->b_size,
+            [&](int start, int end, std::vector<int>& next, std::vector<T>& sums,
+                std::vector<int>& idx2, std::vector<T>& vals, int* row_sizes)
+    {
+        for (int i = start; i < end; i++)
+        {
+            int head = -2;
+            int length = 0;
+            int row_size = idx2.size();
+            int row_start_A = A->idx1[i];
+            int row_end_A = A->idx1[i+1];
+            for (int j = row_start_A; j < row_end_A; j++)
+            {
+                int col_A = A->idx2[j];
+                T val_A = A_vals[j];
+                int row_start_B = B->idx1[col_A];
+                int row_end_B = B->idx1[col_A+1];
+                for (int k = row_start_B; k < row_end_B; k++)
+                {
+                    int col_B = B->idx2[k];
+                    A->mult_vals(val_A, B_vals[k], &sums[col_B],
+                            A->b_rows, B->b_cols, A->b_cols);
+                    if (next[col_B] == -1)
+                    {
+                        next[col_B] = head;
+                        head = col_B;
+                        length++;
+                    }
+                }
+            }
+            for (int j = 0; j < length; j++)
+            {
+                double val = A->abs_val(sums[head]);
+                if (val > zero_tol)
+                {
+                    if (B_to_C) 
+                    {
+                        idx2.emplace_back(B_to_C[head]);
+                    }
+                    else
+                    {
+                        idx2.emplace_back(head);
+                    }
+                    vals.emplace_back(sums[head]);
+                }
+                int tmp = head;
+                head = next[head];
+                next[tmp] = -1;
+                zero_sum(&sums[tmp], A->b_size);
+            }
+            row_sizes[i] = idx2.size() - row_size;
+        }
+    });
+
+    return C;
+}
+
+// SpGEMM of packed BSR matrices with square B x B blocks.  Row sums 
+// are accumulated in a contiguous array (B*B values per column of C)
+// and C is formed directly in contiguous block storage.
+template <int B>
+BSRMatrix* BSR_spgemm(const BSRMatrix* A, const BSRMatrix* B_mat,
+        int* B_to_C = NULL)
+{
+    const int bs = B*B;
+    const double* A_data = A->block_data.data();
+    const double* B_data = B_mat->block_data.data();
+
+    WorkVector<int> next(B_mat->n_cols, -1);
+    WorkVector<double> sums(B_mat->n_cols * bs, 0.0);
+
+    BSRMatrix* C = new BSRMatrix(A->n_rows, B_mat->n_cols, B, B);
+    C->idx2.reserve(1.5*A->nnz);
+    C->block_data.reserve(1.5*A->nnz*bs);
 
     C->idx1[0] = 0;
     for (int i = 0; i < A->n_rows; i++)
@@ -109,14 +268,25 @@ CSRMatrix* spgemm_helper(const CSRMatrix* A, const CSRMatrix* B,
         for (int j = row_start_A; j < row_end_A; j++)
         {
             int col_A = A->idx2[j];
-            T val_A = A_vals[j];
-            int row_start_B = B->idx1[col_A];
-            int row_end_B = B->idx1[col_A+1];
+            const double* val_A = A_data + j*bs;
+            int row_start_B = B_mat->idx1[col_A];
+            int row_end_B = B_mat->idx1[col_A+1];
             for (int k = row_start_B; k < row_end_B; k++)
             {
-                int col_B = B->idx2[k];
-                A->mult_vals(val_A, B_vals[k], &sums[col_B],
-                        A->b_rows, B->b_cols, A->b_cols);
+                int col_B = B_mat->idx2[k];
+                const double* val_B = B_data + k*bs;
+                double* sum = sums.data() + col_B*bs;
+                for (int row = 0; row < B; row++)
+                {
+                    for (int inner = 0; inner < B; inner++)
+                    {
+                        double a = val_A[row*B + inner];
+                        for (int col = 0; col < B; col++)
+                        {
+                            sum[row*B + col] += a * val_B[inner*B + col];
+                        }
+                    }
+                }
                 if (next[col_B] == -1)
                 {
                     next[col_B] = head;
@@ -127,8 +297,8 @@ CSRMatrix* spgemm_helper(const CSRMatrix* A, const CSRMatrix* B,
         }
         for (int j = 0; j < length; j++)
         {
-            double val = A->abs_val(sums[head]);
-            if (val > zero_tol)
+            double* sum = sums.data() + head*bs;
+            if (C->abs_val(sum) > zero_tol)
             {
                 if (B_to_C) 
                 {
@@ -138,18 +308,26 @@ CSRMatrix* spgemm_helper(const CSRMatrix* A, const CSRMatrix* B,
                 {
                     C->idx2.emplace_back(head);
                 }
-                C_vals.emplace_back(sums[head]);
+                C->block_data.insert(C->block_data.end(), sum, sum + bs);
+            }
+            for (int k = 0; k < bs; k++)
+            {
+                sum[k] = 0.0;
             }
             int tmp = head;
             head = next[head];
             next[tmp] = -1;
-            zero_sum(&sums[tmp], A->b_size);
         }
         C->idx1[i+1] = C->idx2.size();
     }
     C->nnz = C->idx2.size();
 
-    finalize_sums(sums);
+    C->block_vals.resize(C->nnz);
+    for (int j = 0; j < C->nnz; j++)
+    {
+        C->block_vals[j] = C->block_data.data() + j*bs;
+    }
+    C->packed = true;
 
     return C;
 }
@@ -161,62 +339,59 @@ CSRMatrix* spgemm_T_helper(const CSCMatrix* A, const CSRMatrix* B,
 {
     CSRMatrix* C;
     std::vector<T>& C_vals = form_new(A, B, &C, A_vals);
-    C->reserve_size(1.5*B->nnz);
 
-    std::vector<int> next(B->n_cols, -1); 
-    std::vector<T> sums;
-    init_sums(sums, B->n_cols, A->b_size);
-
-    C->idx1[0] = 0;
-    for (int i = 0; i < A->n_cols; i++)
+    form_rows(C, C_vals, A->idx1, A->n_cols, B->n_cols, A->b_size,
+            [&](int start, int end, std::vector<int>& next, std::vector<T>& sums,
+                std::vector<int>& idx2, std::vector<T>& vals, int* row_sizes)
     {
-        int head = -2;
-        int length = 0;
-        int row_start_AT = A->idx1[i];
-        int row_end_AT = A->idx1[i+1];
-        for (int j = row_start_AT; j < row_end_AT; j++)
+        for (int i = start; i < end; i++)
         {
-            int col_AT = A->idx2[j];
-            T val_AT = A_vals[j];
-            int row_start = B->idx1[col_AT];
-            int row_end = B->idx1[col_AT+1];
-            for (int k = row_start; k < row_end; k++)
+            int head = -2;
+            int length = 0;
+            int row_size = idx2.size();
+            int row_start_AT = A->idx1[i];
+            int row_end_AT = A->idx1[i+1];
+            for (int j = row_start_AT; j < row_end_AT; j++)
             {
-                int col = B->idx2[k];
-                A->mult_T_vals(val_AT, B_vals[k], &sums[col],
-                        A->b_cols, B->b_cols, A->b_rows);
-                if (next[col] == -1)
+                int col_AT = A->idx2[j];
+                T val_AT = A_vals[j];
+                int row_start = B->idx1[col_AT];
+                int row_end = B->idx1[col_AT+1];
+                for (int k = row_start; k < row_end; k++)
                 {
-                    next[col] = head;
-                    head = col;
-                    length++;
+                    int col = B->idx2[k];
+                    A->mult_T_vals(val_AT, B_vals[k], &sums[col],
+                            A->b_cols, B->b_cols, A->b_rows);
+                    if (next[col] == -1)
+                    {
+                        next[col] = head;
+                        head = col;
+                        length++;
+                    }
                 }
             }
-        }
-        for (int j = 0; j < length; j++)
-        {
-            if (A->abs_val(sums[head]) > zero_tol)
+            for (int j = 0; j < length; j++)
             {
-                if (C_map)
-                {
-                    C->idx2.emplace_back(C_map[head]);
-                }
-                else
+                if (A->abs_val(sums[head]) > zero_tol)
                 {
-                    C->idx2.emplace_back(head);
+                    if (C_map)
+                    {
+                        idx2.emplace_back(C_map[head]);
+                    }
+                    else
+                    {
+                        idx2.emplace_back(head);
+                    }
+                    vals.emplace_back(sums[head]);
                 }
-                C_vals.emplace_back(sums[head]);
+                int tmp = head;
+                head = next[head];
+                next[tmp] = -1;
+                zero_sum(&sums[tmp], A->b_size);
             }
-            int tmp = head;
-            head = next[head];
-            next[tmp] = -1;
-            zero_sum(&sums[tmp], A->b_size);
+            row_sizes[i] = idx2.size() - row_size;
         }
-        C->idx1[i+1] = C->idx2.size();
-    }
-    C->nnz = C->idx2.size();
-
-    finalize_sums(sums);
+    });
 
     return C;
 }
@@ -267,8 +442,22 @@ CSRMatrix* CSRMatrix::spgemm(CSRMatrix* B, int* B_to_C)
 BSRMatrix* BSRMatrix::spgemm(CSRMatrix* B, int* B_to_C)
 {
     BSRMatrix* B_bsr = (BSRMatrix*) B;
-    return (BSRMatrix*) spgemm_helper(this, B_bsr, block_vals, 
+    if (b_rows == b_cols && B_bsr->b_rows == b_rows && B_bsr->b_cols == b_cols
+            && is_packed() && B_bsr->is_packed())
+    {
+        switch (b_rows)
+        {
+            case 2: return BSR_spgemm<2>(this, B_bsr, B_to_C);
+            case 3: return BSR_spgemm<3>(this, B_bsr, B_to_C);
+            case 4: return BSR_spgemm<4>(this, B_bsr, B_to_C);
+            case 6: return BSR_spgemm<6>(this, B_bsr, B_to_C);
+            case 8: return BSR_spgemm<8>(this, B_bsr, B_to_C);
+        }
+    }
+    BSRMatrix* C = (BSRMatrix*) spgemm_helper(this, B_bsr, block_vals, 
             B_bsr->block_vals, B_to_C);
+    C->pack();
+    return C;
 }
 CSRMatrix* COOMatrix::spgemm(CSRMatrix* B, int* B_to_C)
 {
@@ -313,8 +502,10 @@ CSRMatrix* CSRMatrix::spgemm_T(CSCMatrix* A, int* C_map)
 BSRMatrix* BSRMatrix::spgemm_T(CSCMatrix* A, int* C_map)
 {
     BSCMatrix* A_bsc = (BSCMatrix*) A;
-    return (BSRMatrix*) spgemm_T_helper(A_bsc, this, 
+    BSRMatrix* C = (BSRMatrix*) spgemm_T_helper(A_bsc, this, 
             A_bsc->block_vals, block_vals, C_map);
+    C->pack();
+    return C;
 }
 CSRMatrix* COOMatrix::spgemm_T(CSCMatrix* A, int* C_map)
 {
@@ -264,6 +264,23 @@ void ParCSRMatrix::mult_helper(ParCSRMatrix* B, ParCSRMatrix* C,
     CSRMatrix* recv_on = new CSRMatrix(recv_mat->n_rows, -1);
     CSRMatrix* recv_off = new CSRMatrix(recv_mat->n_rows, -1);
 
+    // Count on_proc entries, so both portions are sized exactly
+    int recv_nnz = recv_mat->idx1[recv_mat->n_rows];
+    int recv_on_nnz = 0;
+    for (int j = 0; j < recv_nnz; j++)
+    {
+        global_col = recv_mat->idx2[j];
+        if (global_col >= B->partition->first_local_col &&
+                global_col <= B->partition->last_local_col)
+        {
+            recv_on_nnz++;
+        }
+    }
+    recv_on->idx2.reserve(recv_on_nnz);
+    recv_on->vals.reserve(recv_on_nnz);
+    recv_off->idx2.reserve(recv_nnz - recv_on_nnz);
+    recv_off->vals.reserve(recv_nnz - recv_on_nnz);
+
     int* part_to_col = B->map_partition_to_local();
     recv_on->idx1[0] = 0;
     recv_off->idx1[0] = 0;
@@ -295,9 +312,9 @@ void ParCSRMatrix::mult_helper(ParCSRMatrix* B, ParCSRMatrix* C,
     delete[] part_to_col;
 
     // Calculate global_to_C and B_to_C column maps
-    std::map<int, int> global_to_C;
     std::vector<int> B_to_C(B->off_proc_num_cols);
 
+    C->off_proc_column_map.reserve(recv_off->nnz + B->off_proc_num_cols);
     std::copy(recv_off->idx2.begin(), recv_off->idx2.end(),
             std::back_inserter(C->off_proc_column_map));
     for (std::vector<int>::iterator it = B->off_proc_column_map.begin();
@@ -305,21 +322,9 @@ void ParCSRMatrix::mult_helper(ParCSRMatrix* B, ParCSRMatrix* C,
     {
         C->off_proc_column_map.emplace_back(*it);
     }
-    std::sort(C->off_proc_column_map.begin(), C->off_proc_column_map.end());
-
-    int prev_col = -1;
-    C->off_proc_num_cols = 0;
-    for (std::vector<int>::iterator it = C->off_proc_column_map.begin();
-            it != C->off_proc_column_map.end(); ++it)
-    {
-        if (*it != prev_col)
-        {
-            global_to_C[*it] = C->off_proc_num_cols;
-            C->off_proc_column_map[C->off_proc_num_cols++] = *it;
-            prev_col = *it;
-        }
-    }
-    C->off_proc_column_map.resize(C->off_proc_num_cols);
+    sort_unique(C->off_proc_column_map);
+    C->off_proc_num_cols = C->off_proc_column_map.size();
+    IndexMap global_to_C(C->off_proc_column_map);
 
     for (int i = 0; i < B->off_proc_num_cols; i++)
     {
@@ -393,6 +398,21 @@ void ParCSRMatrix::mult_T_combine(ParCSCMatrix* P, ParCSRMatrix* C, CSRMatrix* r
     // Split recv_mat into on and off proc portions
     CSRMatrix* recv_on = new CSRMatrix(recv_mat->n_rows, -1);
     CSRMatrix* recv_off = new CSRMatrix(recv_mat->n_rows, -1);
+    int recv_nnz = recv_mat->idx1[recv_mat->n_rows];
+    int recv_on_nnz = 0;
+    for (int j = 0; j < recv_nnz; j++)
+    {
+        col = recv_mat->idx2[j];
+        if (col >= partition->first_local_col
+                && col <= partition->last_local_col)
+        {
+            recv_on_nnz++;
+        }
+    }
+    recv_on->idx2.reserve(recv_on_nnz);
+    recv_on->vals.reserve(recv_on_nnz);
+    recv_off->idx2.reserve(recv_nnz - recv_on_nnz);
+    recv_off->vals.reserve(recv_nnz - recv_on_nnz);
     for (int i = 0; i < recv_mat->n_rows; i++)
     {
         start = recv_mat->idx1[i];
@@ -452,37 +472,21 @@ void ParCSRMatrix::mult_T_combine(ParCSCMatrix* P, ParCSRMatrix* C, CSRMatrix* r
      * Form off_proc
      ******************************/
     // Calculate global_to_C and map_to_C column maps
-    std::map<int, int> global_to_C;
     std::vector<int> map_to_C;
     if (off_proc_num_cols)
     {
         map_to_C.reserve(off_proc_num_cols);
     }
 
-    // Create set of global columns in B_off_proc and recv_mat
-    std::set<int> C_col_set;
-    for (std::vector<int>::iterator it = recv_off->idx2.begin(); 
-            it != recv_off->idx2.end(); ++it)
-    {
-        C_col_set.insert(*it);
-    }
-    for (std::vector<int>::iterator it = off_proc_column_map.begin(); 
-            it != off_proc_column_map.end(); ++it)
-    {
-        C_col_set.insert(*it);
-    }
-
-    C->off_proc_num_cols = C_col_set.size();
-    if (C->off_proc_num_cols)
-    {
-        C->off_proc_column_map.reserve(C->off_proc_num_cols);
-    }
-    for (std::set<int>::iterator it = C_col_set.begin(); 
-            it != C_col_set.end(); ++it)
-    {
-        global_to_C[*it] = C->off_proc_column_map.size();
-        C->off_proc_column_map.emplace_back(*it);
-    }
+    // Sorted, unique global columns in B_off_proc and recv_mat
+    C->off_proc_column_map.reserve(recv_off->idx2.size() + off_proc_num_cols);
+    std::copy(recv_off->idx2.begin(), recv_off->idx2.end(),
+            std::back_inserter(C->off_proc_column_map));
+    std::copy(off_proc_column_map.begin(), off_proc_column_map.end(),
+            std::back_inserter(C->off_proc_column_map));
+    sort_unique(C->off_proc_column_map);
+    C->off_proc_num_cols = C->off_proc_column_map.size();
+    IndexMap global_to_C(C->off_proc_column_map);
 
     // Map local off_proc_cols to C->off_proc_column_map
     for (std::vector<int>::iterator it = off_proc_column_map.begin();
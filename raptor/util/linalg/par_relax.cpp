@@ -17,6 +17,9 @@ void sor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
         int num_sweeps, double omega, CommPkg* comm);
 void ssor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, CommPkg* comm);
+bool block_relax_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, 
+        ParVector& tmp, int num_sweeps, double omega, CommPkg* comm, 
+        relax_t relax_type);
 
 
 
@@ -121,6 +124,11 @@ void SOR_backward(ParCSRMatrix* A, ParVector& x, const ParVector& y,
 void jacobi_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, CommPkg* comm)
 {
+    if (block_relax_helper(A, x, b, tmp, num_sweeps, omega, comm, Jacobi))
+    {
+        return;
+    }
+
     A->on_proc->sort();
     A->off_proc->sort();
     A->on_proc->move_diag();
@@ -174,6 +182,11 @@ void jacobi_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void sor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, CommPkg* comm)
 {
+    if (block_relax_helper(A, x, b, tmp, num_sweeps, omega, comm, SOR))
+    {
+        return;
+    }
+
     A->on_proc->sort();
     A->off_proc->sort();
     A->on_proc->move_diag();
@@ -189,6 +202,11 @@ void sor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void ssor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, CommPkg* comm)
 {
+    if (block_relax_helper(A, x, b, tmp, num_sweeps, omega, comm, SSOR))
+    {
+        return;
+    }
+
     A->on_proc->sort();
     A->off_proc->sort();
     A->on_proc->move_diag();
@@ -201,6 +219,231 @@ void ssor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
     }
 }
 
+
+/**************************************************************
+ *****   Block Relaxation (BSR)
+ **************************************************************
+ ***** Point-block variants of the relaxation methods for 
+ ***** matrices with square blocks.  Diagonal blocks are inverted
+ ***** once by block_relax_setup (from ParMultilevel::setup, or on
+ ***** first use) and stored with A->on_proc, so sweeps do not
+ ***** allocate.  The block size B is a template parameter for
+ ***** sizes with fixed kernels (2, 3, 4, 6, 8), and B == 0 falls
+ ***** back to the runtime block size.
+ *****
+ ***** Jacobi : x_i = (1-omega)*x_i + omega*D_i^{-1}(b_i - sum_j A_ij x_j)
+ ***** using x from the previous sweep, SOR : as Jacobi, but using
+ ***** updated on_proc values, SSOR : forward and backward SOR.
+ **************************************************************/
+bool invert_block(const double* block, double* inv, double* work, int n)
+{
+    for (int i = 0; i < n*n; i++)
+    {
+        work[i] = block[i];
+        inv[i] = 0.0;
+    }
+    for (int i = 0; i < n; i++)
+        inv[i*n + i] = 1.0;
+
+    // Gauss-Jordan elimination with partial pivoting
+    for (int k = 0; k < n; k++)
+    {
+        int pivot = k;
+        for (int i = k+1; i < n; i++)
+        {
+            if (fabs(work[i*n + k]) > fabs(work[pivot*n + k]))
+                pivot = i;
+        }
+        if (fabs(work[pivot*n + k]) < zero_tol)
+            return false;
+        if (pivot != k)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                std::swap(work[k*n + j], work[pivot*n + j]);
+                std::swap(inv[k*n + j], inv[pivot*n + j]);
+            }
+        }
+        double scale = 1.0 / work[k*n + k];
+        for (int j = 0; j < n; j++)
+        {
+            work[k*n + j] *= scale;
+            inv[k*n + j] *= scale;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            if (i == k) continue;
+            double factor = work[i*n + k];
+            if (factor == 0.0) continue;
+            for (int j = 0; j < n; j++)
+            {
+                work[i*n + j] -= factor * work[k*n + j];
+                inv[i*n + j] -= factor * inv[k*n + j];
+            }
+        }
+    }
+    return true;
+}
+
+template <int B>
+void block_relax_row(const BSRMatrix* A_on, const BSRMatrix* A_off, int i,
+        const double* x_on, const double* dist_x, const double* b, 
+        const double* diag_inv, double* x_old, double* x_new, double* r, 
+        double omega, int nb)
+{
+    const int n = B ? B : nb;
+    const int bs = n*n;
+    const double* on_data = A_on->block_data.data();
+    const double* off_data = A_off->block_data.data();
+
+    for (int k = 0; k < n; k++)
+        r[k] = b[i*n + k];
+
+    // Diagonal block is first in each row (move_diag)
+    int start = A_on->idx1[i] + 1;
+    int end = A_on->idx1[i+1];
+    for (int j = start; j < end; j++)
+    {
+        const double* block_val = on_data + j*bs;
+        const double* x_val = x_on + A_on->idx2[j]*n;
+        for (int row = 0; row < n; row++)
+            for (int col = 0; col < n; col++)
+                r[row] -= block_val[row*n + col] * x_val[col];
+    }
+
+    start = A_off->idx1[i];
+    end = A_off->idx1[i+1];
+    for (int j = start; j < end; j++)
+    {
+        const double* block_val = off_data + j*bs;
+        const double* x_val = dist_x + A_off->idx2[j]*n;
+        for (int row = 0; row < n; row++)
+            for (int col = 0; col < n; col++)
+                r[row] -= block_val[row*n + col] * x_val[col];
+    }
+
+    const double* d_inv = diag_inv + i*bs;
+    for (int row = 0; row < n; row++)
+    {
+        double val = 0.0;
+        for (int col = 0; col < n; col++)
+            val += d_inv[row*n + col] * r[col];
+        x_new[i*n + row] = (1.0 - omega) * x_old[i*n + row] + omega * val;
+    }
+}
+
+template <int B>
+void block_relax(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
+        int num_sweeps, double omega, CommPkg* comm, relax_t relax_type)
+{
+    BSRMatrix* A_on = (BSRMatrix*) A->on_proc;
+    BSRMatrix* A_off = (BSRMatrix*) A->off_proc;
+    const int n = B ? B : A_on->b_rows;
+    const std::vector<bool>& has_diag = A_on->has_diag_inv;
+    const double* diag_inv = A_on->diag_inv.data();
+    double* r = A_on->relax_work.data();
+
+    double* x_vals = x.local.data();
+    double* tmp_vals = tmp.local.data();
+    double* b_vals = b.local.data();
+    for (int iter = 0; iter < num_sweeps; iter++)
+    {
+        std::vector<double>& dist_x = comm->communicate(x, n);
+        if (relax_type == Jacobi)
+        {
+            for (int i = 0; i < A->local_num_rows * n; i++)
+                tmp_vals[i] = x_vals[i];
+            for (int i = 0; i < A->local_num_rows; i++)
+            {
+                if (!has_diag[i]) continue;
+                block_relax_row<B>(A_on, A_off, i, tmp_vals, dist_x.data(),
+                        b_vals, diag_inv, tmp_vals, x_vals, r, 
+                        omega, n);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < A->local_num_rows; i++)
+            {
+                if (!has_diag[i]) continue;
+                block_relax_row<B>(A_on, A_off, i, x_vals, dist_x.data(),
+                        b_vals, diag_inv, x_vals, x_vals, r, 
+                        omega, n);
+            }
+            if (relax_type == SSOR)
+            {
+                for (int i = A->local_num_rows - 1; i >= 0; i--)
+                {
+                    if (!has_diag[i]) continue;
+                    block_relax_row<B>(A_on, A_off, i, x_vals, dist_x.data(),
+                            b_vals, diag_inv, x_vals, x_vals, r, 
+                            omega, n);
+                }
+            }
+        }
+    }
+}
+
+bool block_relax_setup(ParCSRMatrix* A)
+{
+    if (A->on_proc->format() != BSR || A->off_proc->format() != BSR)
+        return false;
+    if (A->on_proc->b_rows != A->on_proc->b_cols)
+        return false;
+
+    A->on_proc->sort();
+    A->off_proc->sort();
+    A->on_proc->move_diag();
+
+    BSRMatrix* A_on = (BSRMatrix*) A->on_proc;
+    BSRMatrix* A_off = (BSRMatrix*) A->off_proc;
+    if (!A_on->is_packed()) A_on->pack();
+    if (!A_off->is_packed()) A_off->pack();
+
+    // Inverses are kept until pack() moves the blocks
+    if ((int) A_on->has_diag_inv.size() == A->local_num_rows)
+        return true;
+
+    // Rows without a nonsingular diagonal block are left unchanged
+    // by relaxation.  The scratch holds the row residual of a sweep
+    // and the elimination workspace here.
+    const int n = A_on->b_rows;
+    const int bs = n*n;
+    A_on->diag_inv.assign(A->local_num_rows * bs, 0.0);
+    A_on->has_diag_inv.assign(A->local_num_rows, false);
+    A_on->relax_work.resize(bs);
+    for (int i = 0; i < A->local_num_rows; i++)
+    {
+        int start = A_on->idx1[i];
+        if (start == A_on->idx1[i+1] || A_on->idx2[start] != i)
+            continue;
+        A_on->has_diag_inv[i] = invert_block(A_on->block_data.data() + start*bs,
+                A_on->diag_inv.data() + i*bs, A_on->relax_work.data(), n);
+    }
+
+    return true;
+}
+
+// Returns false if A is not a BSR matrix with square blocks
+bool block_relax_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, 
+        ParVector& tmp, int num_sweeps, double omega, CommPkg* comm, 
+        relax_t relax_type)
+{
+    if (!block_relax_setup(A))
+        return false;
+
+    switch (A->on_proc->b_rows)
+    {
+        case 2: block_relax<2>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+        case 3: block_relax<3>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+        case 4: block_relax<4>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+        case 6: block_relax<6>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+        case 8: block_relax<8>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+        default: block_relax<0>(A, x, b, tmp, num_sweeps, omega, comm, relax_type); break;
+    }
+    return true;
+}
+
 /**************************************************************
  *****  Relaxation Method 
  **************************************************************
@@ -216,6 +459,11 @@ void ssor_helper(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void jacobi(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, bool tap)
 {
+    if (A->relax_matrix_free(x, b, tmp, num_sweeps, omega, Jacobi))
+    {
+        return;
+    }
+
     CommPkg* comm;
     if (tap)
     {
@@ -241,6 +489,11 @@ void jacobi(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void sor(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, bool tap)
 {
+    if (A->relax_matrix_free(x, b, tmp, num_sweeps, omega, SOR))
+    {
+        return;
+    }
+
     CommPkg* comm;
     if (tap)
     {
@@ -266,6 +519,11 @@ void sor(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void ssor(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps, double omega, bool tap)
 {
+    if (A->relax_matrix_free(x, b, tmp, num_sweeps, omega, SSOR))
+    {
+        return;
+    }
+
     CommPkg* comm;
     if (tap)
     {
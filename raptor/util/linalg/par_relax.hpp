@@ -19,6 +19,11 @@ void sor(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp,
 void ssor(ParCSRMatrix* A, ParVector& x, ParVector& b, ParVector& tmp, 
         int num_sweeps = 1, double omega = 1.0, bool tap = false);
 
+// Inverts the diagonal blocks of a BSR matrix for block relaxation,
+// unless already stored.  Returns false if A is not BSR with square
+// blocks.
+bool block_relax_setup(ParCSRMatrix* A);
+
 }
 
 #endif
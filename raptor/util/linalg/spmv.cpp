@@ -3,6 +3,10 @@
 
 #include "raptor/core/matrix.hpp"
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 using namespace raptor;
 
 // Declare Private Methods
@@ -323,6 +327,278 @@ void BCOOMatrix::spmv_residual(const double* x, const double* b, double* r) cons
 
 
 
+// Result operations shared by the SELL and fixed-size BSR kernels
+// (b = Ax, b += Ax, b -= Ax, r = b - Ax)
+struct SpMV_set
+{
+    static inline void apply(const double* b, double* r, int row, double val)
+    {
+        r[row] = val;
+    }
+};
+struct SpMV_add
+{
+    static inline void apply(const double* b, double* r, int row, double val)
+    {
+        r[row] += val;
+    }
+};
+struct SpMV_sub
+{
+    static inline void apply(const double* b, double* r, int row, double val)
+    {
+        r[row] -= val;
+    }
+};
+struct SpMV_res
+{
+    static inline void apply(const double* b, double* r, int row, double val)
+    {
+        r[row] = b[row] - val;
+    }
+};
+
+
+
+// SELLMatrix SpMV Methods
+// Each chunk of C rows is stored column-major, so the inner loop 
+// over the C rows of a chunk is a contiguous load of values, a 
+// gather of x, and a multiply-add across SIMD lanes.
+template <int C>
+inline void SELL_chunk(const int* cols, const double* vals, int width,
+        const double* x, double* acc)
+{
+    for (int k = 0; k < C; k++)
+        acc[k] = 0.0;
+    for (int j = 0; j < width; j++)
+    {
+        const int* c = cols + j*C;
+        const double* v = vals + j*C;
+        for (int k = 0; k < C; k++)
+        {
+            acc[k] += v[k] * x[c[k]];
+        }
+    }
+}
+
+#if defined(__AVX2__)
+inline __m256d SELL_fma(__m256d a, __m256d b, __m256d c)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+template <>
+inline void SELL_chunk<4>(const int* cols, const double* vals, int width,
+        const double* x, double* acc)
+{
+    __m256d sum = _mm256_setzero_pd();
+    for (int j = 0; j < width; j++)
+    {
+        __m128i idx = _mm_loadu_si128((const __m128i*)(cols + j*4));
+        __m256d xv = _mm256_i32gather_pd(x, idx, 8);
+        sum = SELL_fma(_mm256_loadu_pd(vals + j*4), xv, sum);
+    }
+    _mm256_storeu_pd(acc, sum);
+}
+#endif
+
+#if defined(__AVX512F__)
+template <>
+inline void SELL_chunk<8>(const int* cols, const double* vals, int width,
+        const double* x, double* acc)
+{
+    __m512d sum = _mm512_setzero_pd();
+    for (int j = 0; j < width; j++)
+    {
+        __m256i idx = _mm256_loadu_si256((const __m256i*)(cols + j*8));
+        __m512d xv = _mm512_i32gather_pd(idx, x, 8);
+        sum = _mm512_fmadd_pd(_mm512_loadu_pd(vals + j*8), xv, sum);
+    }
+    _mm512_storeu_pd(acc, sum);
+}
+#elif defined(__AVX2__)
+template <>
+inline void SELL_chunk<8>(const int* cols, const double* vals, int width,
+        const double* x, double* acc)
+{
+    __m256d sum_lo = _mm256_setzero_pd();
+    __m256d sum_hi = _mm256_setzero_pd();
+    for (int j = 0; j < width; j++)
+    {
+        const int* c = cols + j*8;
+        const double* v = vals + j*8;
+        __m256d x_lo = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i*)c), 8);
+        __m256d x_hi = _mm256_i32gather_pd(x, _mm_loadu_si128((const __m128i*)(c+4)), 8);
+        sum_lo = SELL_fma(_mm256_loadu_pd(v), x_lo, sum_lo);
+        sum_hi = SELL_fma(_mm256_loadu_pd(v + 4), x_hi, sum_hi);
+    }
+    _mm256_storeu_pd(acc, sum_lo);
+    _mm256_storeu_pd(acc + 4, sum_hi);
+}
+#endif
+
+template <int C, typename Op>
+void SELL_kernel(const SELLMatrix* A, const double* x, const double* b, double* r)
+{
+    double acc[C];
+    const int* perm = A->row_perm.data();
+    for (int c = 0; c < A->num_chunks; c++)
+    {
+        int start = A->chunk_ptr[c];
+        SELL_chunk<C>(A->sell_cols.data() + start, A->sell_vals.data() + start, 
+                A->chunk_width[c], x, acc);
+        const int* rows = perm + c*C;
+        for (int k = 0; k < C; k++)
+        {
+            if (rows[k] >= 0)
+                Op::apply(b, r, rows[k], acc[k]);
+        }
+    }
+}
+
+// Chunk sizes without a specialized kernel, one row at a time
+template <typename Op>
+void SELL_kernel_generic(const SELLMatrix* A, const double* x, const double* b, 
+        double* r)
+{
+    int C = A->chunk_size;
+    for (int c = 0; c < A->num_chunks; c++)
+    {
+        int start = A->chunk_ptr[c];
+        int width = A->chunk_width[c];
+        for (int k = 0; k < C; k++)
+        {
+            int row = A->row_perm[c*C + k];
+            if (row < 0) continue;
+            double val = 0.0;
+            for (int j = 0; j < width; j++)
+            {
+                int idx = start + j*C + k;
+                val += A->sell_vals[idx] * x[A->sell_cols[idx]];
+            }
+            Op::apply(b, r, row, val);
+        }
+    }
+}
+
+template <typename Op>
+void SELL_apply(const SELLMatrix* A, const double* x, const double* b, double* r)
+{
+    switch (A->chunk_size)
+    {
+        case 4: SELL_kernel<4, Op>(A, x, b, r); break;
+        case 8: SELL_kernel<8, Op>(A, x, b, r); break;
+        case 16: SELL_kernel<16, Op>(A, x, b, r); break;
+        case 32: SELL_kernel<32, Op>(A, x, b, r); break;
+        default: SELL_kernel_generic<Op>(A, x, b, r); break;
+    }
+}
+
+
+
+// Fixed-size BSR SpMV Methods
+// Square B x B blocks read from the contiguous block_data array, with
+// the block size known at compile time so the block loops unroll
+template <int B, typename Op>
+void BSR_kernel(const BSRMatrix* A, const double* x, const double* b, double* r)
+{
+    const double* data = A->block_data.data();
+    double acc[B];
+    for (int i = 0; i < A->n_rows; i++)
+    {
+        for (int k = 0; k < B; k++)
+            acc[k] = 0.0;
+
+        int start = A->idx1[i];
+        int end = A->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            const double* block_val = data + j*B*B;
+            const double* x_val = x + A->idx2[j]*B;
+            for (int row = 0; row < B; row++)
+            {
+                double sum = 0.0;
+                for (int col = 0; col < B; col++)
+                {
+                    sum += block_val[row*B + col] * x_val[col];
+                }
+                acc[row] += sum;
+            }
+        }
+
+        for (int k = 0; k < B; k++)
+            Op::apply(b, r, i*B + k, acc[k]);
+    }
+}
+
+template <int B, typename Op>
+void BSR_kernel_T(const BSRMatrix* A, const double* x, double* b)
+{
+    const double* data = A->block_data.data();
+    for (int i = 0; i < A->n_rows; i++)
+    {
+        const double* x_val = x + i*B;
+        int start = A->idx1[i];
+        int end = A->idx1[i+1];
+        for (int j = start; j < end; j++)
+        {
+            const double* block_val = data + j*B*B;
+            int first_col = A->idx2[j]*B;
+            for (int col = 0; col < B; col++)
+            {
+                double sum = 0.0;
+                for (int row = 0; row < B; row++)
+                {
+                    sum += block_val[row*B + col] * x_val[row];
+                }
+                Op::apply(NULL, b, first_col + col, sum);
+            }
+        }
+    }
+}
+
+// Returns false if A has no fixed-size kernel (non-square or 
+// unsupported block size, or blocks not packed)
+template <typename Op>
+bool BSR_fixed(const BSRMatrix* A, const double* x, const double* b, double* r)
+{
+    if (A->b_rows != A->b_cols || !A->is_packed())
+        return false;
+
+    switch (A->b_rows)
+    {
+        case 2: BSR_kernel<2, Op>(A, x, b, r); return true;
+        case 3: BSR_kernel<3, Op>(A, x, b, r); return true;
+        case 4: BSR_kernel<4, Op>(A, x, b, r); return true;
+        case 6: BSR_kernel<6, Op>(A, x, b, r); return true;
+        case 8: BSR_kernel<8, Op>(A, x, b, r); return true;
+        default: return false;
+    }
+}
+
+template <typename Op>
+bool BSR_fixed_T(const BSRMatrix* A, const double* x, double* b)
+{
+    if (A->b_rows != A->b_cols || !A->is_packed())
+        return false;
+
+    switch (A->b_rows)
+    {
+        case 2: BSR_kernel_T<2, Op>(A, x, b); return true;
+        case 3: BSR_kernel_T<3, Op>(A, x, b); return true;
+        case 4: BSR_kernel_T<4, Op>(A, x, b); return true;
+        case 6: BSR_kernel_T<6, Op>(A, x, b); return true;
+        case 8: BSR_kernel_T<8, Op>(A, x, b); return true;
+        default: return false;
+    }
+}
+
+
+
 void CSRMatrix::spmv(const double* x, double* b) const
 {
     CSR_spmv(this, x, b);
@@ -347,28 +623,50 @@ void CSRMatrix::spmv_residual(const double* x, const double* b, double* r) const
 {
     CSR_residual(this, x, b, r);
 }
+void SELLMatrix::spmv(const double* x, double* b) const
+{
+    SELL_apply<SpMV_set>(this, x, NULL, b);
+}
+void SELLMatrix::spmv_append(const double* x, double* b) const
+{
+    SELL_apply<SpMV_add>(this, x, NULL, b);
+}
+void SELLMatrix::spmv_append_neg(const double* x, double* b) const
+{
+    SELL_apply<SpMV_sub>(this, x, NULL, b);
+}
+void SELLMatrix::spmv_residual(const double* x, const double* b, double* r) const
+{
+    SELL_apply<SpMV_res>(this, x, b, r);
+}
 void BSRMatrix::spmv(const double* x, double* b) const
 {
+    if (BSR_fixed<SpMV_set>(this, x, NULL, b)) return;
     BSR_spmv(this, x, b);
 }
 void BSRMatrix::spmv_append(const double* x,double* b) const
 {
+    if (BSR_fixed<SpMV_add>(this, x, NULL, b)) return;
     BSR_append(this, block_vals, x, b);
 }
 void BSRMatrix::spmv_append_T(const double* x,double* b) const
 {
+    if (BSR_fixed_T<SpMV_add>(this, x, b)) return;
     CSR_append_T(this, block_vals, x, b);
 }
 void BSRMatrix::spmv_append_neg(const double* x,double* b) const
 {
+    if (BSR_fixed<SpMV_sub>(this, x, NULL, b)) return;
     CSR_append_neg(this, block_vals, x, b);
 }
 void BSRMatrix::spmv_append_neg_T(const double* x,double* b) const
 {
+    if (BSR_fixed_T<SpMV_sub>(this, x, b)) return;
     CSR_append_neg_T(this, block_vals, x, b);
 }
 void BSRMatrix::spmv_residual(const double* x, const double* b, double* r) const
 {
+    if (BSR_fixed<SpMV_res>(this, x, b, r)) return;
     for (int i = 0; i < n_rows * b_rows; i++)
         r[i] = b[i];
     CSR_append_neg(this, block_vals, x, r);
@@ -0,0 +1,119 @@
+// Copyright (c) 2015-2017, RAPtor Developer Team
+// License: Simplified BSD, http://opensource.org/licenses/BSD-2-Clause
+#include "gtest/gtest.h"
+#include "raptor/raptor.hpp"
+#include "raptor/core/threads.hpp"
+#include <map>
+
+using namespace raptor;
+
+int main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+
+} // end of main() //
+
+void compare(CSRMatrix* A, std::vector<std::map<int, double> >& rows)
+{
+    A->sort();
+    ASSERT_EQ(A->n_rows, (int) rows.size());
+    for (int i = 0; i < A->n_rows; i++)
+    {
+        ASSERT_EQ(A->idx1[i+1] - A->idx1[i], (int) rows[i].size());
+        int j = A->idx1[i];
+        for (std::map<int, double>::iterator it = rows[i].begin();
+                it != rows[i].end(); ++it, ++j)
+        {
+            ASSERT_EQ(A->idx2[j], it->first);
+            ASSERT_NEAR(A->vals[j], it->second, 1e-10 * fabs(it->second));
+        }
+    }
+}
+
+TEST(ThreadedSpGEMMTest, TestsInUtil)
+{
+    int grid[3] = {20, 20, 20};
+    double* stencil = laplace_stencil_27pt();
+    CSRMatrix* A = stencil_grid(stencil, grid, 3);
+    delete[] stencil;
+
+    // Scale rows so A is not symmetric, and transposes are tested
+    for (int i = 0; i < A->n_rows; i++)
+    {
+        for (int j = A->idx1[i]; j < A->idx1[i+1]; j++)
+        {
+            A->vals[j] *= (1.0 + (i % 7));
+        }
+    }
+    ASSERT_GE(A->nnz, thread_min_work);
+
+    // Reference rows of A^T and A*A
+    std::vector<std::map<int, double> > AT_rows(A->n_cols);
+    std::vector<std::map<int, double> > AA_rows(A->n_rows);
+    for (int i = 0; i < A->n_rows; i++)
+    {
+        for (int j = A->idx1[i]; j < A->idx1[i+1]; j++)
+        {
+            int k = A->idx2[j];
+            AT_rows[k][i] += A->vals[j];
+            for (int l = A->idx1[k]; l < A->idx1[k+1]; l++)
+            {
+                AA_rows[i][A->idx2[l]] += A->vals[j] * A->vals[l];
+            }
+        }
+    }
+
+    // Reference rows of A^T*A
+    std::vector<std::map<int, double> > ATA_rows(A->n_cols);
+    for (int i = 0; i < A->n_cols; i++)
+    {
+        for (std::map<int, double>::iterator it = AT_rows[i].begin();
+                it != AT_rows[i].end(); ++it)
+        {
+            int k = it->first;
+            for (int l = A->idx1[k]; l < A->idx1[k+1]; l++)
+            {
+                ATA_rows[i][A->idx2[l]] += it->second * A->vals[l];
+            }
+        }
+    }
+
+    CSCMatrix* A_csc = A->to_CSC();
+    CSRMatrix* AT = A->transpose();
+    CSRMatrix* AA = A->mult(A);
+    CSRMatrix* ATA = A->mult_T(A_csc);
+
+    // Threaded and single threaded kernels form identical matrices
+#ifdef USING_OPENMP
+    int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    CSRMatrix* AA_serial = A->mult(A);
+    CSRMatrix* ATA_serial = A->mult_T(A_csc);
+    CSCMatrix* A_csc_serial = A->to_CSC();
+    omp_set_num_threads(max_threads);
+
+    ASSERT_EQ(AA->idx2, AA_serial->idx2);
+    ASSERT_EQ(AA->vals, AA_serial->vals);
+    ASSERT_EQ(ATA->idx2, ATA_serial->idx2);
+    ASSERT_EQ(ATA->vals, ATA_serial->vals);
+    ASSERT_EQ(A_csc->idx1, A_csc_serial->idx1);
+    ASSERT_EQ(A_csc->idx2, A_csc_serial->idx2);
+    ASSERT_EQ(A_csc->vals, A_csc_serial->vals);
+
+    delete AA_serial;
+    delete ATA_serial;
+    delete A_csc_serial;
+#endif
+
+    compare(AT, AT_rows);
+    compare(AA, AA_rows);
+    compare(ATA, ATA_rows);
+
+    delete A_csc;
+    delete AT;
+    delete AA;
+    delete ATA;
+    delete A;
+
+} // end of TEST(ThreadedSpGEMMTest, TestsInUtil) //